@@ -60,11 +60,12 @@
     #endif
 
 #else       /*LV_MEM_CUSTOM*/
-    #define LV_MEM_CUSTOM_INCLUDE "esp_heap_caps.h"   /*Header for the dynamic memory function*/
-    /*Use PSRAM for LVGL memory allocation when available, fallback to internal RAM*/
-    #define LV_MEM_CUSTOM_ALLOC(size)   heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
-    #define LV_MEM_CUSTOM_FREE(p)       heap_caps_free(p)
-    #define LV_MEM_CUSTOM_REALLOC(p, new_size) heap_caps_realloc(p, new_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+    #define LV_MEM_CUSTOM_INCLUDE "lvgl_mem.h"   /*Header for the dynamic memory function*/
+    /*Two-level heap (components/lvgl_mem): small objects from an internal-RAM size-class pool,
+     *bulk allocations (layers, decoded images, long text) from a dedicated PSRAM region*/
+    #define LV_MEM_CUSTOM_ALLOC(size)   lvgl_mem_alloc(size)
+    #define LV_MEM_CUSTOM_FREE(p)       lvgl_mem_free(p)
+    #define LV_MEM_CUSTOM_REALLOC(p, new_size) lvgl_mem_realloc(p, new_size)
 #endif     /*LV_MEM_CUSTOM*/
 
 
@@ -683,7 +684,7 @@
 #endif
 
 /*Tiny TTF library*/
-#define LV_USE_TINY_TTF 0
+#define LV_USE_TINY_TTF 1
 #if LV_USE_TINY_TTF
     /*Load TTF data from files*/
     #define LV_TINY_TTF_FILE_SUPPORT 0
@@ -0,0 +1,105 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * LVGL 两级堆
+ *
+ * lv_conf.h 的 LV_MEM_CUSTOM_ALLOC / FREE / REALLOC 指向这里：
+ * - 小块（<= LVGL_MEM_SMALL_MAX）：内部 RAM 分级池。池按 1 KB 页划分，
+ *   每页只放一种块大小，分配/释放都是 O(1)，页空出后归还给其他级别复用。
+ *   对象、样式、事件描述等每帧都要访问的小结构留在内部 RAM，不走 PSRAM。
+ * - 大块：独立的 PSRAM 区（TLSF），图层、图片解码、长文本等放这里，
+ *   不与系统其他 PSRAM 分配交错，碎片只在 LVGL 自己的区域内产生。
+ * 池满或区域用尽时依次回退到 PSRAM 区、通用 PSRAM 堆，不会因为池的大小而分配失败。
+ *
+ * 大小由 Kconfig 的 LVGL_MEM_INTERNAL_POOL_KB / LVGL_MEM_PSRAM_REGION_KB 配置，
+ * 第一次分配时建立（lv_init() 内）。内部池默认不建立（0 KB），小块与大块一样走 PSRAM 区。接口线程安全。
+ */
+
+#define LVGL_MEM_SMALL_MAX 256 // 走内部池的最大块（字节）
+#define LVGL_MEM_CLASS_NUM 8   // 块大小级别数：16/32/48/64/96/128/192/256
+#define LVGL_MEM_PAGE_SIZE 1024
+
+/** 单个块大小级别的统计 */
+typedef struct {
+    uint16_t slot_size; // 块大小（字节）
+    uint16_t pages;     // 当前占用的页数
+    uint32_t in_use;    // 使用中的块数
+    uint32_t peak;      // 使用中块数的高水位
+    uint32_t allocs;    // 累计分配次数
+    uint32_t overflow;  // 池满转入 PSRAM 的次数
+} lvgl_mem_class_stats_t;
+
+/** 堆统计 */
+typedef struct {
+    lvgl_mem_class_stats_t cls[LVGL_MEM_CLASS_NUM];
+
+    // 内部 RAM 分级池
+    size_t pool_bytes;        // 池大小
+    size_t pool_used_bytes;   // 已分配的块字节（按块大小计）
+    size_t pool_peak_bytes;   // 已分配块字节高水位
+    uint32_t pool_pages_used; // 已分配给某个级别的页数
+    uint32_t pool_pages_total;
+
+    // PSRAM 大块区
+    size_t psram_bytes;        // 区域大小（0 = 未建立）
+    size_t psram_used_bytes;   // 已分配字节
+    size_t psram_peak_bytes;   // 已分配字节高水位
+    size_t psram_free_bytes;   // 剩余字节
+    size_t psram_largest_free; // 最大连续空闲块
+    uint32_t psram_allocs;     // 累计分配次数
+
+    // 通用 PSRAM 堆（区域用尽或未建立时）
+    size_t heap_used_bytes;
+    size_t heap_peak_bytes;
+    uint32_t heap_allocs;
+
+    uint32_t failed; // 分配失败次数
+} lvgl_mem_stats_t;
+
+/**
+ * 分配内存（LV_MEM_CUSTOM_ALLOC）
+ * @param size 字节数
+ * @return 内存指针，失败返回 NULL
+ */
+void *lvgl_mem_alloc(size_t size);
+
+/**
+ * 释放内存（LV_MEM_CUSTOM_FREE），p 可以为 NULL
+ */
+void lvgl_mem_free(void *p);
+
+/**
+ * 重新分配（LV_MEM_CUSTOM_REALLOC）
+ * 块仍落在原级别时原地返回，否则按新大小重新选择层级并拷贝
+ * @param p 原指针（NULL 等同于 lvgl_mem_alloc）
+ * @param size 新大小（0 等同于 lvgl_mem_free，返回 NULL）
+ * @return 新指针，失败返回 NULL 且原内存不变
+ */
+void *lvgl_mem_realloc(void *p, size_t size);
+
+/**
+ * 获取堆统计
+ * @param stats 输出
+ */
+void lvgl_mem_get_stats(lvgl_mem_stats_t *stats);
+
+/**
+ * 把所有高水位重置为当前占用（用于分场景统计）
+ */
+void lvgl_mem_reset_peak(void);
+
+/**
+ * 打印分级统计、高水位和碎片率
+ */
+void lvgl_mem_print_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,474 @@
+#include "lvgl_mem.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#include "multi_heap.h"
+#include "freertos/FreeRTOS.h"
+#endif
+
+#ifndef CONFIG_LVGL_MEM_INTERNAL_POOL_KB
+#define CONFIG_LVGL_MEM_INTERNAL_POOL_KB 0
+#endif
+#ifndef CONFIG_LVGL_MEM_PSRAM_REGION_KB
+#define CONFIG_LVGL_MEM_PSRAM_REGION_KB 512
+#endif
+
+static const char *TAG = "LVGL_MEM";
+
+#ifdef ESP_PLATFORM
+// 池和 PSRAM 区的操作都是 O(1)，临界区很短；与 IDF 堆自身的加锁方式相同
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+#define MEM_LOCK() portENTER_CRITICAL(&s_lock)
+#define MEM_UNLOCK() portEXIT_CRITICAL(&s_lock)
+#else
+#define MEM_LOCK()
+#define MEM_UNLOCK()
+#endif
+
+#define PSRAM_CAPS (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#define POOL_PAGES (CONFIG_LVGL_MEM_INTERNAL_POOL_KB * 1024 / LVGL_MEM_PAGE_SIZE)
+#define PAGE_NONE 0xFFFF
+#define SLOT_NONE 0xFF
+
+// ============== 内部 RAM 分级池 ==============
+
+static const uint16_t s_class_size[LVGL_MEM_CLASS_NUM] = {16, 32, 48, 64, 96, 128, 192, 256};
+
+// 按 16 字节向上取整后的下标 → 级别
+static const uint8_t s_class_of[LVGL_MEM_SMALL_MAX / 16 + 1] = {
+    0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
+};
+
+/**
+ * 页描述，放在池外（静态区）
+ * 页内空闲块用块首字节串成链表；从未分配过的块按序切分，无需预先建链
+ */
+typedef struct {
+    uint8_t cls;       // 所属级别，SLOT_NONE 表示空闲页
+    uint8_t used;      // 页内使用中的块数
+    uint8_t free_head; // 页内空闲链表头（块序号）
+    uint8_t carved;    // 已切分出的块数
+    uint16_t next;     // 空闲页链表 / 级别半满页链表
+    uint16_t prev;
+} page_t;
+
+static page_t s_pages[POOL_PAGES > 0 ? POOL_PAGES : 1];
+static uint8_t *s_pool = NULL;
+static size_t s_pool_size = 0;
+static uint16_t s_free_pages = PAGE_NONE;                // 空闲页（单向）
+static uint16_t s_partial[LVGL_MEM_CLASS_NUM];           // 各级别尚有空位的页（双向）
+
+// ============== PSRAM 大块区 ==============
+
+static uint8_t *s_region = NULL;
+static size_t s_region_size = 0;
+#ifdef ESP_PLATFORM
+static multi_heap_handle_t s_region_heap = NULL;
+#endif
+
+static lvgl_mem_stats_t s_stats;
+static bool s_inited = false;
+
+static inline int class_of(size_t size) {
+    return s_class_of[(size + 15) >> 4];
+}
+
+static inline uint8_t class_slots(int cls) {
+    return (uint8_t)(LVGL_MEM_PAGE_SIZE / s_class_size[cls]);
+}
+
+static inline bool in_pool(const void *p) {
+    return s_pool && (const uint8_t *)p >= s_pool && (const uint8_t *)p < s_pool + s_pool_size;
+}
+
+static inline bool in_region(const void *p) {
+    return s_region && (const uint8_t *)p >= s_region && (const uint8_t *)p < s_region + s_region_size;
+}
+
+static void list_push(uint16_t *head, uint16_t pg) {
+    s_pages[pg].prev = PAGE_NONE;
+    s_pages[pg].next = *head;
+    if (*head != PAGE_NONE) {
+        s_pages[*head].prev = pg;
+    }
+    *head = pg;
+}
+
+static void list_remove(uint16_t *head, uint16_t pg) {
+    page_t *p = &s_pages[pg];
+    if (p->prev != PAGE_NONE) {
+        s_pages[p->prev].next = p->next;
+    } else {
+        *head = p->next;
+    }
+    if (p->next != PAGE_NONE) {
+        s_pages[p->next].prev = p->prev;
+    }
+}
+
+/**
+ * @brief 建立内部池和 PSRAM 区
+ * 第一次分配（lv_init 内）时调用，此时只有 LVGL 任务在使用本模块
+ */
+static void mem_init(void) {
+    s_inited = true;
+    for (int i = 0; i < LVGL_MEM_CLASS_NUM; i++) {
+        s_partial[i] = PAGE_NONE;
+        s_stats.cls[i].slot_size = s_class_size[i];
+    }
+
+    if (POOL_PAGES > 0) {
+        size_t bytes = (size_t)POOL_PAGES * LVGL_MEM_PAGE_SIZE;
+        uint8_t *raw = heap_caps_malloc(bytes + 15, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (raw) {
+            s_pool = (uint8_t *)(((uintptr_t)raw + 15) & ~(uintptr_t)15);
+            s_pool_size = bytes;
+            for (int i = POOL_PAGES - 1; i >= 0; i--) {
+                s_pages[i].cls = SLOT_NONE;
+                s_pages[i].next = s_free_pages;
+                s_free_pages = (uint16_t)i;
+            }
+            s_stats.pool_bytes = bytes;
+            s_stats.pool_pages_total = POOL_PAGES;
+        } else {
+            ESP_LOGW(TAG, "内部 RAM 不足，小块池未建立，全部分配走 PSRAM");
+        }
+    }
+
+#ifdef ESP_PLATFORM
+    size_t region = (size_t)CONFIG_LVGL_MEM_PSRAM_REGION_KB * 1024;
+    if (region > 0) {
+        s_region = heap_caps_malloc(region, PSRAM_CAPS);
+        if (s_region) {
+            s_region_heap = multi_heap_register(s_region, region);
+        }
+        if (s_region_heap) {
+            s_region_size = region;
+            s_stats.psram_bytes = region;
+        } else {
+            heap_caps_free(s_region);
+            s_region = NULL;
+            ESP_LOGW(TAG, "PSRAM 区建立失败，大块直接使用通用 PSRAM 堆");
+        }
+    }
+#endif
+
+    ESP_LOGI(TAG, "LVGL 堆: 内部池 %u KB（%u 页），PSRAM 区 %u KB", (unsigned)(s_pool_size / 1024),
+             (unsigned)s_stats.pool_pages_total, (unsigned)(s_region_size / 1024));
+}
+
+static void *pool_alloc(int cls) {
+    uint16_t pg = s_partial[cls];
+    if (pg == PAGE_NONE) {
+        pg = s_free_pages;
+        if (pg == PAGE_NONE) {
+            return NULL;
+        }
+        page_t *np = &s_pages[pg];
+        s_free_pages = np->next;
+        np->cls = (uint8_t)cls;
+        np->used = 0;
+        np->free_head = SLOT_NONE;
+        np->carved = 0;
+        list_push(&s_partial[cls], pg);
+        s_stats.cls[cls].pages++;
+        s_stats.pool_pages_used++;
+    }
+
+    page_t *p = &s_pages[pg];
+    uint16_t size = s_class_size[cls];
+    uint8_t *base = s_pool + (size_t)pg * LVGL_MEM_PAGE_SIZE;
+    uint8_t slot;
+    if (p->free_head != SLOT_NONE) {
+        slot = p->free_head;
+        p->free_head = base[(size_t)slot * size];
+    } else {
+        slot = p->carved++;
+    }
+    if (++p->used == class_slots(cls)) {
+        list_remove(&s_partial[cls], pg);
+    }
+
+    lvgl_mem_class_stats_t *cs = &s_stats.cls[cls];
+    cs->allocs++;
+    if (++cs->in_use > cs->peak) {
+        cs->peak = cs->in_use;
+    }
+    s_stats.pool_used_bytes += size;
+    if (s_stats.pool_used_bytes > s_stats.pool_peak_bytes) {
+        s_stats.pool_peak_bytes = s_stats.pool_used_bytes;
+    }
+    return base + (size_t)slot * size;
+}
+
+static void pool_free(void *ptr) {
+    size_t off = (size_t)((uint8_t *)ptr - s_pool);
+    uint16_t pg = (uint16_t)(off / LVGL_MEM_PAGE_SIZE);
+    page_t *p = &s_pages[pg];
+    int cls = p->cls;
+    uint16_t size = s_class_size[cls];
+    bool was_full = p->used == class_slots(cls);
+
+    *(uint8_t *)ptr = p->free_head;
+    p->free_head = (uint8_t)((off % LVGL_MEM_PAGE_SIZE) / size);
+    p->used--;
+
+    if (p->used == 0) {
+        // 整页空出，归还给所有级别共用
+        if (!was_full) {
+            list_remove(&s_partial[cls], pg);
+        }
+        p->cls = SLOT_NONE;
+        p->next = s_free_pages;
+        s_free_pages = pg;
+        s_stats.cls[cls].pages--;
+        s_stats.pool_pages_used--;
+    } else if (was_full) {
+        list_push(&s_partial[cls], pg);
+    }
+
+    s_stats.cls[cls].in_use--;
+    s_stats.pool_used_bytes -= size;
+}
+
+// ============== 大块 ==============
+
+static void *region_alloc(size_t size) {
+#ifdef ESP_PLATFORM
+    if (!s_region_heap) {
+        return NULL;
+    }
+    void *p = multi_heap_malloc(s_region_heap, size);
+    if (p) {
+        s_stats.psram_allocs++;
+        s_stats.psram_used_bytes += multi_heap_get_allocated_size(s_region_heap, p);
+        if (s_stats.psram_used_bytes > s_stats.psram_peak_bytes) {
+            s_stats.psram_peak_bytes = s_stats.psram_used_bytes;
+        }
+    }
+    return p;
+#else
+    (void)size;
+    return NULL;
+#endif
+}
+
+static void region_free(void *p) {
+#ifdef ESP_PLATFORM
+    s_stats.psram_used_bytes -= multi_heap_get_allocated_size(s_region_heap, p);
+    multi_heap_free(s_region_heap, p);
+#else
+    (void)p;
+#endif
+}
+
+static void heap_account(size_t old_size, size_t new_size) {
+    MEM_LOCK();
+    s_stats.heap_used_bytes = s_stats.heap_used_bytes - old_size + new_size;
+    if (s_stats.heap_used_bytes > s_stats.heap_peak_bytes) {
+        s_stats.heap_peak_bytes = s_stats.heap_used_bytes;
+    }
+    MEM_UNLOCK();
+}
+
+static size_t block_size(void *p) {
+    if (in_pool(p)) {
+        return s_class_size[s_pages[((uint8_t *)p - s_pool) / LVGL_MEM_PAGE_SIZE].cls];
+    }
+#ifdef ESP_PLATFORM
+    if (in_region(p)) {
+        return multi_heap_get_allocated_size(s_region_heap, p);
+    }
+#endif
+    return heap_caps_get_allocated_size(p);
+}
+
+// ============== 对外接口 ==============
+
+void *lvgl_mem_alloc(size_t size) {
+    if (!s_inited) {
+        mem_init();
+    }
+    if (size == 0) {
+        size = 1;
+    }
+
+    void *p = NULL;
+    MEM_LOCK();
+    if (size <= LVGL_MEM_SMALL_MAX && s_pool) {
+        int cls = class_of(size);
+        p = pool_alloc(cls);
+        if (!p) {
+            s_stats.cls[cls].overflow++;
+        }
+    }
+    if (!p) {
+        p = region_alloc(size);
+    }
+    MEM_UNLOCK();
+    if (p) {
+        return p;
+    }
+
+    p = heap_caps_malloc(size, PSRAM_CAPS);
+    if (p) {
+        heap_account(0, heap_caps_get_allocated_size(p));
+        MEM_LOCK();
+        s_stats.heap_allocs++;
+        MEM_UNLOCK();
+    } else {
+        MEM_LOCK();
+        s_stats.failed++;
+        MEM_UNLOCK();
+    }
+    return p;
+}
+
+void lvgl_mem_free(void *p) {
+    if (!p) {
+        return;
+    }
+    if (in_pool(p)) {
+        MEM_LOCK();
+        pool_free(p);
+        MEM_UNLOCK();
+        return;
+    }
+    if (in_region(p)) {
+        MEM_LOCK();
+        region_free(p);
+        MEM_UNLOCK();
+        return;
+    }
+    heap_account(heap_caps_get_allocated_size(p), 0);
+    heap_caps_free(p);
+}
+
+void *lvgl_mem_realloc(void *p, size_t size) {
+    if (!p) {
+        return lvgl_mem_alloc(size);
+    }
+    if (size == 0) {
+        lvgl_mem_free(p);
+        return NULL;
+    }
+
+    size_t old_size = block_size(p);
+    if (in_pool(p)) {
+        // 仍落在同一级别，原地返回
+        if (size <= LVGL_MEM_SMALL_MAX && s_class_size[class_of(size)] == old_size) {
+            return p;
+        }
+    } else if (size > LVGL_MEM_SMALL_MAX || !s_pool) {
+        // 大块保持大块：交给所在的堆原地扩缩
+#ifdef ESP_PLATFORM
+        if (in_region(p)) {
+            MEM_LOCK();
+            void *np = multi_heap_realloc(s_region_heap, p, size);
+            if (np) {
+                s_stats.psram_used_bytes =
+                    s_stats.psram_used_bytes - old_size + multi_heap_get_allocated_size(s_region_heap, np);
+                if (s_stats.psram_used_bytes > s_stats.psram_peak_bytes) {
+                    s_stats.psram_peak_bytes = s_stats.psram_used_bytes;
+                }
+            }
+            MEM_UNLOCK();
+            if (np) {
+                return np;
+            }
+            // 区域内放不下，下面改从通用堆分配
+        } else
+#endif
+        {
+            void *np = heap_caps_realloc(p, size, PSRAM_CAPS);
+            if (np) {
+                heap_account(old_size, heap_caps_get_allocated_size(np));
+            } else {
+                MEM_LOCK();
+                s_stats.failed++;
+                MEM_UNLOCK();
+            }
+            return np;
+        }
+    }
+
+    // 跨层级：重新分配并拷贝
+    void *np = lvgl_mem_alloc(size);
+    if (!np) {
+        return NULL;
+    }
+    memcpy(np, p, old_size < size ? old_size : size);
+    lvgl_mem_free(p);
+    return np;
+}
+
+void lvgl_mem_get_stats(lvgl_mem_stats_t *stats) {
+    if (!s_inited) {
+        mem_init();
+    }
+    MEM_LOCK();
+    *stats = s_stats;
+#ifdef ESP_PLATFORM
+    if (s_region_heap) {
+        multi_heap_info_t info;
+        multi_heap_get_info(s_region_heap, &info);
+        stats->psram_free_bytes = info.total_free_bytes;
+        stats->psram_largest_free = info.largest_free_block;
+    }
+#endif
+    MEM_UNLOCK();
+}
+
+void lvgl_mem_reset_peak(void) {
+    MEM_LOCK();
+    for (int i = 0; i < LVGL_MEM_CLASS_NUM; i++) {
+        s_stats.cls[i].peak = s_stats.cls[i].in_use;
+    }
+    s_stats.pool_peak_bytes = s_stats.pool_used_bytes;
+    s_stats.psram_peak_bytes = s_stats.psram_used_bytes;
+    s_stats.heap_peak_bytes = s_stats.heap_used_bytes;
+    MEM_UNLOCK();
+}
+
+void lvgl_mem_print_stats(void) {
+    lvgl_mem_stats_t st;
+    lvgl_mem_get_stats(&st);
+
+    ESP_LOGI(TAG, "【LVGL 堆】");
+
+    // 页内碎片：已分给某个级别、但块没有用满的那部分
+    size_t page_bytes = (size_t)st.pool_pages_used * LVGL_MEM_PAGE_SIZE;
+    float pool_frag = page_bytes > 0 ? (1.0f - (float)st.pool_used_bytes / page_bytes) * 100.0f : 0.0f;
+    ESP_LOGI(TAG, "  内部池: 已用 %zu / %zu 字节（高水位 %zu），页 %u / %u，页内碎片 %.1f%%", st.pool_used_bytes,
+             st.pool_bytes, st.pool_peak_bytes, (unsigned)st.pool_pages_used, (unsigned)st.pool_pages_total,
+             pool_frag);
+    for (int i = 0; i < LVGL_MEM_CLASS_NUM; i++) {
+        const lvgl_mem_class_stats_t *cs = &st.cls[i];
+        if (cs->allocs == 0 && cs->overflow == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "    %3u B: 页 %u，使用 %u / %u 块（高水位 %u），累计 %u 次，池满溢出 %u 次",
+                 (unsigned)cs->slot_size, (unsigned)cs->pages, (unsigned)cs->in_use,
+                 (unsigned)(cs->pages * (LVGL_MEM_PAGE_SIZE / cs->slot_size)), (unsigned)cs->peak,
+                 (unsigned)cs->allocs, (unsigned)cs->overflow);
+    }
+
+    if (st.psram_bytes > 0) {
+        // 外部碎片：剩余空间中不能作为一整块分配出去的比例
+        float region_frag = st.psram_free_bytes > 0
+                                ? (1.0f - (float)st.psram_largest_free / st.psram_free_bytes) * 100.0f
+                                : 0.0f;
+        ESP_LOGI(TAG, "  PSRAM 区: 已用 %zu / %zu 字节（高水位 %zu），最大空闲块 %zu，碎片 %.1f%%，累计 %u 次",
+                 st.psram_used_bytes, st.psram_bytes, st.psram_peak_bytes, st.psram_largest_free, region_frag,
+                 (unsigned)st.psram_allocs);
+    }
+    ESP_LOGI(TAG, "  通用 PSRAM 堆: 已用 %zu 字节（高水位 %zu），累计 %u 次", st.heap_used_bytes,
+             st.heap_peak_bytes, (unsigned)st.heap_allocs);
+    if (st.failed > 0) {
+        ESP_LOGW(TAG, "  分配失败 %u 次", (unsigned)st.failed);
+    }
+}
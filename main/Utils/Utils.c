@@ -7,6 +7,8 @@
 #include "esp_chip_info.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "lvgl_mem.h"
+#include "eez_heap.h"
 
 static const char *TAG = "Utils";
 
@@ -101,132 +103,37 @@ void utils_print_memory_info(void) {
 }
 
 void utils_print_memory_breakdown(void) {
-    // ESP_LOGI(TAG, "========== 详细内存占用分解 ==========");
-    
-    // // 1. 获取总内存和已用内存
-    // size_t total_internal = heap_caps_get_total_size(MALLOC_CAP_INTERNAL);
-    // size_t free_internal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
-    // size_t used_internal = total_internal - free_internal;
-    
-    // size_t total_spiram = heap_caps_get_total_size(MALLOC_CAP_SPIRAM);
-    // size_t free_spiram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
-    // size_t used_spiram = total_spiram > 0 ? (total_spiram - free_spiram) : 0;
-    
-    // ESP_LOGI(TAG, "【内部RAM (512KB总容量)】");
-    // ESP_LOGI(TAG, "  - 总容量: %zu KB", total_internal / 1024);
-    // ESP_LOGI(TAG, "  - 已使用: %zu KB (%.1f%%)", used_internal / 1024, 
-    //          (float)used_internal / total_internal * 100.0f);
-    // ESP_LOGI(TAG, "  - 可用: %zu KB (%.1f%%)", free_internal / 1024,
-    //          (float)free_internal / total_internal * 100.0f);
-    // ESP_LOGI(TAG, "  - 最大连续块: %zu KB", 
-    //          heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL) / 1024);
-    
-    // if (total_spiram > 0) {
-    //     ESP_LOGI(TAG, "【SPIRAM (外部PSRAM)】");
-    //     ESP_LOGI(TAG, "  - 总容量: %zu KB (%.2f MB)", total_spiram / 1024, total_spiram / 1024.0 / 1024.0);
-    //     ESP_LOGI(TAG, "  - 已使用: %zu KB (%.1f%%)", used_spiram / 1024,
-    //              (float)used_spiram / total_spiram * 100.0f);
-    //     ESP_LOGI(TAG, "  - 可用: %zu KB (%.1f%%)", free_spiram / 1024,
-    //              (float)free_spiram / total_spiram * 100.0f);
-    //     ESP_LOGI(TAG, "  - 最大连续块: %zu KB", 
-    //              heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) / 1024);
-    // }
-    
-    // // 2. 打印堆信息（ESP-IDF内部信息）
-    // ESP_LOGI(TAG, "【堆内存详细信息】");
-    // ESP_LOGI(TAG, "内部RAM堆:");
-    // heap_caps_print_heap_info(MALLOC_CAP_INTERNAL);
-    
-    // if (total_spiram > 0) {
-    //     ESP_LOGI(TAG, "SPIRAM堆:");
-    //     heap_caps_print_heap_info(MALLOC_CAP_SPIRAM);
-    // }
-    
-    // // 3. 任务栈占用统计
-    // ESP_LOGI(TAG, "【FreeRTOS任务栈占用】");
-    // UBaseType_t task_count = uxTaskGetNumberOfTasks();
-    // TaskStatus_t *task_array = (TaskStatus_t *)malloc(sizeof(TaskStatus_t) * task_count);
-    
-    // if (task_array != NULL) {
-    //     UBaseType_t actual_count = uxTaskGetSystemState(task_array, task_count, NULL);
-        
-    //     for (UBaseType_t i = 0; i < actual_count; i++) {
-    //         UBaseType_t stack_remaining = task_array[i].usStackHighWaterMark;
-            
-    //         // 只显示栈剩余空间较小的任务（说明使用了较多栈）
-    //         if (stack_remaining < 2048) {  // 剩余少于2KB的任务
-    //             ESP_LOGI(TAG, "  - %s: 剩余 %u 字节 (栈使用率较高)",
-    //                      task_array[i].pcTaskName, stack_remaining);
-    //         }
-    //     }
-        
-    //     ESP_LOGI(TAG, "  - 总任务数: %u", actual_count);
-    //     ESP_LOGI(TAG, "  - 当前任务栈剩余: %zu KB", 
-    //              uxTaskGetStackHighWaterMark(NULL) / 1024);
-    //     free(task_array);
-    // }
-    
-    // // 4. 组件内存占用估算
-    // ESP_LOGI(TAG, "【组件内存占用估算】");
-    
-    // // WiFi内存占用估算
-    // size_t wifi_estimated = 0;
-    // #ifdef CONFIG_ESP_WIFI_STATIC_RX_BUFFER_NUM
-    // // WiFi静态缓冲区：每个约1.6KB
-    // wifi_estimated += CONFIG_ESP_WIFI_STATIC_RX_BUFFER_NUM * 1600;
-    // #endif
-    // #ifdef CONFIG_ESP_WIFI_DYNAMIC_RX_BUFFER_NUM
-    // // WiFi动态缓冲区：每个约1.6KB
-    // wifi_estimated += CONFIG_ESP_WIFI_DYNAMIC_RX_BUFFER_NUM * 1600;
-    // #endif
-    // if (wifi_estimated > 0) {
-    //     ESP_LOGI(TAG, "  - WiFi缓冲区: 约 %zu KB (静态+动态)", wifi_estimated / 1024);
-    // }
-    
-    // // LWIP TCP/IP栈
-    // #ifdef CONFIG_LWIP_TCP_SND_BUF_DEFAULT
-    // size_t lwip_estimated = CONFIG_LWIP_TCP_SND_BUF_DEFAULT + 
-    //                        CONFIG_LWIP_TCP_WND_DEFAULT;
-    // ESP_LOGI(TAG, "  - LWIP TCP/IP栈: 约 %zu KB", lwip_estimated / 1024);
-    // #endif
-    
-    // // mbedTLS内存（HTTPS需要）
-    // size_t mbedtls_estimated = 40 * 1024;  // 估算40KB用于HTTPS握手
-    // ESP_LOGI(TAG, "  - mbedTLS (HTTPS): 约 %zu KB (握手时临时占用)", mbedtls_estimated / 1024);
-    
-    // // 5. 内存碎片化分析
-    // ESP_LOGI(TAG, "【内存碎片化分析】");
-    // size_t largest_block = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
-    // float fragmentation = free_internal > 0 ? 
-    //                      (1.0f - (float)largest_block / free_internal) * 100.0f : 0.0f;
-    // ESP_LOGI(TAG, "  - 碎片化程度: %.1f%% (0%%=无碎片, 100%%=完全碎片化)", fragmentation);
-    // if (fragmentation > 50.0f) {
-    //     ESP_LOGW(TAG, "  ⚠️ 警告：内存碎片化严重，可能影响大块内存分配");
-    // }
-    
-    // // 6. 内存使用建议
-    // ESP_LOGI(TAG, "【内存优化建议】");
-    // if (free_internal < 50 * 1024) {
-    //     ESP_LOGW(TAG, "  ⚠️ 内部RAM严重不足（<50KB），建议：");
-    //     ESP_LOGW(TAG, "     1. 检查是否有内存泄漏");
-    //     ESP_LOGW(TAG, "     2. 减少WiFi缓冲区数量（当前: %d)", 
-    //              #ifdef CONFIG_ESP_WIFI_STATIC_RX_BUFFER_NUM
-    //              CONFIG_ESP_WIFI_STATIC_RX_BUFFER_NUM
-    //              #else
-    //              10
-    //              #endif
-    //              );
-    //     ESP_LOGW(TAG, "     3. 确保大缓冲区（>64KB）使用SPIRAM");
-    //     ESP_LOGW(TAG, "     4. 减少任务栈大小");
-    // }
-    
-    // if (fragmentation > 30.0f) {
-    //     ESP_LOGW(TAG, "  ⚠️ 内存碎片化，建议：");
-    //     ESP_LOGW(TAG, "     1. 避免频繁分配/释放不同大小的内存");
-    //     ESP_LOGW(TAG, "     2. 使用内存池管理固定大小的内存块");
-    // }
-    
-    // ESP_LOGI(TAG, "========================================");
+    ESP_LOGI(TAG, "========== 详细内存占用分解 ==========");
+
+    size_t total_internal = heap_caps_get_total_size(MALLOC_CAP_INTERNAL);
+    size_t free_internal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    size_t largest_internal = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    ESP_LOGI(TAG, "【内部RAM】");
+    ESP_LOGI(TAG, "  - 已使用: %zu / %zu KB，可用 %zu KB，最大连续块 %zu KB，历史最小剩余 %zu KB",
+             (total_internal - free_internal) / 1024, total_internal / 1024, free_internal / 1024,
+             largest_internal / 1024, heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL) / 1024);
+    ESP_LOGI(TAG, "  - 碎片化程度: %.1f%% (0%%=无碎片, 100%%=完全碎片化)",
+             free_internal > 0 ? (1.0f - (float)largest_internal / free_internal) * 100.0f : 0.0f);
+
+    size_t total_spiram = heap_caps_get_total_size(MALLOC_CAP_SPIRAM);
+    if (total_spiram > 0) {
+        size_t free_spiram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+        size_t largest_spiram = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        ESP_LOGI(TAG, "【SPIRAM (外部PSRAM)】");
+        ESP_LOGI(TAG, "  - 已使用: %zu / %zu KB，可用 %zu KB，最大连续块 %zu KB",
+                 (total_spiram - free_spiram) / 1024, total_spiram / 1024, free_spiram / 1024,
+                 largest_spiram / 1024);
+        ESP_LOGI(TAG, "  - 碎片化程度: %.1f%%",
+                 free_spiram > 0 ? (1.0f - (float)largest_spiram / free_spiram) * 100.0f : 0.0f);
+    }
+
+    // LVGL 两级堆：内部池分级统计、PSRAM 区高水位与碎片
+    lvgl_mem_print_stats();
+
+    // EEZ flow 堆：分级占用、碎片和占用最多的分配 id（只读统计，不与 LVGL 任务同步，数值为近似）
+    eez_heap_print_stats();
+
+    ESP_LOGI(TAG, "========================================");
 }
 
 int utils_get_memory_info_string(char *buffer, size_t buffer_size) {
@@ -249,3 +156,43 @@ int utils_get_memory_info_string(char *buffer, size_t buffer_size) {
     return (written < 0 || (size_t)written >= buffer_size) ? -1 : written;
 }
 
+// ============================================================================
+// 内存回收钩子
+// ============================================================================
+
+typedef struct {
+    const char *name;
+    utils_mem_reclaim_fn_t fn;
+} mem_reclaim_hook_t;
+
+static mem_reclaim_hook_t s_reclaim_hooks[UTILS_MEM_RECLAIM_MAX];
+static int s_reclaim_hook_count = 0;
+
+void utils_mem_reclaim_register(const char *name, utils_mem_reclaim_fn_t fn) {
+    for (int i = 0; i < s_reclaim_hook_count; i++) {
+        if (s_reclaim_hooks[i].fn == fn) {
+            return;
+        }
+    }
+    if (s_reclaim_hook_count >= UTILS_MEM_RECLAIM_MAX) {
+        ESP_LOGE(TAG, "内存回收钩子已满，忽略 %s", name);
+        return;
+    }
+    s_reclaim_hooks[s_reclaim_hook_count].name = name;
+    s_reclaim_hooks[s_reclaim_hook_count].fn = fn;
+    s_reclaim_hook_count++;
+}
+
+bool utils_mem_reclaim_internal(size_t need) {
+    size_t free_internal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    for (int i = 0; i < s_reclaim_hook_count && free_internal < need; i++) {
+        size_t before = free_internal;
+        s_reclaim_hooks[i].fn();
+        free_internal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+        if (free_internal > before) {
+            ESP_LOGI(TAG, "内部 RAM 不足 %zu KB，回收 %s：释放 %zu KB，可用 %zu KB", need / 1024,
+                     s_reclaim_hooks[i].name, (free_internal - before) / 1024, free_internal / 1024);
+        }
+    }
+    return free_internal >= need;
+}
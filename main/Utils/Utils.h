@@ -4,6 +4,7 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stddef.h>
 
 /**
@@ -22,7 +23,8 @@ void utils_print_memory_info(void);
 
 /**
  * 打印详细的内存占用分解
- * 显示各个内存类型的占用情况、任务栈占用、组件内存占用等
+ * 显示内部RAM / SPIRAM 的占用与碎片，LVGL 两级堆的分级统计、高水位和碎片，
+ * 以及 EEZ flow 堆的分级占用和按分配 id 的统计
  */
 void utils_print_memory_breakdown(void);
 
@@ -34,6 +36,26 @@ void utils_print_memory_breakdown(void);
  */
 int utils_get_memory_info_string(char *buffer, size_t buffer_size);
 
+#define UTILS_MEM_RECLAIM_MAX 4 // 内存回收钩子上限
+
+/**
+ * 内存回收钩子：释放可按需重建的常驻状态（如 AI 对话的预热状态）
+ * 钩子自行判断当前能否释放，正在使用时直接返回
+ */
+typedef void (*utils_mem_reclaim_fn_t)(void);
+
+/**
+ * 注册内存回收钩子（在启动 / 模块初始化时调用，按注册顺序执行）
+ */
+void utils_mem_reclaim_register(const char *name, utils_mem_reclaim_fn_t fn);
+
+/**
+ * 内部 RAM 可用不足 need 字节时依次调用回收钩子，直到满足或钩子用尽
+ * 供 TLS 握手等需要较多内部 RAM 的操作在开始前调用
+ * @return 调用结束时内部 RAM 是否满足 need
+ */
+bool utils_mem_reclaim_internal(size_t need);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,318 @@
+/**
+ * @file audio_mixer.c
+ * @brief 软件混音器实现
+ */
+
+#include "audio_mixer.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/idf_additions.h"
+#include "freertos/semphr.h"
+#include "freertos/stream_buffer.h"
+#include "freertos/task.h"
+#include "metrics.h"
+#include <string.h>
+
+static const char *TAG = "AudioMixer";
+
+// ============================================================================
+// 配置参数
+// ============================================================================
+
+#define MIX_RATE CONFIG_APP_AUDIO_MIXER_SAMPLE_RATE
+#define MIX_FRAMES 256                     // 每周期输出帧数（44.1 kHz 时约 5.8 ms）
+#define MIX_STAGE_FRAMES (MIX_FRAMES * 2 + 2) // 输入采样率最高为输出的 2 倍
+
+#define MIX_TASK_STACK 4096
+#define MIX_TASK_PRIO 6 // 高于所有生产者（播放器 3、AI 播放 4、提示音 4）
+#define MIX_TASK_CORE 1
+
+#define MIX_ACTIVE_HOLD_US 300000 // 停止出声后仍按有声处理的时间，避免 TTS 包间隙时音乐忽高忽低
+#define MIX_RAMP_STEP 16          // 每周期增益最多变化 16/256（约 90 ms 完成一次闪避）
+#define MIX_FORMAT_WAIT_MS 1000   // 切换格式时等待旧数据播完的上限
+
+#define Q16_ONE 65536u
+
+// ============================================================================
+// 内部变量
+// ============================================================================
+
+typedef struct {
+    StreamBufferHandle_t ring; // 设置格式后创建
+    uint32_t rate;
+    uint8_t channels;
+    uint32_t step;  // 每输出一帧前进的输入帧数（Q16）
+    uint32_t phase; // prev 与 cur 之间的位置（Q16），≥ Q16_ONE 表示需要读下一帧
+    int16_t prev[2];
+    int16_t cur[2];
+    uint8_t gain;     // 通道增益 %
+    int32_t level;    // 当前实际增益（Q8，向目标渐变）
+    bool playing;     // 上一周期是否取满（用于统计断音）
+    int64_t active_until_us;
+    int16_t *stage;   // 从环中取出的输入帧
+} mixer_ring_t;
+
+/** 闪避规则：triggers 中任一通道有声时，ch 压低到 percent% */
+typedef struct {
+    mixer_channel_t ch;
+    uint32_t triggers;
+    uint8_t percent;
+} mixer_duck_rule_t;
+
+#define MIXER_MASK(ch) (1u << (ch))
+
+static const mixer_duck_rule_t s_duck_rules[] = {
+    {MIXER_CH_MUSIC, MIXER_MASK(MIXER_CH_TTS) | MIXER_MASK(MIXER_CH_PROMPT), CONFIG_APP_AUDIO_MIXER_MUSIC_DUCK},
+};
+
+static mixer_ring_t s_rings[MIXER_CH_COUNT];
+static SemaphoreHandle_t s_lock = NULL; // 混音周期与格式切换 / 清空互斥
+static TaskHandle_t s_task = NULL;
+static i2s_chan_handle_t s_tx = NULL;
+static volatile uint8_t s_master = 100;
+static metric_t *s_underrun_metric = NULL;
+
+static int16_t s_out[MIX_FRAMES * 2];
+static int32_t s_acc[MIX_FRAMES * 2];
+
+// ============================================================================
+// 混音
+// ============================================================================
+
+static int32_t target_level(int ch, uint32_t active_mask) {
+    int32_t level = s_rings[ch].gain * 256 / 100;
+    for (size_t i = 0; i < sizeof(s_duck_rules) / sizeof(s_duck_rules[0]); i++) {
+        if ((int)s_duck_rules[i].ch == ch && (s_duck_rules[i].triggers & active_mask)) {
+            level = level * s_duck_rules[i].percent / 100;
+        }
+    }
+    return level;
+}
+
+/**
+ * 把一个通道的本周期数据插值后累加到 s_acc
+ * @return 输出的帧数（< MIX_FRAMES 表示欠载）
+ */
+static int mix_ring(mixer_ring_t *r) {
+    size_t frame_bytes = r->channels * sizeof(int16_t);
+    size_t need = ((r->phase + (uint64_t)(MIX_FRAMES - 1) * r->step) >> 16);
+    size_t avail = xStreamBufferBytesAvailable(r->ring) / frame_bytes;
+    if (need > avail) {
+        need = avail;
+    }
+    if (need > MIX_STAGE_FRAMES) {
+        need = MIX_STAGE_FRAMES;
+    }
+    size_t got = need ? xStreamBufferReceive(r->ring, r->stage, need * frame_bytes, 0) / frame_bytes : 0;
+
+    size_t idx = 0;
+    int frames = 0;
+    for (; frames < MIX_FRAMES; frames++) {
+        while (r->phase >= Q16_ONE) {
+            if (idx >= got) {
+                return frames;
+            }
+            const int16_t *in = &r->stage[idx * r->channels];
+            r->prev[0] = r->cur[0];
+            r->prev[1] = r->cur[1];
+            r->cur[0] = in[0];
+            r->cur[1] = r->channels == 2 ? in[1] : in[0];
+            idx++;
+            r->phase -= Q16_ONE;
+        }
+        int32_t frac = (int32_t)r->phase;
+        for (int c = 0; c < 2; c++) {
+            int32_t s = r->prev[c] + (int32_t)(((int64_t)(r->cur[c] - r->prev[c]) * frac) >> 16);
+            s_acc[frames * 2 + c] += (s * r->level) >> 8;
+        }
+        r->phase += r->step;
+    }
+    return frames;
+}
+
+static void mixer_task(void *arg) {
+    while (true) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        int64_t now = esp_timer_get_time();
+        uint32_t active_mask = 0;
+        for (int ch = 0; ch < MIXER_CH_COUNT; ch++) {
+            if (s_rings[ch].ring && s_rings[ch].active_until_us > now) {
+                active_mask |= MIXER_MASK(ch);
+            }
+        }
+
+        memset(s_acc, 0, sizeof(s_acc));
+        bool any = false;
+        for (int ch = 0; ch < MIXER_CH_COUNT; ch++) {
+            mixer_ring_t *r = &s_rings[ch];
+            if (r->ring == NULL) {
+                continue;
+            }
+            // 增益按周期渐变，闪避和增益调整都不会产生咔嗒声
+            int32_t target = target_level(ch, active_mask);
+            if (r->level < target) {
+                r->level = r->level + MIX_RAMP_STEP < target ? r->level + MIX_RAMP_STEP : target;
+            } else if (r->level > target) {
+                r->level = r->level - MIX_RAMP_STEP > target ? r->level - MIX_RAMP_STEP : target;
+            }
+
+            int frames = mix_ring(r);
+            if (frames > 0) {
+                // 上一周期没取满、保持时间内又有数据：生产者供不上，出现了断音
+                if (!r->playing && r->active_until_us > now) {
+                    metrics_counter_add(s_underrun_metric, 1);
+                }
+                any = true;
+                r->active_until_us = now + MIX_ACTIVE_HOLD_US;
+            }
+            r->playing = frames == MIX_FRAMES;
+        }
+        xSemaphoreGive(s_lock);
+
+        if (!any) {
+            // 所有环都空：DMA 自动输出静音，等生产者写入后唤醒
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        int32_t master = s_master * 256 / 100;
+        for (int i = 0; i < MIX_FRAMES * 2; i++) {
+            int32_t v = (s_acc[i] * master) >> 8;
+            s_out[i] = (int16_t)(v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : v));
+        }
+        size_t written = 0;
+        i2s_channel_write(s_tx, s_out, sizeof(s_out), &written, portMAX_DELAY);
+    }
+}
+
+// ============================================================================
+// 公共接口
+// ============================================================================
+
+esp_err_t audio_mixer_start(i2s_chan_handle_t tx_chan) {
+    if (s_task != NULL) {
+        return ESP_OK;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    if (s_lock == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (int ch = 0; ch < MIXER_CH_COUNT; ch++) {
+        s_rings[ch].gain = 100;
+        s_rings[ch].level = 256;
+        s_rings[ch].stage = heap_caps_malloc(MIX_STAGE_FRAMES * 2 * sizeof(int16_t),
+                                             MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (s_rings[ch].stage == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    s_underrun_metric = metrics_counter("audio.mixer.underrun");
+    s_tx = tx_chan;
+
+    if (xTaskCreatePinnedToCore(mixer_task, "mixer", MIX_TASK_STACK, NULL, MIX_TASK_PRIO, &s_task,
+                                MIX_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "创建混音任务失败");
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "混音器启动：%d Hz 立体声，%d 个输入通道", MIX_RATE, MIXER_CH_COUNT);
+    return ESP_OK;
+}
+
+esp_err_t audio_mixer_set_format(mixer_channel_t ch, uint32_t sample_rate, uint8_t channels) {
+    if (s_lock == NULL || (unsigned)ch >= MIXER_CH_COUNT) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (sample_rate == 0 || sample_rate > MIX_RATE * 2 || (channels != 1 && channels != 2)) {
+        ESP_LOGE(TAG, "通道 %d 不支持的格式 %lu Hz / %u 声道", ch, (unsigned long)sample_rate, channels);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    mixer_ring_t *r = &s_rings[ch];
+    if (r->ring && r->rate == sample_rate && r->channels == channels) {
+        return ESP_OK;
+    }
+
+    // 旧格式的数据先播完
+    for (int waited = 0; r->ring && !xStreamBufferIsEmpty(r->ring) && waited < MIX_FORMAT_WAIT_MS; waited += 10) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    size_t frame_bytes = channels * sizeof(int16_t);
+    size_t size = (size_t)sample_rate * CONFIG_APP_AUDIO_MIXER_RING_MS / 1000 * frame_bytes;
+    StreamBufferHandle_t ring = xStreamBufferCreateWithCaps(size, 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (ring == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    StreamBufferHandle_t old = r->ring;
+    r->ring = ring;
+    r->rate = sample_rate;
+    r->channels = channels;
+    r->step = (uint32_t)(((uint64_t)sample_rate << 16) / MIX_RATE);
+    r->phase = Q16_ONE;
+    memset(r->prev, 0, sizeof(r->prev));
+    memset(r->cur, 0, sizeof(r->cur));
+    xSemaphoreGive(s_lock);
+
+    if (old) {
+        vStreamBufferDeleteWithCaps(old);
+    }
+    ESP_LOGI(TAG, "通道 %d：%lu Hz / %u 声道", ch, (unsigned long)sample_rate, channels);
+    return ESP_OK;
+}
+
+esp_err_t audio_mixer_write(mixer_channel_t ch, const void *data, size_t bytes, size_t *bytes_written,
+                            uint32_t timeout_ms) {
+    if (bytes_written) {
+        *bytes_written = 0;
+    }
+    if (s_task == NULL || (unsigned)ch >= MIXER_CH_COUNT || s_rings[ch].ring == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    StreamBufferHandle_t ring = s_rings[ch].ring;
+    TimeOut_t timeout;
+    TickType_t remaining = pdMS_TO_TICKS(timeout_ms);
+    vTaskSetTimeOutState(&timeout);
+    size_t done = 0;
+    while (done < bytes) {
+        done += xStreamBufferSend(ring, (const uint8_t *)data + done, bytes - done, remaining);
+        xTaskNotifyGive(s_task);
+        if (done < bytes && xTaskCheckForTimeOut(&timeout, &remaining) == pdTRUE) {
+            break;
+        }
+    }
+    if (bytes_written) {
+        *bytes_written = done;
+    }
+    return done == bytes ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+void audio_mixer_flush(mixer_channel_t ch) {
+    if (s_lock == NULL || (unsigned)ch >= MIXER_CH_COUNT || s_rings[ch].ring == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    mixer_ring_t *r = &s_rings[ch];
+    xStreamBufferReset(r->ring);
+    r->phase = Q16_ONE;
+    memset(r->prev, 0, sizeof(r->prev));
+    memset(r->cur, 0, sizeof(r->cur));
+    r->playing = false;
+    r->active_until_us = 0;
+    xSemaphoreGive(s_lock);
+}
+
+void audio_mixer_set_gain(mixer_channel_t ch, uint8_t percent) {
+    if ((unsigned)ch < MIXER_CH_COUNT) {
+        s_rings[ch].gain = percent > 100 ? 100 : percent;
+    }
+}
+
+void audio_mixer_set_master(uint8_t percent) { s_master = percent > 100 ? 100 : percent; }
+
+bool audio_mixer_is_active(mixer_channel_t ch) {
+    return (unsigned)ch < MIXER_CH_COUNT && s_rings[ch].active_until_us > esp_timer_get_time();
+}
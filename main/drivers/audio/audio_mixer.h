@@ -0,0 +1,77 @@
+/**
+ * @file audio_mixer.h
+ * @brief 软件混音器：独占 I2S TX 通道，以固定采样率输出
+ *
+ * 原来音乐播放器（bsp_i2s_write）、AI 语音（Audio_I2S_Write）各自直接写同一个 TX 通道，
+ * 并通过 bsp_i2s_reconfig_clk / Audio_I2S_Reconfig 争抢时钟：一方播放时另一方的数据按错误的采样率播出，
+ * 每次切换还要停、启通道。现在：
+ * - I2S 在 Audio_Init 时按 CONFIG_APP_AUDIO_MIXER_SAMPLE_RATE 立体声配置一次，之后不再改时钟
+ * - 每个声源一个输入环形缓冲区（PSRAM 中的 StreamBuffer，长度 CONFIG_APP_AUDIO_MIXER_RING_MS），
+ *   生产者只写自己的环，写满时阻塞，节奏仍由 I2S DMA 决定
+ * - 混音任务逐周期从各环取数据，按各自的输入格式线性插值到输出采样率，乘以通道增益 × 闪避增益，
+ *   叠加后乘以主音量并限幅写入 I2S；所有环都空时阻塞等待，不写静音
+ * - 闪避：TTS 或提示音有声时音乐渐降到 CONFIG_APP_AUDIO_MIXER_MUSIC_DUCK%，结束后渐升；
+ *   提示音和 TTS 互不闪避，可以叠加播放
+ *
+ * 每个通道只能有一个生产者任务。audio_mixer_set_format 会等待该通道的环排空后再切换格式，
+ * 须由该通道的生产者调用（或确认生产者此时不在写入）。
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "driver/i2s_std.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 输入通道 */
+typedef enum {
+    MIXER_CH_MUSIC = 0, // 音乐播放器（esp-audio-player）
+    MIXER_CH_TTS,       // AI 语音回复
+    MIXER_CH_PROMPT,    // 提示音缓存
+    MIXER_CH_COUNT,
+} mixer_channel_t;
+
+/**
+ * 启动混音任务（Audio_Init 中调用，TX 通道须已按固定采样率立体声使能）
+ */
+esp_err_t audio_mixer_start(i2s_chan_handle_t tx_chan);
+
+/**
+ * 设置通道的输入格式（16 位 PCM，交错立体声或单声道）
+ *
+ * 格式不变时直接返回；否则等环中的旧数据播完（最多 1 秒）后按新格式重建环。
+ * 采样率不能超过输出采样率的 2 倍。
+ */
+esp_err_t audio_mixer_set_format(mixer_channel_t ch, uint32_t sample_rate, uint8_t channels);
+
+/**
+ * 写入通道的环形缓冲区（接口与 i2s_channel_write 相同，超时单位为毫秒）
+ * @param bytes_written 可为 NULL
+ * @return ESP_OK 全部写入；ESP_ERR_TIMEOUT 超时（已写入部分见 bytes_written）；
+ *         ESP_ERR_INVALID_STATE 混音器未启动或通道未设置格式
+ */
+esp_err_t audio_mixer_write(mixer_channel_t ch, const void *data, size_t bytes, size_t *bytes_written,
+                            uint32_t timeout_ms);
+
+/** 丢弃通道中尚未播放的数据（生产者不在写入时调用） */
+void audio_mixer_flush(mixer_channel_t ch);
+
+/** 通道增益 0~100（默认 100） */
+void audio_mixer_set_gain(mixer_channel_t ch, uint8_t percent);
+
+/** 主音量 0~100，作用于混音结果 */
+void audio_mixer_set_master(uint8_t percent);
+
+/** 通道最近是否有声（含闪避保持时间） */
+bool audio_mixer_is_active(mixer_channel_t ch);
+
+#ifdef __cplusplus
+}
+#endif
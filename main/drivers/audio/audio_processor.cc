@@ -1,12 +1,21 @@
 #include "audio_processor.h"
 #include <esp_log.h>
+#include "trace.h"
 #include <string>
 
 #define PROCESSOR_RUNNING 0x01
+#define PROCESSOR_EXIT 0x02   // 请求处理任务退出（析构时）
+#define PROCESSOR_EXITED 0x04 // 处理任务已退出
+
+// fetch 的最长等待：停止喂数据后任务仍能及时看到退出请求
+#define FETCH_TIMEOUT_MS 100
 
 static const char *TAG = "AudioProcessor";
 
-AudioProcessor::AudioProcessor() : afe_data_(nullptr) {
+AudioProcessor::AudioProcessor()
+    : afe_iface_(nullptr), afe_config_(nullptr), afe_data_(nullptr),
+      channels_(1), reference_(false), is_speaking_(false),
+      task_handle_(nullptr) {
   event_group_ = xEventGroupCreate();
 }
 
@@ -55,23 +64,36 @@ void AudioProcessor::Initialize(int channels, bool reference) {
       [](void *arg) {
         auto this_ = (AudioProcessor *)arg;
         this_->AudioProcessorTask();
+        xEventGroupSetBits(this_->event_group_, PROCESSOR_EXITED);
         vTaskDelete(NULL);
       },
-      "audio_communication", 4096, this, 3, NULL);
+      "audio_communication", 4096, this, 3, &task_handle_);
 }
 
 AudioProcessor::~AudioProcessor() {
   // 先停止任务
   Stop();
 
-  // 等待任务结束（给任务时间退出循环）
-  vTaskDelay(pdMS_TO_TICKS(200));
+  // 请求任务退出并等待（fetch 最多阻塞 FETCH_TIMEOUT_MS）
+  if (task_handle_ != nullptr) {
+    xEventGroupSetBits(event_group_, PROCESSOR_EXIT);
+    EventBits_t bits = xEventGroupWaitBits(
+        event_group_, PROCESSOR_EXITED, pdFALSE, pdTRUE, pdMS_TO_TICKS(1000));
+    if ((bits & PROCESSOR_EXITED) == 0) {
+      ESP_LOGW(TAG, "等待处理任务退出超时");
+    }
+    task_handle_ = nullptr;
+  }
 
   // 然后销毁 AFE
   if (afe_data_ != nullptr && afe_iface_ != nullptr) {
     afe_iface_->destroy(afe_data_);
     afe_data_ = nullptr;
   }
+  if (afe_config_ != nullptr) {
+    afe_config_free(afe_config_);
+    afe_config_ = nullptr;
+  }
 
   if (event_group_ != nullptr) {
     vEventGroupDelete(event_group_);
@@ -80,6 +102,10 @@ AudioProcessor::~AudioProcessor() {
 }
 
 void AudioProcessor::Input(const std::vector<int16_t> &data) {
+  Input(data.data(), data.size());
+}
+
+void AudioProcessor::Input(const int16_t *data, size_t samples) {
   if (afe_iface_ == nullptr || afe_data_ == nullptr) {
     static int null_count = 0;
     if (++null_count % 50 == 1) {
@@ -89,13 +115,15 @@ void AudioProcessor::Input(const std::vector<int16_t> &data) {
     return;
   }
 
-  input_buffer_.insert(input_buffer_.end(), data.begin(), data.end());
+  input_buffer_.insert(input_buffer_.end(), data, data + samples);
 
   auto feed_size = afe_iface_->get_feed_chunksize(afe_data_) * channels_;
   //   static int feed_count = 0;
   while (input_buffer_.size() >= feed_size) {
     auto chunk = input_buffer_.data();
+    TRACE_BEGIN(TRACE_EV_AFE_FEED, feed_size, 0);
     afe_iface_->feed(afe_data_, chunk);
+    TRACE_END(TRACE_EV_AFE_FEED, feed_size, 0);
     input_buffer_.erase(input_buffer_.begin(),
                         input_buffer_.begin() + feed_size);
     // if (++feed_count % 50 == 1) {
@@ -121,6 +149,16 @@ void AudioProcessor::Stop() {
   }
 }
 
+void AudioProcessor::Suspend() {
+  Stop();
+  // Stop() 清空 AFE 后处理任务可能还在取最后一帧，这里再清一次，下次 Start() 不会带出上次的残留音频
+  if (afe_iface_ != nullptr && afe_data_ != nullptr) {
+    afe_iface_->reset_buffer(afe_data_);
+  }
+  input_buffer_.clear();
+  is_speaking_ = false;
+}
+
 bool AudioProcessor::IsRunning() {
   return xEventGroupGetBits(event_group_) & PROCESSOR_RUNNING;
 }
@@ -148,8 +186,12 @@ void AudioProcessor::AudioProcessorTask() {
            feed_size, fetch_size);
 
   while (true) {
-    xEventGroupWaitBits(event_group_, PROCESSOR_RUNNING, pdFALSE, pdTRUE,
-                        portMAX_DELAY);
+    EventBits_t bits =
+        xEventGroupWaitBits(event_group_, PROCESSOR_RUNNING | PROCESSOR_EXIT,
+                            pdFALSE, pdFALSE, portMAX_DELAY);
+    if (bits & PROCESSOR_EXIT) {
+      break;
+    }
 
     // 检查 AFE 是否仍然有效
     if (afe_iface_ == nullptr || afe_data_ == nullptr) {
@@ -157,7 +199,8 @@ void AudioProcessor::AudioProcessorTask() {
       break;
     }
 
-    auto res = afe_iface_->fetch_with_delay(afe_data_, portMAX_DELAY);
+    auto res = afe_iface_->fetch_with_delay(afe_data_,
+                                           pdMS_TO_TICKS(FETCH_TIMEOUT_MS));
     if ((xEventGroupGetBits(event_group_) & PROCESSOR_RUNNING) == 0) {
       continue;
     }
@@ -167,6 +210,7 @@ void AudioProcessor::AudioProcessorTask() {
       }
       continue;
     }
+    TRACE_INSTANT(TRACE_EV_AFE_FETCH, res->data_size, res->vad_state);
 
     // // 每 50 次打印一次状态
     // static int fetch_count = 0;
@@ -181,10 +225,12 @@ void AudioProcessor::AudioProcessorTask() {
       if (res->vad_state == VAD_SPEECH && !is_speaking_) {
         is_speaking_ = true;
         ESP_LOGI(TAG, "VAD: 检测到语音开始");
+        TRACE_INSTANT(TRACE_EV_VAD, 1, 0);
         vad_state_change_callback_(true);
       } else if (res->vad_state == VAD_SILENCE && is_speaking_) {
         is_speaking_ = false;
         ESP_LOGI(TAG, "VAD: 检测到语音结束");
+        TRACE_INSTANT(TRACE_EV_VAD, 0, 0);
         vad_state_change_callback_(false);
       }
     }
@@ -13,6 +13,7 @@
  * 3. OnVadStateChange(callback) - 设置 VAD 状态回调
  * 4. Start() / Stop() - 控制处理器运行
  * 5. Input(data) - 输入音频数据
+ * 6. Suspend() - 会话结束后待机：停止并清空缓冲，AFE 保留，下次 Start() 直接使用
  */
 
 #pragma once
@@ -28,6 +29,7 @@ extern "C" {
 #include "esp_afe_sr_models.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
+#include "freertos/task.h"
 #ifdef __cplusplus
 }
 #endif
@@ -47,9 +49,11 @@ public:
   void Initialize(int channels, bool reference);
   void Start();
   void Stop();
+  void Suspend(); // 调用前须确保不再有 Input 调用
   bool IsRunning();
 
   void Input(const std::vector<int16_t> &data);
+  void Input(const int16_t *data, size_t samples);
   void OnOutput(std::function<void(std::vector<int16_t> &&data)> callback);
   void OnVadStateChange(std::function<void(bool speaking)> callback);
 
@@ -64,6 +68,7 @@ private:
   int channels_;
   bool reference_;
   bool is_speaking_;
+  TaskHandle_t task_handle_;
 
   std::vector<int16_t> input_buffer_;
   std::function<void(std::vector<int16_t> &&data)> output_callback_;
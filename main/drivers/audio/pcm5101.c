@@ -1,4 +1,5 @@
 #include "pcm5101.h"
+#include "audio_mixer.h"
 
 static const char *TAG = "AUDIO PCM5101"; 
 
@@ -10,32 +11,17 @@ bool Music_Next_Flag = 0;
 // static esp_err_t bsp_i2s_write(void *audio_buffer, size_t len, size_t *bytes_written, uint32_t timeout_ms) {                     // I2S Write Init
 //     return i2s_channel_write(i2s_tx_chan, (char *)audio_buffer, len, bytes_written, timeout_ms);
 // }
+// 音乐播放器的输出写入混音器的音乐通道（音量由混音器的主音量统一处理）
 static esp_err_t bsp_i2s_write(void *audio_buffer, size_t len, size_t *bytes_written, uint32_t timeout_ms) {
-    int16_t *samples = (int16_t *)audio_buffer;
-    size_t sample_count = len / sizeof(int16_t);
-    
-    // Calculate the volume scaling factor to convert the volume level from 0-100 to the 0.0-1.0 range
-    float volume_factor = Volume / 100.0f;
-
-
-    for (size_t i = 0; i < sample_count; i++) {
-        samples[i] = (int16_t)(samples[i] * volume_factor);
-    }
-
-    return i2s_channel_write(i2s_tx_chan, (char *)audio_buffer, len, bytes_written, timeout_ms);
+    return audio_mixer_write(MIXER_CH_MUSIC, audio_buffer, len, bytes_written, timeout_ms);
 }
-static esp_err_t bsp_i2s_reconfig_clk(uint32_t rate, uint32_t bits_cfg, i2s_slot_mode_t ch) {                                   // I2S Init
-    esp_err_t ret = ESP_OK; 
-    i2s_std_config_t std_cfg = {
-        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(rate),
-        .slot_cfg = I2S_STD_PHILIP_SLOT_DEFAULT_CONFIG((i2s_data_bit_width_t)bits_cfg, ch),
-        .gpio_cfg = BSP_I2S_GPIO_CFG,
-    };
-    ret |= i2s_channel_disable(i2s_tx_chan);
-    ret |= i2s_channel_reconfig_std_clock(i2s_tx_chan, &std_cfg.clk_cfg);
-    ret |= i2s_channel_reconfig_std_slot(i2s_tx_chan, &std_cfg.slot_cfg);
-    ret |= i2s_channel_enable(i2s_tx_chan); 
-    return ret; 
+// I2S 时钟由混音器固定，这里只告诉混音器音乐通道的输入格式
+static esp_err_t bsp_i2s_reconfig_clk(uint32_t rate, uint32_t bits_cfg, i2s_slot_mode_t ch) {
+    if (bits_cfg != I2S_DATA_BIT_WIDTH_16BIT) {
+        ESP_LOGE(TAG, "unsupported bit width %lu", (unsigned long)bits_cfg);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return audio_mixer_set_format(MIXER_CH_MUSIC, rate, ch == I2S_SLOT_MODE_STEREO ? 2 : 1);
 }
 
 static esp_err_t audio_mute_function(AUDIO_PLAYER_MUTE_SETTING setting) {                                                       // audio mute function
@@ -78,7 +64,7 @@ static void audio_player_callback(audio_player_cb_ctx_t *ctx) {
 void Audio_Init(void) 
 {
     i2s_std_config_t std_cfg = {
-        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(44100),
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(CONFIG_APP_AUDIO_MIXER_SAMPLE_RATE),
         .slot_cfg = I2S_STD_PHILIP_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_STEREO),
         .gpio_cfg = BSP_I2S_GPIO_CFG,
     };
@@ -87,6 +73,13 @@ void Audio_Init(void)
         ESP_LOGE(TAG, "Failed to initialize audio: %s", esp_err_to_name(ret));
         return;
     }
+    // TX 通道从此只由混音器写入，时钟不再改变
+    ret = audio_mixer_start(i2s_tx_chan);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start mixer: %s", esp_err_to_name(ret));
+        return;
+    }
+    audio_mixer_set_master(Volume);
     audio_player_config_t config = { 
         .mute_fn = audio_mute_function,
         .write_fn = bsp_i2s_write,
@@ -199,21 +192,6 @@ void Volume_adjustment(uint8_t Vol) {
         printf("Audio : The volume value is incorrect. Please enter 0 to 21\r\n");
     else  
         Volume = Vol;
+    audio_mixer_set_master(Volume);
     ESP_LOGI(TAG, "Volume set to %d", Volume);
 }
-
-esp_err_t Audio_I2S_Write(const int16_t *data, size_t samples, uint32_t timeout_ms) {
-    if (i2s_tx_chan == NULL) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    size_t bytes_written = 0;
-    return i2s_channel_write(i2s_tx_chan, data, samples * sizeof(int16_t), 
-                              &bytes_written, pdMS_TO_TICKS(timeout_ms));
-}
-
-esp_err_t Audio_I2S_Reconfig(uint32_t sample_rate) {
-    if (i2s_tx_chan == NULL) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    return bsp_i2s_reconfig_clk(sample_rate, I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO);
-}
\ No newline at end of file
@@ -56,23 +56,6 @@ uint32_t Music_Elapsed(void);
 uint16_t Music_Energy(void);
 void Volume_adjustment(uint8_t Volume);
 
-/**
- * 直接写入 I2S 音频数据（供外部模块复用 I2S 通道）
- * @param data 16位 PCM 数据
- * @param samples 采样数
- * @param timeout_ms 超时时间（毫秒）
- * @return ESP_OK 成功
- */
-esp_err_t Audio_I2S_Write(const int16_t *data, size_t samples,
-                          uint32_t timeout_ms);
-
-/**
- * 重新配置 I2S 时钟（用于切换采样率）
- * @param sample_rate 采样率
- * @return ESP_OK 成功
- */
-esp_err_t Audio_I2S_Reconfig(uint32_t sample_rate);
-
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
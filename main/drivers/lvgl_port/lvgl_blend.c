@@ -0,0 +1,400 @@
+#include "lvgl_blend.h"
+#include "esp_log.h"
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#include "esp_attr.h"
+#define BLEND_FAST_MEM IRAM_ATTR
+#else
+#define BLEND_FAST_MEM
+#endif
+
+// ESP32-S3 的 PIE 扩展提供 128 位 Q 寄存器加载/存储
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+#define BLEND_USE_PIE 1
+#else
+#define BLEND_USE_PIE 0
+#endif
+
+// 内核只针对 16 位色深直写缓冲，其它配置全部交回 LVGL 原实现
+#if LV_COLOR_DEPTH == 16
+#define BLEND_ENABLED 1
+#else
+#define BLEND_ENABLED 0
+#endif
+
+static const char *TAG = "LVGL_BLEND";
+
+// 超过该像素数的透明度填充改用分通道查表
+#define BLEND_LUT_MIN_PX 1024
+
+#if BLEND_ENABLED
+
+// ============== 像素工具 ==============
+
+#define MIX_MASK 0x07E0F81FU // lv_color_mix 的 565 展开掩码（G 移到高 16 位）
+
+// 存储字节序 <-> RGB565
+static inline uint16_t px_swap(uint16_t v)
+{
+#if LV_COLOR_16_SWAP
+    return (uint16_t)((v << 8) | (v >> 8));
+#else
+    return v;
+#endif
+}
+
+// 存储格式像素展开为 lv_color_mix 使用的 32 位形式
+static inline uint32_t px_expand(uint16_t raw)
+{
+    uint32_t c = px_swap(raw);
+    return (c | (c << 16)) & MIX_MASK;
+}
+
+// 与 lv_color_mix 相同的 5 位精度混合，fg 已展开，mix5 = (opa + 4) >> 3
+static inline uint16_t px_mix(uint32_t fg, uint16_t bg_raw, uint32_t mix5)
+{
+    uint32_t bg = px_expand(bg_raw);
+    uint32_t res = ((((fg - bg) * mix5) >> 5) + bg) & MIX_MASK;
+    return px_swap((uint16_t)((res >> 16) | res));
+}
+
+// ============== PIE 128 位存取 ==============
+
+#if BLEND_USE_PIE
+/**
+ * 用 c 填满 blocks 个 16 字节块，d 必须 16 字节对齐
+ */
+static inline void pie_fill(uint16_t *d, const uint16_t *c, uint32_t blocks)
+{
+    __asm__ volatile(
+        "ee.vldbc.16 q0, %[c]\n"
+        "1:\n"
+        "ee.vst.128.ip q0, %[d], 16\n"
+        "addi %[n], %[n], -1\n"
+        "bnez %[n], 1b\n"
+        : [d] "+r"(d), [n] "+r"(blocks)
+        : [c] "r"(c)
+        : "memory");
+}
+
+/**
+ * 拷贝 blocks 个 16 字节块，d 与 s 都必须 16 字节对齐
+ */
+static inline void pie_copy(uint16_t *d, const uint16_t *s, uint32_t blocks)
+{
+    __asm__ volatile(
+        "1:\n"
+        "ee.vld.128.ip q0, %[s], 16\n"
+        "ee.vst.128.ip q0, %[d], 16\n"
+        "addi %[n], %[n], -1\n"
+        "bnez %[n], 1b\n"
+        : [d] "+r"(d), [s] "+r"(s), [n] "+r"(blocks)
+        :
+        : "memory");
+}
+#endif
+
+// ============== 行内核 ==============
+
+static BLEND_FAST_MEM void fill_row(uint16_t *d, uint16_t c, int32_t w)
+{
+#if BLEND_USE_PIE
+    for (; w > 0 && ((uintptr_t)d & 0xF); w--) {
+        *d++ = c;
+    }
+    if (w >= 8) {
+        uint32_t blocks = (uint32_t)w >> 3;
+        pie_fill(d, &c, blocks);
+        d += blocks * 8;
+        w &= 7;
+    }
+#else
+    if (w > 0 && ((uintptr_t)d & 0x2)) {
+        *d++ = c;
+        w--;
+    }
+    uint32_t c32 = c | ((uint32_t)c << 16);
+    uint32_t *d32 = (uint32_t *)d;
+    for (; w >= 2; w -= 2) {
+        *d32++ = c32;
+    }
+    d = (uint16_t *)d32;
+#endif
+    for (; w > 0; w--) {
+        *d++ = c;
+    }
+}
+
+static BLEND_FAST_MEM void copy_row(uint16_t *d, const uint16_t *s, int32_t w)
+{
+#if BLEND_USE_PIE
+    // 源和目标同余 16 时才能对齐到 128 位，否则交给 memcpy
+    if (w >= 16 && (((uintptr_t)d ^ (uintptr_t)s) & 0xF) == 0) {
+        for (; (uintptr_t)d & 0xF; w--) {
+            *d++ = *s++;
+        }
+        uint32_t blocks = (uint32_t)w >> 3;
+        pie_copy(d, s, blocks);
+        d += blocks * 8;
+        s += blocks * 8;
+        w &= 7;
+        for (; w > 0; w--) {
+            *d++ = *s++;
+        }
+        return;
+    }
+#endif
+    memcpy(d, s, (size_t)w * sizeof(uint16_t));
+}
+
+// ============== 矩形内核 ==============
+
+static BLEND_FAST_MEM void fill_opa(uint16_t *d, int32_t stride, int32_t w, int32_t h, uint16_t c,
+                                    lv_opa_t opa)
+{
+    // lv_draw_sw 的 fill_normal 在遇到第一个非黑像素之前，复用 lv_color_mix(color, 黑, opa) 的结果
+    uint16_t black_res = px_mix(px_expand(c), 0, ((uint32_t)opa + 4) >> 3);
+
+    // 之后走预乘公式，opa 先量化到 8 的倍数（按 lv_opa_t 截断，与原实现保持一致）
+    uint32_t opa8 = (uint8_t)((((uint32_t)opa + 4) >> 3) << 3);
+    uint32_t inv = 255 - opa8;
+    uint32_t cu = px_swap(c);
+    uint32_t pr = (cu >> 11) * opa8;
+    uint32_t pg = ((cu >> 5) & 0x3F) * opa8;
+    uint32_t pb = (cu & 0x1F) * opa8;
+
+    // 结果每个通道只取决于目标同一通道，面积够大时先算好三张小表
+    bool use_lut = w * h >= BLEND_LUT_MIN_PX;
+    uint16_t lut_r[32];
+    uint16_t lut_g[64];
+    uint16_t lut_b[32];
+    if (use_lut) {
+        for (uint32_t i = 0; i < 32; i++) {
+            lut_r[i] = px_swap((uint16_t)(LV_UDIV255(pr + i * inv) << 11));
+            lut_b[i] = px_swap((uint16_t)LV_UDIV255(pb + i * inv));
+        }
+        for (uint32_t i = 0; i < 64; i++) {
+            lut_g[i] = px_swap((uint16_t)(LV_UDIV255(pg + i * inv) << 5));
+        }
+    }
+
+    // 逐点计算时复用相同底色的结果（初值为黑色底的结果）
+    uint16_t last_dest = 0;
+    uint16_t last_res = px_swap((uint16_t)((LV_UDIV255(pr) << 11) | (LV_UDIV255(pg) << 5) | LV_UDIV255(pb)));
+
+    bool leading = true;
+    for (int32_t y = 0; y < h; y++) {
+        int32_t x = 0;
+        if (leading) {
+            for (; x < w && d[x] == 0; x++) {
+                d[x] = black_res;
+            }
+            if (x < w) {
+                leading = false;
+            }
+        }
+
+        if (use_lut) {
+            for (; x < w; x++) {
+                uint32_t u = px_swap(d[x]);
+                d[x] = lut_r[u >> 11] | lut_g[(u >> 5) & 0x3F] | lut_b[u & 0x1F];
+            }
+        } else {
+            for (; x < w; x++) {
+                if (d[x] == last_dest) {
+                    d[x] = last_res;
+                    continue;
+                }
+                last_dest = d[x];
+                uint32_t u = px_swap(d[x]);
+                uint32_t r = LV_UDIV255(pr + (u >> 11) * inv);
+                uint32_t g = LV_UDIV255(pg + ((u >> 5) & 0x3F) * inv);
+                uint32_t b = LV_UDIV255(pb + (u & 0x1F) * inv);
+                last_res = px_swap((uint16_t)((r << 11) | (g << 5) | b));
+                d[x] = last_res;
+            }
+        }
+        d += stride;
+    }
+}
+
+// 单个遮罩像素，a 为已合成的不透明度
+static inline void mask_px(uint16_t *d, uint16_t c, uint32_t fg, lv_opa_t a)
+{
+    if (a == LV_OPA_COVER) {
+        *d = c;
+    } else if (a) {
+        *d = px_mix(fg, *d, ((uint32_t)a + 4) >> 3);
+    }
+}
+
+static BLEND_FAST_MEM void fill_mask(uint16_t *d, int32_t stride, int32_t w, int32_t h, uint16_t c,
+                                     lv_opa_t opa, const lv_opa_t *mask, int32_t mask_stride)
+{
+    uint32_t fg = px_expand(c);
+
+    // 只有遮罩起作用：遮罩按 4 字节对齐后整字跳过全透明 / 整段写入全覆盖
+    if (opa >= LV_OPA_MAX) {
+        uint32_t c32 = c | ((uint32_t)c << 16);
+        for (int32_t y = 0; y < h; y++) {
+            int32_t x = 0;
+            for (; x < w && ((uintptr_t)(mask + x) & 0x3); x++) {
+                mask_px(&d[x], c, fg, mask[x]);
+            }
+            for (; x + 4 <= w; x += 4) {
+                uint32_t m32 = *(const uint32_t *)(mask + x);
+                if (m32 == 0) {
+                    continue;
+                }
+                if (m32 == 0xFFFFFFFF) {
+                    if (((uintptr_t)&d[x] & 0x3) == 0) {
+                        uint32_t *d32 = (uint32_t *)&d[x];
+                        d32[0] = c32;
+                        d32[1] = c32;
+                    } else {
+                        d[x] = c;
+                        d[x + 1] = c;
+                        d[x + 2] = c;
+                        d[x + 3] = c;
+                    }
+                    continue;
+                }
+                mask_px(&d[x], c, fg, mask[x]);
+                mask_px(&d[x + 1], c, fg, mask[x + 1]);
+                mask_px(&d[x + 2], c, fg, mask[x + 2]);
+                mask_px(&d[x + 3], c, fg, mask[x + 3]);
+            }
+            for (; x < w; x++) {
+                mask_px(&d[x], c, fg, mask[x]);
+            }
+            d += stride;
+            mask += mask_stride;
+        }
+        return;
+    }
+
+    // 遮罩与整体透明度相乘；同一遮罩值、同一底色时复用上一个结果
+    for (int32_t y = 0; y < h; y++) {
+        lv_opa_t last_mask = LV_OPA_TRANSP;
+        uint16_t last_dest = 0;
+        uint16_t last_res = 0;
+        for (int32_t x = 0; x < w; x++) {
+            lv_opa_t m = mask[x];
+            if (m == LV_OPA_TRANSP) {
+                continue;
+            }
+            if (m != last_mask || d[x] != last_dest) {
+                lv_opa_t a = m == LV_OPA_COVER ? opa : (lv_opa_t)(((uint32_t)m * opa) >> 8);
+                last_mask = m;
+                last_dest = d[x];
+                last_res = d[x];
+                mask_px(&last_res, c, fg, a);
+            }
+            d[x] = last_res;
+        }
+        d += stride;
+        mask += mask_stride;
+    }
+}
+
+static BLEND_FAST_MEM void map_opa(uint16_t *d, int32_t stride, int32_t w, int32_t h, const uint16_t *s,
+                                   int32_t src_stride, lv_opa_t opa)
+{
+    uint32_t mix5 = ((uint32_t)opa + 4) >> 3;
+    for (int32_t y = 0; y < h; y++) {
+        for (int32_t x = 0; x < w; x++) {
+            d[x] = px_mix(px_expand(s[x]), d[x], mix5);
+        }
+        d += stride;
+        s += src_stride;
+    }
+}
+
+#endif /*BLEND_ENABLED*/
+
+// ============== blend 钩子 ==============
+
+void BLEND_FAST_MEM lvgl_blend_fast(lv_draw_ctx_t *draw_ctx, const lv_draw_sw_blend_dsc_t *dsc)
+{
+#if BLEND_ENABLED
+    lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+
+    const lv_opa_t *mask_buf = dsc->mask_buf;
+    if (mask_buf && dsc->mask_res == LV_DRAW_MASK_RES_TRANSP) {
+        return;
+    }
+    lv_opa_t *mask = (mask_buf && dsc->mask_res != LV_DRAW_MASK_RES_FULL_COVER) ? dsc->mask_buf : NULL;
+
+    // 只接管普通混合模式下直写 RGB565 缓冲的情况，带遮罩的图像交回原实现
+    if (disp->driver->set_px_cb || disp->driver->screen_transp || dsc->blend_mode != LV_BLEND_MODE_NORMAL ||
+        (dsc->src_buf && mask)) {
+        lv_draw_sw_blend_basic(draw_ctx, dsc);
+        return;
+    }
+
+    lv_area_t blend_area;
+    if (!_lv_area_intersect(&blend_area, dsc->blend_area, draw_ctx->clip_area)) {
+        return;
+    }
+
+    int32_t dest_stride = lv_area_get_width(draw_ctx->buf_area);
+    uint16_t *dest = (uint16_t *)draw_ctx->buf;
+    dest += dest_stride * (blend_area.y1 - draw_ctx->buf_area->y1) + (blend_area.x1 - draw_ctx->buf_area->x1);
+
+    int32_t w = lv_area_get_width(&blend_area);
+    int32_t h = lv_area_get_height(&blend_area);
+
+    if (dsc->src_buf) {
+        int32_t src_stride = lv_area_get_width(dsc->blend_area);
+        const uint16_t *src = (const uint16_t *)dsc->src_buf;
+        src += src_stride * (blend_area.y1 - dsc->blend_area->y1) + (blend_area.x1 - dsc->blend_area->x1);
+
+        if (dsc->opa >= LV_OPA_MAX) {
+            for (int32_t y = 0; y < h; y++) {
+                copy_row(dest, src, w);
+                dest += dest_stride;
+                src += src_stride;
+            }
+        } else {
+            map_opa(dest, dest_stride, w, h, src, src_stride, dsc->opa);
+        }
+        return;
+    }
+
+    uint16_t color = dsc->color.full;
+    if (mask) {
+        // 关闭抗锯齿时遮罩取整，与原实现相同
+        if (disp->driver->antialiasing == 0) {
+            int32_t mask_size = lv_area_get_size(dsc->mask_area);
+            for (int32_t i = 0; i < mask_size; i++) {
+                mask[i] = mask[i] > 128 ? LV_OPA_COVER : LV_OPA_TRANSP;
+            }
+        }
+        int32_t mask_stride = lv_area_get_width(dsc->mask_area);
+        mask += mask_stride * (blend_area.y1 - dsc->mask_area->y1) + (blend_area.x1 - dsc->mask_area->x1);
+        fill_mask(dest, dest_stride, w, h, color, dsc->opa, mask, mask_stride);
+    } else if (dsc->opa >= LV_OPA_MAX) {
+        for (int32_t y = 0; y < h; y++) {
+            fill_row(dest, color, w);
+            dest += dest_stride;
+        }
+    } else {
+        fill_opa(dest, dest_stride, w, h, color, dsc->opa);
+    }
+#else
+    lv_draw_sw_blend_basic(draw_ctx, dsc);
+#endif
+}
+
+void lvgl_blend_init_ctx(lv_disp_drv_t *drv, lv_draw_ctx_t *draw_ctx)
+{
+    lv_draw_sw_init_ctx(drv, draw_ctx);
+#if BLEND_ENABLED
+    ((lv_draw_sw_ctx_t *)draw_ctx)->blend = lvgl_blend_fast;
+    ESP_LOGI(TAG, "混合加速已启用（%s）", BLEND_USE_PIE ? "PIE 128 位" : "标量");
+#else
+    ESP_LOGW(TAG, "色深 %d 位不支持混合加速，使用 LVGL 原实现", LV_COLOR_DEPTH);
+#endif
+}
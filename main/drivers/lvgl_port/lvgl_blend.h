@@ -0,0 +1,41 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lvgl.h"
+#include "src/draw/sw/lv_draw_sw.h"
+
+/**
+ * LVGL RGB565 混合加速
+ *
+ * 通过 lv_draw_sw_ctx_t::blend 钩子替换 lv_draw_sw_blend_basic，
+ * 对 LV_BLEND_MODE_NORMAL 下最常见的几种操作走专用内核：
+ * - 不透明填充 / 带透明度填充 / 带遮罩填充（文字、圆角、抗锯齿边缘）
+ * - RGB565 图像拷贝 / 带透明度图像拷贝
+ * ESP32-S3 上不透明填充和拷贝使用 PIE 128 位存取指令。
+ * 其余情况（带遮罩的图像、叠加/相减/相乘混合、set_px_cb）交回 LVGL 原实现。
+ *
+ * 所有内核与 lv_draw_sw_blend_basic 逐像素一致（LV_COLOR_16_SWAP 下的
+ * 字节序、lv_color_mix 的 5 位混合精度均保持不变），tools/blend_bench 负责对比验证。
+ */
+
+/**
+ * 绘制上下文初始化，作为 lv_disp_drv_t::draw_ctx_init 使用
+ * 先按 lv_draw_sw_init_ctx 初始化，再替换 blend 回调
+ * @param drv 显示驱动
+ * @param draw_ctx 绘制上下文（大小为 sizeof(lv_draw_sw_ctx_t)）
+ */
+void lvgl_blend_init_ctx(lv_disp_drv_t *drv, lv_draw_ctx_t *draw_ctx);
+
+/**
+ * 加速混合实现，签名与 lv_draw_sw_blend_basic 相同
+ * @param draw_ctx 绘制上下文
+ * @param dsc 混合描述
+ */
+void lvgl_blend_fast(lv_draw_ctx_t *draw_ctx, const lv_draw_sw_blend_dsc_t *dsc);
+
+#ifdef __cplusplus
+}
+#endif
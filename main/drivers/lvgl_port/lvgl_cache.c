@@ -0,0 +1,519 @@
+#include "lvgl_cache.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "LVGL_CACHE";
+
+// ============== 缓存条目 ==============
+
+#define CACHE_BUCKET_COUNT 512 // 哈希桶数量（2 的幂）
+
+typedef enum {
+    ENTRY_GLYPH = 0,
+    ENTRY_IMG,
+} entry_kind_t;
+
+typedef struct cache_entry {
+    struct cache_entry *hash_next; // 同桶链表
+    struct cache_entry *lru_prev;  // LRU 链表（头部最新）
+    struct cache_entry *lru_next;
+    uintptr_t owner;               // 字体指针 / 图片源标识
+    uint32_t key;                  // 码点 / 图片着色
+    uint32_t size;                 // 条目总字节（含头部）
+    uint16_t refcnt;               // 引用计数（打开中的图片不可淘汰）
+    uint8_t kind;                  // entry_kind_t
+    uint8_t found;                 // 字形：字体中是否存在该码点
+    union {
+        lv_font_glyph_dsc_t glyph; // 字形描述
+        lv_img_header_t img;       // 解码后的图片头
+    } u;
+    uint8_t data[];                // 字形位图 / 解码后的像素
+} cache_entry_t;
+
+// 包装字体的上下文
+typedef struct {
+    const lv_font_t *base; // 原始字体
+    bool has_kerning;      // 原始字体是否带字距调整
+} font_ctx_t;
+
+static cache_entry_t **s_buckets = NULL;
+static cache_entry_t *s_lru_head = NULL;
+static cache_entry_t *s_lru_tail = NULL;
+static lv_img_decoder_t *s_img_decoder = NULL;
+static size_t s_budget = 0;
+static bool s_prewarming = false;
+static uint32_t s_prewarm_loads = 0;
+static lvgl_cache_stats_t s_stats;
+
+// ============== 哈希表与 LRU ==============
+
+static inline uint32_t bucket_of(uintptr_t owner, uint32_t key) {
+    uint32_t h = (uint32_t)owner ^ (uint32_t)((uint64_t)owner >> 32);
+    h ^= key * 0x9E3779B1u;
+    h ^= h >> 15;
+    return h & (CACHE_BUCKET_COUNT - 1);
+}
+
+static void lru_unlink(cache_entry_t *e) {
+    if (e->lru_prev) {
+        e->lru_prev->lru_next = e->lru_next;
+    } else {
+        s_lru_head = e->lru_next;
+    }
+    if (e->lru_next) {
+        e->lru_next->lru_prev = e->lru_prev;
+    } else {
+        s_lru_tail = e->lru_prev;
+    }
+    e->lru_prev = NULL;
+    e->lru_next = NULL;
+}
+
+static void lru_push_head(cache_entry_t *e) {
+    e->lru_prev = NULL;
+    e->lru_next = s_lru_head;
+    if (s_lru_head) {
+        s_lru_head->lru_prev = e;
+    }
+    s_lru_head = e;
+    if (!s_lru_tail) {
+        s_lru_tail = e;
+    }
+}
+
+static cache_entry_t *cache_lookup(uint8_t kind, uintptr_t owner, uint32_t key) {
+    if (!s_buckets) {
+        return NULL;
+    }
+    cache_entry_t *e = s_buckets[bucket_of(owner, key)];
+    while (e) {
+        if (e->owner == owner && e->key == key && e->kind == kind) {
+            if (e != s_lru_head) {
+                lru_unlink(e);
+                lru_push_head(e);
+            }
+            return e;
+        }
+        e = e->hash_next;
+    }
+    return NULL;
+}
+
+static void cache_remove(cache_entry_t *e) {
+    cache_entry_t **pp = &s_buckets[bucket_of(e->owner, e->key)];
+    while (*pp && *pp != e) {
+        pp = &(*pp)->hash_next;
+    }
+    if (*pp) {
+        *pp = e->hash_next;
+    }
+    lru_unlink(e);
+    s_stats.used_bytes -= e->size;
+    s_stats.entries--;
+    heap_caps_free(e);
+}
+
+/**
+ * 从 LRU 尾部淘汰，直到能放下 need 字节；引用中的条目跳过
+ */
+static bool cache_make_room(size_t need) {
+    cache_entry_t *e = s_lru_tail;
+    while (s_stats.used_bytes + need > s_budget && e) {
+        cache_entry_t *prev = e->lru_prev;
+        if (e->refcnt == 0) {
+            cache_remove(e);
+            s_stats.evictions++;
+        }
+        e = prev;
+    }
+    return s_stats.used_bytes + need <= s_budget;
+}
+
+static cache_entry_t *cache_insert(uint8_t kind, uintptr_t owner, uint32_t key, size_t data_size) {
+    if (!s_buckets) {
+        return NULL;
+    }
+    size_t size = sizeof(cache_entry_t) + data_size;
+    if (!cache_make_room(size)) {
+        return NULL;
+    }
+
+    cache_entry_t *e = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!e) {
+        return NULL;
+    }
+    memset(e, 0, sizeof(cache_entry_t));
+    e->owner = owner;
+    e->key = key;
+    e->kind = kind;
+    e->size = (uint32_t)size;
+
+    uint32_t b = bucket_of(owner, key);
+    e->hash_next = s_buckets[b];
+    s_buckets[b] = e;
+    lru_push_head(e);
+
+    s_stats.used_bytes += size;
+    s_stats.entries++;
+    if (s_stats.used_bytes > s_stats.peak_bytes) {
+        s_stats.peak_bytes = s_stats.used_bytes;
+    }
+    if (s_prewarming) {
+        s_prewarm_loads++;
+    }
+    return e;
+}
+
+// ============== 字形缓存 ==============
+
+static bool cached_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc_out,
+                                 uint32_t letter, uint32_t letter_next) {
+    const font_ctx_t *ctx = font->dsc;
+    const lv_font_t *base = ctx->base;
+
+    cache_entry_t *e = cache_lookup(ENTRY_GLYPH, (uintptr_t)font, letter);
+    if (e) {
+        if (!s_prewarming) {
+            s_stats.glyph_hits++;
+        }
+        if (!e->found) {
+            return false;
+        }
+        *dsc_out = e->u.glyph;
+    } else {
+        if (!s_prewarming) {
+            s_stats.glyph_misses++;
+        }
+        lv_font_glyph_dsc_t g;
+        memset(&g, 0, sizeof(g));
+        bool found = base->get_glyph_dsc(base, &g, letter, 0);
+        if (found && g.is_placeholder) {
+            // 占位字形由 LVGL 统一处理，不缓存
+            *dsc_out = g;
+            return true;
+        }
+
+        size_t bitmap_size = 0;
+        if (found && g.box_w && g.box_h) {
+            // 3 bpp 字形由 get_glyph_bitmap 按 4 bpp 输出（draw_letter 同样按 4 bpp 读取）
+            size_t bpp = g.bpp == 3 ? 4 : g.bpp;
+            bitmap_size = ((size_t)g.box_w * g.box_h * bpp + 7) / 8;
+        }
+        e = cache_insert(ENTRY_GLYPH, (uintptr_t)font, letter, bitmap_size);
+        if (e) {
+            e->found = found;
+            e->u.glyph = g;
+            if (bitmap_size) {
+                const uint8_t *bmp = base->get_glyph_bitmap(base, letter);
+                if (bmp) {
+                    memcpy(e->data, bmp, bitmap_size);
+                } else {
+                    memset(e->data, 0, bitmap_size);
+                }
+            }
+        }
+        if (!found) {
+            return false;
+        }
+        *dsc_out = g;
+    }
+
+    // 字距与下一个字符相关，不进缓存，按需向原始字体查询
+    if (letter_next && ctx->has_kerning) {
+        lv_font_glyph_dsc_t kern;
+        if (base->get_glyph_dsc(base, &kern, letter, letter_next)) {
+            dsc_out->adv_w = kern.adv_w;
+        }
+    }
+    return true;
+}
+
+static const uint8_t *cached_get_glyph_bitmap(const lv_font_t *font, uint32_t letter) {
+    const font_ctx_t *ctx = font->dsc;
+    cache_entry_t *e = cache_lookup(ENTRY_GLYPH, (uintptr_t)font, letter);
+    if (e && e->found && e->size > sizeof(cache_entry_t)) {
+        return e->data;
+    }
+    return ctx->base->get_glyph_bitmap(ctx->base, letter);
+}
+
+void lvgl_cache_font_init(lv_font_t *font, const lv_font_t *base) {
+    *font = *base;
+
+    // 子像素字体的位图布局特殊，直接使用原始字体
+    if (base->subpx != LV_FONT_SUBPX_NONE) {
+        return;
+    }
+
+    font_ctx_t *ctx = heap_caps_malloc(sizeof(font_ctx_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!ctx) {
+        ESP_LOGW(TAG, "字体上下文分配失败，不启用字形缓存");
+        return;
+    }
+    ctx->base = base;
+    ctx->has_kerning = true;
+    if (base->get_glyph_dsc == lv_font_get_glyph_dsc_fmt_txt) {
+        const lv_font_fmt_txt_dsc_t *fdsc = base->dsc;
+        ctx->has_kerning = fdsc->kern_dsc != NULL;
+    }
+
+    font->get_glyph_dsc = cached_get_glyph_dsc;
+    font->get_glyph_bitmap = cached_get_glyph_bitmap;
+    font->dsc = ctx;
+}
+
+void lvgl_cache_font_set_kerning(lv_font_t *font, bool enable) {
+    if (font->get_glyph_dsc != cached_get_glyph_dsc) {
+        return;
+    }
+    font_ctx_t *ctx = (font_ctx_t *)font->dsc;
+    ctx->has_kerning = enable;
+}
+
+// ============== 图片缓存解码器 ==============
+
+static bool img_cf_cacheable(lv_img_src_t src_type, lv_img_cf_t cf) {
+    switch (cf) {
+    case LV_IMG_CF_TRUE_COLOR:
+    case LV_IMG_CF_TRUE_COLOR_ALPHA:
+        // C 数组形式的真彩图片由内置解码器直接返回指针，无需缓存
+        return src_type == LV_IMG_SRC_FILE;
+    case LV_IMG_CF_ALPHA_1BIT:
+    case LV_IMG_CF_ALPHA_2BIT:
+    case LV_IMG_CF_ALPHA_4BIT:
+    case LV_IMG_CF_INDEXED_1BIT:
+    case LV_IMG_CF_INDEXED_2BIT:
+    case LV_IMG_CF_INDEXED_4BIT:
+    case LV_IMG_CF_INDEXED_8BIT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static lv_img_cf_t img_decoded_cf(lv_img_cf_t cf) {
+    return cf == LV_IMG_CF_TRUE_COLOR ? LV_IMG_CF_TRUE_COLOR : LV_IMG_CF_TRUE_COLOR_ALPHA;
+}
+
+static size_t img_decoded_size(const lv_img_header_t *header) {
+    size_t px = img_decoded_cf(header->cf) == LV_IMG_CF_TRUE_COLOR ? LV_IMG_PX_SIZE_ALPHA_BYTE - 1
+                                                                   : LV_IMG_PX_SIZE_ALPHA_BYTE;
+    return (size_t)header->w * header->h * px;
+}
+
+static uintptr_t img_src_id(const void *src, lv_img_src_t src_type) {
+    if (src_type == LV_IMG_SRC_VARIABLE) {
+        return (uintptr_t)src;
+    }
+    // 文件路径取 FNV-1a 哈希
+    uint32_t h = 2166136261u;
+    for (const char *p = src; *p; p++) {
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    }
+    return (uintptr_t)h | 1; // 奇数，避免与对齐的变量地址冲突
+}
+
+static lv_res_t cache_img_info(lv_img_decoder_t *decoder, const void *src, lv_img_header_t *header) {
+    lv_img_src_t src_type = lv_img_src_get_type(src);
+    if (src_type != LV_IMG_SRC_VARIABLE && src_type != LV_IMG_SRC_FILE) {
+        return LV_RES_INV;
+    }
+    if (lv_img_decoder_built_in_info(decoder, src, header) != LV_RES_OK) {
+        return LV_RES_INV;
+    }
+    if (!img_cf_cacheable(src_type, header->cf)) {
+        return LV_RES_INV;
+    }
+    if (img_decoded_size(header) > s_budget / LVGL_CACHE_IMG_MAX_SHARE) {
+        return LV_RES_INV;
+    }
+    return LV_RES_OK;
+}
+
+static lv_res_t cache_img_open(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+    uintptr_t owner = img_src_id(dsc->src, dsc->src_type);
+    uint32_t key = dsc->header.cf == LV_IMG_CF_TRUE_COLOR ? 0 : dsc->color.full;
+
+    cache_entry_t *e = cache_lookup(ENTRY_IMG, owner, key);
+    if (e) {
+        if (!s_prewarming) {
+            s_stats.img_hits++;
+        }
+    } else {
+        if (!s_prewarming) {
+            s_stats.img_misses++;
+        }
+        size_t data_size = img_decoded_size(&dsc->header);
+        e = cache_insert(ENTRY_IMG, owner, key, data_size);
+        if (!e) {
+            return LV_RES_INV; // 放不下，交给内置解码器逐行解码
+        }
+        e->refcnt = 1; // 解码期间防止被淘汰
+
+        // 用内置解码器逐行解码到缓存
+        lv_img_decoder_dsc_t tmp = *dsc;
+        tmp.img_data = NULL;
+        tmp.user_data = NULL;
+        lv_res_t res = lv_img_decoder_built_in_open(decoder, &tmp);
+        if (res == LV_RES_OK) {
+            size_t line = data_size / dsc->header.h;
+            for (lv_coord_t y = 0; y < (lv_coord_t)dsc->header.h && res == LV_RES_OK; y++) {
+                res = lv_img_decoder_built_in_read_line(decoder, &tmp, 0, y, dsc->header.w,
+                                                        e->data + y * line);
+            }
+            lv_img_decoder_built_in_close(decoder, &tmp);
+        }
+        if (res != LV_RES_OK) {
+            cache_remove(e);
+            return LV_RES_INV;
+        }
+        e->refcnt = 0;
+        e->u.img = dsc->header;
+        e->u.img.cf = img_decoded_cf(dsc->header.cf);
+    }
+
+    e->refcnt++;
+    dsc->header = e->u.img;
+    dsc->img_data = e->data;
+    dsc->user_data = e;
+    dsc->time_to_open = 1;
+    return LV_RES_OK;
+}
+
+static void cache_img_close(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+    LV_UNUSED(decoder);
+    cache_entry_t *e = dsc->user_data;
+    if (e && e->refcnt) {
+        e->refcnt--;
+    }
+    dsc->user_data = NULL;
+}
+
+// ============== 公开接口 ==============
+
+bool lvgl_cache_init(size_t budget_bytes) {
+    if (s_buckets) {
+        return true;
+    }
+    s_buckets = heap_caps_calloc(CACHE_BUCKET_COUNT, sizeof(cache_entry_t *),
+                                 MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_buckets) {
+        ESP_LOGE(TAG, "哈希表分配失败");
+        return false;
+    }
+    s_budget = budget_bytes ? budget_bytes : LVGL_CACHE_BUDGET_BYTES;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.budget_bytes = s_budget;
+
+    // 新建的解码器插在链表头部，优先于内置解码器
+    s_img_decoder = lv_img_decoder_create();
+    if (s_img_decoder) {
+        lv_img_decoder_set_info_cb(s_img_decoder, cache_img_info);
+        lv_img_decoder_set_open_cb(s_img_decoder, cache_img_open);
+        lv_img_decoder_set_close_cb(s_img_decoder, cache_img_close);
+    }
+
+    ESP_LOGI(TAG, "图片/字形缓存已初始化，预算 %u KB (PSRAM)", (unsigned)(s_budget / 1024));
+    return true;
+}
+
+uint32_t lvgl_cache_prewarm_text(const lv_font_t *font, const char *text) {
+    if (!font || !text) {
+        return 0;
+    }
+    bool nested = s_prewarming;
+    uint32_t loads_before = s_prewarm_loads;
+    s_prewarming = true;
+
+    uint32_t i = 0;
+    lv_font_glyph_dsc_t g;
+    while (text[i] != '\0') {
+        uint32_t letter = _lv_txt_encoded_next(text, &i);
+        if (letter < 0x20) {
+            continue;
+        }
+        if (lv_font_get_glyph_dsc(font, &g, letter, 0) && g.resolved_font) {
+            lv_font_get_glyph_bitmap(g.resolved_font, letter);
+        }
+    }
+
+    s_prewarming = nested;
+    return s_prewarm_loads - loads_before;
+}
+
+static void prewarm_obj_recursive(lv_obj_t *obj) {
+    if (lv_obj_check_type(obj, &lv_label_class)) {
+        const lv_font_t *font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+        lvgl_cache_prewarm_text(font, lv_label_get_text(obj));
+    }
+#if LV_USE_IMG
+    else if (lv_obj_check_type(obj, &lv_img_class)) {
+        const void *src = lv_img_get_src(obj);
+        lv_img_src_t src_type = src ? lv_img_src_get_type(src) : LV_IMG_SRC_UNKNOWN;
+        if (src_type == LV_IMG_SRC_VARIABLE || src_type == LV_IMG_SRC_FILE) {
+            lv_img_decoder_dsc_t dsc;
+            lv_color_t color = lv_obj_get_style_img_recolor_filtered(obj, LV_PART_MAIN);
+            if (lv_img_decoder_open(&dsc, src, color, 0) == LV_RES_OK) {
+                lv_img_decoder_close(&dsc);
+            }
+        }
+    }
+#endif
+
+    uint32_t cnt = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < cnt; i++) {
+        prewarm_obj_recursive(lv_obj_get_child(obj, i));
+    }
+}
+
+uint32_t lvgl_cache_prewarm_obj(lv_obj_t *root) {
+    if (!root || !s_buckets) {
+        return 0;
+    }
+    uint32_t loads_before = s_prewarm_loads;
+    s_prewarming = true;
+    prewarm_obj_recursive(root);
+    s_prewarming = false;
+    return s_prewarm_loads - loads_before;
+}
+
+void lvgl_cache_flush(void) {
+    cache_entry_t *e = s_lru_tail;
+    while (e) {
+        cache_entry_t *prev = e->lru_prev;
+        if (e->refcnt == 0) {
+            cache_remove(e);
+        }
+        e = prev;
+    }
+}
+
+void lvgl_cache_get_stats(lvgl_cache_stats_t *stats) {
+    if (stats) {
+        *stats = s_stats;
+    }
+}
+
+void lvgl_cache_reset_stats(void) {
+    s_stats.glyph_hits = 0;
+    s_stats.glyph_misses = 0;
+    s_stats.img_hits = 0;
+    s_stats.img_misses = 0;
+    s_stats.evictions = 0;
+    s_stats.peak_bytes = s_stats.used_bytes;
+}
+
+void lvgl_cache_print_stats(void) {
+    uint32_t glyph_total = s_stats.glyph_hits + s_stats.glyph_misses;
+    uint32_t img_total = s_stats.img_hits + s_stats.img_misses;
+    ESP_LOGI(TAG, "字形 命中 %lu/%lu (%.1f%%), 图片 命中 %lu/%lu (%.1f%%), 淘汰 %lu",
+             (unsigned long)s_stats.glyph_hits, (unsigned long)glyph_total,
+             glyph_total ? 100.0 * s_stats.glyph_hits / glyph_total : 0.0,
+             (unsigned long)s_stats.img_hits, (unsigned long)img_total,
+             img_total ? 100.0 * s_stats.img_hits / img_total : 0.0,
+             (unsigned long)s_stats.evictions);
+    ESP_LOGI(TAG, "条目 %lu, 占用 %u/%u KB, 峰值 %u KB",
+             (unsigned long)s_stats.entries, (unsigned)(s_stats.used_bytes / 1024),
+             (unsigned)(s_stats.budget_bytes / 1024), (unsigned)(s_stats.peak_bytes / 1024));
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * LVGL 图片/字形缓存
+ *
+ * 解码后的图片和字形位图放进同一个按字节预算的 PSRAM LRU：
+ * - 图片：注册一个排在内置解码器之前的缓存解码器，文件图片、索引色/Alpha
+ *   图片首次打开时整图解码进 PSRAM，之后直接返回像素指针
+ *   （C 数组形式的 TRUE_COLOR 图片本身零拷贝，不进缓存）
+ * - 字形：lvgl_cache_font_init() 包装一个字体，字形描述和位图按码点缓存，
+ *   未命中的码点也会记录，避免重复查 cmap
+ *
+ * 所有接口只能在 LVGL 任务中调用（与 lv_timer_handler 同一线程），内部不加锁。
+ */
+
+// 缓存总预算（字节），图片与字形共享
+#ifndef LVGL_CACHE_BUDGET_BYTES
+#define LVGL_CACHE_BUDGET_BYTES (512 * 1024)
+#endif
+
+// 单个图片超过预算的该比例时不缓存，直接走内置解码器
+#ifndef LVGL_CACHE_IMG_MAX_SHARE
+#define LVGL_CACHE_IMG_MAX_SHARE 4
+#endif
+
+/**
+ * 缓存统计
+ */
+typedef struct {
+    uint32_t glyph_hits;   // 字形命中次数
+    uint32_t glyph_misses; // 字形未命中次数
+    uint32_t img_hits;     // 图片命中次数
+    uint32_t img_misses;   // 图片未命中次数
+    uint32_t evictions;    // 淘汰条目数
+    uint32_t entries;      // 当前条目数
+    size_t used_bytes;     // 当前占用字节
+    size_t peak_bytes;     // 峰值占用字节
+    size_t budget_bytes;   // 预算字节
+} lvgl_cache_stats_t;
+
+/**
+ * 初始化缓存并注册图片缓存解码器
+ * 在 lv_init() 之后、创建任何界面之前调用
+ * @param budget_bytes 缓存预算（字节），0 表示使用 LVGL_CACHE_BUDGET_BYTES
+ * @return true 成功，false 分配失败
+ */
+bool lvgl_cache_init(size_t budget_bytes);
+
+/**
+ * 用带缓存的字体包装 base
+ * 包装后的字体与 base 行高、基线一致，界面上直接使用 font
+ * @param font 输出的包装字体（需长期有效，通常为静态变量）
+ * @param base 原始字体
+ */
+void lvgl_cache_font_init(lv_font_t *font, const lv_font_t *base);
+
+/**
+ * 设置包装字体是否向原始字体查询字距
+ * 内置 fmt_txt 字体会自动判断；其它字体默认查询，确认没有字距表时可关闭以省去每个字符的回查
+ * @param font lvgl_cache_font_init 包装后的字体
+ * @param enable true 查询字距，false 不查询
+ */
+void lvgl_cache_font_set_kerning(lv_font_t *font, bool enable);
+
+/**
+ * 预热一棵对象树用到的资源
+ * 遍历 root 及其子对象：标签文本的字形、图片控件的图片都会提前放进缓存。
+ * 在切换屏幕（eez_flow_set_screen）之前调用，首帧即可全部命中。
+ * @param root 屏幕根对象
+ * @return 本次新装入缓存的条目数
+ */
+uint32_t lvgl_cache_prewarm_obj(lv_obj_t *root);
+
+/**
+ * 预热一段文本的字形
+ * @param font 字体（应为 lvgl_cache_font_init 包装后的字体）
+ * @param text UTF-8 文本
+ * @return 本次新装入缓存的条目数
+ */
+uint32_t lvgl_cache_prewarm_text(const lv_font_t *font, const char *text);
+
+/**
+ * 清空缓存（被引用中的图片除外）
+ */
+void lvgl_cache_flush(void);
+
+/**
+ * 获取缓存统计
+ * @param stats 输出统计
+ */
+void lvgl_cache_get_stats(lvgl_cache_stats_t *stats);
+
+/**
+ * 清零命中/未命中计数（用于分段统计）
+ */
+void lvgl_cache_reset_stats(void);
+
+/**
+ * 打印缓存命中率和占用
+ */
+void lvgl_cache_print_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
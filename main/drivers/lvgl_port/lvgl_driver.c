@@ -1,5 +1,10 @@
 #include "lvgl_driver.h"
+#include "lvgl_cache.h"
+#include "lvgl_blend.h"
+#include "lvgl_font.h"
 #include "esp_heap_caps.h"
+#include "metrics.h"
+#include "trace.h"
 
 static const char *TAG_LVGL = "LVGL";
 
@@ -24,10 +29,23 @@ void example_lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t
     int offsety1 = area->y1;
     int offsety2 = area->y2;
     // copy a buffer's content to a specific area of the display
+    TRACE_BEGIN(TRACE_EV_LCD_FLUSH, (offsetx2 - offsetx1 + 1) * (offsety2 - offsety1 + 1), offsety1);
     esp_lcd_panel_draw_bitmap(panel_handle, offsetx1, offsety1, offsetx2 +1, offsety2 + 1, color_map);
+    TRACE_END(TRACE_EV_LCD_FLUSH, 0, 0);
     lv_disp_flush_ready(drv);
 }
 
+// 每次刷新的渲染耗时分布（ms），16 / 33 对应 60 / 30 帧
+static const uint32_t s_render_ms_bounds[] = {4, 8, 16, 33, 50, 100};
+static metric_t *s_render_ms;
+
+// 每次刷新后由 LVGL 调用：渲染耗时和刷新的像素数
+static void lvgl_monitor_cb(lv_disp_drv_t *drv, uint32_t time, uint32_t px)
+{
+    metrics_histogram_observe(s_render_ms, time);
+    TRACE_INSTANT(TRACE_EV_LV_REFR, time, px);
+}
+
 /*Read the touchpad*/
 void example_touchpad_read( lv_indev_drv_t * drv, lv_indev_data_t * data )
 {
@@ -84,9 +102,21 @@ void example_lvgl_port_update_callback(lv_disp_drv_t *drv)
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 lv_disp_t *disp;
 void LVGL_Init(void)
+{
+    LVGL_Init_Core();
+    LVGL_Register_Display();
+}
+
+void LVGL_Init_Core(void)
 {
     ESP_LOGI(TAG_LVGL, "Initialize LVGL library");
     lv_init();
+
+    // 图片/字形缓存（PSRAM），需在创建界面之前初始化
+    lvgl_cache_init(LVGL_CACHE_BUDGET_BYTES);
+
+    // 映射 font 分区的中文字体（未烧录时界面使用内置字库）
+    lvgl_font_init();
     
     // 打印详细的内存状态
     size_t free_spiram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
@@ -148,7 +178,10 @@ void LVGL_Init(void)
     size_t free_internal_after = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
     ESP_LOGI(TAG_LVGL, "分配后 - PSRAM 空闲: %d KB, Internal RAM 空闲: %d KB", 
              free_spiram_after / 1024, free_internal_after / 1024);
+}
 
+void LVGL_Register_Display(void)
+{
     ESP_LOGI(TAG_LVGL, "Register display driver to LVGL");
     lv_disp_drv_init(&disp_drv);                                                                        // Create a new screen object and initialize the associated device
     disp_drv.hor_res = EXAMPLE_LCD_WIDTH;             
@@ -158,6 +191,10 @@ void LVGL_Init(void)
     disp_drv.drv_update_cb = example_lvgl_port_update_callback;                                         // Function : Rotate display and touch, when rotated screen in LVGL. Called when driver parameters are updated. 
     disp_drv.draw_buf = &disp_buf;                                                                      // LVGL will use this buffer(s) to draw the screens contents
     disp_drv.user_data = panel_handle;                
+    disp_drv.draw_ctx_init = lvgl_blend_init_ctx;                                                       // RGB565 混合加速（替换 lv_draw_sw 的 blend 回调）
+    s_render_ms = metrics_histogram("lv.render_ms", s_render_ms_bounds,
+                                    sizeof(s_render_ms_bounds) / sizeof(s_render_ms_bounds[0]));
+    disp_drv.monitor_cb = lvgl_monitor_cb;                                                              // 渲染耗时写入指标和事件跟踪
     ESP_LOGI(TAG_LVGL,"Register display indev to LVGL");                                                  // Custom display driver user data
     disp = lv_disp_drv_register(&disp_drv);     
     
@@ -33,6 +33,10 @@ void example_increase_lvgl_tick(void *arg);
 void LVGL_Init(void); // Call this function to initialize the screen (must be
                       // called in the main function) !!!!!
 
+// LVGL_Init 分两步，启动时第一步可与 LCD_Init 并行：
+void LVGL_Init_Core(void);        // lv_init、图片/字形缓存、字体、显存缓冲区，不访问屏幕
+void LVGL_Register_Display(void); // 注册显示和触摸驱动、启动 tick 定时器，需在 LCD_Init 之后
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include "lvgl_font.h"
+#include "lvgl_cache.h"
+#include "esp_log.h"
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_partition.h"
+#endif
+
+static const char *TAG = "LVGL_FONT";
+
+static const uint8_t *s_data = NULL; // 字体文件（映射地址）
+static size_t s_size = 0;
+static bool s_has_kerning = false;   // 是否带 kern / GPOS 表
+
+#ifdef ESP_PLATFORM
+static esp_partition_mmap_handle_t s_mmap_handle;
+#endif
+
+// ============== 文件校验 ==============
+
+#define FONT_TAG(a, b, c, d) (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((uint32_t)(c) << 8) | (uint32_t)(d))
+
+static uint32_t rd_u32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint16_t rd_u16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+/**
+ * @brief 校验 TTF/OTF 文件头，顺带检查是否有字距表
+ * 分区未烧录时内容全为 0xFF，在这里就会被拒绝
+ */
+static bool font_probe(const uint8_t *data, size_t size, bool *has_kerning) {
+    if (size < 12) {
+        return false;
+    }
+
+    size_t offset = 0;
+    uint32_t tag = rd_u32(data);
+    if (tag == FONT_TAG('t', 't', 'c', 'f')) {
+        // 字体集合，tiny_ttf 使用第一个字体
+        if (size < 16) {
+            return false;
+        }
+        offset = rd_u32(data + 12);
+        if (offset + 12 > size) {
+            return false;
+        }
+        tag = rd_u32(data + offset);
+    }
+    if (tag != 0x00010000 && tag != FONT_TAG('t', 'r', 'u', 'e') && tag != FONT_TAG('O', 'T', 'T', 'O')) {
+        return false;
+    }
+
+    uint16_t num_tables = rd_u16(data + offset + 4);
+    const uint8_t *dir = data + offset + 12;
+    if (offset + 12 + (size_t)num_tables * 16 > size) {
+        return false;
+    }
+
+    *has_kerning = false;
+    for (uint16_t i = 0; i < num_tables; i++) {
+        uint32_t t = rd_u32(dir + i * 16);
+        if (t == FONT_TAG('k', 'e', 'r', 'n') || t == FONT_TAG('G', 'P', 'O', 'S')) {
+            *has_kerning = true;
+        }
+    }
+    return true;
+}
+
+// ============== 对外接口 ==============
+
+bool lvgl_font_init_data(const void *data, size_t size) {
+    bool has_kerning = false;
+    if (!data || !font_probe(data, size, &has_kerning)) {
+        ESP_LOGW(TAG, "字体数据无效（不是 TTF/OTF 文件或未烧录）");
+        return false;
+    }
+    s_data = data;
+    s_size = size;
+    s_has_kerning = has_kerning;
+    return true;
+}
+
+bool lvgl_font_init(void) {
+#ifdef ESP_PLATFORM
+    if (s_data) {
+        return true;
+    }
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                           LVGL_FONT_PARTITION_LABEL);
+    if (!part) {
+        ESP_LOGW(TAG, "未找到 %s 分区，使用内置字库", LVGL_FONT_PARTITION_LABEL);
+        return false;
+    }
+
+    const void *ptr = NULL;
+    esp_err_t ret = esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &ptr, &s_mmap_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "字体分区映射失败: %s", esp_err_to_name(ret));
+        return false;
+    }
+
+    if (!lvgl_font_init_data(ptr, part->size)) {
+        esp_partition_munmap(s_mmap_handle);
+        ESP_LOGW(TAG, "使用内置字库");
+        return false;
+    }
+
+    ESP_LOGI(TAG, "字体分区已映射: %lu KB @ %p，字距表: %s", (unsigned long)(part->size / 1024), ptr,
+             s_has_kerning ? "有" : "无");
+    return true;
+#else
+    return s_data != NULL;
+#endif
+}
+
+bool lvgl_font_ready(void) {
+    return s_data != NULL;
+}
+
+bool lvgl_font_create(lv_font_t *font, lv_coord_t px) {
+    if (!s_data) {
+        return false;
+    }
+
+    lv_font_t *ttf = lv_tiny_ttf_create_data_ex(s_data, s_size, px, LVGL_FONT_TTF_CACHE_BYTES);
+    if (!ttf) {
+        ESP_LOGE(TAG, "%d px 字体创建失败", (int)px);
+        return false;
+    }
+
+    lvgl_cache_font_init(font, ttf);
+    lvgl_cache_font_set_kerning(font, s_has_kerning);
+    ESP_LOGI(TAG, "%d px 字体已创建，行高 %d，基线 %d", (int)px, (int)font->line_height, (int)font->base_line);
+    return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * 分区字体
+ *
+ * font 数据分区（partitions.csv）里存放一个 TTF/OTF 文件，启动时用 esp_partition_mmap
+ * 映射进地址空间，字体数据不拷贝到 RAM。字形由 tiny_ttf 按需光栅化，结果进入
+ * lvgl_cache 的字节预算 LRU，同一字形只光栅化一次。
+ * 换字体、加字号都不需要重新编译固件：
+ *
+ *   parttool.py write_partition --partition-name font --input xxx.ttf
+ *
+ * 分区不存在或内容不是字体文件时 lvgl_font_ready() 返回 false，界面回退到内置字库。
+ * 所有接口只能在 LVGL 任务中调用。
+ */
+
+#define LVGL_FONT_PARTITION_LABEL "font"
+
+// tiny_ttf 自带的位图缓存（字节），字形已由 lvgl_cache 缓存，这里只作光栅化中转
+#ifndef LVGL_FONT_TTF_CACHE_BYTES
+#define LVGL_FONT_TTF_CACHE_BYTES (4 * 1024)
+#endif
+
+/**
+ * 映射 font 分区并校验字体文件
+ * 在 lvgl_cache_init() 之后、create_screens() 之前调用
+ * @return true 分区字体可用，false 使用内置字库
+ */
+bool lvgl_font_init(void);
+
+/**
+ * 直接使用一块内存中的字体文件（主机端基准、测试用）
+ * 数据需在字体使用期间一直有效，不会被拷贝
+ * @param data 字体文件数据
+ * @param size 数据长度（字节）
+ * @return true 校验通过
+ */
+bool lvgl_font_init_data(const void *data, size_t size);
+
+/**
+ * 分区字体是否可用
+ */
+bool lvgl_font_ready(void);
+
+/**
+ * 用分区字体创建一个带缓存的字号
+ * @param font 输出字体（需长期有效，通常为静态变量）
+ * @param px 字号（像素）
+ * @return true 成功，false 字体不可用或创建失败（font 不变）
+ */
+bool lvgl_font_create(lv_font_t *font, lv_coord_t px);
+
+#ifdef __cplusplus
+}
+#endif
@@ -9,6 +9,10 @@
  * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "eez-flow.h"
+#include "eez_watch.h"
+#include "eez_flow_aot.h"
+#include "eez_flow_sched.h"
+#include "eez_string.h"
 #if EEZ_FOR_LVGL_LZ4_OPTION
 #include "eez-flow-lz4.h"
 #endif
@@ -45,40 +49,35 @@ void executeActionFunction(int actionId) {
 #include <math.h>
 #include <assert.h>
 #include <string.h>
+#if defined(EEZ_FOR_LVGL)
+#include "eez_heap.h"
+#include "lvgl_mem.h"
+#endif
 namespace eez {
 #if defined(EEZ_FOR_LVGL)
+// 分级空闲链表堆，见 eez_heap.h
 void initAllocHeap(uint8_t *heap, size_t heapSize) {
     EEZ_UNUSED(heap);
     EEZ_UNUSED(heapSize);
 }
 void *alloc(size_t size, uint32_t id) {
-    EEZ_UNUSED(id);
-#if LVGL_VERSION_MAJOR >= 9
-    return lv_malloc(size);
-#else
-    return lv_mem_alloc(size);
-#endif
+    return eez_heap_alloc(size, id);
 }
 void free(void *ptr) {
-#if LVGL_VERSION_MAJOR >= 9
-    lv_free(ptr);
-#else
-    lv_mem_free(ptr);
-#endif
+    eez_heap_free(ptr);
 }
 template<typename T> void freeObject(T *ptr) {
 	ptr->~T();
-#if LVGL_VERSION_MAJOR >= 9
-    lv_free(ptr);
-#else
-	lv_mem_free(ptr);
-#endif
+	eez_heap_free(ptr);
 }
 void getAllocInfo(uint32_t &free, uint32_t &alloc) {
-    lv_mem_monitor_t mon;
-    lv_mem_monitor(&mon);
-	free = mon.free_size;
-	alloc = mon.total_size - mon.free_size;
+    // 可分配 = 区块中的空闲块和未切分部分 + LVGL PSRAM 区剩余（新区块和大块从这里申请）
+    eez_heap_stats_t st;
+    eez_heap_get_stats(&st);
+    lvgl_mem_stats_t mem;
+    lvgl_mem_get_stats(&mem);
+	free = st.chunk_free_bytes + mem.psram_free_bytes;
+	alloc = st.block_bytes + st.large_bytes;
 }
 #elif defined(EEZ_DASHBOARD_API)
 #include <emscripten/heap.h>
@@ -2405,12 +2404,32 @@ Value MakeEnumDefinitionValue(uint8_t enumValue, uint8_t enumDefinition) {
     value.enumValue.enumDefinition = enumDefinition;
     return value;
 }
+// getString() 从间接值（原生变量、数组元素、属性引用等）解析出内联串时，解析出的临时值保存在这里，
+// 返回的指针在之后 EEZ_STRING_RESOLVED_SLOTS 次同类解析之前有效；需要更久的调用方自己持有 getValue() 的结果
+static Value g_resolvedStrings[EEZ_STRING_RESOLVED_SLOTS];
+static uint8_t g_resolvedStringsNext;
 const char *Value::getString() const {
+	if (type == VALUE_TYPE_STRING) {
+		return (options & STRING_OPTIONS_INLINE) ? inlineStr : strValue;
+	}
+	if (type == VALUE_TYPE_STRING_REF) {
+		return ((StringRef *)refValue)->str;
+	}
+	if (type == VALUE_TYPE_VALUE_PTR) {
+		return pValueValue->getString();
+	}
     auto value = getValue(); 
 	if (value.type == VALUE_TYPE_STRING_REF) {
 		return ((StringRef *)value.refValue)->str;
 	}
 	if (value.type == VALUE_TYPE_STRING) {
+		if (value.options & STRING_OPTIONS_INLINE) {
+			// value 是临时值，保持存活到被后续解析覆盖
+			Value &slot = g_resolvedStrings[g_resolvedStringsNext];
+			g_resolvedStringsNext = (g_resolvedStringsNext + 1) % EEZ_STRING_RESOLVED_SLOTS;
+			slot = value;
+			return slot.inlineStr;
+		}
 		return value.strValue;
 	}
 	return nullptr;
@@ -2766,13 +2785,26 @@ Value Value::toString(uint32_t id) const {
 	return makeStringRef(tempStr, strlen(tempStr), id);
 }
 Value Value::makeStringRef(const char *str, int len, uint32_t id) {
+	if (len == -1) {
+		len = strlen(str);
+	}
+	if (len <= EEZ_STRING_INLINE_MAX_LEN) {
+		Value value;
+		value.type = VALUE_TYPE_STRING;
+		value.options = STRING_OPTIONS_INLINE;
+		stringCopyLength(value.inlineStr, len, str, len);
+		stringCountInline();
+		return value;
+	}
+	const char *interned = stringIntern(str, len);
+	if (interned) {
+		return Value(interned, VALUE_TYPE_STRING);
+	}
     auto stringRef = ObjectAllocator<StringRef>::allocate(id);
 	if (stringRef == nullptr) {
 		return Value(0, VALUE_TYPE_NULL);
 	}
-	if (len == -1) {
-		len = strlen(str);
-	}
+	stringCountRef();
     stringRef->str = (char *)alloc(len + 1, id + 1);
     if (stringRef->str == nullptr) {
         ObjectAllocator<StringRef>::deallocate(stringRef);
@@ -2787,12 +2819,25 @@ Value Value::makeStringRef(const char *str, int len, uint32_t id) {
     value.refValue = stringRef;
 	return value;
 }
-Value Value::concatenateString(const Value &str1, const Value &str2) {
+Value Value::concatenateString(const Value &value1, const Value &value2) {
+    // 先解析成直接值，getString() 的指针在本函数内一直有效
+    auto str1 = value1.getValue();
+    auto str2 = value2.getValue();
+    auto len1 = strlen(str1.getString());
+    auto len2 = strlen(str2.getString());
+    if (len1 + len2 <= EEZ_STRING_INTERN_MAX_LEN) {
+        // 短结果先拼在栈上，交给 makeStringRef 内联或驻留
+        char tempStr[EEZ_STRING_INTERN_MAX_LEN + 1];
+        memcpy(tempStr, str1.getString(), len1);
+        memcpy(tempStr + len1, str2.getString(), len2);
+        return makeStringRef(tempStr, (int)(len1 + len2), 0xbab14c6a);
+    }
     auto stringRef = ObjectAllocator<StringRef>::allocate(0xbab14c6a);;
 	if (stringRef == nullptr) {
 		return Value(0, VALUE_TYPE_NULL);
 	}
-    auto newStrLen = strlen(str1.getString()) + strlen(str2.getString()) + 1;
+	stringCountRef();
+    auto newStrLen = len1 + len2 + 1;
     stringRef->str = (char *)alloc(newStrLen, 0xb5320162);
     if (stringRef->str == nullptr) {
         ObjectAllocator<StringRef>::deallocate(stringRef);
@@ -3701,6 +3746,7 @@ void executeLineChartWidgetComponent(FlowState *flowState, unsigned componentInd
             executionState->numPoints = 0;
             for (uint32_t elementIndex = 0; elementIndex < array->arraySize; elementIndex++) {
                 flowState->values[valueInputIndexInFlow] = array->values[elementIndex];
+                watchMarkDirty(&flowState->values[valueInputIndexInFlow]);
                 if (executionState->onInputValue(flowState, componentIndex)) {
                     updated = true;
                 } else {
@@ -3962,7 +4008,9 @@ void executeLVGLComponent(FlowState *flowState, unsigned componentIndex) {
                     return;
                 }
                 if (specific->property == IMAGE_IMAGE || specific->property == LABEL_TEXT) {
-                    const char *strValue = value.toString(0xe42b3ca2).getString();
+                    // 转换结果可能是内联串，保持它在使用期间存活
+                    Value textValue = value.toString(0xe42b3ca2);
+                    const char *strValue = textValue.getString();
                     if (specific->property == IMAGE_IMAGE) {
                         const void *src = getLvglImageByNameHook(strValue);
                         if (src) {
@@ -4208,7 +4256,8 @@ void executeLVGLComponent(FlowState *flowState, unsigned componentIndex) {
         return; \
     }\
     propIndex++; \
-    const char *NAME = NAME##Value.toString(0xe42b3ca2).getString();
+    NAME##Value = NAME##Value.toString(0xe42b3ca2); \
+    const char *NAME = NAME##Value.getString();
 #define SCREEN_PROP(NAME) \
     Value NAME##Value; \
     if (!evalExpression(flowState, componentIndex, properties[propIndex]->evalInstructions, NAME##Value, FlowError::PropertyInAction(#NAME, actionName, actionIndex))) { \
@@ -6431,6 +6480,7 @@ void onRemoveFromQueue() {
     }
 }
 void onValueChanged(const Value *pValue) {
+    watchMarkDirty(pValue);
     if (isSubscribedTo(MESSAGE_TO_DEBUGGER_VALUE_CHANGED)) {
         char buffer[256];
 		snprintf(buffer, sizeof(buffer), "%d\t%p\t",
@@ -6712,13 +6762,64 @@ void onPageChanged(int previousPageId, int activePageId, bool activePageIsFromSt
 // flow/expression.cpp
 // -----------------------------------------------------------------------------
 #include <stdio.h>
+#include "eez_expr.h"
 #if EEZ_OPTION_GUI
 using namespace eez::gui;
 #endif
 namespace eez {
 namespace flow {
 EvalStack g_stack;
+void evalArrayElement(EvalStack &stack) {
+	auto elementIndexValue = stack.pop().getValue();
+	auto arrayValue = stack.pop().getValue();
+    if (arrayValue.getType() == VALUE_TYPE_UNDEFINED || arrayValue.getType() == VALUE_TYPE_NULL) {
+        stack.push(Value(0, VALUE_TYPE_UNDEFINED));
+    } else {
+        if (arrayValue.isArray()) {
+            auto array = arrayValue.getArray();
+            int err;
+            auto elementIndex = elementIndexValue.toInt32(&err);
+            if (!err) {
+                if (elementIndex >= 0 && elementIndex < (int)array->arraySize) {
+                    stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
+                } else {
+                    stack.push(Value::makeError());
+                    stack.setErrorMessage("Array element index out of bounds\n");
+                }
+            } else {
+                stack.push(Value::makeError());
+                stack.setErrorMessage("Integer value expected for array element index\n");
+            }
+        } else if (arrayValue.isBlob()) {
+            auto blobRef = arrayValue.getBlob();
+            int err;
+            auto elementIndex = elementIndexValue.toInt32(&err);
+            if (!err) {
+                if (elementIndex >= 0 && elementIndex < (int)blobRef->len) {
+                    stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
+                } else {
+                    stack.push(Value::makeError());
+                    stack.setErrorMessage("Blob element index out of bounds\n");
+                }
+            } else {
+                stack.push(Value::makeError());
+                stack.setErrorMessage("Integer value expected for blob element index\n");
+            }
+        } else {
+            stack.push(Value::makeError());
+            stack.setErrorMessage("Array value expected\n");
+        }
+    }
+}
 static void evalExpression(FlowState *flowState, const uint8_t *instructions, int *numInstructionBytes) {
+    // 优先执行 flow 启动时预编译的结果（eez_expr.h），没有时解释执行；
+    // 单个操作数的表达式不查表
+    if (!exprIsTrivial(instructions)) {
+        if (auto program = exprFind(instructions)) {
+            exprRun(flowState, program, numInstructionBytes);
+            return;
+        }
+    }
 	auto flowDefinition = flowState->flowDefinition;
 	auto flow = flowState->flow;
 	int i = 0;
@@ -6745,46 +6846,7 @@ static void evalExpression(FlowState *flowState, const uint8_t *instructions, in
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_OUTPUT) {
 			g_stack.push(Value((uint16_t)instructionArg, VALUE_TYPE_FLOW_OUTPUT));
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_ARRAY_ELEMENT) {
-			auto elementIndexValue = g_stack.pop().getValue();
-			auto arrayValue = g_stack.pop().getValue();
-            if (arrayValue.getType() == VALUE_TYPE_UNDEFINED || arrayValue.getType() == VALUE_TYPE_NULL) {
-                g_stack.push(Value(0, VALUE_TYPE_UNDEFINED));
-            } else {
-                if (arrayValue.isArray()) {
-                    auto array = arrayValue.getArray();
-                    int err;
-                    auto elementIndex = elementIndexValue.toInt32(&err);
-                    if (!err) {
-                        if (elementIndex >= 0 && elementIndex < (int)array->arraySize) {
-                            g_stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
-                        } else {
-                            g_stack.push(Value::makeError());
-                            g_stack.setErrorMessage("Array element index out of bounds\n");
-                        }
-                    } else {
-                        g_stack.push(Value::makeError());
-                        g_stack.setErrorMessage("Integer value expected for array element index\n");
-                    }
-                } else if (arrayValue.isBlob()) {
-                    auto blobRef = arrayValue.getBlob();
-                    int err;
-                    auto elementIndex = elementIndexValue.toInt32(&err);
-                    if (!err) {
-                        if (elementIndex >= 0 && elementIndex < (int)blobRef->len) {
-                            g_stack.push(Value::makeArrayElementRef(arrayValue, elementIndex, 0x132e0e2f));
-                        } else {
-                            g_stack.push(Value::makeError());
-                            g_stack.setErrorMessage("Blob element index out of bounds\n");
-                        }
-                    } else {
-                        g_stack.push(Value::makeError());
-                        g_stack.setErrorMessage("Integer value expected for blob element index\n");
-                    }
-                } else {
-                    g_stack.push(Value::makeError());
-                    g_stack.setErrorMessage("Array value expected\n");
-                }
-            }
+			evalArrayElement(g_stack);
 		} else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_OPERATION) {
 			g_evalOperations[instructionArg](g_stack);
 		} else {
@@ -7006,10 +7068,7 @@ namespace flow {
 #if defined(__EMSCRIPTEN__)
 uint32_t g_wasmModuleId = 0;
 #endif
-#if !defined(EEZ_FLOW_TICK_MAX_DURATION_MS)
-#define EEZ_FLOW_TICK_MAX_DURATION_MS 5
-#endif
-static const uint32_t FLOW_TICK_MAX_DURATION_MS = EEZ_FLOW_TICK_MAX_DURATION_MS;
+// tick 时间预算见 eez_flow_sched.h，g_tick_max_duration_count 记录预算用完留下任务的次数
 static unsigned g_tick_max_duration_count = 0;
 int g_selectedLanguage = 0;
 FlowState *g_firstFlowState;
@@ -7025,6 +7084,7 @@ unsigned start(Assets *assets) {
     g_isStopped = false;
     g_isStopping = false;
     initGlobalVariables(assets);
+    exprCompileAll(assets);
 	queueReset();
     watchListReset();
 	scpiComponentInitHook();
@@ -7039,38 +7099,48 @@ void tick() {
         doStop();
         return;
     }
-	uint32_t startTickCount = millis();
+    schedTickBegin();
     visitWatchList();
-    auto queueSizeAtTickStart = getQueueSize();
-    for (size_t i = 0; i < queueSizeAtTickStart || g_numNonContinuousTaskInQueue > 0; i++) {
+    // 先执行 INPUT、NORMAL 道，连续任务每个 tick 最多轮询一轮（本 tick 中重新入队的留到下个 tick）
+    size_t continuousAtTickStart = getLaneSize(EEZ_FLOW_LANE_CONTINUOUS);
+    size_t continuousVisited = 0;
+    uint32_t executed = 0;
+    bool deferred = false;
+    while (true) {
+        eez_flow_lane_t lane;
+        if (getLaneSize(EEZ_FLOW_LANE_INPUT) > 0) {
+            lane = EEZ_FLOW_LANE_INPUT;
+        } else if (getLaneSize(EEZ_FLOW_LANE_NORMAL) > 0) {
+            lane = EEZ_FLOW_LANE_NORMAL;
+        } else if (continuousVisited < continuousAtTickStart && getLaneSize(EEZ_FLOW_LANE_CONTINUOUS) > 0) {
+            lane = EEZ_FLOW_LANE_CONTINUOUS;
+            continuousVisited++;
+        } else {
+            break;
+        }
 		FlowState *flowState;
 		unsigned componentIndex;
-        bool continuousTask;
-		if (!peekNextTaskFromQueue(flowState, componentIndex, continuousTask)) {
+        bool continuousTask = lane == EEZ_FLOW_LANE_CONTINUOUS;
+		if (!peekNextTaskFromQueue(lane, flowState, componentIndex)) {
 			break;
 		}
         if (!flowState) {
-            removeNextTaskFromQueue();
+            removeNextTaskFromQueue(lane);
             continue;
         }
 		if (!continuousTask && !canExecuteStep(flowState, componentIndex)) {
 			break;
 		}
-		removeNextTaskFromQueue();
+		removeNextTaskFromQueue(lane);
         flowState->executingComponentIndex = componentIndex;
         if (flowState->error) {
             deallocateComponentExecutionState(flowState, componentIndex);
         } else {
-            if (continuousTask) {
-                if (i < queueSizeAtTickStart) {
-                    executeComponent(flowState, componentIndex);
-                } else {
-                    addToQueue(flowState, componentIndex, -1, -1, -1, true);
-                }
-            } else {
-                executeComponent(flowState, componentIndex);
-            }
+            schedSetExecutingLane(lane);
+            executeComponent(flowState, componentIndex);
+            schedSetExecutingLane(EEZ_FLOW_LANE_NORMAL);
         }
+        executed++;
         if (isFlowStopped() || g_isStopping) {
             break;
         }
@@ -7078,13 +7148,17 @@ void tick() {
         if (canFreeFlowState(flowState)) {
             freeFlowState(flowState);
         }
-        if ((i + 1) % 5 == 0) {
-            if (millis() - startTickCount >= FLOW_TICK_MAX_DURATION_MS) {
+        // 每个组件后检查截止时间，剩余任务留在各自的道里
+        if (schedDeadlineReached()) {
+            deferred = getLaneSize(EEZ_FLOW_LANE_INPUT) > 0 || getLaneSize(EEZ_FLOW_LANE_NORMAL) > 0 ||
+                       continuousVisited < continuousAtTickStart;
+            if (deferred) {
                 g_tick_max_duration_count++;
-                break;
             }
+            break;
         }
 	}
+    schedTickEnd(executed, deferred);
 	finishToDebuggerMessageHook();
     for (FlowState *flowState = g_firstFlowState; flowState; flowState = flowState->nextSibling) {
         if (flowState->deleteOnNextTick) {
@@ -7196,8 +7270,10 @@ void setGlobalVariable(Assets *assets, uint32_t globalVariableIndex, const Value
     if (globalVariableIndex < assets->flowDefinition->globalVariables.count) {
         if (g_globalVariables) {
             g_globalVariables->values[globalVariableIndex] = value;
+            watchMarkDirty(g_globalVariables->values + globalVariableIndex);
         } else {
             *assets->flowDefinition->globalVariables[globalVariableIndex] = value;
+            watchMarkDirty(assets->flowDefinition->globalVariables[globalVariableIndex]);
         }
     }
 }
@@ -7408,6 +7484,7 @@ void dataOperation(int16_t dataId, DataOperationEnum operation, const WidgetCurs
                         newPosition = numItems - itemsPerPage;
                     }
                     array->values[defs_v3::SYSTEM_STRUCTURE_SCROLLBAR_STATE_FIELD_POSITION] = newPosition;
+                    watchMarkAllDirty();
                     onValueChanged(&array->values[defs_v3::SYSTEM_STRUCTURE_SCROLLBAR_STATE_FIELD_POSITION]);
                 } else {
                     value = 0;
@@ -7878,12 +7955,18 @@ extern "C" void flowPropagateValueLVGLEvent(void *flowState, unsigned componentI
         rotaryDiff = lv_event_get_rotary_diff(event);
     }
 #endif
-    eez::flow::propagateValue(
-        (eez::flow::FlowState *)flowState, componentIndex, outputIndex,
-        eez::Value::makeLVGLEventRef(
-            code, currentTarget, target, userData, key, gestureDir, rotaryDiff, 0xe7f23624
-        )
-    );
+    // 预编译的连线直接执行，不构造事件值、不经过队列（见 eez_flow_aot.h）
+    if (!eez_flow_aot_dispatch(flowState, componentIndex, outputIndex)) {
+        // 触摸等输入触发的任务进入 INPUT 道，先于普通任务和连续任务执行（见 eez_flow_sched.h）
+        eez::flow::schedInputBegin();
+        eez::flow::propagateValue(
+            (eez::flow::FlowState *)flowState, componentIndex, outputIndex,
+            eez::Value::makeLVGLEventRef(
+                code, currentTarget, target, userData, key, gestureDir, rotaryDiff, 0xe7f23624
+            )
+        );
+        eez::flow::schedInputEnd();
+    }
     g_lastLVGLEvent = *event;
     if (event->user_data) {
         g_lastLVGLEvent.user_data = &g_lastLVGLEventUserDataBuffer;
@@ -10733,6 +10816,7 @@ void assignValue(FlowState *flowState, int componentIndex, Value &dstValue, cons
 	if (dstValue.getType() == VALUE_TYPE_FLOW_OUTPUT) {
 		propagateValue(flowState, componentIndex, dstValue.getUInt16(), srcValue);
 	} else if (dstValue.getType() == VALUE_TYPE_NATIVE_VARIABLE) {
+		watchNativeVariableChanged(dstValue.getInt());
 #if EEZ_OPTION_GUI
 		set(g_widgetCursor, dstValue.getInt(), srcValue);
 #else
@@ -10742,6 +10826,8 @@ void assignValue(FlowState *flowState, int componentIndex, Value &dstValue, cons
 		Value *pDstValue;
         uint32_t dstValueType = VALUE_TYPE_UNDEFINED;
         if (dstValue.getType() == VALUE_TYPE_ARRAY_ELEMENT_VALUE) {
+            // 元素所在的数组可能被任意槽位引用，watch 全部重新求值
+            watchMarkAllDirty();
             auto arrayElementValue = (ArrayElementValue *)dstValue.refValue;
             if (arrayElementValue->arrayValue.isBlob()) {
                 auto blobRef = arrayElementValue->arrayValue.getBlob();
@@ -11061,52 +11147,67 @@ namespace flow {
 #define EEZ_FLOW_QUEUE_SIZE 1000
 #endif
 static const unsigned QUEUE_SIZE = EEZ_FLOW_QUEUE_SIZE;
+static_assert(QUEUE_SIZE < 32768, "queue index is int16_t");
+// 三条道共用 QUEUE_SIZE 个槽位，每条道是槽位上的单向链表（见 eez_flow_sched.h）
 static struct {
 	FlowState *flowState;
-	unsigned componentIndex;
-    bool continuousTask;
+    uint32_t enqueuedUs;
+	uint16_t componentIndex;
+    int16_t next;
 } g_queue[QUEUE_SIZE];
-static unsigned g_queueHead;
-static unsigned g_queueTail;
+static struct {
+    int16_t head;
+    int16_t tail;
+    unsigned size;
+} g_lanes[EEZ_FLOW_LANE_COUNT] = {{-1, -1, 0}, {-1, -1, 0}, {-1, -1, 0}};
+static int16_t g_queueFree = -1; // queueReset 之前不接受任务
+static unsigned g_queueSize;
 static unsigned g_queueMax;
-static bool g_queueIsFull = false;
 unsigned g_numNonContinuousTaskInQueue;
 void queueReset() {
-	g_queueHead = 0;
-	g_queueTail = 0;
+    for (unsigned i = 0; i < QUEUE_SIZE; i++) {
+        g_queue[i].next = i + 1 < QUEUE_SIZE ? (int16_t)(i + 1) : -1;
+    }
+    g_queueFree = 0;
+    for (unsigned lane = 0; lane < EEZ_FLOW_LANE_COUNT; lane++) {
+        g_lanes[lane].head = -1;
+        g_lanes[lane].tail = -1;
+        g_lanes[lane].size = 0;
+    }
+	g_queueSize = 0;
 	g_queueMax  = 0;
-	g_queueIsFull = false;
     g_numNonContinuousTaskInQueue = 0;
 }
 size_t getQueueSize() {
-	if (g_queueHead == g_queueTail) {
-		if (g_queueIsFull) {
-			return QUEUE_SIZE;
-		}
-		return 0;
-	}
-	if (g_queueHead < g_queueTail) {
-		return g_queueTail - g_queueHead;
-	}
-	return QUEUE_SIZE - g_queueHead + g_queueTail;
+	return g_queueSize;
+}
+size_t getLaneSize(eez_flow_lane_t lane) {
+    return g_lanes[lane].size;
 }
 size_t getMaxQueueSize() {
 	return g_queueMax;
 }
 bool addToQueue(FlowState *flowState, unsigned componentIndex, int sourceComponentIndex, int sourceOutputIndex, int targetInputIndex, bool continuousTask) {
-	if (g_queueIsFull) {
+	if (g_queueFree == -1) {
         throwError(flowState, componentIndex, "Execution queue is full\n");
 		return false;
 	}
-	g_queue[g_queueTail].flowState = flowState;
-	g_queue[g_queueTail].componentIndex = componentIndex;
-    g_queue[g_queueTail].continuousTask = continuousTask;
-	g_queueTail = (g_queueTail + 1) % QUEUE_SIZE;
-	if (g_queueHead == g_queueTail) {
-		g_queueIsFull = true;
-	}
-	size_t queueSize = getQueueSize();
-	g_queueMax = g_queueMax < queueSize ? queueSize : g_queueMax;
+    eez_flow_lane_t lane = continuousTask ? EEZ_FLOW_LANE_CONTINUOUS : schedLaneForNewTask();
+    int16_t slot = g_queueFree;
+    g_queueFree = g_queue[slot].next;
+	g_queue[slot].flowState = flowState;
+	g_queue[slot].componentIndex = (uint16_t)componentIndex;
+    g_queue[slot].enqueuedUs = schedNow();
+    g_queue[slot].next = -1;
+    if (g_lanes[lane].tail == -1) {
+        g_lanes[lane].head = slot;
+    } else {
+        g_queue[g_lanes[lane].tail].next = slot;
+    }
+    g_lanes[lane].tail = slot;
+    schedLaneDepth(lane, ++g_lanes[lane].size);
+	g_queueSize++;
+	g_queueMax = g_queueMax < g_queueSize ? g_queueSize : g_queueMax;
     if (!continuousTask) {
         ++g_numNonContinuousTaskInQueue;
 	    onAddToQueue(flowState, sourceComponentIndex, sourceOutputIndex, componentIndex, targetInputIndex);
@@ -11114,54 +11215,49 @@ bool addToQueue(FlowState *flowState, unsigned componentIndex, int sourceCompone
     incRefCounterForFlowState(flowState);
 	return true;
 }
-bool peekNextTaskFromQueue(FlowState *&flowState, unsigned &componentIndex, bool &continuousTask) {
-	if (g_queueHead == g_queueTail && !g_queueIsFull) {
+bool peekNextTaskFromQueue(eez_flow_lane_t lane, FlowState *&flowState, unsigned &componentIndex) {
+    int16_t slot = g_lanes[lane].head;
+	if (slot == -1) {
 		return false;
 	}
-	flowState = g_queue[g_queueHead].flowState;
-	componentIndex = g_queue[g_queueHead].componentIndex;
-    continuousTask = g_queue[g_queueHead].continuousTask;
+	flowState = g_queue[slot].flowState;
+	componentIndex = g_queue[slot].componentIndex;
 	return true;
 }
-void removeNextTaskFromQueue() {
-	auto flowState = g_queue[g_queueHead].flowState;
+void removeNextTaskFromQueue(eez_flow_lane_t lane) {
+    int16_t slot = g_lanes[lane].head;
+	auto flowState = g_queue[slot].flowState;
     decRefCounterForFlowState(flowState);
-    auto continuousTask = g_queue[g_queueHead].continuousTask;
-	g_queueHead = (g_queueHead + 1) % QUEUE_SIZE;
-	g_queueIsFull = false;
-    if (!continuousTask) {
+    schedTaskDequeued(lane, g_queue[slot].enqueuedUs);
+    g_lanes[lane].head = g_queue[slot].next;
+    if (g_lanes[lane].head == -1) {
+        g_lanes[lane].tail = -1;
+    }
+    g_lanes[lane].size--;
+    g_queue[slot].next = g_queueFree;
+    g_queueFree = slot;
+	g_queueSize--;
+    if (lane != EEZ_FLOW_LANE_CONTINUOUS) {
         --g_numNonContinuousTaskInQueue;
 	    onRemoveFromQueue();
     }
 }
 bool isInQueue(FlowState *flowState, unsigned componentIndex) {
-	if (g_queueHead == g_queueTail && !g_queueIsFull) {
-		return false;
-	}
-    unsigned int it = g_queueHead;
-    while (true) {
-		if (g_queue[it].flowState == flowState && g_queue[it].componentIndex == componentIndex) {
-            return true;
-		}
-        it = (it + 1) % QUEUE_SIZE;
-        if (it == g_queueTail) {
-            break;
+    for (unsigned lane = 0; lane < EEZ_FLOW_LANE_COUNT; lane++) {
+        for (int16_t it = g_lanes[lane].head; it != -1; it = g_queue[it].next) {
+            if (g_queue[it].flowState == flowState && g_queue[it].componentIndex == componentIndex) {
+                return true;
+            }
         }
 	}
     return false;
 }
 void removeTasksFromQueueForFlowState(FlowState *flowState) {
-	if (g_queueHead == g_queueTail && !g_queueIsFull) {
-		return;
-	}
-    unsigned int it = g_queueHead;
-    while (true) {
-		if (g_queue[it].flowState == flowState) {
-            g_queue[it].flowState = 0;
-		}
-        it = (it + 1) % QUEUE_SIZE;
-        if (it == g_queueTail) {
-            break;
+    for (unsigned lane = 0; lane < EEZ_FLOW_LANE_COUNT; lane++) {
+        for (int16_t it = g_lanes[lane].head; it != -1; it = g_queue[it].next) {
+            if (g_queue[it].flowState == flowState) {
+                g_queue[it].flowState = 0;
+            }
         }
 	}
 }
@@ -11178,6 +11274,9 @@ struct WatchListNode {
     unsigned componentIndex;
     WatchListNode *prev;
     WatchListNode *next;
+    uint64_t depMask;  // 表达式读取的槽位（eez_watch.h）
+    bool dynamic;      // 依赖无法静态确定，每个 tick 求值
+    bool pending;      // 脏了但上次遍历时不能执行，保留到下次
 };
 struct WatchList {
     WatchListNode *first;
@@ -11198,6 +11297,9 @@ WatchListNode *watchListAdd(FlowState *flowState, unsigned componentIndex) {
     node->next = 0;
     node->flowState = flowState;
     node->componentIndex = componentIndex;
+    auto property = flowState->flow->components[componentIndex]->properties[defs_v3::WATCH_VARIABLE_ACTION_COMPONENT_PROPERTY_VARIABLE];
+    node->dynamic = !watchResolveDeps(flowState, property->evalInstructions, &node->depMask);
+    node->pending = false;
     incRefCounterForFlowState(flowState);
     (g_watchList.size)++;
     return node;
@@ -11217,10 +11319,20 @@ void watchListRemove(WatchListNode *node) {
     g_watchList.size > 0 ? (g_watchList.size)-- : 0;
 }
 void visitWatchList() {
+    uint32_t visited = 0;
+    uint32_t evaluated = 0;
+    watchVisitBegin();
     for (auto node = g_watchList.first; node; ) {
         auto nextNode = node->next;
-        if (canExecuteStep(node->flowState, node->componentIndex)) {
-            executeWatchVariableComponent(node->flowState, node->componentIndex);
+        visited++;
+        if (node->dynamic || node->pending || watchIsDirty(node->depMask)) {
+            if (canExecuteStep(node->flowState, node->componentIndex)) {
+                node->pending = false;
+                evaluated++;
+                executeWatchVariableComponent(node->flowState, node->componentIndex);
+            } else {
+                node->pending = true;
+            }
         }
         decRefCounterForFlowState(node->flowState);
         if (canFreeFlowState(node->flowState)) {
@@ -11231,6 +11343,7 @@ void visitWatchList() {
         }
         node = nextNode;
     }
+    watchVisitEnd(visited, evaluated);
 }
 void watchListReset() {
     for (auto node = g_watchList.first; node;) {
@@ -892,6 +892,7 @@ struct EnumValue {
 };
 #define VALUE_OPTIONS_REF (1 << 0)
 #define STRING_OPTIONS_FILE_ELLIPSIS (1 << 1)
+#define STRING_OPTIONS_INLINE (1 << 2) // VALUE_TYPE_STRING 的内容在 inlineStr 中（eez_string.h）
 #define FLOAT_OPTIONS_LESS_THEN (1 << 1)
 #define FLOAT_OPTIONS_FIXED_DECIMALS (1 << 2)
 #define FLOAT_OPTIONS_GET_NUM_FIXED_DECIMALS(options) (((options) >> 3) & 0b111)
@@ -1146,6 +1147,9 @@ struct Value {
 	bool isString() const {
         return type == VALUE_TYPE_STRING || type == VALUE_TYPE_STRING_ASSET || type == VALUE_TYPE_STRING_REF;
     }
+    bool isInlineString() const {
+        return type == VALUE_TYPE_STRING && (options & STRING_OPTIONS_INLINE);
+    }
     bool isArray() const {
         return type == VALUE_TYPE_ARRAY || type == VALUE_TYPE_ARRAY_ASSET || type == VALUE_TYPE_ARRAY_REF;
     }
@@ -1316,6 +1320,7 @@ struct Value {
 		PairOfUint8Value pairOfUint8Value;
 		PairOfUint16Value pairOfUint16Value;
 		PairOfInt16Value pairOfInt16Value;
+		char inlineStr[sizeof(uint64_t)];
 	};
 };
 struct StringRef : public Ref {
@@ -2723,6 +2728,7 @@ Value op_great_eq(const Value& a1, const Value& b1);
 // -----------------------------------------------------------------------------
 // flow/queue.h
 // -----------------------------------------------------------------------------
+#include "eez_flow_sched.h"
 namespace eez {
 namespace flow {
 void queueReset();
@@ -2732,8 +2738,9 @@ extern unsigned g_numNonContinuousTaskInQueue;
 bool addToQueue(FlowState *flowState, unsigned componentIndex,
     int sourceComponentIndex, int sourceOutputIndex, int targetInputIndex,
     bool continuousTask);
-bool peekNextTaskFromQueue(FlowState *&flowState, unsigned &componentIndex, bool &continuousTask);
-void removeNextTaskFromQueue();
+bool peekNextTaskFromQueue(eez_flow_lane_t lane, FlowState *&flowState, unsigned &componentIndex);
+void removeNextTaskFromQueue(eez_flow_lane_t lane);
+size_t getLaneSize(eez_flow_lane_t lane);
 bool isInQueue(FlowState *flowState, unsigned componentIndex);
 void removeTasksFromQueueForFlowState(FlowState *flowState);
 } 
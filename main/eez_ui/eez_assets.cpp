@@ -0,0 +1,214 @@
+/**
+ * @file eez_assets.cpp
+ * @brief EEZ 资源（assets）加载，说明见 eez_assets.h
+ */
+
+#include "eez_assets.h"
+#include "eez-flow.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stddef.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_partition.h"
+#endif
+
+using namespace eez;
+
+static const char *TAG = "EEZ_ASSETS";
+
+static const uint8_t *s_data = nullptr;
+static size_t s_size = 0;
+static eez_assets_info_t s_info;
+
+#ifdef ESP_PLATFORM
+static esp_partition_mmap_handle_t s_mmap_handle;
+#endif
+
+// ============== 校验 ==============
+
+#if EEZ_FOR_LVGL_LZ4_OPTION
+/** 解压缓冲区在 Assets 中的起始偏移（与 eez-flow.cpp 的 decompressAssetsData 相同） */
+static size_t decompressedDataOffset() {
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+#endif
+  return offsetof(Assets, settings);
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+}
+#endif
+
+uint32_t eez_assets_build_id(const uint8_t *data, size_t size) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < size; i++) {
+    h = (h ^ data[i]) * 16777619u;
+  }
+  return h;
+}
+
+bool eez_assets_check(const uint8_t *data, size_t size, eez_assets_info_t *info) {
+  memset(info, 0, sizeof(*info));
+  if (!data || size < sizeof(Header)) {
+    return false;
+  }
+  info->size = size;
+
+  Header header;
+  memcpy(&header, data, sizeof(header));
+
+  if (header.tag == HEADER_TAG_COMPRESSED) {
+    info->compressed = true;
+    info->major_version = header.projectMajorVersion;
+#if EEZ_FOR_LVGL_LZ4_OPTION
+    info->ram_bytes = decompressedDataOffset() + header.decompressedSize;
+    return header.projectMajorVersion == PROJECT_VERSION_V3;
+#else
+    return false;
+#endif
+  }
+
+  if (header.tag != HEADER_TAG || size < sizeof(uint32_t) + sizeof(Assets)) {
+    return false;
+  }
+  // 非压缩格式：tag 之后紧接 Assets，g_mainAssets 直接指向这里
+  info->major_version = data[sizeof(uint32_t)];
+  if (info->major_version != PROJECT_VERSION_V3) {
+    return false;
+  }
+  info->in_place = ((uintptr_t)data & 3) == 0;
+  info->ram_bytes = info->in_place ? 0 : size;
+  if (info->in_place) {
+    auto assets = (const Assets *)(data + sizeof(uint32_t));
+    auto flowDefinition = (const uint8_t *)(const FlowDefinition *)assets->flowDefinition;
+    if (!flowDefinition || flowDefinition < data || flowDefinition >= data + size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ============== 选择 ==============
+
+#ifdef ESP_PLATFORM
+static bool use_partition(uint32_t build_id, eez_assets_info_t *info) {
+  const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                         EEZ_ASSETS_PARTITION_LABEL);
+  if (!part) {
+    return false;
+  }
+
+  const void *ptr = nullptr;
+  esp_err_t ret = esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &ptr, &s_mmap_handle);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "资源分区映射失败: %s", esp_err_to_name(ret));
+    return false;
+  }
+
+  eez_assets_part_header_t header = {};
+  if (part->size >= sizeof(header)) {
+    memcpy(&header, ptr, sizeof(header));
+  }
+  const uint8_t *data = (const uint8_t *)ptr + sizeof(header);
+  if (part->size < sizeof(header) || header.magic != EEZ_ASSETS_PART_MAGIC ||
+      header.size > part->size - sizeof(header)) {
+    esp_partition_munmap(s_mmap_handle);
+    ESP_LOGW(TAG, "%s 分区未烧录资源镜像，使用内置资源", EEZ_ASSETS_PARTITION_LABEL);
+    return false;
+  }
+  // 对象和页面下标编译在 screens.c 里，只接受针对本固件内置资源生成的镜像
+  if (header.build_id != build_id) {
+    esp_partition_munmap(s_mmap_handle);
+    ESP_LOGW(TAG, "%s 分区针对其他固件（build_id 0x%08x，本固件 0x%08x），使用内置资源",
+             EEZ_ASSETS_PARTITION_LABEL, (unsigned)header.build_id, (unsigned)build_id);
+    return false;
+  }
+  // 分区只支持原地使用的非压缩格式（压缩格式需要解压缓冲区）
+  if (!eez_assets_check(data, header.size, info) || !info->in_place) {
+    esp_partition_munmap(s_mmap_handle);
+    ESP_LOGW(TAG, "%s 分区内容无效（不是非压缩的 EEZ 资源），使用内置资源", EEZ_ASSETS_PARTITION_LABEL);
+    return false;
+  }
+
+  s_data = data;
+  s_size = header.size;
+  info->source = EEZ_ASSETS_SRC_PARTITION;
+  return true;
+}
+#endif
+
+static bool use_embedded(const uint8_t *embedded, size_t embedded_size, eez_assets_info_t *info) {
+  if (!eez_assets_check(embedded, embedded_size, info)) {
+    uint32_t tag = 0;
+    if (embedded && embedded_size >= sizeof(tag)) {
+      memcpy(&tag, embedded, sizeof(tag));
+    }
+    ESP_LOGE(TAG, "内置资源无效（tag 0x%08x，%u 字节）", (unsigned)tag, (unsigned)embedded_size);
+    return false;
+  }
+
+  s_data = embedded;
+  s_size = embedded_size;
+  info->source = EEZ_ASSETS_SRC_EMBEDDED;
+
+  if (!info->compressed && !info->in_place) {
+    // 偏移按 4 字节读取，未对齐的数组拷贝到对齐的缓冲区
+    uint8_t *copy = (uint8_t *)heap_caps_malloc(embedded_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!copy) {
+      ESP_LOGE(TAG, "内置资源未对齐且拷贝失败（%u 字节）", (unsigned)embedded_size);
+      s_data = nullptr;
+      s_size = 0;
+      return false;
+    }
+    memcpy(copy, embedded, embedded_size);
+    s_data = copy;
+    ESP_LOGW(TAG, "内置资源地址 %p 未按 4 字节对齐，已拷贝到 RAM（%u 字节）", embedded, (unsigned)embedded_size);
+  }
+  return true;
+}
+
+bool eez_assets_init(const uint8_t *embedded, size_t embedded_size) {
+  int64_t t0 = esp_timer_get_time();
+  eez_assets_info_t info;
+
+  bool ok = false;
+#ifdef ESP_PLATFORM
+  ok = use_partition(embedded ? eez_assets_build_id(embedded, embedded_size) : 0, &info);
+#endif
+  if (!ok) {
+    ok = use_embedded(embedded, embedded_size, &info);
+  }
+  if (!ok) {
+    // 交给 eez_flow_init 原样处理（与未使用本模块时相同）
+    memset(&info, 0, sizeof(info));
+    s_data = embedded;
+    s_size = embedded_size;
+  }
+
+  info.load_us = (uint32_t)(esp_timer_get_time() - t0);
+  s_info = info;
+
+  if (ok) {
+    ESP_LOGI(TAG, "资源: %s，%u 字节，%s，占用 RAM %u 字节，耗时 %u us",
+             info.source == EEZ_ASSETS_SRC_PARTITION ? "分区" : "内置", (unsigned)info.size,
+             info.compressed ? "LZ4 压缩（启动时解压）" : (info.in_place ? "原地使用" : "拷贝后使用"),
+             (unsigned)info.ram_bytes, (unsigned)info.load_us);
+  }
+  return ok;
+}
+
+const uint8_t *eez_assets_data(void) {
+  return s_data;
+}
+
+size_t eez_assets_size(void) {
+  return s_size;
+}
+
+void eez_assets_get_info(eez_assets_info_t *info) {
+  *info = s_info;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * EEZ 资源（assets）加载
+ *
+ * EEZ Studio 导出的 assets 有两种格式（eez-flow.h 的 Header）：
+ * - 非压缩（HEADER_TAG）：内部指针全是相对自身的偏移（AssetsPtr），与加载地址无关，
+ *   loadMainAssets() 直接在原地使用，不解压、不修正偏移、不占 RAM
+ * - LZ4 压缩（HEADER_TAG_COMPRESSED）：需解压到 eez::alloc 的缓冲区，常驻 RAM，
+ *   只在 EEZ_FOR_LVGL_LZ4_OPTION 打开时可用（网络下发等场景）
+ *
+ * 启动时按以下顺序选择资源，选中的数据原样交给 eez_flow_init()：
+ * 1. eez_assets 数据分区（partitions.csv）：esp_partition_mmap 映射后原地使用，
+ *    更新界面资源不需要重新编译固件：
+ *
+ *      parttool.py write_partition --partition-name eez_assets --input eez_assets.bin
+ *
+ *    （eez_assets.bin 由 tools/eez_assets 从 ui.c 中提取）
+ * 2. ui.c 内置的 const assets[]（位于 flash 的 .rodata）
+ *
+ * 分区以 eez_assets_part_header_t 开头，build_id 是镜像所针对的固件内置资源的哈希。
+ * screens.c 中的对象、页面下标是按内置资源编译的，build_id 与本固件内置资源不一致
+ * （旧固件留下的分区）时不使用分区。
+ * 分区未烧录（全 0xFF）、build_id 不匹配或校验失败时回退到内置资源。
+ * 非压缩资源按 4 字节读取偏移，地址未对齐时拷贝一份到 PSRAM 再使用（会打印警告）。
+ */
+
+#define EEZ_ASSETS_PARTITION_LABEL "eez_assets"
+#define EEZ_ASSETS_PART_MAGIC 0x50415A45u // "EZAP"
+
+/** eez_assets 分区头，资源数据紧随其后（16 字节，保持 4 字节对齐） */
+typedef struct {
+    uint32_t magic;    // EEZ_ASSETS_PART_MAGIC
+    uint32_t build_id; // 所针对固件的内置资源哈希（eez_assets_build_id）
+    uint32_t size;     // 资源数据长度（字节）
+    uint32_t reserved;
+} eez_assets_part_header_t;
+
+typedef enum {
+    EEZ_ASSETS_SRC_NONE = 0,
+    EEZ_ASSETS_SRC_EMBEDDED, // ui.c 内置
+    EEZ_ASSETS_SRC_PARTITION, // eez_assets 分区
+} eez_assets_src_t;
+
+typedef struct {
+    eez_assets_src_t source;
+    bool compressed;       // LZ4 压缩格式
+    bool in_place;         // 原地使用（不解压、不拷贝）
+    uint8_t major_version; // 工程版本
+    size_t size;           // 资源数据长度（字节）
+    size_t ram_bytes;      // 为资源占用的 RAM：原地使用为 0，压缩格式为解压缓冲区，未对齐时为拷贝
+    uint32_t load_us;      // 选择、映射、校验资源的耗时（不含 eez_flow_init）
+} eez_assets_info_t;
+
+/**
+ * 校验一块资源数据（不改变当前选择，主机端工具也使用）
+ * @param data 资源数据
+ * @param size 数据长度（字节）
+ * @param info 输出格式与 RAM 占用（source、load_us 不填）
+ * @return true 可以交给 eez_flow_init()
+ */
+bool eez_assets_check(const uint8_t *data, size_t size, eez_assets_info_t *info);
+
+/**
+ * 资源数据的哈希（FNV-1a 32 位），作为分区头的 build_id
+ */
+uint32_t eez_assets_build_id(const uint8_t *data, size_t size);
+
+/**
+ * 选择资源：优先 eez_assets 分区，否则使用内置资源
+ * 在 eez_flow_init() 之前调用
+ * @param embedded ui.c 内置的 assets
+ * @param embedded_size 内置资源长度（字节）
+ * @return true 选中了有效资源
+ */
+bool eez_assets_init(const uint8_t *embedded, size_t embedded_size);
+
+/** 选中的资源数据（传给 eez_flow_init） */
+const uint8_t *eez_assets_data(void);
+
+/** 选中的资源长度（字节） */
+size_t eez_assets_size(void);
+
+void eez_assets_get_info(eez_assets_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
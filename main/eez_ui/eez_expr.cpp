@@ -0,0 +1,483 @@
+/**
+ * @file eez_expr.cpp
+ * @brief EEZ flow 表达式预编译，说明见 eez_expr.h
+ */
+
+#include "eez_expr.h"
+#include "esp_log.h"
+#include <new>
+#include <stddef.h>
+#include <string.h>
+
+namespace eez {
+namespace flow {
+
+extern EvalStack g_stack;
+using namespace defs_v3;
+
+static const char *TAG = "EEZ_EXPR";
+
+// 单个表达式的上限，超出时不编译（回退解释器）
+#define EXPR_MAX_OPS 128
+#define EXPR_MAX_OWNED 32
+
+#define EXPR_ALLOC_ID_PROGRAM 0x3f9d2b61
+#define EXPR_ALLOC_ID_TABLE 0x3f9d2b62
+
+// ============== 编译结果 ==============
+
+enum ExprOpCode : uint8_t {
+  EXPR_OP_PUSH_VALUE, // 压入 Value 副本（常量、折叠结果、全局变量初值）
+  EXPR_OP_PUSH_INPUT, // 压入组件输入 flowState->values[arg]
+  EXPR_OP_PUSH_LOCAL, // 压入局部变量指针 &flowState->values[arg]（arg 已含输入数）
+  EXPR_OP_PUSH_PTR,   // 压入全局变量指针
+  EXPR_OP_OPERATION,  // 调用运算函数
+  EXPR_OP_END,
+  EXPR_OP_END_DST, // 结束并设置目标值类型（program->dstValueType）
+};
+
+// 编译期标记
+#define EXPR_FLAG_CONST (1 << 0) // 可参与常量折叠
+#define EXPR_FLAG_OWNED (1 << 1) // value 指向程序自带的 Value（编译中 arg 为下标）
+
+struct ExprOp {
+  uint8_t code;
+  uint8_t flags;
+  uint16_t arg;
+  union {
+    const Value *value;
+    Value *ptr;
+    EvalOperation fn;
+  };
+};
+
+struct ExprProgram {
+  const uint8_t *instructions; // 原指令流（查找键）
+  uint32_t dstValueType;
+  uint16_t numInstructionBytes;
+  uint8_t numOps;
+  uint8_t numOwned;
+  ExprOp ops[1];
+  // 其后按 8 字节对齐存放 numOwned 个 Value（折叠结果、输出 / 原生变量引用）
+};
+
+static ExprProgram **s_table = nullptr; // 按指令流地址的开放寻址表
+static uint32_t s_mask = 0;
+static bool s_enabled = true;
+static ExprStats s_stats;
+
+// 编译用的临时缓冲（只在 LVGL 任务中编译）
+static ExprOp s_ops[EXPR_MAX_OPS];
+static Value s_owned[EXPR_MAX_OWNED];
+
+static inline uint32_t hashPtr(const void *p) {
+  return ((uint32_t)(uintptr_t)p >> 1) * 2654435761u;
+}
+
+static inline size_t ownedOffset(int numOps) {
+  size_t size = offsetof(ExprProgram, ops) + numOps * sizeof(ExprOp);
+  return (size + 7) & ~(size_t)7;
+}
+
+static inline Value *ownedValues(const ExprProgram *program) {
+  return (Value *)((uint8_t *)program + ownedOffset(program->numOps));
+}
+
+// ============== 常量折叠 ==============
+
+/** 可在编译时求值的纯运算，返回操作数个数，0 表示不折叠 */
+static int foldArity(uint16_t operation) {
+  if (operation <= OPERATION_TYPE_LOGICAL_OR) {
+    return 2;
+  }
+  if (operation <= OPERATION_TYPE_NOT) {
+    return 1;
+  }
+  if (operation == OPERATION_TYPE_CONDITIONAL) {
+    return 3;
+  }
+  if (operation >= OPERATION_TYPE_MATH_SIN && operation <= OPERATION_TYPE_MATH_ROUND) {
+    return 1;
+  }
+  if (operation == OPERATION_TYPE_MATH_POW) {
+    return 2;
+  }
+  if (operation == OPERATION_TYPE_STRING_LENGTH) {
+    return 1;
+  }
+  return 0;
+}
+
+static const Value *opValue(const ExprOp &op) {
+  return (op.flags & EXPR_FLAG_OWNED) ? &s_owned[op.arg] : op.value;
+}
+
+/**
+ * 最后 arity 个操作都是常量压栈时，在求值栈上执行运算，用结果替换这些操作
+ * 结果为错误或引用类型时不折叠，保留到运行时（错误信息与解释器一致）
+ */
+static bool tryFold(int &numOps, int &numOwned, int arity, EvalOperation fn) {
+  if (numOps < arity) {
+    return false;
+  }
+  for (int k = numOps - arity; k < numOps; k++) {
+    if (!(s_ops[k].flags & EXPR_FLAG_CONST)) {
+      return false;
+    }
+  }
+
+  size_t savedSp = g_stack.sp;
+  const char *savedErrorMessage = g_stack.errorMessage;
+  for (int k = numOps - arity; k < numOps; k++) {
+    g_stack.push(*opValue(s_ops[k]));
+  }
+  fn(g_stack);
+  Value result;
+  bool ok = g_stack.sp == savedSp + 1;
+  if (ok) {
+    result = g_stack.pop();
+  }
+  g_stack.sp = savedSp;
+  g_stack.errorMessage = savedErrorMessage;
+  if (!ok || result.isError() || result.isIndirectValueType()) {
+    return false;
+  }
+
+  // 被替换的操作数如果用了自带 Value，一定是最后分配的几个，回收
+  numOps -= arity;
+  for (int k = numOps; k < numOps + arity; k++) {
+    if ((s_ops[k].flags & EXPR_FLAG_OWNED) && s_ops[k].arg < numOwned) {
+      numOwned = s_ops[k].arg;
+    }
+  }
+  for (int k = numOwned; k < EXPR_MAX_OWNED; k++) {
+    s_owned[k] = Value();
+  }
+  s_owned[numOwned] = result;
+  s_ops[numOps++] = {EXPR_OP_PUSH_VALUE, EXPR_FLAG_CONST | EXPR_FLAG_OWNED, (uint16_t)numOwned++, {nullptr}};
+  s_stats.folded++;
+  return true;
+}
+
+// ============== 编译 ==============
+
+static void resetOwned(int numOwned) {
+  for (int k = 0; k < numOwned; k++) {
+    s_owned[k] = Value();
+  }
+}
+
+static ExprProgram *compile(FlowDefinition *flowDefinition, Flow *flow, const uint8_t *instructions) {
+  int numOps = 0;
+  int numOwned = 0;
+  uint32_t dstValueType = 0;
+  uint32_t numInstructions = 0;
+  int i = 0;
+  bool done = false;
+
+  while (!done) {
+    if (numOps >= EXPR_MAX_OPS || numOwned >= EXPR_MAX_OWNED) {
+      resetOwned(numOwned);
+      return nullptr;
+    }
+    uint16_t instruction = instructions[i] + (instructions[i + 1] << 8);
+    uint16_t instructionType = instruction & EXPR_EVAL_INSTRUCTION_TYPE_MASK;
+    uint16_t instructionArg = instruction & EXPR_EVAL_INSTRUCTION_PARAM_MASK;
+    ExprOp &op = s_ops[numOps];
+    op = {EXPR_OP_PUSH_VALUE, 0, 0, {nullptr}};
+    numInstructions++;
+
+    if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT) {
+      if (instructionArg >= flowDefinition->constants.count) {
+        resetOwned(numOwned);
+        return nullptr;
+      }
+      op.flags = EXPR_FLAG_CONST;
+      op.value = flowDefinition->constants[instructionArg];
+      numOps++;
+    } else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_INPUT) {
+      op.code = EXPR_OP_PUSH_INPUT;
+      op.arg = instructionArg;
+      numOps++;
+    } else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_LOCAL_VAR) {
+      uint32_t index = flow->componentInputs.count + instructionArg;
+      if (index > 0xFFFF) {
+        resetOwned(numOwned);
+        return nullptr;
+      }
+      op.code = EXPR_OP_PUSH_LOCAL;
+      op.arg = (uint16_t)index;
+      numOps++;
+    } else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_GLOBAL_VAR) {
+      if ((uint32_t)instructionArg < flowDefinition->globalVariables.count) {
+        // 与解释器相同压入指针：赋值和之后的读取都作用于同一份全局变量
+        op.code = EXPR_OP_PUSH_PTR;
+        if (g_globalVariables) {
+          op.ptr = g_globalVariables->values + instructionArg;
+        } else {
+          op.ptr = flowDefinition->globalVariables[instructionArg];
+        }
+      } else {
+        // 原生变量：运行时经 getValue() 读取，不能折叠
+        op.flags = EXPR_FLAG_OWNED;
+        op.arg = (uint16_t)numOwned;
+        s_owned[numOwned++] =
+            Value((int)(instructionArg - flowDefinition->globalVariables.count + 1), VALUE_TYPE_NATIVE_VARIABLE);
+      }
+      numOps++;
+    } else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_OUTPUT) {
+      op.flags = EXPR_FLAG_OWNED;
+      op.arg = (uint16_t)numOwned;
+      s_owned[numOwned++] = Value((uint16_t)instructionArg, VALUE_TYPE_FLOW_OUTPUT);
+      numOps++;
+    } else if (instructionType == EXPR_EVAL_INSTRUCTION_ARRAY_ELEMENT) {
+      op.code = EXPR_OP_OPERATION;
+      op.fn = evalArrayElement;
+      numOps++;
+    } else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_OPERATION) {
+      EvalOperation fn = g_evalOperations[instructionArg];
+      int arity = foldArity(instructionArg);
+      if (!arity || !tryFold(numOps, numOwned, arity, fn)) {
+        op = {EXPR_OP_OPERATION, 0, instructionArg, {nullptr}};
+        op.fn = fn;
+        numOps++;
+      }
+    } else {
+      if (instruction == EXPR_EVAL_INSTRUCTION_TYPE_END_WITH_DST_VALUE_TYPE) {
+        i += 2;
+        dstValueType = instructions[i] + (instructions[i + 1] << 8) + (instructions[i + 2] << 16) +
+                       (instructions[i + 3] << 24);
+        i += 4;
+        op.code = EXPR_OP_END_DST;
+      } else {
+        i += 2;
+        op.code = EXPR_OP_END;
+      }
+      numOps++;
+      done = true;
+      continue;
+    }
+    i += 2;
+  }
+
+  size_t size = ownedOffset(numOps) + numOwned * sizeof(Value);
+  auto program = (ExprProgram *)alloc(size, EXPR_ALLOC_ID_PROGRAM);
+  if (!program) {
+    resetOwned(numOwned);
+    return nullptr;
+  }
+  program->instructions = instructions;
+  program->dstValueType = dstValueType;
+  program->numInstructionBytes = (uint16_t)i;
+  program->numOps = (uint8_t)numOps;
+  program->numOwned = (uint8_t)numOwned;
+  Value *owned = ownedValues(program);
+  for (int k = 0; k < numOwned; k++) {
+    new (owned + k) Value(s_owned[k]);
+  }
+  for (int k = 0; k < numOps; k++) {
+    program->ops[k] = s_ops[k];
+    if (s_ops[k].flags & EXPR_FLAG_OWNED) {
+      program->ops[k].value = owned + s_ops[k].arg;
+    }
+  }
+  resetOwned(numOwned);
+
+  s_stats.instructions += numInstructions;
+  s_stats.ops += numOps;
+  s_stats.bytes += size;
+  return program;
+}
+
+static void insert(ExprProgram *program) {
+  uint32_t h = hashPtr(program->instructions) & s_mask;
+  while (s_table[h]) {
+    h = (h + 1) & s_mask;
+  }
+  s_table[h] = program;
+}
+
+/** 保证查找表装载率不超过 1/2，不够时按 2 倍扩容并重新插入 */
+static bool reserve(uint32_t count) {
+  uint32_t capacity = s_table ? s_mask + 1 : 0;
+  if (count * 2 <= capacity) {
+    return true;
+  }
+  uint32_t newCapacity = 8;
+  while (newCapacity < count * 2) {
+    newCapacity <<= 1;
+  }
+  auto table = (ExprProgram **)alloc(newCapacity * sizeof(ExprProgram *), EXPR_ALLOC_ID_TABLE);
+  if (!table) {
+    return false;
+  }
+  memset(table, 0, newCapacity * sizeof(ExprProgram *));
+  ExprProgram **oldTable = s_table;
+  s_table = table;
+  s_mask = newCapacity - 1;
+  for (uint32_t h = 0; h < capacity; h++) {
+    if (oldTable[h]) {
+      insert(oldTable[h]);
+    }
+  }
+  free(oldTable);
+  s_stats.bytes += (newCapacity - capacity) * sizeof(ExprProgram *);
+  return true;
+}
+
+static ExprProgram *lookup(const uint8_t *instructions) {
+  if (!s_table) {
+    return nullptr;
+  }
+  uint32_t h = hashPtr(instructions) & s_mask;
+  for (ExprProgram *program; (program = s_table[h]) != nullptr; h = (h + 1) & s_mask) {
+    if (program->instructions == instructions) {
+      return program;
+    }
+  }
+  return nullptr;
+}
+
+static bool compileAndInsert(FlowDefinition *flowDefinition, Flow *flow, const uint8_t *instructions) {
+  if (lookup(instructions)) {
+    return true;
+  }
+  // 空表达式（未设置的属性）和单个操作数解释器已经是最短路径，不编译
+  if (exprIsTrivial(instructions)) {
+    s_stats.trivial++;
+    return false;
+  }
+  if (!reserve(s_stats.programs + 1)) {
+    s_stats.skipped++;
+    return false;
+  }
+  ExprProgram *program = compile(flowDefinition, flow, instructions);
+  if (!program) {
+    s_stats.skipped++;
+    return false;
+  }
+  insert(program);
+  s_stats.programs++;
+  return true;
+}
+
+static void freeProgram(ExprProgram *program) {
+  Value *owned = ownedValues(program);
+  for (int k = 0; k < program->numOwned; k++) {
+    owned[k].~Value();
+  }
+  free(program);
+}
+
+void exprFreeAll() {
+  if (s_table) {
+    for (uint32_t h = 0; h <= s_mask; h++) {
+      if (s_table[h]) {
+        freeProgram(s_table[h]);
+      }
+    }
+    free(s_table);
+  }
+  s_table = nullptr;
+  s_mask = 0;
+  memset(&s_stats, 0, sizeof(s_stats));
+}
+
+void exprCompileAll(Assets *assets) {
+  exprFreeAll();
+
+  auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+  if (!flowDefinition) {
+    return;
+  }
+
+  for (uint32_t f = 0; f < flowDefinition->flows.count; f++) {
+    auto flow = flowDefinition->flows[f];
+    for (uint32_t c = 0; c < flow->components.count; c++) {
+      auto component = flow->components[c];
+      for (uint32_t p = 0; p < component->properties.count; p++) {
+        auto property = component->properties[p];
+        if (property) {
+          compileAndInsert(flowDefinition, flow, property->evalInstructions);
+        }
+      }
+    }
+  }
+
+  ESP_LOGI(TAG, "表达式预编译: %u 个（空或单操作数 %u，跳过 %u），指令 %u -> 操作 %u，折叠 %u 个运算，占用 %u 字节",
+           (unsigned)s_stats.programs, (unsigned)s_stats.trivial, (unsigned)s_stats.skipped,
+           (unsigned)s_stats.instructions, (unsigned)s_stats.ops, (unsigned)s_stats.folded,
+           (unsigned)s_stats.bytes);
+}
+
+bool exprCompile(Assets *assets, int flowIndex, const uint8_t *instructions) {
+  auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+  if (!flowDefinition || flowIndex < 0 || flowIndex >= (int)flowDefinition->flows.count) {
+    return false;
+  }
+  return compileAndInsert(flowDefinition, flowDefinition->flows[flowIndex], instructions);
+}
+
+// ============== 执行 ==============
+
+const ExprProgram *exprFind(const uint8_t *instructions) {
+  ExprProgram *program = s_enabled ? lookup(instructions) : nullptr;
+  if (program) {
+    s_stats.hits++;
+  } else {
+    s_stats.fallbacks++;
+  }
+  return program;
+}
+
+void exprRun(FlowState *flowState, const ExprProgram *program, int *numInstructionBytes) {
+  for (const ExprOp *op = program->ops;; op++) {
+    switch (op->code) {
+    case EXPR_OP_PUSH_VALUE:
+      g_stack.push(*op->value);
+      continue;
+    case EXPR_OP_PUSH_INPUT:
+      g_stack.push(flowState->values[op->arg]);
+      continue;
+    case EXPR_OP_PUSH_LOCAL:
+      g_stack.push(&flowState->values[op->arg]);
+      continue;
+    case EXPR_OP_PUSH_PTR:
+      g_stack.push(op->ptr);
+      continue;
+    case EXPR_OP_OPERATION:
+      op->fn(g_stack);
+      continue;
+    case EXPR_OP_END_DST:
+      // 与解释器的 END_WITH_DST_VALUE_TYPE 相同
+      if (g_stack.sp == 1) {
+        auto finalResult = g_stack.pop();
+        if (finalResult.getType() == VALUE_TYPE_VALUE_PTR) {
+          finalResult.dstValueType = program->dstValueType;
+        } else if (finalResult.getType() == VALUE_TYPE_ARRAY_ELEMENT_VALUE) {
+          auto arrayElementValue = (ArrayElementValue *)finalResult.refValue;
+          arrayElementValue->dstValueType = program->dstValueType;
+        }
+        g_stack.push(finalResult);
+      }
+      break;
+    default:
+      break;
+    }
+    break;
+  }
+  if (numInstructionBytes) {
+    *numInstructionBytes = program->numInstructionBytes;
+  }
+}
+
+void exprSetEnabled(bool enabled) {
+  s_enabled = enabled;
+}
+
+void exprGetStats(ExprStats *stats) {
+  *stats = s_stats;
+}
+
+} // namespace flow
+} // namespace eez
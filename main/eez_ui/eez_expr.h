@@ -0,0 +1,100 @@
+/**
+ * @file eez_expr.h
+ * @brief EEZ flow 表达式预编译
+ *
+ * eez-flow 的表达式是 16 位指令流（eez-flow.h 的 EXPR_EVAL_INSTRUCTION_*），
+ * 解释器每次求值都要重新解码指令、经 AssetsPtr 偏移查常量表和运算表。
+ * flow 启动时（eez::flow::start）把所有组件属性的指令流编译成预解码的操作数组：
+ * - 常量、全局变量直接存 Value 指针，运算直接存函数指针
+ * - 局部变量下标预先加上组件输入数
+ * - 操作数全为常量的纯运算（算术、比较、逻辑、条件、数学函数）在编译时求值
+ *
+ * 求值入口不变（evalExpression），按指令流地址查到编译结果时执行编译结果，
+ * 否则（组件私有的指令流、超长表达式）回退到原解释器，两者结果一致。
+ * 空表达式和单个操作数的表达式（exprIsTrivial）不编译，求值时也不查表，直接解释执行。
+ *
+ * 只在 LVGL 任务中使用，不加锁。
+ */
+
+#pragma once
+
+#include "eez-flow.h"
+
+namespace eez {
+namespace flow {
+
+struct ExprProgram;
+
+/** 预编译统计 */
+struct ExprStats {
+  uint32_t programs;     // 编译成功的表达式数
+  uint32_t trivial;      // 空表达式或单个操作数（不编译）
+  uint32_t skipped;      // 无法编译（回退解释器）的表达式数
+  uint32_t ops;          // 编译后的操作总数
+  uint32_t instructions; // 编译前的指令总数
+  uint32_t folded;       // 编译时求值掉的运算数
+  uint32_t bytes;        // 编译结果占用的字节数（含查找表）
+  uint32_t hits;         // 执行编译结果的次数
+  uint32_t fallbacks;    // 回退解释器的次数
+};
+
+/**
+ * 是否为只有 END 或只有一个操作数加 END 的表达式
+ *
+ * 解释器只需解码一两条指令，比按地址查表还快，这类表达式绕过编译结果
+ */
+inline bool exprIsTrivial(const uint8_t *instructions) {
+  uint16_t first = instructions[0] + (instructions[1] << 8);
+  uint16_t firstType = first & EXPR_EVAL_INSTRUCTION_TYPE_MASK;
+  if (firstType == EXPR_EVAL_INSTRUCTION_TYPE_END) {
+    return true;
+  }
+  if (firstType > EXPR_EVAL_INSTRUCTION_TYPE_PUSH_OUTPUT) {
+    return false;
+  }
+  uint16_t second = instructions[2] + (instructions[3] << 8);
+  return (second & EXPR_EVAL_INSTRUCTION_TYPE_MASK) == EXPR_EVAL_INSTRUCTION_TYPE_END;
+}
+
+/**
+ * 编译 assets 中所有 flow 的组件属性表达式（替换上一次的编译结果）
+ * 需在 initGlobalVariables 之后调用，全局变量指针在编译时解析
+ */
+void exprCompileAll(Assets *assets);
+
+/**
+ * 编译单个指令流并加入查找表（组件私有的表达式、主机基准用）
+ * @param flowIndex 指令流所属的 flow（决定局部变量下标）
+ * @return 已编译或编译成功返回 true
+ */
+bool exprCompile(Assets *assets, int flowIndex, const uint8_t *instructions);
+
+/**
+ * 释放所有编译结果
+ */
+void exprFreeAll();
+
+/**
+ * 按指令流地址查找编译结果
+ * @return 未编译或已禁用时返回 nullptr
+ */
+const ExprProgram *exprFind(const uint8_t *instructions);
+
+/**
+ * 执行编译结果，压栈结果与解释器相同
+ * @param numInstructionBytes 输出原指令流字节数，可以为 nullptr
+ */
+void exprRun(FlowState *flowState, const ExprProgram *program, int *numInstructionBytes);
+
+/**
+ * 启用 / 禁用编译结果（禁用后全部走解释器，用于对比）
+ */
+void exprSetEnabled(bool enabled);
+
+void exprGetStats(ExprStats *stats);
+
+/** 数组元素取值（EXPR_EVAL_INSTRUCTION_ARRAY_ELEMENT），解释器与编译结果共用 */
+void evalArrayElement(EvalStack &stack);
+
+} // namespace flow
+} // namespace eez
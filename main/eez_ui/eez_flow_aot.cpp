@@ -0,0 +1,95 @@
+/**
+ * @file eez_flow_aot.cpp
+ * @brief EEZ flow 预先编译结果的运行时，说明见 eez_flow_aot.h
+ */
+
+#include "eez_flow_aot.h"
+#include "eez-flow.h"
+#include "esp_log.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+using namespace eez;
+using namespace eez::flow;
+
+static const char *TAG = "EEZ_AOT";
+
+// 主机端工具没有 sdkconfig，按固件默认配置启用
+#if !defined(ESP_PLATFORM) || defined(CONFIG_UI_EEZ_FLOW_AOT)
+static const bool kConfigEnabled = true;
+#else
+static const bool kConfigEnabled = false;
+#endif
+
+static bool s_enabled = false;
+static bool s_matched = false;
+static eez_flow_aot_stats_t s_stats;
+
+uint32_t eez_flow_aot_hash(const uint8_t *data, size_t size) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < size; i++) {
+    h = (h ^ data[i]) * 16777619u;
+  }
+  return h;
+}
+
+bool eez_flow_aot_init(const uint8_t *assets, size_t size) {
+  // 内置数组和分区（分区头记录的资源长度，见 eez_assets.h）给出的都是资源本身的长度
+  s_matched = assets && size == eez_flow_aot_assets_size &&
+              eez_flow_aot_hash(assets, eez_flow_aot_assets_size) == eez_flow_aot_assets_hash;
+  s_enabled = kConfigEnabled && s_matched;
+
+  if (!s_matched) {
+    ESP_LOGW(TAG, "资源与 eez_flow_aot_gen.c 不一致（需重新运行 tools/eez_aot），全部使用解释器");
+  } else {
+    ESP_LOGI(TAG, "预编译连线 %u 条，%s", (unsigned)eez_flow_aot_num_entries, s_enabled ? "已启用" : "配置关闭，使用解释器");
+  }
+  return s_enabled;
+}
+
+void eez_flow_aot_set_enabled(bool enabled) {
+  s_enabled = enabled && s_matched;
+}
+
+bool eez_flow_aot_dispatch(void *flow_state, unsigned component_index, unsigned output_index) {
+  if (!s_enabled || !flow_state) {
+    return false;
+  }
+  auto flowState = (FlowState *)flow_state;
+  // 生成函数按页面 flow 的对象下标（lvglWidgetStartIndex 为 0）翻译，用户控件内的 flow 交给解释器
+  if (flowState->parentFlowState || flowState->lvglWidgetStartIndex != 0 || isFlowStopped() ||
+      g_debuggerIsConnected) {
+    s_stats.misses++;
+    return false;
+  }
+
+  if (eez_flow_aot_run(flowState->flowIndex, component_index, output_index)) {
+    s_stats.hits++;
+    return true;
+  }
+
+  // 区分没有这条连线与目标对象未创建
+  uint32_t key = EEZ_FLOW_AOT_KEY(flowState->flowIndex, component_index, output_index);
+  for (size_t i = 0; i < eez_flow_aot_num_entries; i++) {
+    const eez_flow_aot_entry_t *entry = &eez_flow_aot_entries[i];
+    if (EEZ_FLOW_AOT_KEY(entry->flow_index, entry->component_index, entry->output_index) == key) {
+      s_stats.fallbacks++;
+      return false;
+    }
+  }
+  s_stats.misses++;
+  return false;
+}
+
+lv_obj_t *eez_flow_aot_object(int32_t index) {
+  return getLvglObjectFromIndexHook(index);
+}
+
+void eez_flow_aot_get_stats(eez_flow_aot_stats_t *stats) {
+  *stats = s_stats;
+  stats->enabled = s_enabled;
+  stats->matched = s_matched;
+  stats->entries = (uint32_t)eez_flow_aot_num_entries;
+}
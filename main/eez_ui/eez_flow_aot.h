@@ -0,0 +1,100 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lvgl.h"
+
+/**
+ * EEZ flow 预先编译（AOT）
+ *
+ * 解释器处理一次控件事件要经过：构造 LVGL 事件 Value → propagateValue 写组件输入 →
+ * 压入 g_queue → 下一个 eez_flow_tick 出队 → executeComponent 查函数表 →
+ * executeLVGLApiComponent 逐个动作对每个属性求值表达式再调用 LVGL。
+ *
+ * tools/eez_aot 在构建前读取 ui.c 的 assets，把“控件事件输出 → LVGL API 动作组件”这类
+ * 固定的连线翻译成 C 函数（eez_flow_aot_gen.c），属性都是常量，在生成时求值；
+ * flowPropagateValueLVGLEvent 先查这张表，命中时在事件回调里直接调用，不经过队列和解释器。
+ * 与解释器的区别只在时机（事件回调中立即执行，而不是下一个 tick）和不写动作组件的输入值。
+ *
+ * 只翻译行为能完全确定的连线，其余（非常量属性、取值、动画、样式、组件输入不止一个等）
+ * 仍交给解释器，生成文件开头列出了每条未翻译连线的原因。
+ *
+ * 生成文件记录了 assets 的长度和 FNV-1a 散列，eez_flow_aot_init() 与实际加载的资源
+ * （含 eez_assets 分区）不一致时整体停用，全部走解释器。
+ *
+ * 开发时可在 menuconfig 关闭 UI_EEZ_FLOW_AOT，完全使用字节码解释执行（EEZ Studio 调试器连接时也自动回退）。
+ *
+ * 只在 LVGL 任务中使用，不加锁。
+ */
+
+/** 生成函数：执行一条连线，返回 false 表示需要交给解释器（目标对象取不到，此时没有任何副作用） */
+typedef bool (*eez_flow_aot_func_t)(void);
+
+typedef struct {
+    int16_t flow_index;
+    uint16_t component_index;
+    uint16_t output_index;
+    eez_flow_aot_func_t func;
+} eez_flow_aot_entry_t;
+
+#define EEZ_FLOW_AOT_KEY(flow, component, output)                                                                      \
+    (((uint32_t)(flow) << 24) | ((uint32_t)(component) << 8) | (uint32_t)(output))
+
+typedef struct {
+    bool enabled;       // 当前是否使用预编译结果
+    bool matched;       // 生成时的 assets 与加载的资源一致
+    uint32_t entries;   // 预编译的连线数
+    uint32_t hits;      // 由预编译结果处理的事件数
+    uint32_t fallbacks; // 有预编译结果但交给解释器的事件数
+    uint32_t misses;    // 没有预编译结果的事件数
+} eez_flow_aot_stats_t;
+
+// ============== 生成文件（eez_flow_aot_gen.c）提供 ==============
+
+extern const uint32_t eez_flow_aot_assets_size;
+extern const uint32_t eez_flow_aot_assets_hash;
+extern const eez_flow_aot_entry_t eez_flow_aot_entries[];
+extern const size_t eez_flow_aot_num_entries;
+
+/**
+ * 按连线执行预编译函数
+ * @return true 已处理；false 没有这条连线或需要交给解释器
+ */
+bool eez_flow_aot_run(int flow_index, unsigned component_index, unsigned output_index);
+
+// ============== 运行时（eez_flow_aot.cpp） ==============
+
+/** assets 的 FNV-1a 散列（与 tools/eez_aot 相同） */
+uint32_t eez_flow_aot_hash(const uint8_t *data, size_t size);
+
+/**
+ * 核对资源与生成文件是否一致，一致且配置打开时启用，在 eez_flow_init() 之后调用
+ * @param assets 传给 eez_flow_init 的资源
+ * @param size 资源长度（字节）
+ * @return true 已启用
+ */
+bool eez_flow_aot_init(const uint8_t *assets, size_t size);
+
+/** 启用 / 停用（资源不一致时无法启用），用于对比 */
+void eez_flow_aot_set_enabled(bool enabled);
+
+/**
+ * 控件事件入口，由 flowPropagateValueLVGLEvent 调用
+ * @return true 已由预编译结果处理，调用者不再交给解释器
+ */
+bool eez_flow_aot_dispatch(void *flow_state, unsigned component_index, unsigned output_index);
+
+/** 生成函数取 LVGL 对象（objects 中的下标） */
+lv_obj_t *eez_flow_aot_object(int32_t index);
+
+void eez_flow_aot_get_stats(eez_flow_aot_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,99 @@
+/**
+ * @file eez_flow_aot_gen.c
+ * @brief EEZ flow 预先编译结果，说明见 eez_flow_aot.h
+ *
+ * 由 tools/eez_aot 根据 ui.c 的 assets 生成，不要手工修改。界面资源更新后重新生成：
+ *
+ *   ./build_eez_aot/eez_aot_gen main/eez_ui/ui.c main/eez_ui/eez_flow_aot_gen.c
+ *
+ * 控件事件连线 6 条，预编译 6 条
+ */
+
+#include "eez_flow_aot.h"
+#include "eez-flow.h"
+
+const uint32_t eez_flow_aot_assets_size = 2480;
+const uint32_t eez_flow_aot_assets_hash = 0xac028d06u;
+
+// flow 1 组件 0 输出 0
+static bool flow1_c0_o0(void) {
+    // 组件 5
+    eez_flow_push_screen(3, (lv_scr_load_anim_t)2, 300, 0);
+    return true;
+}
+
+// flow 1 组件 3 输出 0
+static bool flow1_c3_o0(void) {
+    // 组件 6
+    eez_flow_push_screen(4, (lv_scr_load_anim_t)1, 300, 0);
+    return true;
+}
+
+// flow 2 组件 0 输出 0
+static bool flow2_c0_o0(void) {
+    lv_obj_t *t6 = eez_flow_aot_object(6);
+    lv_obj_t *t7 = eez_flow_aot_object(7);
+    if (!t6 || !t7) {
+        return false;
+    }
+    // 组件 5
+    lv_obj_add_flag(t6, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_clear_flag(t7, LV_OBJ_FLAG_HIDDEN);
+    return true;
+}
+
+// flow 2 组件 1 输出 0
+static bool flow2_c1_o0(void) {
+    // 组件 7
+    eez_flow_pop_screen((lv_scr_load_anim_t)11, 200, 0);
+    return true;
+}
+
+// flow 2 组件 3 输出 0
+static bool flow2_c3_o0(void) {
+    lv_obj_t *t6 = eez_flow_aot_object(6);
+    lv_obj_t *t7 = eez_flow_aot_object(7);
+    if (!t6 || !t7) {
+        return false;
+    }
+    // 组件 6
+    lv_obj_add_flag(t7, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_clear_flag(t6, LV_OBJ_FLAG_HIDDEN);
+    return true;
+}
+
+// flow 3 组件 1 输出 0
+static bool flow3_c1_o0(void) {
+    // 组件 3
+    eez_flow_pop_screen((lv_scr_load_anim_t)12, 200, 0);
+    return true;
+}
+
+const eez_flow_aot_entry_t eez_flow_aot_entries[] = {
+    {1, 0, 0, flow1_c0_o0},
+    {1, 3, 0, flow1_c3_o0},
+    {2, 0, 0, flow2_c0_o0},
+    {2, 1, 0, flow2_c1_o0},
+    {2, 3, 0, flow2_c3_o0},
+    {3, 1, 0, flow3_c1_o0},
+};
+const size_t eez_flow_aot_num_entries = 6;
+
+bool eez_flow_aot_run(int flow_index, unsigned component_index, unsigned output_index) {
+    switch (EEZ_FLOW_AOT_KEY(flow_index, component_index, output_index)) {
+    case EEZ_FLOW_AOT_KEY(1, 0, 0):
+        return flow1_c0_o0();
+    case EEZ_FLOW_AOT_KEY(1, 3, 0):
+        return flow1_c3_o0();
+    case EEZ_FLOW_AOT_KEY(2, 0, 0):
+        return flow2_c0_o0();
+    case EEZ_FLOW_AOT_KEY(2, 1, 0):
+        return flow2_c1_o0();
+    case EEZ_FLOW_AOT_KEY(2, 3, 0):
+        return flow2_c3_o0();
+    case EEZ_FLOW_AOT_KEY(3, 1, 0):
+        return flow3_c1_o0();
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,116 @@
+/**
+ * @file eez_flow_sched.cpp
+ * @brief EEZ flow 队列分道与 tick 时间预算，说明见 eez_flow_sched.h
+ */
+
+#include "eez_flow_sched.h"
+#include "eez-flow.h"
+#include "esp_timer.h"
+
+namespace eez {
+namespace flow {
+
+static uint32_t s_budgetUs = EEZ_FLOW_TICK_BUDGET_DEFAULT_US;
+static uint32_t s_tickStartUs;
+static uint32_t s_deadlineUs;
+static int s_inputDepth = 0;  // flowPropagateValueLVGLEvent 可能嵌套（事件里再发事件）
+static eez_flow_lane_t s_executingLane = EEZ_FLOW_LANE_NORMAL;
+static eez_flow_sched_stats_t s_stats;
+
+// ============== 分道 ==============
+
+uint32_t schedNow() {
+  return (uint32_t)esp_timer_get_time();
+}
+
+eez_flow_lane_t schedLaneForNewTask() {
+  // 调试器按入队顺序镜像队列，不能让后入队的任务先执行
+  if (g_debuggerIsConnected) {
+    return EEZ_FLOW_LANE_NORMAL;
+  }
+  if (s_inputDepth > 0 || s_executingLane == EEZ_FLOW_LANE_INPUT) {
+    return EEZ_FLOW_LANE_INPUT;
+  }
+  return EEZ_FLOW_LANE_NORMAL;
+}
+
+void schedInputBegin() {
+  s_inputDepth++;
+}
+
+void schedInputEnd() {
+  s_inputDepth--;
+}
+
+void schedSetExecutingLane(eez_flow_lane_t lane) {
+  s_executingLane = lane;
+}
+
+// ============== 预算 ==============
+
+void schedTickBegin() {
+  s_tickStartUs = schedNow();
+  s_deadlineUs = s_tickStartUs + s_budgetUs;
+}
+
+bool schedDeadlineReached() {
+  // 无符号差值按有符号比较，计时器回绕时也正确
+  return (int32_t)(schedNow() - s_deadlineUs) >= 0;
+}
+
+void schedTickEnd(uint32_t executed, bool deferred) {
+  s_executingLane = EEZ_FLOW_LANE_NORMAL;
+  if (executed == 0) {
+    return;
+  }
+  uint32_t elapsed = schedNow() - s_tickStartUs;
+  s_stats.ticks++;
+  if (deferred) {
+    s_stats.deferred++;
+  }
+  if (elapsed > s_budgetUs) {
+    s_stats.overruns++;
+  }
+  if (elapsed > s_stats.max_tick_us) {
+    s_stats.max_tick_us = elapsed;
+  }
+}
+
+// ============== 统计 ==============
+
+void schedTaskDequeued(eez_flow_lane_t lane, uint32_t enqueuedUs) {
+  uint32_t wait = schedNow() - enqueuedUs;
+  eez_flow_lane_stats_t *l = &s_stats.lanes[lane];
+  l->executed++;
+  l->wait_us_sum += wait;
+  if (wait > l->wait_us_max) {
+    l->wait_us_max = wait;
+  }
+}
+
+void schedLaneDepth(eez_flow_lane_t lane, uint32_t depth) {
+  if (depth > s_stats.lanes[lane].max_depth) {
+    s_stats.lanes[lane].max_depth = depth;
+  }
+}
+
+} // namespace flow
+} // namespace eez
+
+extern "C" void eez_flow_set_frame_remaining_us(uint32_t remaining_us) {
+  if (remaining_us < EEZ_FLOW_TICK_BUDGET_MIN_US) {
+    remaining_us = EEZ_FLOW_TICK_BUDGET_MIN_US;
+  } else if (remaining_us > EEZ_FLOW_TICK_BUDGET_MAX_US) {
+    remaining_us = EEZ_FLOW_TICK_BUDGET_MAX_US;
+  }
+  eez::flow::s_budgetUs = remaining_us;
+}
+
+extern "C" void eez_flow_get_sched_stats(eez_flow_sched_stats_t *stats) {
+  *stats = eez::flow::s_stats;
+  stats->budget_us = eez::flow::s_budgetUs;
+}
+
+extern "C" void eez_flow_reset_sched_stats(void) {
+  eez::flow::s_stats = eez_flow_sched_stats_t();
+}
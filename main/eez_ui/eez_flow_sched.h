@@ -0,0 +1,116 @@
+/**
+ * @file eez_flow_sched.h
+ * @brief EEZ flow 队列分道与 tick 时间预算
+ *
+ * 原实现所有待执行组件在同一个 FIFO g_queue 里，Animate / Delay 等连续任务每个 tick 重新入队轮询，
+ * 触摸触发的动作要排在它们后面；tick 每执行 5 个组件才检查一次固定的 5 ms 上限。
+ *
+ * 这里把队列分成三条道，每个 tick 按优先级取任务：
+ * - INPUT：LVGL 事件（flowPropagateValueLVGLEvent）触发的组件，以及它们执行时继续触发的组件
+ * - NORMAL：其余一次性任务（页面加载、原生代码 propagate、定时器等）
+ * - CONTINUOUS：连续任务，每个 tick 最多轮询一轮（与原实现相同），放在最后
+ *
+ * 每执行完一个组件检查一次截止时间。预算由 LVGL 任务在每帧渲染后报告的剩余帧时间给出
+ * （eez_flow_set_frame_remaining_us），限制在 [EEZ_FLOW_TICK_BUDGET_MIN_US, EEZ_FLOW_TICK_BUDGET_MAX_US]；
+ * 下限保证渲染很重时 flow 仍能前进。没有报告时使用 EEZ_FLOW_TICK_BUDGET_DEFAULT_US（原实现的 5 ms）。
+ *
+ * EEZ Studio 调试器连接时按入队顺序镜像队列，此时 INPUT 并入 NORMAL，保持 FIFO。
+ *
+ * 只在 LVGL 任务中使用，不加锁。
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef EEZ_FLOW_TICK_BUDGET_MIN_US
+#define EEZ_FLOW_TICK_BUDGET_MIN_US 1000
+#endif
+#ifndef EEZ_FLOW_TICK_BUDGET_MAX_US
+#define EEZ_FLOW_TICK_BUDGET_MAX_US 8000
+#endif
+#ifndef EEZ_FLOW_TICK_BUDGET_DEFAULT_US
+#define EEZ_FLOW_TICK_BUDGET_DEFAULT_US 5000
+#endif
+
+typedef enum {
+    EEZ_FLOW_LANE_INPUT = 0,
+    EEZ_FLOW_LANE_NORMAL,
+    EEZ_FLOW_LANE_CONTINUOUS,
+    EEZ_FLOW_LANE_COUNT,
+} eez_flow_lane_t;
+
+/** 单条道的统计 */
+typedef struct {
+    uint32_t executed;    // 出队执行的任务数
+    uint32_t max_depth;   // 队列长度峰值
+    uint64_t wait_us_sum; // 入队到出队的等待时间累计（微秒）
+    uint32_t wait_us_max; // 最长等待
+} eez_flow_lane_stats_t;
+
+typedef struct {
+    uint32_t ticks;        // 执行过任务的 tick 数
+    uint32_t budget_us;    // 当前预算
+    uint32_t deferred;     // 预算用完、还有任务留到下个 tick 的次数
+    uint32_t overruns;     // tick 实际耗时超过预算的次数（单个组件跨过截止时间）
+    uint32_t max_tick_us;  // 最长一次 tick 的任务执行时间
+    eez_flow_lane_stats_t lanes[EEZ_FLOW_LANE_COUNT];
+} eez_flow_sched_stats_t;
+
+/**
+ * LVGL 任务报告本帧剩余时间，作为下一次 eez_flow_tick 的预算
+ * @param remaining_us 帧周期减去本帧渲染和循环等待后的剩余（微秒），不足时传 0
+ */
+void eez_flow_set_frame_remaining_us(uint32_t remaining_us);
+
+void eez_flow_get_sched_stats(eez_flow_sched_stats_t *stats);
+
+/** 清零统计（预算保持） */
+void eez_flow_reset_sched_stats(void);
+
+#ifdef __cplusplus
+}
+
+namespace eez {
+namespace flow {
+
+/** 当前时间（微秒），入队时间戳和截止时间共用 */
+uint32_t schedNow();
+
+/** 新入队的一次性任务所在的道 */
+eez_flow_lane_t schedLaneForNewTask();
+
+/** LVGL 事件开始 / 结束向 flow 传值，期间入队的任务进入 INPUT */
+void schedInputBegin();
+void schedInputEnd();
+
+/** tick 开始执行某条道的任务（其中继续入队的任务沿用 INPUT） */
+void schedSetExecutingLane(eez_flow_lane_t lane);
+
+/** tick 开始：记录起点，按当前预算计算截止时间 */
+void schedTickBegin();
+
+/** 已到截止时间 */
+bool schedDeadlineReached();
+
+/**
+ * tick 结束
+ * @param executed 本 tick 执行的任务数
+ * @param deferred 是否因预算用完留下了任务
+ */
+void schedTickEnd(uint32_t executed, bool deferred);
+
+/** 任务出队，累计等待时间 */
+void schedTaskDequeued(eez_flow_lane_t lane, uint32_t enqueuedUs);
+
+/** 任务入队后的道长度，更新峰值 */
+void schedLaneDepth(eez_flow_lane_t lane, uint32_t depth);
+
+} // namespace flow
+} // namespace eez
+
+#endif
@@ -0,0 +1,407 @@
+#include "eez_heap.h"
+#include "lvgl.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "EEZ_HEAP";
+
+#define FREED_MARK 0xFFFFFFFFu // 已释放块的 size 字段，用于发现重复释放
+#define OTHER_ID 0xFFFFFFFFu   // id 表满后的汇总项
+#define LUT_SIZE (EEZ_HEAP_MAX_CLASS_SIZE / 8 + 1)
+
+/** 块头，紧挨在返回给调用者的地址之前 */
+typedef struct {
+    uint32_t size;      // 请求大小（不含头），FREED_MARK 表示已释放
+    uint16_t chunk_off; // 块相对所在区块起始的偏移（大块为 0）
+    uint8_t id_slot;    // s_ids 下标（id 表满时为 EEZ_HEAP_ID_SLOTS）
+    uint8_t reserved;
+} block_hdr_t;
+
+/** 空闲块：头之后存放链表指针 */
+typedef struct free_block {
+    block_hdr_t hdr;
+    struct free_block *next;
+} free_block_t;
+
+/** 区块头，位于区块起始处，之后是 capacity 个同级块 */
+typedef struct chunk {
+    struct chunk *prev; // 本级可分配区块链表
+    struct chunk *next;
+    free_block_t *free; // 区块内已释放的块
+    uint16_t live;      // 使用中的块数
+    uint16_t carved;    // 已切分的块数
+    uint16_t capacity;  // 可容纳的块数
+    uint8_t cls;
+    bool listed;        // 是否在 s_avail[cls] 中（有空闲块或未切分部分）
+} chunk_t;
+
+#define CHUNK_HDR_SIZE ((sizeof(chunk_t) + 7) & ~(size_t)7)
+
+static const uint16_t s_class_size[EEZ_HEAP_CLASS_NUM] = {
+    16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048,
+};
+
+static uint8_t s_class_of[LUT_SIZE]; // 按 8 字节向上取整后的下标 → 级别
+static bool s_lut_ready = false;
+
+static chunk_t *s_avail[EEZ_HEAP_CLASS_NUM]; // 各级可分配的区块
+
+static eez_heap_stats_t s_stats;
+
+static eez_heap_id_stats_t s_ids[EEZ_HEAP_ID_SLOTS + 1]; // 最后一项为 OTHER_ID
+static bool s_id_used[EEZ_HEAP_ID_SLOTS];
+
+static eez_heap_trace_cb_t s_trace = NULL;
+static void *s_trace_user = NULL;
+
+// ============== 级别 ==============
+
+static void lut_init(void) {
+    int cls = 0;
+    for (int i = 0; i < LUT_SIZE; i++) {
+        while (s_class_size[cls] < i * 8) {
+            cls++;
+        }
+        s_class_of[i] = (uint8_t)cls;
+    }
+    for (int i = 0; i < EEZ_HEAP_CLASS_NUM; i++) {
+        s_stats.cls[i].block_size = s_class_size[i];
+    }
+    s_ids[EEZ_HEAP_ID_SLOTS].id = OTHER_ID;
+    s_lut_ready = true;
+}
+
+static inline int class_of(size_t size) {
+    return s_class_of[(size + EEZ_HEAP_HDR_SIZE + 7) >> 3];
+}
+
+static inline bool is_large(size_t size) {
+    return size + EEZ_HEAP_HDR_SIZE > EEZ_HEAP_MAX_CLASS_SIZE;
+}
+
+// ============== 按 id 统计 ==============
+
+static uint8_t id_slot(uint32_t id) {
+    uint32_t h = (id * 2654435761u) % EEZ_HEAP_ID_SLOTS;
+    for (int n = 0; n < EEZ_HEAP_ID_SLOTS; n++) {
+        if (!s_id_used[h]) {
+            s_id_used[h] = true;
+            s_ids[h].id = id;
+            return (uint8_t)h;
+        }
+        if (s_ids[h].id == id) {
+            return (uint8_t)h;
+        }
+        h = (h + 1) % EEZ_HEAP_ID_SLOTS;
+    }
+    return EEZ_HEAP_ID_SLOTS;
+}
+
+static void account_alloc(uint8_t slot, size_t size, size_t block) {
+    eez_heap_id_stats_t *ids = &s_ids[slot];
+    ids->live++;
+    ids->allocs++;
+    ids->live_bytes += size;
+    if (ids->live_bytes > ids->peak_bytes) {
+        ids->peak_bytes = ids->live_bytes;
+    }
+
+    s_stats.allocs++;
+    s_stats.requested_bytes += size;
+    if (block) {
+        s_stats.block_bytes += block;
+    } else {
+        s_stats.large_bytes += size + EEZ_HEAP_HDR_SIZE;
+        s_stats.large_count++;
+    }
+    size_t used = s_stats.block_bytes + s_stats.large_bytes;
+    if (used > s_stats.peak_bytes) {
+        s_stats.peak_bytes = used;
+    }
+}
+
+static void account_free(uint8_t slot, size_t size, size_t block) {
+    eez_heap_id_stats_t *ids = &s_ids[slot];
+    ids->live--;
+    ids->live_bytes -= size;
+
+    s_stats.frees++;
+    s_stats.requested_bytes -= size;
+    if (block) {
+        s_stats.block_bytes -= block;
+    } else {
+        s_stats.large_bytes -= size + EEZ_HEAP_HDR_SIZE;
+        s_stats.large_count--;
+    }
+}
+
+// ============== 区块 ==============
+
+static void avail_push(chunk_t *c) {
+    c->prev = NULL;
+    c->next = s_avail[c->cls];
+    if (c->next) {
+        c->next->prev = c;
+    }
+    s_avail[c->cls] = c;
+    c->listed = true;
+}
+
+static void avail_remove(chunk_t *c) {
+    if (c->prev) {
+        c->prev->next = c->next;
+    } else {
+        s_avail[c->cls] = c->next;
+    }
+    if (c->next) {
+        c->next->prev = c->prev;
+    }
+    c->prev = c->next = NULL;
+    c->listed = false;
+}
+
+static size_t chunk_bytes(const chunk_t *c) {
+    return CHUNK_HDR_SIZE + (size_t)c->capacity * s_class_size[c->cls];
+}
+
+static chunk_t *chunk_new(int cls) {
+    uint16_t bsize = s_class_size[cls];
+    size_t capacity = (EEZ_HEAP_CHUNK_SIZE - CHUNK_HDR_SIZE) / bsize;
+    if (capacity == 0) {
+        capacity = 1;
+    }
+    chunk_t *c = lv_mem_alloc(CHUNK_HDR_SIZE + capacity * bsize);
+    if (!c) {
+        return NULL;
+    }
+    memset(c, 0, sizeof(*c));
+    c->capacity = (uint16_t)capacity;
+    c->cls = (uint8_t)cls;
+    avail_push(c);
+
+    size_t bytes = chunk_bytes(c);
+    s_stats.reserved_bytes += bytes;
+    s_stats.chunk_free_bytes += bytes - CHUNK_HDR_SIZE;
+    s_stats.chunks++;
+    return c;
+}
+
+/** 归还空区块（其中的块都在区块自己的空闲链表里，随区块一起消失） */
+static void chunk_release(chunk_t *c) {
+    int cls = c->cls;
+    uint16_t bsize = s_class_size[cls];
+    avail_remove(c);
+
+    size_t bytes = chunk_bytes(c);
+    s_stats.cls[cls].cached -= c->carved;
+    s_stats.cached_bytes -= (size_t)c->carved * bsize;
+    s_stats.reserved_bytes -= bytes;
+    s_stats.chunk_free_bytes -= bytes - CHUNK_HDR_SIZE;
+    s_stats.chunks--;
+    s_stats.chunks_released++;
+    lv_mem_free(c);
+}
+
+// ============== 分配 / 释放 ==============
+
+static block_hdr_t *class_alloc(int cls) {
+    chunk_t *c = s_avail[cls];
+    if (!c) {
+        c = chunk_new(cls);
+        if (!c) {
+            return NULL;
+        }
+    }
+
+    uint16_t bsize = s_class_size[cls];
+    block_hdr_t *hdr;
+    if (c->free) {
+        free_block_t *fb = c->free;
+        c->free = fb->next;
+        s_stats.cls[cls].cached--;
+        s_stats.cached_bytes -= bsize;
+        hdr = &fb->hdr;
+    } else {
+        hdr = (block_hdr_t *)((uint8_t *)c + CHUNK_HDR_SIZE + (size_t)c->carved * bsize);
+        c->carved++;
+    }
+    c->live++;
+    s_stats.chunk_free_bytes -= bsize;
+    if (!c->free && c->carved == c->capacity) {
+        avail_remove(c); // 区块已满，释放块时再放回
+    }
+    hdr->chunk_off = (uint16_t)((uint8_t *)hdr - (uint8_t *)c);
+    return hdr;
+}
+
+static void class_free(block_hdr_t *hdr) {
+    chunk_t *c = (chunk_t *)((uint8_t *)hdr - hdr->chunk_off);
+    int cls = c->cls;
+    uint16_t bsize = s_class_size[cls];
+
+    free_block_t *fb = (free_block_t *)hdr;
+    fb->next = c->free;
+    c->free = fb;
+    c->live--;
+    s_stats.cls[cls].in_use--;
+    s_stats.cls[cls].cached++;
+    s_stats.cached_bytes += bsize;
+    s_stats.chunk_free_bytes += bsize;
+
+    if (!c->listed) {
+        avail_push(c);
+    }
+    // 区块空出后归还，但本级只剩这一个可分配区块时保留，避免在边界上反复申请 / 归还
+    if (c->live == 0 && (c->prev || c->next)) {
+        chunk_release(c);
+    }
+}
+
+void *eez_heap_alloc(size_t size, uint32_t id) {
+    if (!s_lut_ready) {
+        lut_init();
+    }
+    if (size == 0) {
+        size = 1;
+    }
+
+    block_hdr_t *hdr;
+    size_t block = 0;
+    if (is_large(size)) {
+        hdr = lv_mem_alloc(size + EEZ_HEAP_HDR_SIZE);
+        if (hdr) {
+            hdr->chunk_off = 0;
+        }
+    } else {
+        int cls = class_of(size);
+        hdr = class_alloc(cls);
+        if (hdr) {
+            block = s_class_size[cls];
+            eez_heap_class_stats_t *cs = &s_stats.cls[cls];
+            cs->allocs++;
+            if (++cs->in_use > cs->peak) {
+                cs->peak = cs->in_use;
+            }
+        }
+    }
+    if (!hdr) {
+        s_stats.failed++;
+        ESP_LOGE(TAG, "分配失败: %u 字节 (id 0x%08x)", (unsigned)size, (unsigned)id);
+        return NULL;
+    }
+
+    hdr->size = (uint32_t)size;
+    hdr->id_slot = id_slot(id);
+    account_alloc(hdr->id_slot, size, block);
+
+    if (s_trace) {
+        s_trace('a', hdr + 1, (uint32_t)size, id, s_trace_user);
+    }
+    return hdr + 1;
+}
+
+void eez_heap_free(void *p) {
+    if (!p) {
+        return;
+    }
+    block_hdr_t *hdr = (block_hdr_t *)p - 1;
+    if (hdr->size == FREED_MARK) {
+        ESP_LOGE(TAG, "重复释放 %p", p);
+        return;
+    }
+    if (s_trace) {
+        s_trace('f', p, 0, 0, s_trace_user);
+    }
+
+    size_t size = hdr->size;
+
+    if (is_large(size)) {
+        account_free(hdr->id_slot, size, 0);
+#if EEZ_HEAP_POISON
+        memset(p, 0xCC, size);
+#endif
+        hdr->size = FREED_MARK;
+        lv_mem_free(hdr);
+        return;
+    }
+
+    int cls = class_of(size);
+    account_free(hdr->id_slot, size, s_class_size[cls]);
+#if EEZ_HEAP_POISON
+    memset(p, 0xCC, s_class_size[cls] - EEZ_HEAP_HDR_SIZE);
+#endif
+    hdr->size = FREED_MARK;
+    class_free(hdr);
+}
+
+// ============== 统计 ==============
+
+void eez_heap_get_stats(eez_heap_stats_t *stats) {
+    if (!s_lut_ready) {
+        lut_init();
+    }
+    *stats = s_stats;
+}
+
+size_t eez_heap_get_id_stats(eez_heap_id_stats_t *out, size_t max) {
+    size_t n = 0;
+    for (int i = 0; i <= EEZ_HEAP_ID_SLOTS; i++) {
+        bool used = i < EEZ_HEAP_ID_SLOTS ? s_id_used[i] : s_ids[i].allocs > 0;
+        if (!used) {
+            continue;
+        }
+        // 插入排序（按峰值降序），表项很少
+        const eez_heap_id_stats_t *e = &s_ids[i];
+        size_t pos = n < max ? n : max;
+        while (pos > 0 && out[pos - 1].peak_bytes < e->peak_bytes) {
+            if (pos < max) {
+                out[pos] = out[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < max) {
+            out[pos] = *e;
+            if (n < max) {
+                n++;
+            }
+        }
+    }
+    return n;
+}
+
+void eez_heap_print_stats(void) {
+    eez_heap_stats_t st;
+    eez_heap_get_stats(&st);
+
+    ESP_LOGI(TAG, "【EEZ flow 堆】");
+    // 内部碎片：级别取整和块头；外部碎片：区块中空闲链表、未切分部分和区块头
+    size_t used = st.block_bytes + st.large_bytes;
+    float internal = used ? (1.0f - (float)st.requested_bytes / used) * 100.0f : 0.0f;
+    float external = st.reserved_bytes ? (1.0f - (float)st.block_bytes / st.reserved_bytes) * 100.0f : 0.0f;
+    ESP_LOGI(TAG, "  使用中: %zu 字节（块 %zu + 大块 %zu，高水位 %zu），区块 %u 个 / %zu 字节，空闲链表 %zu 字节",
+             st.requested_bytes, st.block_bytes, st.large_bytes, st.peak_bytes, (unsigned)st.chunks,
+             st.reserved_bytes, st.cached_bytes);
+    ESP_LOGI(TAG, "  内部碎片 %.1f%%，区块空闲 %.1f%%（未切分 %zu 字节），已归还区块 %u，分配 %u / 释放 %u / 失败 %u",
+             internal, external, st.chunk_free_bytes - st.cached_bytes, (unsigned)st.chunks_released,
+             (unsigned)st.allocs, (unsigned)st.frees, (unsigned)st.failed);
+    for (int i = 0; i < EEZ_HEAP_CLASS_NUM; i++) {
+        const eez_heap_class_stats_t *cs = &st.cls[i];
+        if (cs->allocs == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "    %4u B: 使用 %u（高水位 %u），空闲 %u，累计 %u 次", (unsigned)cs->block_size,
+                 (unsigned)cs->in_use, (unsigned)cs->peak, (unsigned)cs->cached, (unsigned)cs->allocs);
+    }
+
+    eez_heap_id_stats_t ids[8];
+    size_t n = eez_heap_get_id_stats(ids, sizeof(ids) / sizeof(ids[0]));
+    for (size_t i = 0; i < n; i++) {
+        ESP_LOGI(TAG, "    id 0x%08x: 使用 %u 块 / %zu 字节（高水位 %zu），累计 %u 次", (unsigned)ids[i].id,
+                 (unsigned)ids[i].live, ids[i].live_bytes, ids[i].peak_bytes, (unsigned)ids[i].allocs);
+    }
+}
+
+void eez_heap_set_trace(eez_heap_trace_cb_t cb, void *user_data) {
+    s_trace_user = user_data;
+    s_trace = cb;
+}
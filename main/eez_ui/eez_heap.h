@@ -0,0 +1,129 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+/**
+ * EEZ flow 堆（eez::alloc / eez::free 的实现）
+ *
+ * 分级区块：块大小（含 8 字节头）按 16 ~ 2048 字节分为 15 级，
+ * 每级的块从约 4 KB 的区块中切分，区块用 lv_mem_alloc 申请，每个区块有自己的 LIFO 空闲链表
+ * 和使用中块数。分配取本级第一个有空位的区块，释放按块头中的偏移找到区块，都是 O(1)。
+ * 区块中的块全部释放后归还给 lv_mem（本级仅剩的一个可分配区块保留，避免反复申请），
+ * 占用随 flow 的存活数据回落。
+ * 超过 2048 字节的请求直接交给 lv_mem_alloc（PSRAM 区 TLSF，同样 O(1)）。
+ *
+ * 块头记录请求大小、所在区块的偏移和按 id 统计的表项下标。
+ * 打开 CONFIG_APP_EEZ_HEAP_POISON（或编译时定义 EEZ_HEAP_POISON=1）后释放时用 0xCC 填充，
+ * 便于发现释放后使用。
+ *
+ * 只在 LVGL 任务中调用（与 eez-flow 的 LVGL 分支一致，不加锁）。
+ */
+
+#define EEZ_HEAP_CLASS_NUM 15
+#define EEZ_HEAP_HDR_SIZE 8
+#define EEZ_HEAP_MAX_CLASS_SIZE 2048
+#define EEZ_HEAP_CHUNK_SIZE 4096
+#define EEZ_HEAP_ID_SLOTS 64 // 按 id 统计的表项数，满了以后计入 id=0xFFFFFFFF
+
+#ifndef EEZ_HEAP_POISON
+#if defined(CONFIG_APP_EEZ_HEAP_POISON)
+#define EEZ_HEAP_POISON 1
+#else
+#define EEZ_HEAP_POISON 0
+#endif
+#endif
+
+/** 单个块大小级别的统计 */
+typedef struct {
+    uint16_t block_size; // 块大小（含头）
+    uint32_t in_use;     // 使用中的块数
+    uint32_t peak;       // 使用中块数的高水位
+    uint32_t cached;     // 空闲链表中的块数
+    uint32_t allocs;     // 累计分配次数
+} eez_heap_class_stats_t;
+
+/** 堆统计 */
+typedef struct {
+    eez_heap_class_stats_t cls[EEZ_HEAP_CLASS_NUM];
+    size_t requested_bytes;   // 使用中块的请求字节（不含头）
+    size_t block_bytes;       // 使用中块的块字节（含头、含级别取整）
+    size_t peak_bytes;        // block_bytes + large_bytes 的高水位
+    size_t reserved_bytes;    // 当前持有的区块总字节（含区块头）
+    size_t cached_bytes;      // 区块空闲链表中的块字节
+    size_t chunk_free_bytes;  // 区块中可分配的字节（空闲链表 + 未切分）
+    uint32_t chunks;          // 当前持有的区块数
+    uint32_t chunks_released; // 累计归还的区块数
+    size_t large_bytes;       // 直接走 lv_mem_alloc 的大块字节
+    uint32_t large_count;     // 使用中的大块数
+    uint32_t allocs;          // 累计分配次数
+    uint32_t frees;           // 累计释放次数
+    uint32_t failed;          // 分配失败次数
+} eez_heap_stats_t;
+
+/** 按分配 id 的统计 */
+typedef struct {
+    uint32_t id;
+    uint32_t live;       // 使用中的块数
+    uint32_t allocs;     // 累计分配次数
+    size_t live_bytes;   // 使用中的请求字节
+    size_t peak_bytes;   // live_bytes 的高水位
+} eez_heap_id_stats_t;
+
+/**
+ * 分配跟踪回调（主机端录制分配序列用）
+ * @param op 'a' 分配 / 'f' 释放
+ * @param ptr 块地址
+ * @param size 请求大小（释放时为 0）
+ * @param id 分配 id（释放时为 0）
+ */
+typedef void (*eez_heap_trace_cb_t)(char op, const void *ptr, uint32_t size, uint32_t id, void *user_data);
+
+/**
+ * 分配内存
+ * @param size 字节数
+ * @param id eez 分配 id（调用点标识）
+ * @return 8 字节对齐的内存，失败返回 NULL
+ */
+void *eez_heap_alloc(size_t size, uint32_t id);
+
+/**
+ * 释放内存，p 可以为 NULL
+ */
+void eez_heap_free(void *p);
+
+/**
+ * 获取堆统计
+ */
+void eez_heap_get_stats(eez_heap_stats_t *stats);
+
+/**
+ * 获取按 id 的统计，按 peak_bytes 从大到小排列
+ * @param out 输出数组
+ * @param max 数组长度
+ * @return 写入的项数
+ */
+size_t eez_heap_get_id_stats(eez_heap_id_stats_t *out, size_t max);
+
+/**
+ * 打印分级统计、碎片和占用最多的分配 id
+ */
+void eez_heap_print_stats(void);
+
+/**
+ * 设置分配跟踪回调，NULL 取消
+ */
+void eez_heap_set_trace(eez_heap_trace_cb_t cb, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
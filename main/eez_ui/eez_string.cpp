@@ -0,0 +1,127 @@
+/**
+ * @file eez_string.cpp
+ * @brief eez::Value 的短字符串内联与字符串驻留，说明见 eez_string.h
+ */
+
+#include "eez_string.h"
+
+#include <string.h>
+
+namespace eez {
+
+#define INTERN_MASK (EEZ_STRING_INTERN_SLOTS - 1)
+#define INTERN_PROBES 8 // 线性探测的最大步数
+
+static_assert((EEZ_STRING_INTERN_SLOTS & INTERN_MASK) == 0, "EEZ_STRING_INTERN_SLOTS 必须是 2 的幂");
+static_assert(EEZ_STRING_INTERN_ARENA_BYTES <= 0xFFFF, "驻留区偏移为 16 位");
+
+enum {
+    SLOT_EMPTY = 0,
+    SLOT_CANDIDATE, // 出现过一次，只记散列和长度
+    SLOT_INTERNED,
+};
+
+typedef struct {
+    uint32_t hash;
+    uint16_t offset; // 在驻留区中的偏移
+    uint8_t len;
+    uint8_t state;
+} intern_slot_t;
+
+static intern_slot_t s_slots[EEZ_STRING_INTERN_SLOTS];
+static char s_arena[EEZ_STRING_INTERN_ARENA_BYTES];
+static uint32_t s_arenaUsed = 0;
+static eez_string_stats_t s_stats;
+
+// FNV-1a
+static uint32_t hashString(const char *str, size_t len) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    h ^= (uint8_t)str[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static const char *store(intern_slot_t *slot, uint32_t hash, const char *str, size_t len) {
+  if (s_arenaUsed + len + 1 > EEZ_STRING_INTERN_ARENA_BYTES) {
+    s_stats.intern_full++;
+    return nullptr;
+  }
+  char *dst = &s_arena[s_arenaUsed];
+  memcpy(dst, str, len);
+  dst[len] = 0;
+  slot->hash = hash;
+  slot->offset = (uint16_t)s_arenaUsed;
+  slot->len = (uint8_t)len;
+  slot->state = SLOT_INTERNED;
+  s_arenaUsed += len + 1;
+  s_stats.interned++;
+  s_stats.arena_bytes = s_arenaUsed;
+  return dst;
+}
+
+/**
+ * 查找驻留串；没有时第一次记为候选、第二次驻留
+ *
+ * 表项只会从候选变为驻留或被新的候选 / 驻留串覆盖，不会变空，探测链不会断。
+ */
+static const char *lookup(const char *str, size_t len) {
+  if (len > EEZ_STRING_INTERN_MAX_LEN || strnlen(str, len) != len) {
+    return nullptr;
+  }
+  uint32_t hash = hashString(str, len);
+  intern_slot_t *target = nullptr;
+  intern_slot_t *candidate = nullptr;
+  for (int i = 0; i < INTERN_PROBES; i++) {
+    intern_slot_t *slot = &s_slots[(hash + i) & INTERN_MASK];
+    if (slot->state == SLOT_EMPTY) {
+      target = slot;
+      break;
+    }
+    if (slot->hash == hash && slot->len == len) {
+      if (slot->state == SLOT_INTERNED) {
+        const char *interned = &s_arena[slot->offset];
+        if (memcmp(interned, str, len) == 0) {
+          s_stats.intern_hits++;
+          return interned;
+        }
+      } else {
+        // 散列相同的候选：第二次出现
+        return store(slot, hash, str, len);
+      }
+    }
+    if (slot->state == SLOT_CANDIDATE && !candidate) {
+      candidate = slot;
+    }
+  }
+  if (!target) {
+    target = candidate;
+  }
+  if (!target) {
+    s_stats.intern_full++;
+    return nullptr;
+  }
+  target->hash = hash;
+  target->len = (uint8_t)len;
+  target->state = SLOT_CANDIDATE;
+  return nullptr;
+}
+
+const char *stringIntern(const char *str, size_t len) {
+  return lookup(str, len);
+}
+
+void stringCountInline() {
+  s_stats.inlined++;
+}
+
+void stringCountRef() {
+  s_stats.ref_allocs++;
+}
+
+} // namespace eez
+
+extern "C" void eez_string_get_stats(eez_string_stats_t *stats) {
+  *stats = eez::s_stats;
+}
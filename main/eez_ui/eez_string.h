@@ -0,0 +1,77 @@
+/**
+ * @file eez_string.h
+ * @brief eez::Value 的短字符串内联与字符串驻留
+ *
+ * 原实现 flow 里每个动态字符串（Value::makeStringRef：数字转文本、拼接、子串等）都从 eez 堆分配两次：
+ * 一个 StringRef 对象和字符内容，值释放时再各释放一次。状态名、数字文本这类短串每次求值都重新分配。
+ *
+ * 这里分两层：
+ * - 内联：不超过 EEZ_STRING_INLINE_MAX_LEN 字节的字符串直接放进 Value 的 8 字节联合体，
+ *   类型仍是 VALUE_TYPE_STRING，options 带 STRING_OPTIONS_INLINE，复制值时随值复制，不分配
+ * - 驻留：不超过 EEZ_STRING_INTERN_MAX_LEN 字节的字符串第二次出现时复制进固定大小的驻留区，
+ *   之后同样内容的 makeStringRef 直接返回指向驻留区的 VALUE_TYPE_STRING（与 assets 中的字符串常量相同），
+ *   驻留区满了以后照旧分配 StringRef
+ *
+ * 内联串的 getString() 指向值本身，值被销毁或覆盖后指针失效（StringRef 是其他副本还持有时仍有效）。
+ * 通过间接值（原生变量、数组元素、属性引用等）解析出的内联串，getString() 把解析出的临时值保存在
+ * EEZ_STRING_RESOLVED_SLOTS 个槽位的环形缓冲里，指针在之后同样次数的解析之前有效，不占用驻留区。
+ *
+ * 驻留区不释放，只在 LVGL 任务中使用，不加锁。
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 内联串最大长度（Value 联合体 8 字节，含结尾 0） */
+#define EEZ_STRING_INLINE_MAX_LEN 7
+
+#ifndef EEZ_STRING_RESOLVED_SLOTS
+#define EEZ_STRING_RESOLVED_SLOTS 8 // getString() 保存间接值解析结果的槽位数
+#endif
+
+#ifndef EEZ_STRING_INTERN_MAX_LEN
+#define EEZ_STRING_INTERN_MAX_LEN 32
+#endif
+#ifndef EEZ_STRING_INTERN_SLOTS
+#define EEZ_STRING_INTERN_SLOTS 128 // 散列表项数（2 的幂），含只出现过一次的候选
+#endif
+#ifndef EEZ_STRING_INTERN_ARENA_BYTES
+#define EEZ_STRING_INTERN_ARENA_BYTES 2048
+#endif
+
+typedef struct {
+    uint32_t inlined;      // 内联的字符串数
+    uint32_t intern_hits;  // 命中驻留串的次数
+    uint32_t interned;     // 驻留的字符串数
+    uint32_t arena_bytes;  // 驻留区已用字节
+    uint32_t ref_allocs;   // 仍然分配 StringRef 的次数
+    uint32_t intern_full;  // 驻留区或散列表已满、无法驻留的次数
+} eez_string_stats_t;
+
+void eez_string_get_stats(eez_string_stats_t *stats);
+
+#ifdef __cplusplus
+}
+
+namespace eez {
+
+/**
+ * 查找或驻留字符串（makeStringRef 调用）
+ * 第一次出现只记为候选返回 nullptr，第二次出现起返回驻留区中的副本；
+ * 超过 EEZ_STRING_INTERN_MAX_LEN、内容里有 0、或驻留区已满时返回 nullptr
+ */
+const char *stringIntern(const char *str, size_t len);
+
+/** 统计：内联一次 / 分配一次 StringRef */
+void stringCountInline();
+void stringCountRef();
+
+} // namespace eez
+
+#endif
@@ -0,0 +1,197 @@
+/**
+ * @file eez_watch.cpp
+ * @brief EEZ flow WatchVariable 的按变化求值，说明见 eez_watch.h
+ */
+
+#include "eez_watch.h"
+
+namespace eez {
+namespace flow {
+
+using namespace defs_v3;
+
+static uint64_t s_dirty = 0;     // 上一轮 visitWatchList 之后写入的槽位
+static uint64_t s_seen = 0;      // 本轮开始时取走的脏集合
+static bool s_allDirty = false;  // 有写入无法对应到槽位
+static bool s_seenAll = false;
+static bool s_tracking = true;
+static eez_watch_stats_t s_stats;
+
+// ============== 依赖掩码 ==============
+
+static inline uint64_t slotBit(const void *p) {
+  return 1ull << ((((uint32_t)((uintptr_t)p >> 3)) * 2654435761u) >> 26);
+}
+
+static inline uint64_t nativeBit(int nativeVariableId) {
+  return 1ull << ((((uint32_t)nativeVariableId + 0x9e3779b9u) * 2654435761u) >> 26);
+}
+
+/** 结果只由操作数决定、且不新建数组 / 对象的运算 */
+static bool isPureOperation(uint16_t operation) {
+  if (operation <= OPERATION_TYPE_CONDITIONAL) {
+    return true;
+  }
+  switch (operation) {
+  case OPERATION_TYPE_FLOW_PARSE_INTEGER:
+  case OPERATION_TYPE_FLOW_PARSE_FLOAT:
+  case OPERATION_TYPE_FLOW_PARSE_DOUBLE:
+  case OPERATION_TYPE_FLOW_TO_INTEGER:
+  case OPERATION_TYPE_DATE_TO_STRING:
+  case OPERATION_TYPE_DATE_FROM_STRING:
+  case OPERATION_TYPE_DATE_GET_YEAR:
+  case OPERATION_TYPE_DATE_GET_MONTH:
+  case OPERATION_TYPE_DATE_GET_DAY:
+  case OPERATION_TYPE_DATE_GET_HOURS:
+  case OPERATION_TYPE_DATE_GET_MINUTES:
+  case OPERATION_TYPE_DATE_GET_SECONDS:
+  case OPERATION_TYPE_DATE_GET_MILLISECONDS:
+  case OPERATION_TYPE_DATE_MAKE:
+  case OPERATION_TYPE_MATH_SIN:
+  case OPERATION_TYPE_MATH_COS:
+  case OPERATION_TYPE_MATH_POW:
+  case OPERATION_TYPE_MATH_LOG:
+  case OPERATION_TYPE_MATH_LOG10:
+  case OPERATION_TYPE_MATH_ABS:
+  case OPERATION_TYPE_MATH_FLOOR:
+  case OPERATION_TYPE_MATH_CEIL:
+  case OPERATION_TYPE_MATH_ROUND:
+  case OPERATION_TYPE_MATH_MIN:
+  case OPERATION_TYPE_MATH_MAX:
+  case OPERATION_TYPE_STRING_LENGTH:
+  case OPERATION_TYPE_STRING_SUBSTRING:
+  case OPERATION_TYPE_STRING_FIND:
+  case OPERATION_TYPE_STRING_FORMAT:
+  case OPERATION_TYPE_STRING_FORMAT_PREFIX:
+  case OPERATION_TYPE_STRING_PAD_START:
+  case OPERATION_TYPE_STRING_FROM_CODE_POINT:
+  case OPERATION_TYPE_STRING_CODE_POINT_AT:
+  case OPERATION_TYPE_ARRAY_LENGTH:
+  case OPERATION_TYPE_BLOB_TO_STRING:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/** 槽位里是间接值时，实际读取的位置不在槽位本身 */
+static bool isIndirect(const Value *slot) {
+  auto type = slot->getType();
+  return type == VALUE_TYPE_VALUE_PTR || type == VALUE_TYPE_PROPERTY_REF;
+}
+
+static bool resolve(FlowState *flowState, const uint8_t *instructions, uint64_t *depMask) {
+  auto flowDefinition = flowState->flowDefinition;
+  auto flow = flowState->flow;
+  uint64_t mask = 0;
+
+  for (int i = 0;; i += 2) {
+    uint16_t instruction = instructions[i] + (instructions[i + 1] << 8);
+    auto instructionType = instruction & EXPR_EVAL_INSTRUCTION_TYPE_MASK;
+    auto instructionArg = instruction & EXPR_EVAL_INSTRUCTION_PARAM_MASK;
+
+    const Value *slot = nullptr;
+    if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT) {
+      continue;
+    } else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_INPUT) {
+      slot = &flowState->values[instructionArg];
+    } else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_LOCAL_VAR) {
+      slot = &flowState->values[flow->componentInputs.count + instructionArg];
+    } else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_PUSH_GLOBAL_VAR) {
+      if ((uint32_t)instructionArg < flowDefinition->globalVariables.count) {
+        slot = g_globalVariables ? g_globalVariables->values + instructionArg
+                                 : flowDefinition->globalVariables[instructionArg];
+      } else {
+        mask |= nativeBit((int)(instructionArg - flowDefinition->globalVariables.count + 1));
+        continue;
+      }
+    } else if (instructionType == EXPR_EVAL_INSTRUCTION_ARRAY_ELEMENT) {
+      continue;
+    } else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_OPERATION) {
+      if (!isPureOperation(instructionArg)) {
+        return false;
+      }
+      continue;
+    } else if (instructionType == EXPR_EVAL_INSTRUCTION_TYPE_END) {
+      break;
+    } else {
+      // PUSH_OUTPUT 等
+      return false;
+    }
+
+    if (isIndirect(slot)) {
+      return false;
+    }
+    mask |= slotBit(slot);
+  }
+
+  *depMask = mask;
+  return true;
+}
+
+bool watchResolveDeps(FlowState *flowState, const uint8_t *instructions, uint64_t *depMask) {
+  if (resolve(flowState, instructions, depMask)) {
+    s_stats.tracked++;
+    return true;
+  }
+  s_stats.dynamic++;
+  return false;
+}
+
+// ============== 脏集合 ==============
+
+void watchMarkDirty(const Value *slot) {
+  s_dirty |= slotBit(slot);
+}
+
+void watchMarkAllDirty() {
+  s_allDirty = true;
+}
+
+void watchNativeVariableChanged(int nativeVariableId) {
+  s_dirty |= nativeBit(nativeVariableId);
+}
+
+void watchVisitBegin() {
+  s_seen = s_dirty;
+  s_seenAll = s_allDirty;
+  s_dirty = 0;
+  s_allDirty = false;
+}
+
+bool watchIsDirty(uint64_t depMask) {
+  return !s_tracking || s_seenAll || s_allDirty || ((s_seen | s_dirty) & depMask) != 0;
+}
+
+void watchVisitEnd(uint32_t visited, uint32_t evaluated) {
+  s_stats.ticks++;
+  s_stats.visited += visited;
+  s_stats.evaluated += evaluated;
+}
+
+// ============== 配置 / 统计 ==============
+
+void watchSetTracking(bool enabled) {
+  s_tracking = enabled;
+}
+
+void watchGetStats(eez_watch_stats_t *stats) {
+  *stats = s_stats;
+}
+
+void watchResetStats() {
+  s_stats.ticks = 0;
+  s_stats.visited = 0;
+  s_stats.evaluated = 0;
+}
+
+} // namespace flow
+} // namespace eez
+
+extern "C" void eez_flow_native_var_changed(int32_t native_var_id) {
+  eez::flow::watchNativeVariableChanged((int)native_var_id);
+}
+
+extern "C" void eez_flow_get_watch_stats(eez_watch_stats_t *stats) {
+  eez::flow::watchGetStats(stats);
+}
@@ -0,0 +1,96 @@
+/**
+ * @file eez_watch.h
+ * @brief EEZ flow WatchVariable 的按变化求值
+ *
+ * 原实现每次 eez::flow::tick() 开头把 watch 列表里所有 WatchVariable 的表达式重新求值一遍。
+ * 这里在 watch 加入列表时静态分析表达式读取的槽位（组件输入、局部变量、全局变量、原生变量），
+ * 折成 64 位掩码；写槽位的路径（onValueChanged、setGlobalVariable、原生变量赋值）把槽位记入脏集合，
+ * visitWatchList 只对掩码与脏集合相交的 watch 求值。
+ *
+ * 以下情况无法静态确定依赖，该 watch 每个 tick 都求值（与原实现相同）：
+ * - 调用了结果随时间 / 环境变化或每次新建对象的运算（getTick、Date.now、数组分配等）
+ * - 读取 flow 输出、用户组件属性引用（PROPERTY_REF）或值指针
+ *
+ * 数组 / blob 元素的原地赋值无法对应到槽位，按全部变脏处理。
+ * 掩码是按地址散列的布隆过滤，冲突只会多求值，不会漏。
+ *
+ * 原生变量由原生代码直接修改时 flow 感知不到，原生代码需要调用 eez_flow_native_var_changed()。
+ *
+ * 只在 LVGL 任务中使用，不加锁。
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** watch 统计（visitWatchList 调用累计） */
+typedef struct {
+    uint32_t ticks;     // visitWatchList 次数
+    uint32_t visited;   // 遍历到的 watch 数
+    uint32_t evaluated; // 实际求值的 watch 数
+    uint32_t tracked;   // 加入列表时依赖可静态确定的 watch 数
+    uint32_t dynamic;   // 加入列表时依赖无法确定（每 tick 求值）的 watch 数
+} eez_watch_stats_t;
+
+void eez_flow_get_watch_stats(eez_watch_stats_t *stats);
+
+/**
+ * 通知 flow 原生变量已在原生代码中修改（读取它的 watch 在下一个 tick 重新求值）
+ * @param native_var_id vars.h 中原生变量的编号
+ */
+void eez_flow_native_var_changed(int32_t native_var_id);
+
+#ifdef __cplusplus
+}
+
+#include "eez-flow.h"
+
+namespace eez {
+namespace flow {
+
+/**
+ * 分析表达式读取的槽位
+ * @param depMask 输出依赖掩码
+ * @return 依赖可静态确定返回 true；返回 false 时调用者应每个 tick 都求值
+ */
+bool watchResolveDeps(FlowState *flowState, const uint8_t *instructions, uint64_t *depMask);
+
+/** 槽位（flowState->values / g_globalVariables->values 中的 Value）被写入 */
+void watchMarkDirty(const Value *slot);
+
+/** 写入无法对应到槽位（数组元素等），所有 watch 下个 tick 求值 */
+void watchMarkAllDirty();
+
+/** 原生变量被写入 */
+void watchNativeVariableChanged(int nativeVariableId);
+
+/** visitWatchList 开始：取走上一轮积累的脏集合 */
+void watchVisitBegin();
+
+/**
+ * 依赖掩码是否与脏集合相交（含本轮遍历中新写入的槽位）
+ * 关闭跟踪时总是返回 true
+ */
+bool watchIsDirty(uint64_t depMask);
+
+/** visitWatchList 结束，累计统计 */
+void watchVisitEnd(uint32_t visited, uint32_t evaluated);
+
+/**
+ * 启用 / 关闭依赖跟踪（关闭后每个 tick 求值全部 watch，用于对比）
+ */
+void watchSetTracking(bool enabled);
+
+void watchGetStats(eez_watch_stats_t *stats);
+
+/** 清零 ticks / visited / evaluated（tracked / dynamic 随 watch 加入累计，不清零） */
+void watchResetStats();
+
+} // namespace flow
+} // namespace eez
+
+#endif
@@ -9,6 +9,10 @@ extern "C" {
 
 extern const lv_font_t ui_font_chinese_18;
 
+// 带字形缓存的 ui_font_chinese_18（create_screens 中初始化），页面统一使用 UI_FONT_CHINESE_18
+extern lv_font_t ui_font_chinese_18_cached;
+#define UI_FONT_CHINESE_18 (&ui_font_chinese_18_cached)
+
 
 #ifdef __cplusplus
 }
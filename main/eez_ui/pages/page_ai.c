@@ -8,6 +8,7 @@
 #include "../screens.h"
 #include "../fonts.h"
 #include "../eez-flow.h"
+#include "../ui_bindings.h"
 #include "ai_service.h"
 #include "app_config.h"
 #include "esp_log.h"
@@ -23,6 +24,9 @@ static breathing_light_state_t ai_breathing = {0};
 // AI 超时定时器
 static TimerHandle_t ai_timeout_timer = NULL;
 
+// 已显示的 NATIVE_VAR_AI_STATE 版本
+static uint32_t ai_state_seen = 0;
+
 // AI 按钮原始文本（保存进入 AI 模式前的文本，用于退出时恢复）
 char ai_btn_original_text[32] = "开始";
 
@@ -59,14 +63,22 @@ static void stop_ai_service_cleanup(void) {
  */
 static void stop_ai_and_return_main(void) {
     stop_ai_service_cleanup();
-    // 切换到主界面
-    lv_scr_load(objects.main);
+    // 切换到主界面（主界面可能已被驱逐，经 flow 切换时按需重新创建）
+    eez_flow_set_screen(SCREEN_ID_MAIN, LV_SCR_LOAD_ANIM_NONE, 0, 0);
 }
 
 /**
- * @brief AI 状态变化回调
+ * @brief AI 状态变化回调（AI 服务任务上下文，只发布，不操作 LVGL）
  */
 static void ai_state_callback(cg_ai_state_t new_state, void *user_data) {
+    (void)user_data;
+    ui_bind_set_int(NATIVE_VAR_AI_STATE, new_state);
+}
+
+/**
+ * @brief 在 LVGL 任务中按最新的 AI 状态更新呼吸灯和按钮文本
+ */
+static void ai_apply_state(cg_ai_state_t new_state) {
     ESP_LOGI(TAG, "AI 状态变化: %d", new_state);
     
     // 根据状态控制呼吸灯
@@ -190,7 +202,7 @@ static void event_handler_cb_page_ai_btn_ai_start(lv_event_t *e) {
             ret = cg_ai_service_start();
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "AI 服务启动失败");
-                cg_ai_service_deinit();
+                // 不反初始化：编解码器和 AudioProcessor 保持预热，内存紧张时由回收钩子释放
                 // 恢复按钮文本
                 if (objects.obj2 && ai_btn_original_text[0] != '\0') {
                     lv_label_set_text(objects.obj2, ai_btn_original_text);
@@ -241,7 +253,7 @@ void create_screen_page_ai(void) {
             lv_obj_set_size(obj, 100, 100);
             lv_obj_add_event_cb(obj, event_handler_cb_page_ai_btn_ai_start, LV_EVENT_ALL, flowState);
             lv_obj_set_style_radius(obj, 50, LV_PART_MAIN | LV_STATE_DEFAULT);
-            lv_obj_set_style_text_font(obj, &ui_font_chinese_18, LV_PART_MAIN | LV_STATE_DEFAULT);
+            lv_obj_set_style_text_font(obj, UI_FONT_CHINESE_18, LV_PART_MAIN | LV_STATE_DEFAULT);
             lv_obj_set_style_bg_color(obj, lv_color_hex(0xff2196f3), LV_PART_MAIN | LV_STATE_DEFAULT);
             {
                 lv_obj_t *parent_obj = obj;
@@ -251,7 +263,7 @@ void create_screen_page_ai(void) {
                     lv_obj_set_pos(obj, 0, 0);
                     lv_obj_set_size(obj, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
                     lv_obj_set_style_align(obj, LV_ALIGN_CENTER, LV_PART_MAIN | LV_STATE_DEFAULT);
-                    lv_obj_set_style_text_font(obj, &ui_font_chinese_18, LV_PART_MAIN | LV_STATE_DEFAULT);
+                    lv_obj_set_style_text_font(obj, UI_FONT_CHINESE_18, LV_PART_MAIN | LV_STATE_DEFAULT);
                     lv_label_set_text(obj, "开始");
                 }
             }
@@ -273,12 +285,16 @@ void delete_screen_page_ai(void) {
     objects.page_ai = 0;
     objects.btn_ai_start = 0;
     objects.obj2 = 0;
+    ai_state_seen = 0;
     deletePageFlowState(3);
 }
 
 void tick_screen_page_ai(void) {
     void *flowState = getFlowState(0, 3);
     (void)flowState;
-    // 标签文本由 ai_state_callback() 动态管理，不使用 eez-flow 数据绑定
+    // AI 服务发布新状态后才更新呼吸灯和标签文本（见 ui_bindings.h）
+    if (ui_bind_changed(NATIVE_VAR_AI_STATE, &ai_state_seen)) {
+        ai_apply_state((cg_ai_state_t)ui_bind_get_int(NATIVE_VAR_AI_STATE));
+    }
 }
 
@@ -44,7 +44,7 @@ void create_screen_loading(void) {
             objects.lab_loading = obj;
             lv_obj_set_pos(obj, 55, 65);
             lv_obj_set_size(obj, 250, 50);
-            lv_obj_set_style_text_font(obj, &ui_font_chinese_18, LV_PART_MAIN | LV_STATE_DEFAULT);
+            lv_obj_set_style_text_font(obj, UI_FONT_CHINESE_18, LV_PART_MAIN | LV_STATE_DEFAULT);
             lv_obj_set_style_text_align(obj, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN | LV_STATE_DEFAULT);
             lv_label_set_text(obj, "连接中");
         }
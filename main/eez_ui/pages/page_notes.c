@@ -8,6 +8,7 @@
 #include "../screens.h"
 #include "../fonts.h"
 #include "../eez-flow.h"
+#include "../ui_bindings.h"
 #include "note_service.h"
 #include "esp_log.h"
 #include "esp_timer.h"
@@ -20,6 +21,83 @@ static breathing_light_state_t notes_breathing = {0};
 // 录音开始时间（微秒）
 static int64_t recording_start_time_us = 0;
 
+// 收尾进度标签（上传中 / 生成中 / 已提交）
+static lv_obj_t *notes_status_label = NULL;
+
+// 服务事件：回调在服务任务中发布，tick 中逐个取出事件、按版本更新剩余段数
+static uint32_t notes_event_cursor = 0;
+static uint32_t notes_pending_seen = 0;
+
+static void notes_show_idle(void);
+
+// ============== 服务事件 ==============
+
+/**
+ * @brief 笔记服务事件回调（服务任务上下文）
+ *
+ * 先发布剩余段数再发布事件，LVGL 任务看到新事件时段数已经是对应的值。
+ * 录音会话和收尾会话的事件可能落在同一个 tick 里，事件走队列，不合并
+ */
+static void notes_event_callback(const note_event_info_t *info, void *user_data) {
+    (void)user_data;
+    ui_bind_set_int(NATIVE_VAR_NOTE_PENDING, info->pending);
+    ui_bind_post_int(NATIVE_VAR_NOTE_EVENT, info->event);
+}
+
+static void notes_show_event(int32_t event, int32_t pending) {
+    switch (event) {
+        case NOTE_EVENT_STOPPING:
+            lv_label_set_text(notes_status_label, "正在保存最后一段...");
+            break;
+        case NOTE_EVENT_UPLOADING:
+            lv_label_set_text_fmt(notes_status_label, "上传中，剩余 %d 段", (int)pending);
+            break;
+        case NOTE_EVENT_GENERATING:
+            lv_label_set_text(notes_status_label, "正在生成笔记...");
+            break;
+        case NOTE_EVENT_DONE:
+            lv_label_set_text(notes_status_label, "笔记已提交");
+            break;
+        case NOTE_EVENT_FAILED:
+            lv_label_set_text(notes_status_label, "笔记生成失败");
+            break;
+        case NOTE_EVENT_RECORD_FAILED:
+            // 录音器不可用，服务已结束会话，不再调用 stop_note_recording
+            recording_start_time_us = 0;
+            notes_show_idle();
+            lv_label_set_text(notes_status_label, "录音失败，请稍后重试");
+            break;
+        case NOTE_EVENT_DISCARDED:
+            lv_label_set_text(notes_status_label, "录音不足 1 分钟，未保存");
+            break;
+        default:
+            lv_label_set_text(notes_status_label, "");
+            break;
+    }
+}
+
+/**
+ * @brief 在 LVGL 任务中按顺序处理新事件，显示到状态标签
+ *
+ * 连续的 UPLOADING 事件只有剩余段数变化，没有新事件但段数变化时重新显示最近一次事件
+ */
+static void notes_apply_event(void) {
+    if (notes_status_label == NULL) {
+        return;
+    }
+    bool pending_changed = ui_bind_changed(NATIVE_VAR_NOTE_PENDING, &notes_pending_seen);
+    int32_t pending = ui_bind_get_int(NATIVE_VAR_NOTE_PENDING);
+    int32_t event;
+    bool any = false;
+    while (ui_bind_next_event(NATIVE_VAR_NOTE_EVENT, &notes_event_cursor, &event)) {
+        notes_show_event(event, pending);
+        any = true;
+    }
+    if (!any && pending_changed) {
+        notes_show_event(ui_bind_get_int(NATIVE_VAR_NOTE_EVENT), pending);
+    }
+}
+
 // ============== 录音控制 ==============
 
 /**
@@ -27,10 +105,17 @@ static int64_t recording_start_time_us = 0;
  */
 static void notes_start_recording(void) {
     // 记录开始时间
-    recording_start_time_us = esp_timer_get_time();
     ESP_LOGI(TAG, "开始录音，记录开始时间");
-    
-    start_note_recording();
+    note_service_set_event_callback(notes_event_callback, NULL);
+    if (start_note_recording() != 0) {
+        // flow 已把按钮切到"结束"，没有开始录音时切回空闲
+        notes_show_idle();
+        if (notes_status_label) {
+            lv_label_set_text(notes_status_label, "上一条笔记仍在处理，请稍候");
+        }
+        return;
+    }
+    recording_start_time_us = esp_timer_get_time();
     
     // 隐藏开始按钮，显示结束按钮
     if (objects.btn_notes_start) {
@@ -59,8 +144,15 @@ static void notes_stop_recording_internal(void) {
     recording_start_time_us = 0;
     
     // 停止录音（传入持续时间，由 note_service 判断是否提交数据）
+    // 立即返回，上传和生成笔记的进度通过事件显示在状态标签上
     stop_note_recording(duration_sec);
-    
+    notes_show_idle();
+}
+
+/**
+ * @brief 停止呼吸灯，恢复开始按钮
+ */
+static void notes_show_idle(void) {
     // 停止呼吸灯
     breathing_light_stop(&notes_breathing);
     
@@ -152,7 +244,7 @@ void create_screen_page_notes(void) {
             lv_obj_set_size(obj, 100, 100);
             lv_obj_add_event_cb(obj, event_handler_cb_page_notes_btn_notes_start, LV_EVENT_ALL, flowState);
             lv_obj_set_style_radius(obj, 50, LV_PART_MAIN | LV_STATE_DEFAULT);
-            lv_obj_set_style_text_font(obj, &ui_font_chinese_18, LV_PART_MAIN | LV_STATE_DEFAULT);
+            lv_obj_set_style_text_font(obj, UI_FONT_CHINESE_18, LV_PART_MAIN | LV_STATE_DEFAULT);
             lv_obj_set_style_bg_color(obj, lv_color_hex(0xffc02537), LV_PART_MAIN | LV_STATE_DEFAULT);
             {
                 lv_obj_t *parent_obj = obj;
@@ -161,12 +253,23 @@ void create_screen_page_notes(void) {
                     lv_obj_set_pos(obj, 0, 0);
                     lv_obj_set_size(obj, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
                     lv_obj_set_style_align(obj, LV_ALIGN_CENTER, LV_PART_MAIN | LV_STATE_DEFAULT);
-                    lv_obj_set_style_text_font(obj, &ui_font_chinese_18, LV_PART_MAIN | LV_STATE_DEFAULT);
+                    lv_obj_set_style_text_font(obj, UI_FONT_CHINESE_18, LV_PART_MAIN | LV_STATE_DEFAULT);
                     lv_label_set_text(obj, "开始");
                 }
             }
         }
         
+        // 收尾进度标签（开始按钮下方）
+        {
+            lv_obj_t *obj = lv_label_create(parent_obj);
+            notes_status_label = obj;
+            lv_obj_set_pos(obj, 0, 250);
+            lv_obj_set_size(obj, 360, LV_SIZE_CONTENT);
+            lv_obj_set_style_text_font(obj, UI_FONT_CHINESE_18, LV_PART_MAIN | LV_STATE_DEFAULT);
+            lv_obj_set_style_text_align(obj, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN | LV_STATE_DEFAULT);
+            lv_label_set_text(obj, "");
+        }
+        
         // btn_notes_end - 结束按钮（默认隐藏）
         {
             lv_obj_t *obj = lv_btn_create(parent_obj);
@@ -176,7 +279,7 @@ void create_screen_page_notes(void) {
             lv_obj_add_event_cb(obj, event_handler_cb_page_notes_btn_notes_end, LV_EVENT_ALL, flowState);
             lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
             lv_obj_set_style_radius(obj, 150, LV_PART_MAIN | LV_STATE_DEFAULT);
-            lv_obj_set_style_text_font(obj, &ui_font_chinese_18, LV_PART_MAIN | LV_STATE_DEFAULT);
+            lv_obj_set_style_text_font(obj, UI_FONT_CHINESE_18, LV_PART_MAIN | LV_STATE_DEFAULT);
             lv_obj_set_style_bg_color(obj, lv_color_hex(0xffc02537), LV_PART_MAIN | LV_STATE_DEFAULT);
             {
                 lv_obj_t *parent_obj = obj;
@@ -185,7 +288,7 @@ void create_screen_page_notes(void) {
                     lv_obj_set_pos(obj, 0, 0);
                     lv_obj_set_size(obj, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
                     lv_obj_set_style_align(obj, LV_ALIGN_CENTER, LV_PART_MAIN | LV_STATE_DEFAULT);
-                    lv_obj_set_style_text_font(obj, &ui_font_chinese_18, LV_PART_MAIN | LV_STATE_DEFAULT);
+                    lv_obj_set_style_text_font(obj, UI_FONT_CHINESE_18, LV_PART_MAIN | LV_STATE_DEFAULT);
                     lv_label_set_text(obj, "结束");
                 }
             }
@@ -207,11 +310,15 @@ void delete_screen_page_notes(void) {
     objects.page_notes = 0;
     objects.btn_notes_start = 0;
     objects.btn_notes_end = 0;
+    notes_status_label = NULL;
+    // 事件读取位置保留，不重放旧事件；重建后按段数版本重新显示最近一次事件
+    notes_pending_seen = 0;
     deletePageFlowState(2);
 }
 
 void tick_screen_page_notes(void) {
     void *flowState = getFlowState(0, 2);
     (void)flowState;
+    notes_apply_event();
 }
 
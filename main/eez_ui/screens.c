@@ -5,6 +5,7 @@
  * 职责：
  * - 管理所有屏幕对象（objects_t）
  * - 屏幕创建/删除/tick 函数的注册和调度
+ * - 屏幕按需创建，常驻数量超过上限时按 LRU 驱逐，空闲时预建下一个可能的屏幕
  * - LVGL 主题设置
  * - 屏幕名称和对象名称映射
  * 
@@ -17,10 +18,18 @@
  */
 
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "lvgl.h"
 
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
 #include "screens.h"
+#include "fonts.h"
 #include "eez-flow.h"
+#include "lvgl_cache.h"
+#include "lvgl_font.h"
 
 // 包含各页面头文件
 #include "pages/page_loading.h"
@@ -30,11 +39,27 @@
 
 static const char *TAG = "SCREENS";
 
+// 主机端工具没有 sdkconfig，按固件默认配置
+#ifndef CONFIG_UI_SCREEN_RESIDENT_MAX
+#define CONFIG_UI_SCREEN_RESIDENT_MAX 2
+#endif
+#if !defined(ESP_PLATFORM) || defined(CONFIG_UI_SCREEN_PREWARM)
+#define SCREEN_PREWARM_DEFAULT true
+#else
+#define SCREEN_PREWARM_DEFAULT false
+#endif
+
+// 屏幕加载完成后等这么久再驱逐 / 预建，不占用新屏幕前几帧
+#define SCREEN_MAINTAIN_DELAY_MS 300
+
 // ============== 全局对象 ==============
 
 objects_t objects;
 lv_obj_t *tick_value_change_obj;
 
+// 带字形缓存的中文字体
+lv_font_t ui_font_chinese_18_cached;
+
 
 // ============== 屏幕名称映射 ==============
 
@@ -86,11 +111,232 @@ static tick_screen_func_t tick_screen_funcs[] = {
     tick_screen_page_ai,
 };
 
+// ============== 资源预热 ==============
+
+#define SCREEN_COUNT ((int)(sizeof(create_screen_funcs) / sizeof(create_screen_funcs[0])))
+
+/**
+ * @brief 屏幕根对象（objects_t 前 4 个成员按屏幕索引排列）
+ */
+static lv_obj_t *screen_root(int screen_index) {
+    if (screen_index < 0 || screen_index >= SCREEN_COUNT) {
+        return NULL;
+    }
+    return ((lv_obj_t **)&objects)[screen_index];
+}
+
+// ============== 按需创建与驱逐 ==============
+
+static int s_resident_max = CONFIG_UI_SCREEN_RESIDENT_MAX;
+static bool s_prewarm_enabled = SCREEN_PREWARM_DEFAULT;
+static int8_t s_lru[UI_SCREEN_COUNT];       // 已创建屏幕的索引，最近使用的在前
+static int s_lru_len = 0;
+static int s_last_loaded = -1;               // 最近加载完成的屏幕
+static uint16_t s_transitions[UI_SCREEN_COUNT][UI_SCREEN_COUNT]; // [从][到] 切换次数
+static int64_t s_cold_start_us[UI_SCREEN_COUNT]; // 切换时现场创建的开始时间，0 表示不是现场创建
+static bool s_creating_for_prewarm = false;
+static lv_timer_t *s_maintain_timer = NULL;
+static screens_stats_t s_stats;
+
+// 没有切换记录时的默认预测：loading 之后是 main，子页面都返回 main
+static const int8_t s_default_next[UI_SCREEN_COUNT] = { 1, -1, 1, 1 };
+
+static void lru_remove(int screen_index) {
+    for (int i = 0; i < s_lru_len; i++) {
+        if (s_lru[i] == screen_index) {
+            for (int j = i + 1; j < s_lru_len; j++) {
+                s_lru[j - 1] = s_lru[j];
+            }
+            s_lru_len--;
+            return;
+        }
+    }
+}
+
+/** 把屏幕放到 LRU 的第 pos 位（0 为最近使用） */
+static void lru_insert(int screen_index, int pos) {
+    lru_remove(screen_index);
+    if (pos > s_lru_len) {
+        pos = s_lru_len;
+    }
+    for (int j = s_lru_len; j > pos; j--) {
+        s_lru[j] = s_lru[j - 1];
+    }
+    s_lru[pos] = (int8_t)screen_index;
+    s_lru_len++;
+}
+
+/** 页面有进行中的业务（录音、AI 会话）时不驱逐，删除屏幕会把它们停掉 */
+static bool screen_busy(int screen_index) {
+    switch (screen_index) {
+        case SCREEN_ID_PAGE_NOTES - 1:
+            return page_notes_is_recording();
+        case SCREEN_ID_PAGE_CONF - 1:
+            return page_ai_is_active();
+        default:
+            return false;
+    }
+}
+
+/** 正在显示或参与切换动画的屏幕 */
+static bool screen_in_use(int screen_index) {
+    lv_obj_t *root = screen_root(screen_index);
+    lv_disp_t *disp = lv_disp_get_default();
+    return root == lv_scr_act() || root == disp->scr_to_load || root == disp->prev_scr;
+}
+
+/** 从最久未用的屏幕开始删除，直到常驻数量不超过上限 */
+static void evict_screens(void) {
+    for (int i = s_lru_len - 1; i >= 0 && s_lru_len > s_resident_max; i--) {
+        int victim = s_lru[i];
+        if (screen_in_use(victim) || screen_busy(victim)) {
+            continue;
+        }
+        ESP_LOGI(TAG, "驱逐屏幕 %d（常驻 %d / 上限 %d）", victim, s_lru_len, s_resident_max);
+        delete_screen(victim);
+        s_stats.screens[victim].evictions++;
+    }
+}
+
+/** 当前屏幕之后最可能打开的屏幕：切换次数最多的目标，没有记录时用默认表 */
+static int predict_next(int screen_index) {
+    int best = -1;
+    uint16_t best_count = 0;
+    for (int to = 0; to < SCREEN_COUNT; to++) {
+        if (to != screen_index && s_transitions[screen_index][to] > best_count) {
+            best = to;
+            best_count = s_transitions[screen_index][to];
+        }
+    }
+    return best >= 0 ? best : s_default_next[screen_index];
+}
+
+/** 在空闲时创建预测的下一个屏幕并预热字形 / 图片缓存，切换时直接命中 */
+static void prewarm_next(int current) {
+    if (!s_prewarm_enabled || s_resident_max < 2 || current < 0) {
+        return;
+    }
+    int next = predict_next(current);
+    if (next < 0 || screen_root(next)) {
+        return;
+    }
+    s_creating_for_prewarm = true;
+    create_screen(next);
+    s_creating_for_prewarm = false;
+    lv_obj_t *root = screen_root(next);
+    if (root) {
+        lvgl_cache_prewarm_obj(root);
+        lru_insert(next, 1);
+        s_stats.screens[next].prewarms++;
+        ESP_LOGI(TAG, "预建屏幕 %d（当前 %d）", next, current);
+    }
+}
+
+static void maintain_timer_cb(lv_timer_t *timer) {
+    lv_timer_pause(timer);
+    // 预建放在驱逐之前：预建的屏幕排在第二位，驱逐的是更久未用的
+    prewarm_next(s_last_loaded);
+    evict_screens();
+}
+
+static void schedule_maintain(void) {
+    if (s_maintain_timer == NULL) {
+        s_maintain_timer = lv_timer_create(maintain_timer_cb, SCREEN_MAINTAIN_DELAY_MS, NULL);
+    }
+    lv_timer_reset(s_maintain_timer);
+    lv_timer_resume(s_maintain_timer);
+}
+
+/**
+ * @brief 屏幕开始加载时预热（覆盖 flow 内部触发的切换），加载完成后更新 LRU
+ */
+static void screen_load_event_cb(lv_event_t *e) {
+    int screen_index = (int)(intptr_t)lv_event_get_user_data(e);
+    screen_stats_t *st = &s_stats.screens[screen_index];
+
+    if (lv_event_get_code(e) == LV_EVENT_SCREEN_LOAD_START) {
+        // 首帧前的准备：现场创建（如果有）+ 缓存预热
+        int64_t start = s_cold_start_us[screen_index] ? s_cold_start_us[screen_index] : esp_timer_get_time();
+        lvgl_cache_prewarm_obj(lv_event_get_target(e));
+        uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+        if (s_cold_start_us[screen_index]) {
+            st->cold_shows++;
+            s_cold_start_us[screen_index] = 0;
+        }
+        st->show_prep_us_last = us;
+        if (us > st->show_prep_us_max) {
+            st->show_prep_us_max = us;
+        }
+    } else if (lv_event_get_code(e) == LV_EVENT_SCREEN_LOADED) {
+        st->shows++;
+        if (s_last_loaded >= 0 && s_last_loaded != screen_index &&
+            s_transitions[s_last_loaded][screen_index] < UINT16_MAX) {
+            s_transitions[s_last_loaded][screen_index]++;
+        }
+        s_last_loaded = screen_index;
+        lru_insert(screen_index, 0);
+        schedule_maintain();
+    }
+}
+
+static void attach_prewarm(int screen_index) {
+    lv_obj_t *root = screen_root(screen_index);
+    if (root) {
+        lv_obj_add_event_cb(root, screen_load_event_cb, LV_EVENT_SCREEN_LOAD_START, (void *)(intptr_t)screen_index);
+        lv_obj_add_event_cb(root, screen_load_event_cb, LV_EVENT_SCREEN_LOADED, (void *)(intptr_t)screen_index);
+    }
+}
+
+void screens_set_resident_max(int max) {
+    s_resident_max = max < 1 ? 1 : max;
+    if (s_resident_max > SCREEN_COUNT) {
+        s_resident_max = SCREEN_COUNT;
+    }
+}
+
+void screens_set_prewarm(bool enabled) {
+    s_prewarm_enabled = enabled;
+}
+
+void screens_get_stats(screens_stats_t *stats) {
+    *stats = s_stats;
+    stats->resident = s_lru_len;
+    stats->resident_max = s_resident_max;
+}
+
+void prewarm_screen(int screen_index) {
+    lv_obj_t *root = screen_root(screen_index);
+    if (root) {
+        uint32_t loads = lvgl_cache_prewarm_obj(root);
+        ESP_LOGI(TAG, "屏幕 %d 预热完成，新装入 %lu 个缓存条目", screen_index, (unsigned long)loads);
+    }
+}
+
+void prewarm_screen_by_id(enum ScreensEnum screenId) {
+    prewarm_screen(screenId - 1);
+}
+
 // ============== 屏幕管理接口 ==============
 
 void create_screen(int screen_index) {
-    if (screen_index >= 0 && screen_index < (int)(sizeof(create_screen_funcs) / sizeof(create_screen_funcs[0]))) {
+    if (screen_index >= 0 && screen_index < SCREEN_COUNT && !screen_root(screen_index)) {
+        int64_t start = esp_timer_get_time();
         create_screen_funcs[screen_index]();
+        attach_prewarm(screen_index);
+        uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+
+        screen_stats_t *st = &s_stats.screens[screen_index];
+        st->creates++;
+        st->create_us_last = us;
+        if (us > st->create_us_max) {
+            st->create_us_max = us;
+        }
+        // flow 切换时现场创建（非预建）：首帧准备时间从这里算起，加载完成后移到 LRU 最前
+        // 预建的位置由 prewarm_next 决定
+        if (!s_creating_for_prewarm) {
+            s_cold_start_us[screen_index] = start;
+            lru_insert(screen_index, s_lru_len);
+        }
     }
 }
 
@@ -99,8 +345,10 @@ void create_screen_by_id(enum ScreensEnum screenId) {
 }
 
 void delete_screen(int screen_index) {
-    if (screen_index >= 0 && screen_index < (int)(sizeof(delete_screen_funcs) / sizeof(delete_screen_funcs[0]))) {
+    if (screen_index >= 0 && screen_index < SCREEN_COUNT && screen_root(screen_index)) {
         delete_screen_funcs[screen_index]();
+        lru_remove(screen_index);
+        s_cold_start_us[screen_index] = 0;
     }
 }
 
@@ -118,10 +366,10 @@ void tick_screen_by_id(enum ScreensEnum screenId) {
     tick_screen(screenId - 1);
 }
 
-// ============== 初始化所有屏幕 ==============
+// ============== 初始化屏幕 ==============
 
 /**
- * @brief 创建所有屏幕
+ * @brief 注册屏幕管理函数并创建启动屏幕
  * 
  * 在 ui_init 中由 eez_flow_init 调用
  * 
@@ -129,7 +377,7 @@ void tick_screen_by_id(enum ScreensEnum screenId) {
  * 1. 初始化屏幕名称和对象名称映射
  * 2. 注册屏幕创建和删除函数
  * 3. 设置 LVGL 主题
- * 4. 创建所有屏幕对象（但不加载显示）
+ * 4. 创建 loading 屏幕（常驻上限不小于屏幕数时创建所有屏幕），但不加载显示
  * 
  * 屏幕索引映射：
  * - screen_names[0] = "loading"    -> SCREEN_ID_LOADING = 1
@@ -139,7 +387,7 @@ void tick_screen_by_id(enum ScreensEnum screenId) {
  */
 void create_screens(void) {
     ESP_LOGI(TAG, "========================================");
-    ESP_LOGI(TAG, "开始创建所有屏幕...");
+    ESP_LOGI(TAG, "开始初始化屏幕...");
     
     // 初始化屏幕名称映射
     eez_flow_init_screen_names(screen_names, sizeof(screen_names) / sizeof(const char *));
@@ -166,18 +414,34 @@ void create_screens(void) {
     lv_disp_set_theme(dispp, theme);
     ESP_LOGI(TAG, "LVGL 主题已设置");
     
-    // 创建所有屏幕对象
-    ESP_LOGI(TAG, "开始创建各个屏幕对象...");
+    // 中文字体：优先使用 font 分区里的字体按需光栅化，分区为空时包装内置字库，字形都经 PSRAM 缓存
+    if (lvgl_font_create(&ui_font_chinese_18_cached, 18)) {
+        ui_font_chinese_18_cached.fallback = &ui_font_chinese_18; // 分区字体缺字时用内置字库补
+    } else {
+        lvgl_cache_font_init(&ui_font_chinese_18_cached, &ui_font_chinese_18);
+    }
+    
+    // 启动时只创建 loading（eez_flow_init 随后加载它），其余屏幕在 flow 切换到它时
+    // 由 replacePageHook 调用 create_screen 创建；常驻上限不小于屏幕数时保持原来的全部预先创建
+    ESP_LOGI(TAG, "开始创建屏幕对象（常驻上限 %d / %d）...", s_resident_max, SCREEN_COUNT);
+    int64_t start = esp_timer_get_time();
     
-    create_screen_loading();    // 屏幕ID=1, 索引=0
-    create_screen_main();       // 屏幕ID=2, 索引=1
-    create_screen_page_notes(); // 屏幕ID=3, 索引=2
-    create_screen_page_ai();    // 屏幕ID=4, 索引=3
+    create_screen(0); // loading,    屏幕ID=1
+    if (s_resident_max >= SCREEN_COUNT) {
+        create_screen(1); // main,       屏幕ID=2
+        create_screen(2); // page_notes, 屏幕ID=3
+        create_screen(3); // page_ai,    屏幕ID=4
+    }
+    // 启动时创建的不算切换时的现场创建
+    for (int i = 0; i < SCREEN_COUNT; i++) {
+        s_cold_start_us[i] = 0;
+    }
+    s_stats.boot_create_us = (uint32_t)(esp_timer_get_time() - start);
     
-    ESP_LOGI(TAG, "✓ 所有屏幕创建完成");
+    ESP_LOGI(TAG, "✓ 启动屏幕创建完成，耗时 %lu us", (unsigned long)s_stats.boot_create_us);
     ESP_LOGI(TAG, "屏幕对象验证:");
     ESP_LOGI(TAG, "  - loading:    %p", (void*)objects.loading);
-    ESP_LOGI(TAG, "  - main:       %p (WiFi 连接后切换目标)", (void*)objects.main);
+    ESP_LOGI(TAG, "  - main:       %p (WiFi 连接后切换目标，未创建时在 loading 加载后预建)", (void*)objects.main);
     ESP_LOGI(TAG, "  - page_notes: %p", (void*)objects.page_notes);
     ESP_LOGI(TAG, "  - page_ai:    %p", (void*)objects.page_ai);
     ESP_LOGI(TAG, "========================================");
@@ -67,6 +67,8 @@ enum ScreensEnum {
   SCREEN_ID_PAGE_CONF = 4,  // AI 对话屏幕（保持原命名兼容）
 };
 
+#define UI_SCREEN_COUNT 4
+
 // ============== 屏幕管理接口 ==============
 
 // 各页面的创建/删除/tick 函数声明
@@ -100,7 +102,61 @@ void delete_screen_by_id(enum ScreensEnum screenId);
 void tick_screen(int screen_index);
 void tick_screen_by_id(enum ScreensEnum screenId);
 
-// 初始化所有屏幕
+/**
+ * @brief 预热屏幕用到的字形和图片，首帧渲染无需解码
+ * 屏幕加载开始时会自动预热；在 eez_flow_set_screen 之前显式调用可把这部分
+ * 开销挪到切换之前
+ */
+void prewarm_screen(int screen_index);
+void prewarm_screen_by_id(enum ScreensEnum screenId);
+
+// ============== 按需创建与驱逐 ==============
+
+/**
+ * @brief 单个屏幕的统计
+ *
+ * show_prep_us 是切换到该屏幕时首帧之前的同步开销：现场创建（屏幕未常驻时）+ 字形 / 图片缓存预热，
+ * 从 flow 请求切换（replacePageHook 调用 create_screen）或 SCREEN_LOAD_START 算起
+ */
+typedef struct {
+  uint32_t creates;           // 创建次数（含预建）
+  uint32_t prewarms;          // 其中空闲时预建的次数
+  uint32_t evictions;         // 被驱逐次数
+  uint32_t shows;             // 加载完成次数
+  uint32_t cold_shows;        // 其中切换时才现场创建的次数
+  uint32_t create_us_last;    // 最近一次创建耗时
+  uint32_t create_us_max;
+  uint32_t show_prep_us_last; // 最近一次首帧前准备耗时
+  uint32_t show_prep_us_max;
+} screen_stats_t;
+
+typedef struct {
+  uint32_t boot_create_us; // create_screens 中创建屏幕的耗时
+  int resident;            // 当前常驻屏幕数
+  int resident_max;        // 常驻上限
+  screen_stats_t screens[UI_SCREEN_COUNT];
+} screens_stats_t;
+
+/**
+ * @brief 设置常驻屏幕上限（默认 CONFIG_UI_SCREEN_RESIDENT_MAX）
+ *
+ * 屏幕加载完成后稍等片刻，从最久未使用的开始删除，直到不超过上限；
+ * 正在显示、参与切换动画或有进行中业务（录音、AI 会话）的屏幕不删除。
+ * 上限不小于屏幕数时，create_screens 在启动时创建所有屏幕（原行为）。需在 ui_init 之前调用。
+ */
+void screens_set_resident_max(int max);
+
+/**
+ * @brief 是否在空闲时预建下一个可能的屏幕（默认 CONFIG_UI_SCREEN_PREWARM）
+ *
+ * 预测取该屏幕之后切换次数最多的目标，没有记录时 loading 和子页面之后是 main。
+ * 常驻上限为 1 时不预建。
+ */
+void screens_set_prewarm(bool enabled);
+
+void screens_get_stats(screens_stats_t *stats);
+
+// 注册屏幕管理函数，创建启动屏幕
 void create_screens(void);
 
 #ifdef __cplusplus
@@ -3,10 +3,13 @@
 #endif
 
 #include "ui.h"
+#include "eez_assets.h"
+#include "eez_flow_aot.h"
 #include "screens.h"
 #include "images.h"
 #include "actions.h"
 #include "vars.h"
+#include "ui_bindings.h"
 #include "wifi_service.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
@@ -175,6 +178,11 @@ const uint8_t assets[2480] = {
 
 native_var_t native_vars[] = {
     { NATIVE_VAR_TYPE_NONE, 0, 0 },
+    { NATIVE_VAR_TYPE_INTEGER, get_var_wifi_state, set_var_wifi_state },
+    { NATIVE_VAR_TYPE_INTEGER, get_var_ai_state, set_var_ai_state },
+    { NATIVE_VAR_TYPE_INTEGER, get_var_battery_mv, set_var_battery_mv },
+    { NATIVE_VAR_TYPE_INTEGER, get_var_note_event, set_var_note_event },
+    { NATIVE_VAR_TYPE_INTEGER, get_var_note_pending, set_var_note_pending },
 };
 
 
@@ -188,11 +196,8 @@ ActionExecFunc actions[] = {
 // WiFi连接检查和屏幕切换相关变量
 // ============================================================================
 static bool wifi_check_started = false;      // WiFi检查是否已启动（在ui_init中设置为true）
-static int wifi_check_timeout = 0;           // WiFi检查超时计数器（每次ui_tick递增）
-#define WIFI_CHECK_TIMEOUT_SEC 300            // WiFi检查超时时间（秒）- 仅用于初始化完成后的连接超时
-                                             // 注意：ui_tick每5ms调用一次，所以超时计数 = 30 * 200 = 6000
-#define WIFI_INIT_TIMEOUT_SEC 600            // WiFi初始化超时时间（秒）- 用于等待WiFi初始化完成
-                                             // 注意：如果WiFi还在初始化中，应该继续等待，而不是超时停止
+static uint32_t wifi_state_seen = 0;         // 已处理的 NATIVE_VAR_WIFI_STATE 版本
+static int last_ticked_screen = -1;          // 上次调用tick函数的屏幕索引
 
 static bool screen_switch_pending = false;  // 标记屏幕切换是否待处理（用于验证切换是否成功）
 static int screen_switch_verify_count = 0;  // 屏幕切换验证计数（最多验证20次，约100ms）
@@ -207,8 +212,16 @@ static int screen_switch_verify_count = 0;  // 屏幕切换验证计数（最多
 //   2. objects_t结构体包含: loading, main, page_notes, page_conf, btn_notes, obj0, 
 //      btn_notes_start, btn_notes_end, btn_ai_start, obj1, lab_loading, obj2
 //      共12个对象
-//   3. eez_flow_init会调用create_screens()创建所有屏幕，并默认加载loading屏幕（ID=1）
+//   3. eez_flow_init会调用create_screens()创建并加载loading屏幕（ID=1），其余屏幕按需创建
 //   4. wifi_check_started设置为true，开始WiFi连接检查
+//   5. 注册WiFi状态回调，状态变化时发布到 NATIVE_VAR_WIFI_STATE（见 ui_bindings.h）
+
+// WiFi状态回调（WiFi任务 / 系统事件任务中调用，只发布，不操作LVGL）
+static void ui_wifi_state_callback(wifi_link_state_t state, void *user_data) {
+    (void)user_data;
+    ui_bind_set_int(NATIVE_VAR_WIFI_STATE, state);
+}
+
 void ui_init() {
     // 计算objects结构体中对象的数量（所有lv_obj_t*成员的数量）
     // objects_t结构体包含: loading, main, page_notes, page_conf, btn_notes, obj0, 
@@ -218,13 +231,22 @@ void ui_init() {
     ESP_LOGI("UI", "[ui_init] 初始化UI系统");
     ESP_LOGI("UI", "[ui_init] 对象数量: %zu (期望: 12)", num_objects);
     
+    // 选择资源：eez_assets 分区（映射后原地使用）或内置 assets，见 eez_assets.h
+    eez_assets_init(assets, sizeof(assets));
+
     // 初始化EEZ Flow系统
-    // 注意：eez_flow_init内部会调用create_screens()创建所有屏幕，并默认加载loading屏幕
-    eez_flow_init(assets, sizeof(assets), (lv_obj_t **)&objects, num_objects, images, sizeof(images), actions);
+    // 注意：eez_flow_init内部会调用create_screens()创建loading屏幕并加载，其余屏幕按需创建（见 screens.h）
+    eez_flow_init(eez_assets_data(), eez_assets_size(), (lv_obj_t **)&objects, num_objects, images, sizeof(images), actions);
+
+    // 启用预编译的 flow 连线（资源与 eez_flow_aot_gen.c 一致时），见 eez_flow_aot.h
+    eez_flow_aot_init(eez_assets_data(), eez_assets_size());
     
     // 启动WiFi连接检查
     wifi_check_started = true;
-    wifi_check_timeout = 0;
+    wifi_state_seen = 0;
+    last_ticked_screen = -1;
+    // 注册时立即发布一次当前状态，WiFi在UI初始化前已连上也不会漏掉
+    WiFi_SetStateCallback(ui_wifi_state_callback, NULL);
     ESP_LOGI("UI", "[ui_init] WiFi检查已启动，当前屏幕ID: %d (期望: %d=LOADING)", 
              eez_flow_get_current_screen(), SCREEN_ID_LOADING);
 }
@@ -235,19 +257,18 @@ void ui_init() {
 // 功能：
 //   1. 执行EEZ Flow的tick处理
 //   2. 检查屏幕切换是否成功（如果待处理）
-//   3. 在loading屏幕时检查WiFi连接状态
-//   4. WiFi连接成功后切换到main屏幕
-//   5. 调用当前屏幕的tick函数
+//   3. 处理服务发布的状态变化（ui_bindings_dispatch）
+//   4. WiFi状态变化时更新loading屏幕，连接成功后切换到main屏幕
+//   5. 有状态变化或屏幕切换时调用当前屏幕的tick函数
 // 
 // 执行流程：
 //   [1] eez_flow_tick() - 处理EEZ Flow内部逻辑
 //   [2] 如果屏幕切换待处理，验证切换是否成功
-//   [3] 如果当前在loading屏幕且WiFi检查已启动：
-//       - 递增超时计数器
-//       - 检查WiFi连接状态
-//       - 如果WiFi已连接：切换到main屏幕
-//       - 如果超时：显示错误信息并停止检查
-//   [4] tick_screen() - 调用当前屏幕的tick函数
+//   [3] ui_bindings_dispatch() - 没有发布时直接返回，不再每次轮询服务
+//   [4] 如果 NATIVE_VAR_WIFI_STATE 有新版本且当前在loading屏幕：
+//       - 已连接：切换到main屏幕
+//       - 全部失败：显示错误信息
+//   [5] tick_screen() - 只在有变化或刚切换屏幕时调用
 void ui_tick() {
     // ========================================================================
     // 步骤1: 执行EEZ Flow的tick处理
@@ -286,22 +307,23 @@ void ui_tick() {
     }
     
     // ========================================================================
-    // 步骤3: 如果当前在加载界面，检查WiFi状态
+    // 步骤3: 处理服务发布的状态变化
     // ========================================================================
-    int16_t current_screen_id = eez_flow_get_current_screen();
+    // 没有任何发布时只比较一个序号；有变化时通知flow重新求值读取原生变量的watch
+    bool bindings_changed = ui_bindings_dispatch();
     
-    // 条件检查：当前屏幕必须是loading屏幕，且WiFi检查已启动
-    if (current_screen_id == SCREEN_ID_LOADING && wifi_check_started) {
-        
-        // 检查WiFi连接状态
-        // 注意：WiFi_IsConnected()直接返回事件处理函数中设置的wifi_connected变量
-        bool wifi_connected = WiFi_IsConnected();
-        const char *error_msg = WiFi_GetError();
+    // ========================================================================
+    // 步骤4: WiFi状态变化时更新加载界面
+    // ========================================================================
+    // 状态由WiFi服务在事件中发布（见 ui_wifi_state_callback），这里不再轮询
+    if (bindings_changed && ui_bind_changed(NATIVE_VAR_WIFI_STATE, &wifi_state_seen) &&
+        eez_flow_get_current_screen() == SCREEN_ID_LOADING && wifi_check_started) {
+        wifi_link_state_t wifi_state = (wifi_link_state_t)ui_bind_get_int(NATIVE_VAR_WIFI_STATE);
         
         // ====================================================================
         // 情况1: WiFi连接成功，切换到主界面
         // ====================================================================
-        if (wifi_connected) {
+        if (wifi_state == WIFI_LINK_CONNECTED) {
             ESP_LOGI("UI", "[ui_tick] ========================================");
             ESP_LOGI("UI", "[ui_tick] WiFi连接成功！准备切换到主界面");
             
@@ -314,13 +336,11 @@ void ui_tick() {
             wifi_check_started = false;
             ESP_LOGI("UI", "[ui_tick] WiFi检查已停止");
             
-            // 验证主界面对象是否存在
+            // 主界面通常已在 loading 加载后预建（见 screens_set_prewarm），否则在切换时创建
             if (objects.main == NULL) {
-                ESP_LOGW("UI", "[ui_tick] ⚠️  警告：主界面对象未创建！");
-                ESP_LOGW("UI", "[ui_tick] 主界面应该已经在 create_screens() 中创建");
-                ESP_LOGW("UI", "[ui_tick] 这可能表示屏幕创建失败或对象索引错误");
+                ESP_LOGI("UI", "[ui_tick] 主界面尚未创建，将在切换时创建");
             } else {
-                ESP_LOGI("UI", "[ui_tick] ✓ 主界面对象已创建，指针: %p", (void*)objects.main);
+                ESP_LOGI("UI", "[ui_tick] ✓ 主界面已预建，指针: %p", (void*)objects.main);
             }
             
             // 调用屏幕切换函数
@@ -328,6 +348,9 @@ void ui_tick() {
             //   1. 调用replacePageHook(screenId, ...)
             //   2. replacePageHook会调用createScreen确保屏幕已创建
             //   3. 使用lv_scr_load_anim加载屏幕
+            // 切换前预热主界面字形，首帧直接命中缓存（未创建时在加载开始时预热）
+            prewarm_screen_by_id(SCREEN_ID_MAIN);
+            
             ESP_LOGI("UI", "[ui_tick] 调用 eez_flow_set_screen(%d, ...)", SCREEN_ID_MAIN);
             eez_flow_set_screen(SCREEN_ID_MAIN, LV_SCR_LOAD_ANIM_NONE, 0, 0);
             
@@ -338,19 +361,27 @@ void ui_tick() {
             ESP_LOGI("UI", "[ui_tick] ========================================");
             
         // ====================================================================
-        // 情况2: 检查WiFi连接超时
+        // 情况2: 所有配置的网络都连接失败，显示原因（WiFi任务已结束，不会再重试）
         // ====================================================================
-        // 重要：需要区分两种情况：
-        //   a) WiFi还在初始化中 - 应该继续等待（使用更长的超时时间60秒）
-        //   b) WiFi初始化完成但连接失败 - 应该超时停止（使用较短的超时时间30秒）
-        } 
+        } else if (wifi_state == WIFI_LINK_FAILED) {
+            const char *error_msg = WiFi_GetError();
+            ESP_LOGW("UI", "[ui_tick] WiFi连接失败: %s", error_msg ? error_msg : "");
+            if (objects.lab_loading != NULL && error_msg != NULL) {
+                lv_label_set_text(objects.lab_loading, error_msg);
+            }
+        }
     }
     
     // ========================================================================
-    // 步骤4: 调用当前屏幕的tick函数
+    // 步骤5: 调用当前屏幕的tick函数
     // ========================================================================
     // 注意：g_currentScreen是eez-flow.cpp中的全局变量，表示当前屏幕索引（0-based）
     // 屏幕ID是1-based（SCREEN_ID_LOADING=1, SCREEN_ID_MAIN=2, ...）
     // 屏幕索引是0-based（loading=0, main=1, ...）
+    // tick函数只根据绑定版本更新控件，状态没变且屏幕没切换时无事可做
+    if (!bindings_changed && g_currentScreen == last_ticked_screen) {
+        return;
+    }
+    last_ticked_screen = g_currentScreen;
     tick_screen(g_currentScreen);
 }
@@ -0,0 +1,209 @@
+/**
+ * @file ui_bindings.c
+ * @brief 服务状态到 EEZ 原生变量的绑定，说明见 ui_bindings.h
+ */
+
+#include "ui_bindings.h"
+#include "eez_watch.h"
+#include "freertos/FreeRTOS.h"
+
+typedef struct {
+    int32_t value;
+    uint32_t version;
+} ui_bind_slot_t;
+
+// 发布来自 WiFi 事件任务、AI / 笔记服务任务和驱动任务，读取在 LVGL 任务
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static ui_bind_slot_t s_slots[NATIVE_VAR_COUNT] = {
+    [NATIVE_VAR_NOTE_EVENT] = { .value = -1 },
+};
+typedef struct {
+    uint32_t seq;
+    int32_t id;
+    int32_t value;
+} ui_bind_event_t;
+
+static ui_bind_event_t s_events[UI_BIND_EVENT_QUEUE_LEN];
+static uint32_t s_event_seq = 0;        // 最后一个事件的序号，从 1 开始
+static uint32_t s_seq = 0;              // 任意变量变化时加一
+static uint32_t s_dispatched_seq = 0;   // 上次 dispatch 看到的 s_seq
+static uint32_t s_flow_seen[NATIVE_VAR_COUNT]; // 已通知 flow 的版本
+static ui_bind_stats_t s_stats;
+
+static bool valid_id(int32_t id) {
+    return id > NATIVE_VAR_NONE && id < NATIVE_VAR_COUNT;
+}
+
+// ============== 发布 ==============
+
+void ui_bind_set_int(int32_t id, int32_t value) {
+    if (!valid_id(id)) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    if (s_slots[id].version != 0 && s_slots[id].value == value) {
+        s_stats.unchanged++;
+    } else {
+        s_slots[id].value = value;
+        s_slots[id].version++;
+        s_seq++;
+        s_stats.published++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void ui_bind_post_int(int32_t id, int32_t value) {
+    if (!valid_id(id)) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    s_event_seq++;
+    ui_bind_event_t *event = &s_events[s_event_seq % UI_BIND_EVENT_QUEUE_LEN];
+    event->seq = s_event_seq;
+    event->id = id;
+    event->value = value;
+    s_slots[id].value = value;
+    s_slots[id].version++;
+    s_seq++;
+    s_stats.published++;
+    s_stats.events++;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void ui_bind_set_bool(int32_t id, bool value) {
+    ui_bind_set_int(id, value ? 1 : 0);
+}
+
+// ============== 读取 ==============
+
+int32_t ui_bind_get_int(int32_t id) {
+    if (!valid_id(id)) {
+        return 0;
+    }
+    portENTER_CRITICAL(&s_lock);
+    int32_t value = s_slots[id].value;
+    portEXIT_CRITICAL(&s_lock);
+    return value;
+}
+
+bool ui_bind_get_bool(int32_t id) {
+    return ui_bind_get_int(id) != 0;
+}
+
+uint32_t ui_bind_version(int32_t id) {
+    if (!valid_id(id)) {
+        return 0;
+    }
+    portENTER_CRITICAL(&s_lock);
+    uint32_t version = s_slots[id].version;
+    portEXIT_CRITICAL(&s_lock);
+    return version;
+}
+
+bool ui_bind_changed(int32_t id, uint32_t *seen) {
+    uint32_t version = ui_bind_version(id);
+    if (version == *seen) {
+        return false;
+    }
+    *seen = version;
+    return true;
+}
+
+bool ui_bind_next_event(int32_t id, uint32_t *cursor, int32_t *value) {
+    bool found = false;
+    portENTER_CRITICAL(&s_lock);
+    if (s_event_seq - *cursor > UI_BIND_EVENT_QUEUE_LEN) {
+        // 落后太多，最早的事件已被覆盖
+        s_stats.events_lost += s_event_seq - *cursor - UI_BIND_EVENT_QUEUE_LEN;
+        *cursor = s_event_seq - UI_BIND_EVENT_QUEUE_LEN;
+    }
+    while (*cursor != s_event_seq) {
+        (*cursor)++;
+        const ui_bind_event_t *event = &s_events[*cursor % UI_BIND_EVENT_QUEUE_LEN];
+        if (event->id == id) {
+            *value = event->value;
+            found = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return found;
+}
+
+// ============== 分发 ==============
+
+bool ui_bindings_dispatch(void) {
+    uint32_t versions[NATIVE_VAR_COUNT];
+
+    portENTER_CRITICAL(&s_lock);
+    uint32_t seq = s_seq;
+    if (seq != s_dispatched_seq) {
+        for (int i = 0; i < NATIVE_VAR_COUNT; i++) {
+            versions[i] = s_slots[i].version;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (seq == s_dispatched_seq) {
+        s_stats.idle++;
+        return false;
+    }
+    s_dispatched_seq = seq;
+    s_stats.dispatches++;
+
+    for (int i = NATIVE_VAR_NONE + 1; i < NATIVE_VAR_COUNT; i++) {
+        if (versions[i] != s_flow_seen[i]) {
+            s_flow_seen[i] = versions[i];
+            eez_flow_native_var_changed(i);
+        }
+    }
+    return true;
+}
+
+void ui_bindings_get_stats(ui_bind_stats_t *stats) {
+    portENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+// ============== EEZ 原生变量（vars.h） ==============
+
+int32_t get_var_wifi_state() {
+    return ui_bind_get_int(NATIVE_VAR_WIFI_STATE);
+}
+
+void set_var_wifi_state(int32_t value) {
+    ui_bind_set_int(NATIVE_VAR_WIFI_STATE, value);
+}
+
+int32_t get_var_ai_state() {
+    return ui_bind_get_int(NATIVE_VAR_AI_STATE);
+}
+
+void set_var_ai_state(int32_t value) {
+    ui_bind_set_int(NATIVE_VAR_AI_STATE, value);
+}
+
+int32_t get_var_battery_mv() {
+    return ui_bind_get_int(NATIVE_VAR_BATTERY_MV);
+}
+
+void set_var_battery_mv(int32_t value) {
+    ui_bind_set_int(NATIVE_VAR_BATTERY_MV, value);
+}
+
+int32_t get_var_note_event() {
+    return ui_bind_get_int(NATIVE_VAR_NOTE_EVENT);
+}
+
+void set_var_note_event(int32_t value) {
+    ui_bind_post_int(NATIVE_VAR_NOTE_EVENT, value);
+}
+
+int32_t get_var_note_pending() {
+    return ui_bind_get_int(NATIVE_VAR_NOTE_PENDING);
+}
+
+void set_var_note_pending(int32_t value) {
+    ui_bind_set_int(NATIVE_VAR_NOTE_PENDING, value);
+}
@@ -0,0 +1,93 @@
+/**
+ * @file ui_bindings.h
+ * @brief 服务状态到 EEZ 原生变量的绑定
+ *
+ * 原实现里界面状态各走各的路：ui_tick 在 loading 屏幕每次调用都轮询 WiFi_IsConnected() / WiFi_GetError()，
+ * AI 状态回调在服务任务里直接改 LVGL 对象，笔记页面自己维护事件序号，tick_screen_* 每轮主循环都调用。
+ *
+ * 这里统一成一条路径：
+ * - 服务（或 main.cpp / 页面注册给服务的回调）在任意任务中调用 ui_bind_set_*() 发布值，
+ *   值不变时什么都不做，变化时该变量的版本号加一
+ * - ui_tick 开头调用 ui_bindings_dispatch()：没有任何发布时只比较一个序号就返回；
+ *   有变化时通知 flow（eez_flow_native_var_changed，读取该变量的 watch 下个 tick 重新求值），
+ *   再调用当前屏幕的 tick_screen_*
+ * - tick_screen_* 用 ui_bind_changed() 比较自己看过的版本，只在变化时读值、更新控件
+ *
+ * 变量编号与 vars.h 中的 enum NativeVars 相同，flow 表达式通过 get_var_*() 读取同一份值。
+ * 版本号只在 LVGL 任务中比较；两次 dispatch 之间的多次发布合并为最后一次的值（版本号仍各加一）。
+ *
+ * 离散事件（笔记服务事件等）不能合并：两个会话的事件可能落在同一个 tick 里，后一个会覆盖前一个。
+ * 这类变量用 ui_bind_post_int() 发布，除更新值外还按顺序记入事件队列，
+ * 页面用 ui_bind_next_event() 逐个取出；变量本身（flow 读取的值）仍是最后一次的事件。
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "vars.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 绑定统计 */
+typedef struct {
+    uint32_t published;  // 值发生变化的发布次数
+    uint32_t unchanged;  // 值与当前相同、被忽略的发布次数
+    uint32_t dispatches; // ui_bindings_dispatch 发现变化的次数
+    uint32_t idle;       // ui_bindings_dispatch 没有变化、直接返回的次数
+    uint32_t events;     // ui_bind_post_int 发布的事件数
+    uint32_t events_lost; // 读取方落后超过队列长度、被覆盖的事件数
+} ui_bind_stats_t;
+
+#ifndef UI_BIND_EVENT_QUEUE_LEN
+#define UI_BIND_EVENT_QUEUE_LEN 16 // 事件队列长度（所有事件变量共用）
+#endif
+
+/**
+ * 发布整数值（任意任务）
+ * @param id enum NativeVars 中的编号
+ */
+void ui_bind_set_int(int32_t id, int32_t value);
+
+/**
+ * 发布离散事件（任意任务）：相同的值也发布，并按顺序记入事件队列
+ * @param id enum NativeVars 中的编号
+ */
+void ui_bind_post_int(int32_t id, int32_t value);
+
+/** 发布布尔值，按 0 / 1 保存（任意任务） */
+void ui_bind_set_bool(int32_t id, bool value);
+
+int32_t ui_bind_get_int(int32_t id);
+bool ui_bind_get_bool(int32_t id);
+
+/** 当前版本号，从未发布过为 0 */
+uint32_t ui_bind_version(int32_t id);
+
+/**
+ * 变量是否在 *seen 之后发布过新值；是则把 *seen 更新为当前版本（LVGL 任务）
+ * *seen 初始为 0 时，第一次发布之后返回 true
+ */
+bool ui_bind_changed(int32_t id, uint32_t *seen);
+
+/**
+ * 取出变量 id 在 *cursor 之后的下一个事件（LVGL 任务）
+ * @param cursor 读取位置，初始为 0（从队列中最早的事件开始）；每个读取方各持有一个
+ * @return 有事件返回 true，值写入 *value
+ */
+bool ui_bind_next_event(int32_t id, uint32_t *cursor, int32_t *value);
+
+/**
+ * 处理上次调用以来的发布（LVGL 任务，ui_tick 中调用）
+ * @return 有变量发生变化返回 true
+ */
+bool ui_bindings_dispatch(void);
+
+void ui_bindings_get_stats(ui_bind_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -20,7 +20,27 @@ enum FlowGlobalVariables {
 
 // Native global variables
 
+// 编号即 native_vars[] 的下标（0 保留），由服务通过 ui_bindings.h 发布
+enum NativeVars {
+    NATIVE_VAR_NONE = 0,
+    NATIVE_VAR_WIFI_STATE,      // wifi_link_state_t
+    NATIVE_VAR_AI_STATE,        // cg_ai_state_t
+    NATIVE_VAR_BATTERY_MV,      // 电池电压（毫伏）
+    NATIVE_VAR_NOTE_EVENT,      // 最近一次笔记事件 note_event_t，未发生时为 -1
+    NATIVE_VAR_NOTE_PENDING,    // 最近一次笔记事件时待上传的分段数
+    NATIVE_VAR_COUNT
+};
 
+extern int32_t get_var_wifi_state();
+extern void set_var_wifi_state(int32_t value);
+extern int32_t get_var_ai_state();
+extern void set_var_ai_state(int32_t value);
+extern int32_t get_var_battery_mv();
+extern void set_var_battery_mv(int32_t value);
+extern int32_t get_var_note_event();
+extern void set_var_note_event(int32_t value);
+extern int32_t get_var_note_pending();
+extern void set_var_note_pending(int32_t value);
 
 #ifdef __cplusplus
 }
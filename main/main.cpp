@@ -2,122 +2,187 @@
  * @file main.cpp
  * @brief ESP32-HMI 主程序入口
  *
- * 系统启动流程：
- * 1. 初始化基础驱动（I2C、GPIO扩展、RTC、电池）
- * 2. 初始化显示系统（LCD、背光、触摸）
- * 3. 初始化音频系统（I2S、音频播放器）
- * 4. 初始化 LVGL 图形库和 UI
- * 5. 启动网络监控服务
- * 6. 进入主循环处理 UI 事件
+ * 系统启动流程（boot_seq 按依赖编排，见 s_boot_stages）：
+ * - NVS -> WiFi：最先开始，WiFi 在后台连接
+ * - I2C -> IO 扩展 -> LCD（屏幕、背光、触摸）；LVGL 核心初始化与 LCD 并行，两者完成后注册显示驱动、创建 UI
+ * - 音频（I2S、音频播放器）、电池 ADC、RTC 互不依赖，在另一个核上并行
+ * - 网络监控等 WiFi 和音频就绪后启动
+ * LVGL 相关阶段在 app_main 任务中执行，完成后直接进入主循环，不等待其他阶段。
+ * 首帧和获取 IP 的时间点与各阶段一起打印为一次启动时间线。
  */
 
+#include "alloc_prof.h"
 #include "bat_driver.h"
+#include "boot_seq.h"
+#include "console_service.h"
 #include "lvgl.h"
 #include "lvgl_driver.h"
+#include "metrics.h"
 #include "network_monitor.h"
 #include "pcf85063.h"
 #include "pcm5101.h"
+#include "prompt.h"
 #include "st77916.h"
 #include "tca9554.h"
+#include "trace.h"
 #include "ui.h"
-#include "utils.h"
+#include "ui_bindings.h"
 #include "wifi_service.h"
+#include "eez_flow_sched.h"
 
-#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+// 主循环每轮的等待（减少 SPI 队列压力）
+#define MAIN_LOOP_DELAY_MS 5
+
+// 电池电压发布到界面的粒度（毫伏），按档取整后发布，小幅抖动不会每 100ms 产生一次变化
+#define BATTERY_PUBLISH_STEP_MV 20
+
+// 启动时间线最晚在启动后这么久打印（WiFi 一直连不上时不再等待获取 IP）
+#define BOOT_REPORT_TIMEOUT_MS 30000
+
+// 主循环第一次 lv_timer_handler 之后置位（首帧已渲染）
+static volatile bool s_first_frame = false;
 
 // ============================================================================
 // 任务函数
 // ============================================================================
 
+/**
+ * @brief 启动时间线：全部阶段完成、首帧已渲染且 WiFi 初始化结束后打印一次
+ */
+static void boot_report_poll(void) {
+  static bool reported = false;
+  if (reported) {
+    return;
+  }
+  bool timeout = esp_timer_get_time() >= (int64_t)BOOT_REPORT_TIMEOUT_MS * 1000;
+  if (!timeout && !(boot_seq_done() && s_first_frame && WiFi_IsInitComplete())) {
+    return;
+  }
+  if (WiFi_IsConnected()) {
+    wifi_connect_info_t info;
+    WiFi_GetConnectInfo(&info);
+    boot_seq_mark_at("wifi_ip", (int64_t)info.boot_to_ip_ms * 1000);
+  }
+  boot_seq_print();
+  reported = true;
+}
+
 /**
  * @brief 后台驱动任务
  *
  * 负责处理：
- * - WiFi 连接管理
  * - RTC 时间更新
  * - 电池电压监测
+ * - 启动时间线打印
  */
 static void driver_task(void *parameter) {
-  Wireless_Init();
-
   while (1) {
+    boot_report_poll();
     PCF85063_Loop();
-    BAT_Get_Volts();
+    int32_t battery_mv = (int32_t)(BAT_Get_Volts() * 1000.0f + 0.5f);
+    ui_bind_set_int(NATIVE_VAR_BATTERY_MV, battery_mv / BATTERY_PUBLISH_STEP_MV * BATTERY_PUBLISH_STEP_MV);
     vTaskDelay(pdMS_TO_TICKS(100));
   }
 
   vTaskDelete(NULL);
 }
 
-/**
- * @brief 内存监控任务
- *
- * 定期打印内存使用情况，用于调试和内存优化
- */
-static void memory_monitor_task(void *parameter) {
-  // 等待系统初始化完成
-  vTaskDelay(pdMS_TO_TICKS(2000));
-
-  while (1) {
-    utils_print_memory_info();
-
-    // 内存紧张时打印详细分解
-    size_t free_internal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
-    if (free_internal < 100 * 1024) {
-      utils_print_memory_breakdown();
-    }
-
-    vTaskDelay(pdMS_TO_TICKS(5000));
-  }
-
-  vTaskDelete(NULL);
-}
-
 // ============================================================================
 // 初始化函数
 // ============================================================================
 
 /**
- * @brief 初始化基础驱动
+ * @brief 创建后台任务（RTC / 电池初始化之后）
  */
-static void driver_init(void) {
-  Flash_Searching(); // 启动动画
-  BAT_Init();        // 电池 ADC
-  I2C_Init();        // I2C 总线
-  EXIO_Init();       // IO 扩展器
-  PCF85063_Init();   // RTC 时钟
-
-  // 创建后台任务
+static void background_tasks_init(void) {
   xTaskCreatePinnedToCore(driver_task, "driver_task", 4096, NULL, 3, NULL, 0);
-  xTaskCreatePinnedToCore(memory_monitor_task, "mem_monitor", 4096, NULL, 1,
-                          NULL, 1);
+  metrics_start();
+}
+
+static void io_expander_init(void) { EXIO_Init(); }
+
+/**
+ * @brief 启动串口控制台并注册各模块的命令
+ */
+static void console_init(void) {
+  if (console_service_start() == ESP_OK) {
+    trace_register_console();
+    metrics_register_console();
+    alloc_prof_register_console();
+    prompt_register_console();
+  }
 }
 
+// 启动阶段（依赖只能指向前面的阶段，调用者阶段按表顺序执行）
+enum {
+  STAGE_NVS,
+  STAGE_WIFI,
+  STAGE_I2C,
+  STAGE_EXIO,
+  STAGE_LCD,
+  STAGE_LVGL,
+  STAGE_DISPLAY,
+  STAGE_UI,
+  STAGE_AUDIO,
+  STAGE_BATTERY,
+  STAGE_RTC,
+  STAGE_FLASH,
+  STAGE_TASKS,
+  STAGE_PROMPT,
+  STAGE_NET_MONITOR,
+  STAGE_CONSOLE,
+  STAGE_COUNT,
+};
+
+static const boot_stage_t s_boot_stages[STAGE_COUNT] = {
+    // 名称、函数、依赖、核（BOOT_CORE_CALLER：app_main 任务）、栈（0：默认）
+    {"nvs", WiFi_NVS_Init, 0, 0, 0},
+    {"wifi", WiFi_Start, BOOT_DEP(STAGE_NVS), 0, 0},
+    {"i2c", I2C_Init, 0, BOOT_CORE_CALLER, 0},
+    {"exio", io_expander_init, BOOT_DEP(STAGE_I2C), BOOT_CORE_CALLER, 0},
+    {"lcd", LCD_Init, BOOT_DEP(STAGE_EXIO), 1, 0},
+    {"lvgl", LVGL_Init_Core, 0, BOOT_CORE_CALLER, 0},
+    {"display", LVGL_Register_Display, BOOT_DEP(STAGE_LCD) | BOOT_DEP(STAGE_LVGL), BOOT_CORE_CALLER, 0},
+    {"ui", ui_init, BOOT_DEP(STAGE_DISPLAY), BOOT_CORE_CALLER, 0},
+    {"audio", Audio_Init, 0, 1, 0},
+    {"battery", BAT_Init, 0, 1, 0},
+    {"rtc", PCF85063_Init, BOOT_DEP(STAGE_I2C), 1, 0},
+    {"flash", Flash_Searching, 0, 1, 0},
+    {"tasks", background_tasks_init, BOOT_DEP(STAGE_BATTERY) | BOOT_DEP(STAGE_RTC), 1, 0},
+    {"prompt", prompt_init, BOOT_DEP(STAGE_AUDIO), 1, 8192},
+    {"net_mon", network_monitor_start, BOOT_DEP(STAGE_WIFI) | BOOT_DEP(STAGE_PROMPT), 1, 0},
+    {"console", console_init, 0, 1, 0},
+};
+
 // ============================================================================
 // 主入口
 // ============================================================================
 
 extern "C" void app_main(void) {
-  // 阶段1：基础驱动初始化
-  driver_init();
+  // 事件跟踪最先初始化，之后的阶段都可以记录
+  trace_init();
+  alloc_prof_init();
 
-  // 阶段2：显示系统初始化
-  LCD_Init();
-
-  // 阶段3：音频系统初始化
-  Audio_Init();
-
-  // 阶段4：UI 初始化
-  LVGL_Init();
-  ui_init();
-
-  // 阶段5：启动网络监控服务（检测网络断开并播放提示音）
-  network_monitor_start();
+  // 阶段1~5：按依赖并行初始化，UI 创建完成后返回（其余阶段可能仍在后台进行）
+  boot_seq_run(s_boot_stages, STAGE_COUNT);
 
   // 阶段6：主循环
+  // 一帧 = ui_tick + 等待 + lv_timer_handler，帧周期减去等待和渲染后的剩余时间作为下一次 flow tick 的预算
+  const int64_t frame_us = LV_DISP_DEF_REFR_PERIOD * 1000;
   while (1) {
     ui_tick();
-    vTaskDelay(pdMS_TO_TICKS(5)); // 减少 SPI 队列压力
+    vTaskDelay(pdMS_TO_TICKS(MAIN_LOOP_DELAY_MS));
+    int64_t t0 = esp_timer_get_time();
+    TRACE_BEGIN(TRACE_EV_LV_TIMER, 0, 0);
     lv_timer_handler();
+    TRACE_END(TRACE_EV_LV_TIMER, 0, 0);
+    if (!s_first_frame) {
+      boot_seq_mark("first_frame");
+      s_first_frame = true;
+    }
+    int64_t busy = esp_timer_get_time() - t0 + MAIN_LOOP_DELAY_MS * 1000;
+    eez_flow_set_frame_remaining_us(busy < frame_us ? (uint32_t)(frame_us - busy) : 0);
   }
 }
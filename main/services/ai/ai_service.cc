@@ -9,14 +9,21 @@
  */
 
 #include "ai_service.h"
+#include "alloc_prof.h"
 #include "app_config.h"
+#include "arena.h"
 
 extern "C" {
 #include "driver/i2s_std.h"
 #include "esp_system.h"
 #include "esp_wifi.h"
+#include "metrics.h"
 #include "mic_driver.h"
+#include "network_monitor.h"
+#include "audio_mixer.h"
 #include "pcm5101.h"
+#include "trace.h"
+#include "utils.h"
 #include <sys/time.h>
 #include <time.h>
 }
@@ -37,12 +44,13 @@ extern "C" {
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 
-#include <deque>
+#include <atomic>
 #include <list>
 #include <memory>
 #include <mutex>
 #include <stdlib.h>
 #include <string.h>
+#include <string>
 #include <vector>
 
 #include "esp_heap_caps.h" // 用于 PSRAM 分配
@@ -99,21 +107,25 @@ public:
     // 在堆上分配函数对象
     auto *task_ptr = new std::function<void()>(std::move(task));
     void *ptr = static_cast<void *>(task_ptr);
+    pending_++;
     if (xQueueSend(queue_, &ptr, portMAX_DELAY) != pdTRUE) {
+      pending_--;
       delete task_ptr;
       ESP_LOGE(TAG, "调度后台任务失败");
     }
   }
 
   void WaitForCompletion() {
-    // 简单实现：等待队列为空
+    // 等待已调度的任务全部执行完（包括正在执行的那个）
     int wait_count = 0;
-    while (uxQueueMessagesWaiting(queue_) > 0 && wait_count < 100) {
+    while (pending_ > 0 && wait_count < 100) {
       vTaskDelay(pdMS_TO_TICKS(10));
       wait_count++;
     }
   }
 
+  bool IsIdle() const { return pending_ == 0; }
+
 private:
   static void task_wrapper(void *arg) {
     auto *self = static_cast<BackgroundTask *>(arg);
@@ -136,6 +148,7 @@ private:
         (*task_ptr)();
         delete task_ptr;
         ptr = nullptr;
+        pending_--;
       }
     }
   }
@@ -144,6 +157,7 @@ private:
   QueueHandle_t queue_;
   TaskHandle_t task_handle_;
   volatile bool running_;
+  std::atomic<int> pending_{0}; // 已调度但尚未执行完的任务数
 };
 
 // ============== 常量定义 ==============
@@ -159,6 +173,27 @@ private:
 // I2S 输出采样率
 #define I2S_OUT_SAMPLE_RATE 16000
 
+// ============== 会话内存 ==============
+// 一次对话中的字符串、WebSocket 分片缓冲、语音缓冲、TTS 包都从会话 arena 分配，
+// cg_ai_service_stop 时整体回收，不再在通用堆（小块默认落在内部 RAM）上反复申请释放
+static arena_t g_session_arena; // PSRAM，可增长
+static arena_t g_iram_arena;    // 内部 RAM 小池（固定大小），用于麦克风读缓冲
+
+template <typename T> using SessionVector = std::vector<T, ArenaAllocator<T>>;
+using SessionString =
+    std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+using OpusPacket = SessionVector<uint8_t>;
+using PcmFrame = SessionVector<int16_t>;
+
+template <typename T> static ArenaAllocator<T> session_alloc(void) {
+  return ArenaAllocator<T>(&g_session_arena);
+}
+
+// 会话内存峰值（每次回收时更新）
+static metric_t *g_arena_peak_metric = nullptr;
+static metric_t *g_arena_footprint_metric = nullptr;
+static metric_t *g_iram_arena_peak_metric = nullptr;
+
 // ============== 全局变量 ==============
 static cg_ai_state_t g_state = CG_AI_STATE_IDLE;
 static cg_ai_state_callback_t g_state_callback = nullptr;
@@ -170,6 +205,11 @@ static TaskHandle_t g_mic_task_handle = nullptr;
 static TaskHandle_t g_audio_out_task_handle = nullptr;
 static volatile bool g_running = false;
 
+// 运行指标（WebSocket 收发字节数、发送失败次数）
+static metric_t *g_tx_bytes_metric = nullptr;
+static metric_t *g_rx_bytes_metric = nullptr;
+static metric_t *g_send_fail_metric = nullptr;
+
 // Opus 编解码器
 static std::unique_ptr<OpusEncoderWrapper> g_opus_encoder;
 static std::unique_ptr<OpusDecoderWrapper> g_opus_decoder;
@@ -178,20 +218,31 @@ static std::unique_ptr<OpusDecoderWrapper> g_opus_decoder;
 static std::unique_ptr<BackgroundTask> g_background_task;
 
 // 音频处理器（用于 VAD 和音频处理）
+// 首次对话时创建，对话结束后待机保留（预热），内存紧张时由回收钩子释放
 static std::unique_ptr<AudioProcessor> g_audio_processor;
+static std::mutex g_warm_mutex; // 保护 g_audio_processor 的创建和释放
+
+// 点击开始到进入 LISTENING 的耗时（区分 AFE 冷启动 / 预热）
+static int64_t g_start_time_us = 0;
+static bool g_start_warm = false;
+static metric_t *g_ready_cold_metric = nullptr;
+static metric_t *g_ready_warm_metric = nullptr;
+static const uint32_t READY_MS_BOUNDS[] = {250, 500, 1000, 1500, 2000, 3000, 5000};
 
 // 音频输出队列（存储原始 Opus 数据，在播放任务中解码）
 static std::mutex g_audio_mutex;
-static std::list<std::vector<uint8_t>> g_audio_out_queue;
+static std::list<OpusPacket, ArenaAllocator<OpusPacket>>
+    g_audio_out_queue{session_alloc<OpusPacket>()};
 
 // 音频缓冲区（用于累积说话时的音频，断句时发送）
 static std::mutex g_speech_buffer_mutex;
-static std::vector<int16_t> g_speech_buffer; // 累积的音频数据
+static PcmFrame g_speech_buffer{session_alloc<int16_t>()}; // 累积的音频数据
 static bool g_is_speaking = false;           // VAD 检测到的说话状态
 
 // VAD 预缓冲（保留语音开始前的音频，避免丢失开头）
-static std::deque<std::vector<int16_t>> g_pre_speech_buffer; // 预缓冲队列
-static const size_t PRE_SPEECH_BUFFER_COUNT = 5;             // 保留最近 5 帧
+static std::list<PcmFrame, ArenaAllocator<PcmFrame>>
+    g_pre_speech_buffer{session_alloc<PcmFrame>()}; // 预缓冲队列
+static const size_t PRE_SPEECH_BUFFER_COUNT = 5;    // 保留最近 5 帧
 
 // VAD 防抖参数
 static uint32_t g_listening_start_time = 0; // 进入 LISTENING 状态的时间
@@ -205,7 +256,7 @@ static const int32_t MIN_AUDIO_ENERGY_THRESHOLD =
 /**
  * 计算音频的 RMS 能量（用于过滤噪音）
  */
-static int32_t calculate_audio_rms(const std::vector<int16_t> &audio) {
+static int32_t calculate_audio_rms(const PcmFrame &audio) {
   if (audio.empty())
     return 0;
 
@@ -217,7 +268,7 @@ static int32_t calculate_audio_rms(const std::vector<int16_t> &audio) {
 }
 
 // WebSocket 二进制消息分片缓冲区
-static std::vector<uint8_t> g_ws_binary_buffer;
+static OpusPacket g_ws_binary_buffer{session_alloc<uint8_t>()};
 
 // I2S 输出状态
 static bool g_i2s_output_configured = false;
@@ -228,10 +279,10 @@ static bool g_server_hello_received = false;
 static int g_server_sample_rate = 16000;
 
 // 会话 ID（从服务器 hello 响应中获取，所有消息都需要包含）
-static std::string g_session_id;
+static SessionString g_session_id{session_alloc<char>()};
 
 // WebSocket headers（需要在整个连接期间保持有效）
-static std::string g_ws_headers;
+static SessionString g_ws_headers{session_alloc<char>()};
 
 // ============== 辅助函数 ==============
 
@@ -250,6 +301,7 @@ static void set_state(cg_ai_state_t new_state);
  * 在 WebSocket 连接成功后调用，避免内存不足导致 SSL 握手失败
  */
 static void init_audio_processor(void) {
+  std::lock_guard<std::mutex> lock(g_warm_mutex);
   if (g_audio_processor) {
     ESP_LOGW(TAG, "AudioProcessor 已初始化，跳过");
     return;
@@ -346,7 +398,8 @@ static void init_audio_processor(void) {
       g_speech_buffer.insert(g_speech_buffer.end(), data.begin(), data.end());
     } else {
       // 未说话：更新预缓冲区（滑动窗口，保留最近的音频帧）
-      g_pre_speech_buffer.push_back(data);
+      g_pre_speech_buffer.emplace_back(data.begin(), data.end(),
+                                       session_alloc<int16_t>());
       while (g_pre_speech_buffer.size() > PRE_SPEECH_BUFFER_COUNT) {
         g_pre_speech_buffer.pop_front();
       }
@@ -407,6 +460,18 @@ static void set_state(cg_ai_state_t new_state) {
       g_listening_start_time = get_time_ms();
       g_speech_start_time = 0;
 
+      // 本次对话首次进入 LISTENING：记录点击开始到可以说话的耗时
+      if (g_start_time_us != 0) {
+        uint32_t ready_ms =
+            (uint32_t)((esp_timer_get_time() - g_start_time_us) / 1000);
+        g_start_time_us = 0;
+        metrics_histogram_observe(
+            g_start_warm ? g_ready_warm_metric : g_ready_cold_metric,
+            ready_ms);
+        ESP_LOGI(TAG, "开始对话到聆听: %lu ms（%s）", (unsigned long)ready_ms,
+                 g_start_warm ? "预热" : "冷启动");
+      }
+
       // 清空缓冲区
       {
         std::lock_guard<std::mutex> lock(g_speech_buffer_mutex);
@@ -470,26 +535,24 @@ static void set_state(cg_ai_state_t new_state) {
 /**
  * 获取设备 MAC 地址（格式：XX:XX:XX:XX:XX:XX）
  */
-static std::string get_device_mac_address(void) {
+static void get_device_mac_address(char *mac_str, size_t size) {
   uint8_t mac[6];
   esp_err_t ret = esp_wifi_get_mac(WIFI_IF_STA, mac);
 
   if (ret != ESP_OK) {
     ESP_LOGW(TAG, "获取 MAC 地址失败，使用默认值");
-    return "00:00:00:00:00:00";
+    snprintf(mac_str, size, "00:00:00:00:00:00");
+    return;
   }
 
-  char mac_str[18];
-  snprintf(mac_str, sizeof(mac_str), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0],
-           mac[1], mac[2], mac[3], mac[4], mac[5]);
-
-  return std::string(mac_str);
+  snprintf(mac_str, size, "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1],
+           mac[2], mac[3], mac[4], mac[5]);
 }
 
 /**
  * 生成 UUID v4（格式：xxxxxxxx-xxxx-4xxx-yxxx-xxxxxxxxxxxx）
  */
-static std::string generate_uuid(void) {
+static void generate_uuid(char *uuid, size_t size) {
   // 使用时间戳和随机数生成 UUID
   struct timeval tv;
   gettimeofday(&tv, nullptr);
@@ -504,42 +567,37 @@ static std::string generate_uuid(void) {
   uint32_t r3 = r2 * 1103515245 + 12345;
   uint32_t r4 = r3 * 1103515245 + 12345;
 
-  char uuid[37];
-  snprintf(uuid, sizeof(uuid), "%08lx-%04x-4%03x-%04x-%08lx%04x",
-           (unsigned long)r1, (unsigned int)(r2 >> 16),
-           (unsigned int)(r2 & 0x0fff),
+  snprintf(uuid, size, "%08lx-%04x-4%03x-%04x-%08lx%04x", (unsigned long)r1,
+           (unsigned int)(r2 >> 16), (unsigned int)(r2 & 0x0fff),
            (unsigned int)((r3 >> 16) | 0x8000), // 版本 4 标识
            (unsigned long)r3, (unsigned int)(r4 >> 16));
-
-  return std::string(uuid);
 }
 
-// ============== I2S 输出（复用 PCM5101 的 I2S 通道）==============
+// ============== 音频输出（混音器的 TTS 通道）==============
 
 static esp_err_t i2s_output_init(void) {
   if (g_i2s_output_configured) {
     return ESP_OK;
   }
 
-  // 复用 PCM5101 的 I2S 通道，重新配置采样率
-  ESP_LOGI(TAG, "配置 I2S 输出（采样率: %d）", I2S_OUT_SAMPLE_RATE);
-  esp_err_t ret = Audio_I2S_Reconfig(I2S_OUT_SAMPLE_RATE);
+  // I2S 时钟由混音器固定，这里只设置 TTS 通道的输入格式，不影响音乐播放
+  ESP_LOGI(TAG, "配置 TTS 输出（采样率: %d）", I2S_OUT_SAMPLE_RATE);
+  esp_err_t ret = audio_mixer_set_format(MIXER_CH_TTS, I2S_OUT_SAMPLE_RATE, 1);
   if (ret == ESP_OK) {
     g_i2s_output_configured = true;
-    ESP_LOGI(TAG, "I2S 输出配置成功（复用 PCM5101 通道）");
   } else {
-    ESP_LOGW(TAG, "I2S 重新配置失败: %s", esp_err_to_name(ret));
+    ESP_LOGW(TAG, "TTS 输出配置失败: %s", esp_err_to_name(ret));
   }
-
-  return ESP_OK; // 即使配置失败也继续，因为 PCM5101 可能已经处于正确状态
+  return ret;
 }
 
 static void i2s_output_write(const int16_t *data, size_t samples) {
-  Audio_I2S_Write(data, samples, 100);
+  audio_mixer_write(MIXER_CH_TTS, data, samples * sizeof(int16_t), nullptr,
+                    100);
 }
 
 static void i2s_output_deinit(void) {
-  // 不需要做任何事，I2S 通道由 PCM5101 管理
+  // 混音器通道保留，下次初始化直接使用
   g_i2s_output_configured = false;
 }
 
@@ -608,6 +666,9 @@ static void websocket_event_handler(void *handler_args, esp_event_base_t base,
       if (message_complete && !g_ws_binary_buffer.empty()) {
         ESP_LOGD(TAG, "收到完整 Opus 数据: %zu 字节",
                  g_ws_binary_buffer.size());
+        TRACE_INSTANT(TRACE_EV_WS_RECV, g_ws_binary_buffer.size(),
+                      data->op_code);
+        metrics_counter_add(g_rx_bytes_metric, g_ws_binary_buffer.size());
         // 在 SENDING 或 SPEAKING 状态下接收音频
         if (g_state == CG_AI_STATE_SPEAKING || g_state == CG_AI_STATE_SENDING) {
           // 收到 TTS 音频时自动进入 SPEAKING 状态（不依赖 tts start 消息）
@@ -617,6 +678,7 @@ static void websocket_event_handler(void *handler_args, esp_event_base_t base,
           }
           std::lock_guard<std::mutex> lock(g_audio_mutex);
           g_audio_out_queue.push_back(std::move(g_ws_binary_buffer));
+          TRACE_COUNTER(TRACE_EV_AUDIO_QUEUE, g_audio_out_queue.size());
           //   ESP_LOGI(TAG, "TTS 音频已加入播放队列，队列大小: %zu",
           //            g_audio_out_queue.size());
         } else {
@@ -702,6 +764,8 @@ static void websocket_event_handler(void *handler_args, esp_event_base_t base,
 
   case WEBSOCKET_EVENT_ERROR:
     ESP_LOGE(TAG, "WebSocket 错误，重置状态");
+    // 让网络监控尽快重新探测，下次启动时可据此快速失败
+    network_monitor_report_failure();
     g_server_hello_received = false;
     g_session_id.clear();
     g_running = false; // 允许重新启动
@@ -735,21 +799,25 @@ static int websocket_connect(void) {
   ESP_LOGI(TAG, "连接到: %s", CG_AI_URL);
 
   // 获取设备 MAC 地址
-  std::string device_id = get_device_mac_address();
+  char device_id[18];
+  get_device_mac_address(device_id, sizeof(device_id));
 
   // 生成新的 UUID（每次连接时重新生成）
-  std::string client_id = generate_uuid();
-  std::string device_type = "boxbot";
+  char client_id[37];
+  generate_uuid(client_id, sizeof(client_id));
+  const char *device_type = "boxbot";
 
-  ESP_LOGI(TAG, "Device-Id: %s", device_id.c_str());
-  ESP_LOGI(TAG, "Client-Id: %s", client_id.c_str());
-  ESP_LOGI(TAG, "Device-Type: %s", device_type.c_str());
+  ESP_LOGI(TAG, "Device-Id: %s", device_id);
+  ESP_LOGI(TAG, "Client-Id: %s", client_id);
+  ESP_LOGI(TAG, "Device-Type: %s", device_type);
 
   // 构建 headers 字符串（每个 header 以 \r\n 结尾）
-  // 使用全局变量确保字符串在连接期间保持有效
-  g_ws_headers = "Device-Id: " + device_id + "\r\n" +
-                 "Client-Id: " + client_id + "\r\n" +
-                 "Device-Type: " + device_type + "\r\n";
+  // 使用全局变量确保字符串在连接期间保持有效（会话 arena，停止时回收）
+  char headers[128];
+  snprintf(headers, sizeof(headers),
+           "Device-Id: %s\r\nClient-Id: %s\r\nDevice-Type: %s\r\n",
+           device_id, client_id, device_type);
+  g_ws_headers.assign(headers);
 
   esp_websocket_client_config_t config = {};
   config.uri = CG_AI_URL;
@@ -821,12 +889,16 @@ static void websocket_send_audio(const std::vector<uint8_t> &opus_data) {
   //   ESP_LOGI(TAG, ">>> 发送 Opus 帧 #%d: %zu 字节", send_count,
   //   opus_data.size());
 
+  TRACE_BEGIN(TRACE_EV_WS_SEND, opus_data.size(), 0);
   int ret =
       esp_websocket_client_send_bin(g_ws_client, (const char *)opus_data.data(),
                                     opus_data.size(), portMAX_DELAY);
+  TRACE_END(TRACE_EV_WS_SEND, opus_data.size(), ret);
   if (ret < 0) {
+    metrics_counter_add(g_send_fail_metric, 1);
     ESP_LOGE(TAG, "!!! 发送失败，返回值: %d", ret);
   } else {
+    metrics_counter_add(g_tx_bytes_metric, ret);
     // ESP_LOGI(TAG, "<<< 发送成功，返回值: %d 字节", ret);
   }
 }
@@ -834,33 +906,46 @@ static void websocket_send_audio(const std::vector<uint8_t> &opus_data) {
 static void websocket_send_start_listening(void) {
   if (g_ws_client && esp_websocket_client_is_connected(g_ws_client)) {
     // 包含 session_id（服务器需要识别会话）
-    std::string msg =
-        "{\"session_id\":\"" + g_session_id +
-        "\",\"type\":\"listen\",\"state\":\"start\",\"mode\":\"auto\"}";
-    esp_websocket_client_send_text(g_ws_client, msg.c_str(), msg.length(),
-                                   portMAX_DELAY);
-    ESP_LOGI(TAG, "发送开始监听消息: %s", msg.c_str());
+    char msg[192];
+    int len = snprintf(msg, sizeof(msg),
+                       "{\"session_id\":\"%s\",\"type\":\"listen\","
+                       "\"state\":\"start\",\"mode\":\"auto\"}",
+                       g_session_id.c_str());
+    if (len < 0 || len >= (int)sizeof(msg)) {
+      ESP_LOGE(TAG, "会话 ID 过长，无法发送开始监听消息");
+      return;
+    }
+    esp_websocket_client_send_text(g_ws_client, msg, len, portMAX_DELAY);
+    ESP_LOGI(TAG, "发送开始监听消息: %s", msg);
   }
 }
 
 static void websocket_send_stop_listening(void) {
   if (g_ws_client && esp_websocket_client_is_connected(g_ws_client)) {
-    std::string msg = "{\"session_id\":\"" + g_session_id +
-                      "\",\"type\":\"listen\",\"state\":\"stop\"}";
-    esp_websocket_client_send_text(g_ws_client, msg.c_str(), msg.length(),
-                                   portMAX_DELAY);
-    ESP_LOGI(TAG, "发送停止监听消息: %s", msg.c_str());
+    char msg[160];
+    int len = snprintf(
+        msg, sizeof(msg),
+        "{\"session_id\":\"%s\",\"type\":\"listen\",\"state\":\"stop\"}",
+        g_session_id.c_str());
+    if (len < 0 || len >= (int)sizeof(msg)) {
+      ESP_LOGE(TAG, "会话 ID 过长，无法发送停止监听消息");
+      return;
+    }
+    esp_websocket_client_send_text(g_ws_client, msg, len, portMAX_DELAY);
+    ESP_LOGI(TAG, "发送停止监听消息: %s", msg);
 
     // 发送一帧静音音频，触发服务器处理
     // 服务器在 handleAudioMessage 中检查
     // client_voice_stop，需要收到音频才能触发
     if (g_opus_encoder) {
       std::vector<int16_t> silence(OPUS_FRAME_SIZE, 0);
+      TRACE_BEGIN(TRACE_EV_OPUS_ENCODE, OPUS_FRAME_SIZE, 0);
       g_opus_encoder->Encode(std::move(silence),
                              [](std::vector<uint8_t> &&opus) {
                                websocket_send_audio(opus);
                                ESP_LOGI(TAG, "发送静音帧触发服务器处理");
                              });
+      TRACE_END(TRACE_EV_OPUS_ENCODE, 0, 0);
     }
   }
 }
@@ -879,7 +964,7 @@ static void send_accumulated_audio(void) {
     return;
   }
 
-  std::vector<int16_t> audio_to_send;
+  PcmFrame audio_to_send{session_alloc<int16_t>()};
 
   {
     std::lock_guard<std::mutex> lock(g_speech_buffer_mutex);
@@ -923,11 +1008,13 @@ static void send_accumulated_audio(void) {
                                          audio_to_send.begin() + offset +
                                              current_frame_size);
 
+              TRACE_BEGIN(TRACE_EV_OPUS_ENCODE, current_frame_size, 0);
               g_opus_encoder->Encode(std::move(frame),
                                      [](std::vector<uint8_t> &&opus) {
                                        websocket_send_audio(opus);
                                        update_activity_time();
                                      });
+              TRACE_END(TRACE_EV_OPUS_ENCODE, 0, 0);
 
               offset += current_frame_size;
               frame_count++;
@@ -967,8 +1054,6 @@ static void send_accumulated_audio(void) {
 static void mic_task(void *pvParameters) {
   ESP_LOGI(TAG, "麦克风任务启动");
 
-  std::vector<int16_t> pcm_buffer(MIC_READ_SAMPLES);
-
   // 等待 WebSocket 连接成功（先不启用麦克风，避免 DMA 缓冲区溢出）
   int wait_count = 0;
   while (!g_server_hello_received && g_running && wait_count < 100) {
@@ -1011,6 +1096,22 @@ static void mic_task(void *pvParameters) {
     g_is_speaking = false;
   }
 
+  // 麦克风读缓冲：优先用内部 RAM 小池，未开启或不足时用 PSRAM 会话 arena
+  const size_t pcm_bytes = MIC_READ_SAMPLES * sizeof(int16_t);
+  arena_t *pcm_arena = &g_iram_arena;
+  int16_t *pcm_buffer = (int16_t *)arena_alloc(pcm_arena, pcm_bytes);
+  if (pcm_buffer == nullptr) {
+    pcm_arena = &g_session_arena;
+    pcm_buffer = (int16_t *)arena_alloc(pcm_arena, pcm_bytes);
+  }
+  if (pcm_buffer == nullptr) {
+    ESP_LOGE(TAG, "分配麦克风读缓冲失败");
+    g_running = false;
+    g_mic_task_handle = nullptr;
+    vTaskDelete(nullptr);
+    return;
+  }
+
   // 启用麦克风
   MIC_Enable(true);
   // 等待 I2S DMA 缓冲区稳定
@@ -1027,8 +1128,9 @@ static void mic_task(void *pvParameters) {
 
     // 读取麦克风数据（使用较长超时，与 koi_esp32 一致）
     size_t bytes_read = 0;
-    esp_err_t ret =
-        MIC_Read(pcm_buffer.data(), MIC_READ_SAMPLES, &bytes_read, 1000);
+    TRACE_BEGIN(TRACE_EV_MIC_READ, 0, 0);
+    esp_err_t ret = MIC_Read(pcm_buffer, MIC_READ_SAMPLES, &bytes_read, 1000);
+    TRACE_END(TRACE_EV_MIC_READ, bytes_read, ret);
 
     // 每秒打印一次读取状态（约每50次）
     // static int read_count = 0;
@@ -1048,14 +1150,10 @@ static void mic_task(void *pvParameters) {
 
       size_t samples_read = bytes_read / sizeof(int16_t);
 
-      // 创建临时 vector
-      std::vector<int16_t> pcm_data(pcm_buffer.begin(),
-                                    pcm_buffer.begin() + samples_read);
-
-      // 使用音频处理器进行 VAD 检测和音频处理
+      // 使用音频处理器进行 VAD 检测和音频处理（直接传读缓冲，不再逐帧拷贝）
       //   static int input_count = 0;
       if (g_audio_processor && g_audio_processor->IsRunning()) {
-        g_audio_processor->Input(pcm_data);
+        g_audio_processor->Input(pcm_buffer, samples_read);
         // if (++input_count % 50 == 1) {
         //   ESP_LOGI(TAG, "已输入 %d 次音频到 AudioProcessor, samples=%d",
         //            input_count, samples_read);
@@ -1068,14 +1166,18 @@ static void mic_task(void *pvParameters) {
         //            samples_read);
         // }
         if (g_background_task) {
+          // Opus 编码器接口要求 std::vector，回退路径按帧拷贝
+          std::vector<int16_t> pcm_data(pcm_buffer, pcm_buffer + samples_read);
           g_background_task->Schedule(
               [pcm_data = std::move(pcm_data)]() mutable {
                 if (g_opus_encoder) {
+                  TRACE_BEGIN(TRACE_EV_OPUS_ENCODE, pcm_data.size(), 0);
                   g_opus_encoder->Encode(std::move(pcm_data),
                                          [](std::vector<uint8_t> &&opus) {
                                            websocket_send_audio(opus);
                                            update_activity_time();
                                          });
+                  TRACE_END(TRACE_EV_OPUS_ENCODE, 0, 0);
                 }
               });
         }
@@ -1110,6 +1212,7 @@ static void mic_task(void *pvParameters) {
   }
 
   MIC_Enable(false);
+  arena_free(pcm_arena, pcm_buffer, pcm_bytes);
   ESP_LOGI(TAG, "麦克风任务结束");
   g_mic_task_handle = nullptr;
   vTaskDelete(nullptr);
@@ -1123,15 +1226,23 @@ static void audio_out_task(void *pvParameters) {
   int empty_count = 0;           // 队列为空的计数
   bool has_played_audio = false; // 是否播放过音频
 
+  // 解码输入 / 输出缓冲在任务内复用（解码器接口要求 std::vector），不再逐包申请
+  std::vector<uint8_t> opus_data;
+  std::vector<int16_t> pcm;
+  opus_data.reserve(1500);
+
   while (g_running) {
-    std::vector<uint8_t> opus_data;
     bool queue_empty = false;
+    opus_data.clear();
 
     {
       std::lock_guard<std::mutex> lock(g_audio_mutex);
       if (!g_audio_out_queue.empty()) {
-        opus_data = std::move(g_audio_out_queue.front());
+        // 拷出后立即出队，包内存交还会话 arena
+        const OpusPacket &packet = g_audio_out_queue.front();
+        opus_data.assign(packet.begin(), packet.end());
         g_audio_out_queue.pop_front();
+        TRACE_COUNTER(TRACE_EV_AUDIO_QUEUE, g_audio_out_queue.size());
         empty_count = 0;
         has_played_audio = true; // 标记已播放过音频
         // static int queue_pop_count = 0;
@@ -1146,8 +1257,11 @@ static void audio_out_task(void *pvParameters) {
 
     if (!opus_data.empty() && g_opus_decoder) {
       // 解码 Opus 数据
-      std::vector<int16_t> pcm;
-      if (g_opus_decoder->Decode(std::move(opus_data), pcm)) {
+      size_t opus_bytes = opus_data.size();
+      TRACE_BEGIN(TRACE_EV_OPUS_DECODE, opus_bytes, 0);
+      bool decoded = g_opus_decoder->Decode(std::move(opus_data), pcm);
+      TRACE_END(TRACE_EV_OPUS_DECODE, opus_bytes, pcm.size());
+      if (decoded) {
         // 打印解码结果（调试用，每 10 帧打印一次）
         // static int decode_count = 0;
         // if (++decode_count % 10 == 1) {
@@ -1155,12 +1269,16 @@ static void audio_out_task(void *pvParameters) {
         //            pcm.size());
         // }
         // 播放音频（使用足够长的超时确保写入完成）
-        esp_err_t write_ret = Audio_I2S_Write(pcm.data(), pcm.size(), 1000);
+        TRACE_BEGIN(TRACE_EV_I2S_WRITE, pcm.size(), 0);
+        esp_err_t write_ret = audio_mixer_write(
+            MIXER_CH_TTS, pcm.data(), pcm.size() * sizeof(int16_t), nullptr,
+            1000);
+        TRACE_END(TRACE_EV_I2S_WRITE, pcm.size(), write_ret);
         if (write_ret != ESP_OK) {
           ESP_LOGE(TAG, "音频写入失败: %s", esp_err_to_name(write_ret));
         }
       } else {
-        ESP_LOGW(TAG, "Opus 解码失败，数据大小=%zu", opus_data.size());
+        ESP_LOGW(TAG, "Opus 解码失败，数据大小=%zu", opus_bytes);
       }
     } else {
       vTaskDelay(pdMS_TO_TICKS(10));
@@ -1196,6 +1314,78 @@ static void audio_out_task(void *pvParameters) {
   vTaskDelete(nullptr);
 }
 
+// ============== 会话内存回收 ==============
+
+// 换成空容器，保证容量交还 arena（clear 只清元素，不释放容量）
+template <typename Container> static void release_container(Container &c) {
+  Container(c.get_allocator()).swap(c);
+}
+
+/**
+ * 整体回收会话 arena 并记录峰值
+ *
+ * 只有麦克风 / 播放 / 后台编码任务都已结束、WebSocket 客户端已销毁时才回收，
+ * 否则保留到下一次 stop（reset 后不能再有任何容器持有 arena 中的内存）
+ */
+static void release_session_memory(void) {
+  if (g_mic_task_handle != nullptr || g_audio_out_task_handle != nullptr ||
+      g_ws_client != nullptr ||
+      (g_background_task && !g_background_task->IsIdle())) {
+    ESP_LOGW(TAG, "会话任务尚未结束，暂不回收会话内存");
+    return;
+  }
+
+  arena_stats_t stats;
+  arena_stats_t iram_stats;
+  {
+    std::lock_guard<std::mutex> speech_lock(g_speech_buffer_mutex);
+    std::lock_guard<std::mutex> audio_lock(g_audio_mutex);
+    release_container(g_speech_buffer);
+    release_container(g_pre_speech_buffer);
+    release_container(g_audio_out_queue);
+    release_container(g_ws_binary_buffer);
+    release_container(g_session_id);
+    release_container(g_ws_headers);
+    arena_reset(&g_session_arena, &stats);
+    arena_reset(&g_iram_arena, &iram_stats);
+  }
+
+  if (stats.peak == 0 && iram_stats.peak == 0) {
+    return;
+  }
+  metrics_gauge_set(g_arena_peak_metric, (int32_t)stats.peak);
+  metrics_gauge_set(g_arena_footprint_metric, (int32_t)stats.peak_footprint);
+  metrics_gauge_set(g_iram_arena_peak_metric, (int32_t)iram_stats.peak);
+  ESP_LOGI(TAG,
+           "会话内存已回收：PSRAM 峰值 %u 字节（占用峰值 %u 字节，%lu 块 + %lu "
+           "个大块），内部 RAM 峰值 %u 字节",
+           (unsigned)stats.peak, (unsigned)stats.peak_footprint,
+           (unsigned long)stats.chunks, (unsigned long)stats.large_blocks,
+           (unsigned)iram_stats.peak);
+}
+
+// ============== AudioProcessor 预热待机 ==============
+
+/**
+ * 对话结束后让 AudioProcessor 待机（清空残留输入，AFE 实例保留）
+ *
+ * 下次对话直接复用，省去 esp-sr 模型加载；Opus 编解码器本来就常驻（start 时 ResetState）。
+ * 麦克风任务未结束时仍可能调用 Input，只停止不清空。
+ */
+static void suspend_warm_state(void) {
+  std::lock_guard<std::mutex> lock(g_warm_mutex);
+  if (!g_audio_processor) {
+    return;
+  }
+  if (g_mic_task_handle != nullptr) {
+    g_audio_processor->Stop();
+    return;
+  }
+  g_audio_processor->Suspend();
+  ESP_LOGI(TAG, "AudioProcessor 已待机（预热保留，内部 RAM 剩余 %u 字节）",
+           (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+}
+
 // ============== 公共接口（C 兼容） ==============
 
 extern "C" {
@@ -1203,8 +1393,8 @@ extern "C" {
 esp_err_t cg_ai_service_init(void) {
   ESP_LOGI(TAG, "初始化 AI 服务...");
 
-  // 检查是否已经初始化（通过检查关键对象是否存在）
-  if (g_opus_encoder != nullptr && g_audio_processor != nullptr) {
+  // 检查是否已经初始化（AudioProcessor 延迟创建、可能已被回收，不作为判断依据）
+  if (g_opus_encoder != nullptr) {
     ESP_LOGW(TAG, "AI 服务已经初始化，跳过重复初始化");
     return ESP_OK;
   }
@@ -1217,6 +1407,35 @@ esp_err_t cg_ai_service_init(void) {
     }
   }
 
+  g_tx_bytes_metric = metrics_counter("ai.ws.tx_bytes");
+  g_rx_bytes_metric = metrics_counter("ai.ws.rx_bytes");
+  g_send_fail_metric = metrics_counter("ai.ws.send_fail");
+  g_arena_peak_metric = metrics_gauge("ai.arena.peak");
+  g_arena_footprint_metric = metrics_gauge("ai.arena.footprint");
+  g_iram_arena_peak_metric = metrics_gauge("ai.arena.iram_peak");
+  g_ready_cold_metric = metrics_histogram(
+      "ai.listen_ready_ms.cold", READY_MS_BOUNDS,
+      sizeof(READY_MS_BOUNDS) / sizeof(READY_MS_BOUNDS[0]));
+  g_ready_warm_metric = metrics_histogram(
+      "ai.listen_ready_ms.warm", READY_MS_BOUNDS,
+      sizeof(READY_MS_BOUNDS) / sizeof(READY_MS_BOUNDS[0]));
+
+  // 内部 RAM 不足（如 TLS 握手前）时可释放待机中的 AudioProcessor
+  utils_mem_reclaim_register("ai_afe", cg_ai_service_release_warm);
+
+  // 会话内存（首次初始化后常驻，deinit 不释放）
+  if (arena_init(&g_session_arena, "ai_session", CONFIG_APP_AI_ARENA_CHUNK_SIZE,
+                 MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, true) != ESP_OK) {
+    return ESP_ERR_NO_MEM;
+  }
+#if CONFIG_APP_AI_ARENA_INTERNAL_SIZE > 0
+  if (arena_init(&g_iram_arena, "ai_iram", CONFIG_APP_AI_ARENA_INTERNAL_SIZE,
+                 MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA | MALLOC_CAP_8BIT,
+                 false) != ESP_OK) {
+    ESP_LOGW(TAG, "内部 RAM 小池分配失败，麦克风读缓冲改用 PSRAM");
+  }
+#endif
+
   // 初始化麦克风
   esp_err_t ret = MIC_Init();
   if (ret != ESP_OK) {
@@ -1251,15 +1470,16 @@ esp_err_t cg_ai_service_init(void) {
   ESP_LOGI(TAG, "后台编码任务已创建");
 
   // 注意：AudioProcessor（esp-sr）延迟初始化
-  // 在 WebSocket 连接成功后再初始化，避免内存不足导致 SSL 握手失败
+  // 首次在 WebSocket 连接成功后创建，避免内存不足导致 SSL 握手失败；
+  // 之后对话结束只待机不销毁，握手前内部 RAM 不足时由回收钩子释放
   ESP_LOGI(TAG, "AudioProcessor 将在 WebSocket 连接成功后初始化");
 
   // 初始化 I2S 输出
   ret = i2s_output_init();
   if (ret != ESP_OK) {
-    ESP_LOGW(TAG, "I2S 输出初始化警告: %s（可能已被音频播放器使用）",
+    ESP_LOGW(TAG, "TTS 输出初始化警告: %s（混音器未启动？）",
              esp_err_to_name(ret));
-    // 不返回错误，因为 I2S 可能已经被 Audio_Init 初始化
+    // 不返回错误：对话仍可进行，只是没有声音
   }
 
   ESP_LOGI(TAG, "AI 服务初始化成功");
@@ -1269,11 +1489,9 @@ esp_err_t cg_ai_service_init(void) {
 void cg_ai_service_deinit(void) {
   cg_ai_service_stop();
 
-  // 停止并清理音频处理器（必须在后台任务之前停止）
-  if (g_audio_processor) {
-    g_audio_processor->Stop();
-    // 等待任务结束
-    vTaskDelay(pdMS_TO_TICKS(100));
+  // 停止并清理音频处理器（必须在后台任务之前停止，析构时等待其任务退出）
+  {
+    std::lock_guard<std::mutex> lock(g_warm_mutex);
     g_audio_processor.reset();
   }
 
@@ -1314,11 +1532,32 @@ esp_err_t cg_ai_service_start(void) {
     return ESP_OK;
   }
 
+  int64_t start_time_us = esp_timer_get_time();
   ESP_LOGI(TAG, "启动 AI 服务...");
   ESP_LOGI(TAG, "目标 URL: %s", CG_AI_URL);
 
+  // 网络监控已判定后端不可达时直接报错，不再等 WebSocket 握手超时
+  if (!network_monitor_backend_reachable()) {
+    ESP_LOGE(TAG, "网络不可用，AI 服务未启动");
+    set_state(CG_AI_STATE_ERROR);
+    return ESP_FAIL;
+  }
+
+  // 分配分析（CONFIG_APP_ALLOC_PROF）：一次对话为一个会话
+  alloc_prof_session_begin("ai");
+
+  // TLS 握手需要整块内部 RAM：不足时先让各模块释放可重建的常驻状态（可能包括 AFE）
+  utils_mem_reclaim_internal(CONFIG_APP_TLS_INTERNAL_RESERVE);
+  g_start_time_us = start_time_us;
+  {
+    // 先置 g_running 再采样：之后 cg_ai_service_release_warm 不会再释放 AudioProcessor
+    std::lock_guard<std::mutex> lock(g_warm_mutex);
+    g_running = true;
+    g_start_warm = (g_audio_processor != nullptr);
+  }
+  ESP_LOGI(TAG, "AudioProcessor %s", g_start_warm ? "已预热" : "冷启动");
+
   set_state(CG_AI_STATE_CONNECTING);
-  g_running = true;
   g_server_hello_received = false;
   update_activity_time();
 
@@ -1339,8 +1578,12 @@ esp_err_t cg_ai_service_start(void) {
   // 连接 WebSocket
   if (websocket_connect() != 0) {
     ESP_LOGE(TAG, "WebSocket 连接失败");
+    network_monitor_report_failure();
     g_running = false;
+    g_start_time_us = 0;
     set_state(CG_AI_STATE_ERROR);
+    release_session_memory();
+    alloc_prof_session_end("ai");
     return ESP_FAIL;
   }
 
@@ -1382,6 +1625,11 @@ esp_err_t cg_ai_service_start(void) {
 
 void cg_ai_service_stop(void) {
   if (!g_running && g_state == CG_AI_STATE_IDLE) {
+    // 服务器断开后已回到 IDLE：仍需销毁客户端并回收会话内存
+    websocket_disconnect();
+    suspend_warm_state();
+    release_session_memory();
+    alloc_prof_session_end("ai");
     return;
   }
 
@@ -1420,14 +1668,36 @@ void cg_ai_service_stop(void) {
     wait++;
   }
 
+  // 丢弃混音器中尚未播放的 TTS，停止后立即静音
+  if (g_audio_out_task_handle == nullptr) {
+    audio_mixer_flush(MIXER_CH_TTS);
+  }
+
   // 断开 WebSocket
   websocket_disconnect();
 
   set_state(CG_AI_STATE_IDLE);
+  suspend_warm_state();
+  release_session_memory();
+  alloc_prof_session_end("ai");
 
   ESP_LOGI(TAG, "AI 服务已停止");
 }
 
+void cg_ai_service_release_warm(void) {
+  std::lock_guard<std::mutex> lock(g_warm_mutex);
+  if (!g_audio_processor) {
+    return;
+  }
+  if (g_running || g_mic_task_handle != nullptr ||
+      g_audio_processor->IsRunning()) {
+    ESP_LOGW(TAG, "对话进行中，保留 AudioProcessor");
+    return;
+  }
+  g_audio_processor.reset();
+  ESP_LOGI(TAG, "AudioProcessor 预热状态已释放，下次对话重新创建");
+}
+
 cg_ai_state_t cg_ai_service_get_state(void) { return g_state; }
 
 bool cg_ai_service_is_active(void) {
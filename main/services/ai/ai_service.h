@@ -77,6 +77,13 @@ esp_err_t cg_ai_service_start(void);
  */
 void cg_ai_service_stop(void);
 
+/**
+ * 释放待机中的 AudioProcessor（esp-sr AFE）预热状态
+ * 对话结束后 AFE 默认保留以加快下次开始；对话进行中调用时忽略。
+ * 已注册为内部 RAM 回收钩子（utils_mem_reclaim_internal）。
+ */
+void cg_ai_service_release_warm(void);
+
 /**
  * 获取当前 AI 服务状态
  * @return 当前状态
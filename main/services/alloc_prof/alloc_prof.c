@@ -0,0 +1,353 @@
+/**
+ * @file alloc_prof.c
+ * @brief 按调用点统计的堆分配分析实现
+ */
+
+#include "alloc_prof.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <string.h>
+
+#if CONFIG_APP_ALLOC_PROF
+
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_debug_helpers.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#include "esp_private/cache_utils.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "AllocProf";
+
+#define SITE_CAPACITY CONFIG_APP_ALLOC_PROF_SITES
+#define LIVE_CAPACITY CONFIG_APP_ALLOC_PROF_LIVE
+#define SKIP_FRAMES 2 // record_alloc 和堆钩子本身
+
+_Static_assert((SITE_CAPACITY & (SITE_CAPACITY - 1)) == 0, "CONFIG_APP_ALLOC_PROF_SITES 必须是 2 的幂");
+_Static_assert((LIVE_CAPACITY & (LIVE_CAPACITY - 1)) == 0, "CONFIG_APP_ALLOC_PROF_LIVE 必须是 2 的幂");
+_Static_assert(SITE_CAPACITY <= 65536, "调用点编号为 16 位");
+
+/** 调用点：调用栈 + 所在内存相同的分配合并统计 */
+typedef struct {
+    uint32_t hash; // 0 表示空槽
+    uint8_t external;
+    uint32_t frames[ALLOC_PROF_DEPTH];
+    uint32_t count;
+    uint32_t freed;
+    uint64_t bytes;
+    uint32_t live_bytes;
+    uint32_t peak_live_bytes;
+    uint64_t life_sum_us;
+    uint32_t life_max_us;
+} site_t;
+
+/** 会话内分配、尚未释放的块 */
+typedef struct {
+    uintptr_t ptr; // 0 表示空槽
+    uint16_t site;
+    uint32_t size;
+    uint32_t time_us;
+} live_t;
+
+// 表格在 PSRAM 中，钩子只在 Flash 缓存开启时访问
+static site_t *s_sites = NULL;
+static live_t *s_live = NULL;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool s_enabled = false;
+
+static const char *s_session = NULL;
+static int64_t s_session_start_us = 0;
+static uint32_t s_site_count = 0;
+static uint32_t s_live_count = 0;
+static uint32_t s_dropped = 0; // 表满未记录的分配
+
+// ============================================================================
+// 哈希表
+// ============================================================================
+
+static uint32_t hash_frames(const uint32_t *frames, uint8_t external) {
+    uint32_t h = 2166136261u ^ external;
+    for (int i = 0; i < ALLOC_PROF_DEPTH; i++) {
+        h = (h ^ frames[i]) * 16777619u;
+    }
+    return h ? h : 1;
+}
+
+static inline uint32_t hash_ptr(uintptr_t ptr) {
+    return (uint32_t)(ptr >> 3) * 2654435761u;
+}
+
+/** 找到或新建调用点，表满时返回 -1（调用时持有锁） */
+static int site_lookup(const uint32_t *frames, uint8_t external) {
+    uint32_t h = hash_frames(frames, external);
+    for (uint32_t i = 0, slot = h & (SITE_CAPACITY - 1); i < SITE_CAPACITY; i++, slot = (slot + 1) & (SITE_CAPACITY - 1)) {
+        site_t *s = &s_sites[slot];
+        if (s->hash == 0) {
+            if (s_site_count >= SITE_CAPACITY * 3 / 4) {
+                return -1;
+            }
+            s->hash = h;
+            s->external = external;
+            memcpy(s->frames, frames, sizeof(s->frames));
+            s_site_count++;
+            return (int)slot;
+        }
+        if (s->hash == h && s->external == external && memcmp(s->frames, frames, sizeof(s->frames)) == 0) {
+            return (int)slot;
+        }
+    }
+    return -1;
+}
+
+static bool live_insert(uintptr_t ptr, uint16_t site, uint32_t size, uint32_t now) {
+    if (s_live_count >= LIVE_CAPACITY * 3 / 4) {
+        return false; // 保持探测链短，临界区时间有界
+    }
+    for (uint32_t i = 0, slot = hash_ptr(ptr) & (LIVE_CAPACITY - 1); i < LIVE_CAPACITY;
+         i++, slot = (slot + 1) & (LIVE_CAPACITY - 1)) {
+        live_t *l = &s_live[slot];
+        if (l->ptr == 0 || l->ptr == ptr) {
+            if (l->ptr == 0) {
+                s_live_count++;
+            }
+            l->ptr = ptr;
+            l->site = site;
+            l->size = size;
+            l->time_us = now;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** 取出并删除（线性探测的后移删除，不留墓碑） */
+static bool live_remove(uintptr_t ptr, live_t *out) {
+    uint32_t slot = hash_ptr(ptr) & (LIVE_CAPACITY - 1);
+    for (uint32_t i = 0; i < LIVE_CAPACITY; i++, slot = (slot + 1) & (LIVE_CAPACITY - 1)) {
+        if (s_live[slot].ptr == 0) {
+            return false;
+        }
+        if (s_live[slot].ptr == ptr) {
+            break;
+        }
+    }
+    if (s_live[slot].ptr != ptr) {
+        return false;
+    }
+    *out = s_live[slot];
+    uint32_t hole = slot;
+    for (uint32_t next = (hole + 1) & (LIVE_CAPACITY - 1); s_live[next].ptr != 0; next = (next + 1) & (LIVE_CAPACITY - 1)) {
+        uint32_t home = hash_ptr(s_live[next].ptr) & (LIVE_CAPACITY - 1);
+        // home 不在 (hole, next] 之间时，该项可以前移填补空洞
+        if (((next - home) & (LIVE_CAPACITY - 1)) >= ((next - hole) & (LIVE_CAPACITY - 1))) {
+            s_live[hole] = s_live[next];
+            hole = next;
+        }
+    }
+    s_live[hole].ptr = 0;
+    s_live_count--;
+    return true;
+}
+
+// ============================================================================
+// 记录
+// ============================================================================
+
+static void __attribute__((noinline)) record_alloc(void *ptr, size_t size) {
+    uint32_t frames[ALLOC_PROF_DEPTH] = {0};
+    esp_backtrace_frame_t frame;
+    esp_backtrace_get_start(&frame.pc, &frame.sp, &frame.next_pc);
+    for (int i = 0; i < SKIP_FRAMES + ALLOC_PROF_DEPTH && frame.next_pc != 0; i++) {
+        if (!esp_backtrace_get_next_frame(&frame)) {
+            break;
+        }
+        if (i >= SKIP_FRAMES) {
+            frames[i - SKIP_FRAMES] = esp_cpu_process_stack_pc(frame.pc);
+        }
+    }
+    uint8_t external = esp_ptr_external_ram(ptr) ? 1 : 0;
+    uint32_t now = (uint32_t)(esp_timer_get_time() - s_session_start_us);
+
+    portENTER_CRITICAL(&s_lock);
+    int site = site_lookup(frames, external);
+    if (site < 0 || !live_insert((uintptr_t)ptr, (uint16_t)site, (uint32_t)size, now)) {
+        s_dropped++;
+    } else {
+        site_t *s = &s_sites[site];
+        s->count++;
+        s->bytes += size;
+        s->live_bytes += size;
+        if (s->live_bytes > s->peak_live_bytes) {
+            s->peak_live_bytes = s->live_bytes;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+static void __attribute__((noinline)) record_free(void *ptr) {
+    uint32_t now = (uint32_t)(esp_timer_get_time() - s_session_start_us);
+    live_t l;
+    portENTER_CRITICAL(&s_lock);
+    if (live_remove((uintptr_t)ptr, &l)) {
+        site_t *s = &s_sites[l.site];
+        uint32_t life = now - l.time_us;
+        s->freed++;
+        s->live_bytes -= l.size;
+        s->life_sum_us += life;
+        if (life > s->life_max_us) {
+            s->life_max_us = life;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+// 堆钩子（CONFIG_HEAP_USE_HOOKS）：堆函数在 IRAM 中，钩子入口也必须在 IRAM
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps) {
+    if (!s_enabled || ptr == NULL || !spi_flash_cache_enabled()) {
+        return;
+    }
+    record_alloc(ptr, size);
+}
+
+void IRAM_ATTR esp_heap_trace_free_hook(void *ptr) {
+    if (!s_enabled || ptr == NULL || !spi_flash_cache_enabled()) {
+        return;
+    }
+    record_free(ptr);
+}
+
+// ============================================================================
+// 控制
+// ============================================================================
+
+void alloc_prof_init(void) {
+    s_sites = heap_caps_calloc(SITE_CAPACITY, sizeof(site_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    s_live = heap_caps_calloc(LIVE_CAPACITY, sizeof(live_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (s_sites == NULL || s_live == NULL) {
+        ESP_LOGE(TAG, "统计表分配失败，分配分析未启用");
+        heap_caps_free(s_sites);
+        heap_caps_free(s_live);
+        s_sites = NULL;
+        s_live = NULL;
+        return;
+    }
+    ESP_LOGI(TAG, "分配分析已启用：%d 个调用点，%d 个存活块（%u KB PSRAM）", SITE_CAPACITY, LIVE_CAPACITY,
+             (unsigned)((SITE_CAPACITY * sizeof(site_t) + LIVE_CAPACITY * sizeof(live_t)) / 1024));
+}
+
+/** 停止记录并等待正在进行的钩子完成 */
+static void pause_recording(void) {
+    s_enabled = false;
+    vTaskDelay(pdMS_TO_TICKS(10));
+}
+
+void alloc_prof_session_begin(const char *name) {
+    if (s_sites == NULL) {
+        return;
+    }
+    if (s_session != NULL) {
+        ESP_LOGW(TAG, "会话 %s 进行中，忽略 %s", s_session, name);
+        return;
+    }
+    pause_recording();
+    memset(s_sites, 0, SITE_CAPACITY * sizeof(site_t));
+    memset(s_live, 0, LIVE_CAPACITY * sizeof(live_t));
+    s_site_count = 0;
+    s_live_count = 0;
+    s_dropped = 0;
+    s_session = name;
+    s_session_start_us = esp_timer_get_time();
+    s_enabled = true;
+    ESP_LOGI(TAG, "开始记录会话 %s", name);
+}
+
+void alloc_prof_session_end(const char *name) {
+    if (s_session == NULL || (name != NULL && strcmp(name, s_session) != 0)) {
+        return;
+    }
+    pause_recording();
+    alloc_prof_dump();
+    s_session = NULL;
+}
+
+/**
+ * 输出格式（tools/alloc_report 解析）：
+ *   # allocprof v1 session=<名称> duration_ms=<时长> depth=<栈帧数> sites=<调用点数> dropped=<未记录数>
+ *   S <i|p> <次数> <字节> <已释放次数> <存活字节> <存活峰值> <平均存活 us> <最长存活 us> <栈帧>...
+ *   # end
+ * i / p 表示内部 RAM / PSRAM，栈帧从分配函数向外，均为十六进制地址
+ */
+void alloc_prof_dump(void) {
+    if (s_sites == NULL) {
+        printf("分配分析未启用\n");
+        return;
+    }
+    bool was_enabled = s_enabled;
+    pause_recording();
+
+    int64_t duration = s_session ? esp_timer_get_time() - s_session_start_us : 0;
+    printf("# allocprof v1 session=%s duration_ms=%lld depth=%d sites=%lu dropped=%lu\n",
+           s_session ? s_session : "-", (long long)(duration / 1000), ALLOC_PROF_DEPTH,
+           (unsigned long)s_site_count, (unsigned long)s_dropped);
+    for (int i = 0; i < SITE_CAPACITY; i++) {
+        const site_t *s = &s_sites[i];
+        if (s->hash == 0 || s->count == 0) {
+            continue;
+        }
+        printf("S %c %lu %llu %lu %lu %lu %lu %lu", s->external ? 'p' : 'i', (unsigned long)s->count,
+               (unsigned long long)s->bytes, (unsigned long)s->freed, (unsigned long)s->live_bytes,
+               (unsigned long)s->peak_live_bytes, (unsigned long)(s->freed ? s->life_sum_us / s->freed : 0),
+               (unsigned long)s->life_max_us);
+        for (int f = 0; f < ALLOC_PROF_DEPTH && s->frames[f]; f++) {
+            printf(" %08lx", (unsigned long)s->frames[f]);
+        }
+        printf("\n");
+    }
+    printf("# end\n");
+    fflush(stdout);
+
+    s_enabled = was_enabled;
+}
+
+#else // CONFIG_APP_ALLOC_PROF
+
+void alloc_prof_init(void) {}
+void alloc_prof_session_begin(const char *name) {}
+void alloc_prof_session_end(const char *name) {}
+void alloc_prof_dump(void) { printf("分配分析未编译（CONFIG_APP_ALLOC_PROF）\n"); }
+
+#endif // CONFIG_APP_ALLOC_PROF
+
+// ============================================================================
+// 控制台命令
+// ============================================================================
+
+static int cmd_allocprof(int argc, char **argv) {
+    const char *sub = argc > 1 ? argv[1] : "dump";
+    if (strcmp(sub, "start") == 0) {
+        alloc_prof_session_begin("manual");
+    } else if (strcmp(sub, "stop") == 0) {
+        alloc_prof_session_end(NULL);
+    } else if (strcmp(sub, "dump") == 0) {
+        alloc_prof_dump();
+    } else {
+        printf("用法: allocprof [start|stop|dump]\n");
+        return 1;
+    }
+    return 0;
+}
+
+void alloc_prof_register_console(void) {
+    const esp_console_cmd_t cmd = {
+        .command = "allocprof",
+        .help = "堆分配分析: start 开始手动会话 / stop 结束当前会话并打印 / dump 打印当前统计"
+                "（tools/alloc_report 符号化）",
+        .hint = "[start|stop|dump]",
+        .func = cmd_allocprof,
+    };
+    esp_console_cmd_register(&cmd);
+}
@@ -0,0 +1,52 @@
+/**
+ * @file alloc_prof.h
+ * @brief 按调用点统计的堆分配分析
+ *
+ * 开启 CONFIG_APP_ALLOC_PROF 后通过 ESP-IDF 的堆钩子（CONFIG_HEAP_USE_HOOKS）记录每一次分配和释放，
+ * 覆盖 malloc / calloc / realloc / new / heap_caps_*：
+ * - 分配时回溯 ALLOC_PROF_DEPTH 层调用栈，按调用栈和所在内存（内部 RAM / PSRAM）聚合次数、字节数
+ * - 释放时按指针找回分配记录，累计存活时间（平均 / 最大）和仍存活的字节数
+ * - 表格在 PSRAM 中预先分配，钩子内不再分配；Flash 缓存关闭期间的分配不记录
+ *
+ * 设备端只记录地址，`allocprof dump` 打印后由 tools/alloc_report 用 ELF 符号化，
+ * 跳过 malloc / new / STL 内部的栈帧，归到第一个业务代码的调用点，按会话列出分配最多的位置。
+ *
+ * AI 对话（cg_ai_service_start ~ stop）和笔记录音（start_note_recording ~ 生成笔记结束）
+ * 自动作为一次会话：开始时清空统计，结束时打印。
+ *
+ * 关闭 CONFIG_APP_ALLOC_PROF 时所有接口为空函数。
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ALLOC_PROF_DEPTH 8 // 每个调用点记录的栈帧数
+
+/** 分配统计表（启动时调用，之后才开始记录） */
+void alloc_prof_init(void);
+
+/**
+ * 开始一次会话：清空统计并开始记录
+ * 已有会话进行中时忽略，重叠的会话只记录第一个；name 只保存指针，须保持有效到 end
+ */
+void alloc_prof_session_begin(const char *name);
+
+/** 结束会话：停止记录并打印统计（name 与 begin 不一致时忽略） */
+void alloc_prof_session_end(const char *name);
+
+/** 打印当前统计（tools/alloc_report 解析） */
+void alloc_prof_dump(void);
+
+/** 注册控制台命令 allocprof（需在 console_service_start 之后） */
+void alloc_prof_register_console(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,265 @@
+/**
+ * @file arena.c
+ * @brief 会话内存池（按块 bump 分配 + 按 2 的幂分级回收，整体 reset）
+ */
+
+#include "arena.h"
+
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char *TAG = "Arena";
+
+#define ARENA_ALIGN 16
+#define ARENA_MIN_BLOCK (1u << ARENA_MIN_SHIFT)
+
+// 块头部，后面紧跟 size 字节的可分配区域
+struct arena_chunk {
+    arena_chunk_t *next;
+    size_t size;
+    size_t used;
+    uint32_t reserved; // 头部凑齐 16 字节，保证分配区域对齐
+};
+
+// 大块头部，后面紧跟 size 字节的用户数据
+struct arena_large {
+    arena_large_t *next;
+    arena_large_t *prev;
+    size_t size;
+    uint32_t reserved;
+};
+
+_Static_assert(sizeof(struct arena_chunk) % ARENA_ALIGN == 0, "chunk header alignment");
+_Static_assert(sizeof(struct arena_large) % ARENA_ALIGN == 0, "large header alignment");
+
+// ============================================================================
+// 内部实现（调用方持有锁）
+// ============================================================================
+
+static int class_index(size_t size) {
+    if (size <= ARENA_MIN_BLOCK) {
+        return 0;
+    }
+    // 向上取整到 2 的幂：17~32 -> 1，33~64 -> 2 ...
+    return 32 - __builtin_clz((unsigned)(size - 1)) - ARENA_MIN_SHIFT;
+}
+
+static void note_footprint(arena_t *arena, size_t bytes) {
+    arena->footprint += bytes;
+    if (arena->footprint > arena->peak_footprint) {
+        arena->peak_footprint = arena->footprint;
+    }
+}
+
+static arena_chunk_t *chunk_new(arena_t *arena) {
+    arena_chunk_t *chunk = heap_caps_aligned_alloc(ARENA_ALIGN, sizeof(arena_chunk_t) + arena->chunk_size,
+                                                   arena->caps);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    chunk->size = arena->chunk_size;
+    chunk->used = 0;
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    note_footprint(arena, sizeof(arena_chunk_t) + chunk->size);
+    return chunk;
+}
+
+static void *bump(arena_t *arena, size_t block) {
+    arena_chunk_t *chunk = arena->chunks;
+    if (chunk->size - chunk->used < block) {
+        // 当前块剩余部分放弃（reset 时回收），换新块
+        if (!arena->growable || block > arena->chunk_size) {
+            return NULL;
+        }
+        chunk = chunk_new(arena);
+        if (chunk == NULL) {
+            return NULL;
+        }
+    }
+    void *ptr = (uint8_t *)(chunk + 1) + chunk->used;
+    chunk->used += block;
+    return ptr;
+}
+
+static void *large_alloc(arena_t *arena, size_t size) {
+    if (!arena->growable) {
+        return NULL;
+    }
+    arena_large_t *large = heap_caps_aligned_alloc(ARENA_ALIGN, sizeof(arena_large_t) + size, arena->caps);
+    if (large == NULL) {
+        return NULL;
+    }
+    large->size = size;
+    large->prev = NULL;
+    large->next = arena->large;
+    if (arena->large) {
+        arena->large->prev = large;
+    }
+    arena->large = large;
+    note_footprint(arena, sizeof(arena_large_t) + size);
+    return large + 1;
+}
+
+static void large_free(arena_t *arena, void *ptr) {
+    arena_large_t *large = (arena_large_t *)ptr - 1;
+    if (large->prev) {
+        large->prev->next = large->next;
+    } else {
+        arena->large = large->next;
+    }
+    if (large->next) {
+        large->next->prev = large->prev;
+    }
+    arena->footprint -= sizeof(arena_large_t) + large->size;
+    heap_caps_free(large);
+}
+
+static void fill_stats(const arena_t *arena, arena_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->in_use = arena->in_use;
+    out->peak = arena->peak;
+    out->footprint = arena->footprint;
+    out->peak_footprint = arena->peak_footprint;
+    for (const arena_chunk_t *c = arena->chunks; c; c = c->next) {
+        out->chunks++;
+    }
+    for (const arena_large_t *l = arena->large; l; l = l->next) {
+        out->large_blocks++;
+    }
+}
+
+// ============================================================================
+// 公共接口
+// ============================================================================
+
+esp_err_t arena_init(arena_t *arena, const char *name, size_t chunk_size, uint32_t caps, bool growable) {
+    if (arena->lock != NULL) {
+        return ESP_OK;
+    }
+
+    memset(arena, 0, sizeof(*arena));
+    arena->name = name;
+    arena->caps = caps;
+    arena->growable = growable;
+    arena->chunk_size = (chunk_size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (growable && arena->chunk_size < ARENA_MAX_CLASS_SIZE) {
+        arena->chunk_size = ARENA_MAX_CLASS_SIZE;
+    }
+
+    // 第一块立即申请并常驻：内部 RAM 的小池在堆还完整时占好位置，之后不再向堆申请
+    if (chunk_new(arena) == NULL) {
+        ESP_LOGE(TAG, "%s: 申请 %u 字节失败", name, (unsigned)arena->chunk_size);
+        memset(arena, 0, sizeof(*arena));
+        return ESP_ERR_NO_MEM;
+    }
+    arena->lock = xSemaphoreCreateMutexStatic(&arena->lock_buffer);
+
+    ESP_LOGI(TAG, "%s: 块大小 %u 字节%s", name, (unsigned)arena->chunk_size, growable ? "" : "（固定）");
+    return ESP_OK;
+}
+
+void *arena_alloc(arena_t *arena, size_t size) {
+    if (arena->lock == NULL) {
+        return NULL;
+    }
+    if (size == 0) {
+        size = 1;
+    }
+
+    void *ptr = NULL;
+    xSemaphoreTake(arena->lock, portMAX_DELAY);
+    if (size > ARENA_MAX_CLASS_SIZE) {
+        ptr = large_alloc(arena, size);
+        if (ptr) {
+            arena->in_use += size;
+        }
+    } else {
+        int cls = class_index(size);
+        size_t block = (size_t)ARENA_MIN_BLOCK << cls;
+        ptr = arena->free_lists[cls];
+        if (ptr) {
+            arena->free_lists[cls] = *(void **)ptr;
+        } else {
+            ptr = bump(arena, block);
+        }
+        if (ptr) {
+            arena->in_use += block;
+        }
+    }
+    if (arena->in_use > arena->peak) {
+        arena->peak = arena->in_use;
+    }
+    xSemaphoreGive(arena->lock);
+    return ptr;
+}
+
+void arena_free(arena_t *arena, void *ptr, size_t size) {
+    if (ptr == NULL || arena->lock == NULL) {
+        return;
+    }
+    if (size == 0) {
+        size = 1;
+    }
+
+    xSemaphoreTake(arena->lock, portMAX_DELAY);
+    if (size > ARENA_MAX_CLASS_SIZE) {
+        arena->in_use -= size;
+        large_free(arena, ptr);
+    } else {
+        int cls = class_index(size);
+        *(void **)ptr = arena->free_lists[cls];
+        arena->free_lists[cls] = ptr;
+        arena->in_use -= (size_t)ARENA_MIN_BLOCK << cls;
+    }
+    xSemaphoreGive(arena->lock);
+}
+
+void arena_reset(arena_t *arena, arena_stats_t *last) {
+    if (arena->lock == NULL) {
+        if (last) {
+            memset(last, 0, sizeof(*last));
+        }
+        return;
+    }
+
+    xSemaphoreTake(arena->lock, portMAX_DELAY);
+    if (last) {
+        fill_stats(arena, last);
+    }
+
+    while (arena->large) {
+        arena_large_t *next = arena->large->next;
+        heap_caps_free(arena->large);
+        arena->large = next;
+    }
+
+    // 只保留链表尾（最早申请的）那一块
+    arena_chunk_t *chunk = arena->chunks;
+    while (chunk->next) {
+        arena_chunk_t *next = chunk->next;
+        heap_caps_free(chunk);
+        chunk = next;
+    }
+    chunk->used = 0;
+    arena->chunks = chunk;
+
+    memset(arena->free_lists, 0, sizeof(arena->free_lists));
+    arena->in_use = 0;
+    arena->peak = 0;
+    arena->footprint = sizeof(arena_chunk_t) + chunk->size;
+    arena->peak_footprint = arena->footprint;
+    xSemaphoreGive(arena->lock);
+}
+
+void arena_get_stats(arena_t *arena, arena_stats_t *out) {
+    if (arena->lock == NULL) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    xSemaphoreTake(arena->lock, portMAX_DELAY);
+    fill_stats(arena, out);
+    xSemaphoreGive(arena->lock);
+}
@@ -0,0 +1,157 @@
+/**
+ * @file arena.h
+ * @brief 会话内存池（arena）
+ *
+ * 一次会话（如一次 AI 对话）中反复创建、销毁的小对象不再走通用堆：
+ * 默认配置下小于 4 KB 的 malloc 落在内部 RAM（CONFIG_SPIRAM_MALLOC_ALWAYSINTERNAL），
+ * 逐帧的音频包、字符串会把 TLS 握手需要的内部 RAM 切碎。arena 从指定内存（通常是 PSRAM）
+ * 按块申请，块内顺序（bump）分配，会话结束时整体回收。
+ *
+ * - 不超过 ARENA_MAX_CLASS_SIZE 的分配按 2 的幂分级，释放后挂到对应级别的空闲链表，
+ *   同一会话内复用，长时间对话时占用不会随时间增长
+ * - 更大的分配（如长句语音缓冲）直接向 arena 的内存类型申请，挂在链表上，reset 时一并释放
+ * - arena_reset 整体回收：释放大块和后续申请的块，只保留第一块常驻，下次会话直接复用，
+ *   因此反复开始 / 结束会话不会在堆上留下碎片
+ * - 不可增长的 arena（growable = false）只有初始化时申请的一块，用满后返回 NULL，
+ *   适合放在内部 RAM 的小池
+ *
+ * 线程安全（内部互斥锁），不能在中断中调用。
+ * 调用 arena_reset 前，所有从 arena 分配的内存必须已不再使用（容器已清空并交还容量）。
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARENA_MIN_SHIFT 4    // 最小分级 16 字节
+#define ARENA_NUM_CLASSES 11 // 16 B ~ 16 KB
+#define ARENA_MAX_CLASS_SIZE (1u << (ARENA_MIN_SHIFT + ARENA_NUM_CLASSES - 1))
+
+typedef struct arena_chunk arena_chunk_t;
+typedef struct arena_large arena_large_t;
+
+/** arena 实例（由使用方静态定义，arena_init 之前为全 0） */
+typedef struct {
+    const char *name;
+    uint32_t caps;     // heap_caps 内存类型
+    size_t chunk_size; // 每块可分配字节数
+    bool growable;     // 用满后是否继续申请新块
+    SemaphoreHandle_t lock;
+    StaticSemaphore_t lock_buffer;
+    arena_chunk_t *chunks; // 链表头为当前分配的块，链表尾为常驻的第一块
+    arena_large_t *large;  // 超过最大分级的分配
+    void *free_lists[ARENA_NUM_CLASSES];
+    size_t in_use;         // 当前分配出去的字节（按分级取整）
+    size_t peak;           // 本次会话 in_use 的峰值
+    size_t footprint;      // 当前从堆申请的字节（块 + 大块）
+    size_t peak_footprint; // 本次会话 footprint 的峰值
+} arena_t;
+
+/** 统计信息 */
+typedef struct {
+    size_t in_use;
+    size_t peak;
+    size_t footprint;
+    size_t peak_footprint;
+    uint32_t chunks;
+    uint32_t large_blocks;
+} arena_stats_t;
+
+/**
+ * 初始化 arena 并立即申请第一块（常驻，之后不再释放）
+ *
+ * 已初始化时直接返回 ESP_OK。可增长的 arena 块大小至少为 ARENA_MAX_CLASS_SIZE。
+ * @param name       日志中的名称（须为静态字符串）
+ * @param chunk_size 每块字节数
+ * @param caps       heap_caps 内存类型，如 MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT
+ * @param growable   false 时只使用第一块
+ */
+esp_err_t arena_init(arena_t *arena, const char *name, size_t chunk_size, uint32_t caps, bool growable);
+
+/**
+ * 分配内存（16 字节对齐）
+ * @return 未初始化或内存不足时返回 NULL
+ */
+void *arena_alloc(arena_t *arena, size_t size);
+
+/**
+ * 释放内存
+ * @param size 与分配时相同的字节数（arena 不记录小块的大小）
+ */
+void arena_free(arena_t *arena, void *ptr, size_t size);
+
+/**
+ * 整体回收：释放全部分配，只保留第一块
+ * @param last 可为 NULL；非空时写入回收前的统计（含本次会话峰值）
+ */
+void arena_reset(arena_t *arena, arena_stats_t *last);
+
+/** 读取当前统计 */
+void arena_get_stats(arena_t *arena, arena_stats_t *out);
+
+#ifdef __cplusplus
+}
+
+#include <cstdlib>
+#include <type_traits>
+
+#include "esp_log.h"
+
+/**
+ * STL 分配器适配：容器的内存来自指定 arena
+ *
+ *   std::vector<uint8_t, ArenaAllocator<uint8_t>> buf{ArenaAllocator<uint8_t>(&arena)};
+ *
+ * arena 内存不足时与未开启异常的 operator new 一致，直接 abort。
+ */
+template <typename T> class ArenaAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit ArenaAllocator(arena_t *arena) noexcept : arena_(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena_(other.arena()) {}
+
+    T *allocate(size_t n) {
+        void *p = arena_alloc(arena_, n * sizeof(T));
+        if (p == nullptr) {
+            ESP_LOGE("Arena", "%s: 分配 %u 字节失败", arena_->name ? arena_->name : "?",
+                     (unsigned)(n * sizeof(T)));
+            abort();
+        }
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, size_t n) noexcept { arena_free(arena_, p, n * sizeof(T)); }
+
+    arena_t *arena() const noexcept { return arena_; }
+
+private:
+    arena_t *arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+    return a.arena() != b.arena();
+}
+
+#endif // __cplusplus
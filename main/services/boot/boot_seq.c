@@ -0,0 +1,221 @@
+/**
+ * @file boot_seq.c
+ * @brief 启动阶段编排与时间线实现
+ */
+
+#include "boot_seq.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "BootSeq";
+
+#define BOOT_SEQ_BAR_WIDTH 32 // 时间线条形图宽度（字符）
+
+typedef struct {
+    int64_t start_us;
+    int64_t end_us;
+    int8_t core;
+} stage_record_t;
+
+typedef struct {
+    const char *name;
+    int64_t time_us;
+} mark_record_t;
+
+// ============================================================================
+// 内部变量
+// ============================================================================
+
+static const boot_stage_t *s_stages = NULL;
+static int s_count = 0;
+static uint32_t s_all_bits = 0;
+static EventGroupHandle_t s_done = NULL;
+static stage_record_t s_records[BOOT_SEQ_MAX_STAGES];
+static int64_t s_run_us = 0;
+
+static portMUX_TYPE s_mark_lock = portMUX_INITIALIZER_UNLOCKED;
+static mark_record_t s_marks[BOOT_SEQ_MAX_MARKS];
+static int s_mark_count = 0;
+static bool s_printed = false;
+
+// ============================================================================
+// 执行
+// ============================================================================
+
+static void run_stage(int id) {
+    const boot_stage_t *stage = &s_stages[id];
+    if (stage->deps) {
+        xEventGroupWaitBits(s_done, stage->deps, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    s_records[id].core = (int8_t)xPortGetCoreID();
+    s_records[id].start_us = esp_timer_get_time();
+    stage->fn();
+    s_records[id].end_us = esp_timer_get_time();
+    ESP_LOGD(TAG, "%s 完成（%lld us，核 %d）", stage->name, s_records[id].end_us - s_records[id].start_us,
+             s_records[id].core);
+    xEventGroupSetBits(s_done, BOOT_DEP(id));
+}
+
+static void stage_task(void *arg) {
+    run_stage((int)(intptr_t)arg);
+    vTaskDelete(NULL);
+}
+
+void boot_seq_run(const boot_stage_t *stages, int count) {
+    configASSERT(count > 0 && count <= BOOT_SEQ_MAX_STAGES);
+    s_stages = stages;
+    s_count = count;
+    s_all_bits = (uint32_t)((1ull << count) - 1);
+    s_run_us = esp_timer_get_time();
+    memset(s_records, 0, sizeof(s_records));
+    s_done = xEventGroupCreate();
+    configASSERT(s_done);
+
+    // 依赖只能指向前面的阶段：调用者阶段按表顺序执行，这样任何等待都不会成环
+    for (int i = 0; i < count; i++) {
+        if (stages[i].deps >> i) {
+            ESP_LOGE(TAG, "阶段 %s 依赖了排在后面的阶段（0x%lx）", stages[i].name, (unsigned long)stages[i].deps);
+            configASSERT(0);
+        }
+    }
+
+    // 任务创建失败的阶段与调用者阶段一起按表顺序在当前任务中执行
+    uint32_t inline_bits = 0;
+    for (int i = 0; i < count; i++) {
+        if (stages[i].core == BOOT_CORE_CALLER) {
+            inline_bits |= BOOT_DEP(i);
+            continue;
+        }
+        uint32_t stack = stages[i].stack_size ? stages[i].stack_size : BOOT_SEQ_STAGE_STACK;
+        BaseType_t ret = xTaskCreatePinnedToCore(stage_task, stages[i].name, stack, (void *)(intptr_t)i,
+                                                 BOOT_SEQ_STAGE_PRIO, NULL, stages[i].core);
+        if (ret != pdPASS) {
+            // 创建失败时退回到调用者任务中执行，启动变慢但不丢阶段；
+            // 不能在这里直接执行，它可能依赖还没执行的调用者阶段
+            ESP_LOGW(TAG, "创建阶段任务 %s 失败，在当前任务中执行", stages[i].name);
+            inline_bits |= BOOT_DEP(i);
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (inline_bits & BOOT_DEP(i)) {
+            run_stage(i);
+        }
+    }
+}
+
+bool boot_seq_wait(uint32_t deps, uint32_t timeout_ms) {
+    if (s_done == NULL) {
+        return false;
+    }
+    uint32_t bits = deps ? deps : s_all_bits;
+    EventBits_t got = xEventGroupWaitBits(s_done, bits, pdFALSE, pdTRUE, pdMS_TO_TICKS(timeout_ms));
+    return (got & bits) == bits;
+}
+
+bool boot_seq_done(void) {
+    if (s_done == NULL) {
+        return false;
+    }
+    return (xEventGroupGetBits(s_done) & s_all_bits) == s_all_bits;
+}
+
+// ============================================================================
+// 时间点
+// ============================================================================
+
+void boot_seq_mark_at(const char *name, int64_t time_us) {
+    portENTER_CRITICAL(&s_mark_lock);
+    if (s_mark_count < BOOT_SEQ_MAX_MARKS) {
+        s_marks[s_mark_count].name = name;
+        s_marks[s_mark_count].time_us = time_us;
+        s_mark_count++;
+    }
+    portEXIT_CRITICAL(&s_mark_lock);
+}
+
+void boot_seq_mark(const char *name) {
+    boot_seq_mark_at(name, esp_timer_get_time());
+}
+
+// ============================================================================
+// 打印
+// ============================================================================
+
+static int ms(int64_t us) {
+    return (int)(us / 1000);
+}
+
+/**
+ * 每个阶段一行：名称、核、开始-结束（ms，启动后）、耗时和条形图，按开始时间排序；
+ * 时间点合并为最后一行
+ */
+void boot_seq_print(void) {
+    if (s_printed || s_stages == NULL) {
+        return;
+    }
+    s_printed = true;
+
+    mark_record_t marks[BOOT_SEQ_MAX_MARKS];
+    portENTER_CRITICAL(&s_mark_lock);
+    int mark_count = s_mark_count;
+    memcpy(marks, s_marks, sizeof(marks));
+    portEXIT_CRITICAL(&s_mark_lock);
+
+    int order[BOOT_SEQ_MAX_STAGES];
+    int64_t stages_end = 0;
+    for (int i = 0; i < s_count; i++) {
+        order[i] = i;
+        if (s_records[i].end_us > stages_end) {
+            stages_end = s_records[i].end_us;
+        }
+    }
+    int64_t span = stages_end > 0 ? stages_end : 1;
+    for (int i = 0; i < mark_count; i++) {
+        if (marks[i].time_us > span) {
+            span = marks[i].time_us;
+        }
+    }
+    for (int i = 1; i < s_count; i++) {
+        int id = order[i];
+        int j = i - 1;
+        while (j >= 0 && s_records[order[j]].start_us > s_records[id].start_us) {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = id;
+    }
+
+    ESP_LOGI(TAG, "启动时间线（ms，启动后）：编排开始 %d，全部阶段完成 %d", ms(s_run_us), ms(stages_end));
+    for (int i = 0; i < s_count; i++) {
+        const stage_record_t *r = &s_records[order[i]];
+        char bar[BOOT_SEQ_BAR_WIDTH + 1];
+        if (r->end_us == 0) {
+            ESP_LOGI(TAG, "  %-10s 未完成", s_stages[order[i]].name);
+            continue;
+        }
+        int from = (int)(r->start_us * BOOT_SEQ_BAR_WIDTH / span);
+        int to = (int)(r->end_us * BOOT_SEQ_BAR_WIDTH / span);
+        for (int k = 0; k < BOOT_SEQ_BAR_WIDTH; k++) {
+            bar[k] = (k == from || (k > from && k < to)) ? '#' : '.';
+        }
+        bar[BOOT_SEQ_BAR_WIDTH] = '\0';
+        ESP_LOGI(TAG, "  %-10s c%d %5d-%-5d %5d |%s|", s_stages[order[i]].name, r->core, ms(r->start_us),
+                 ms(r->end_us), ms(r->end_us - r->start_us), bar);
+    }
+    if (mark_count > 0) {
+        char line[160];
+        int len = 0;
+        for (int i = 0; i < mark_count && len < (int)sizeof(line); i++) {
+            len += snprintf(line + len, sizeof(line) - len, "%s%s %d", i ? "，" : "", marks[i].name,
+                            ms(marks[i].time_us));
+        }
+        ESP_LOGI(TAG, "  时间点：%s", line);
+    }
+}
@@ -0,0 +1,73 @@
+/**
+ * @file boot_seq.h
+ * @brief 启动阶段编排与时间线
+ *
+ * 启动阶段以表的形式声明（名称、初始化函数、依赖、运行位置）：
+ * - 每个阶段完成后置位事件组中对应的位，依赖它的阶段等待这些位后开始
+ * - core 为 BOOT_CORE_CALLER 的阶段在 boot_seq_run 的调用者任务中按表顺序执行
+ *   （LVGL 相关阶段必须如此，LVGL 不是线程安全的，之后的主循环也在这个任务里）
+ * - 其余阶段各自创建一个固定在指定核上的任务，依赖满足后立即执行，互不相关的阶段在两个核上并行
+ * - 依赖只能指向表中排在前面的阶段，保证不会死锁
+ *
+ * 每个阶段记录开始 / 结束时间（esp_timer，启动后微秒）和实际运行的核，
+ * boot_seq_mark 记录额外的时间点（首帧、获取 IP 等），boot_seq_print 以紧凑格式打印一次。
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BOOT_SEQ_MAX_STAGES 24 // 事件组可用 24 位
+#define BOOT_SEQ_MAX_MARKS 8
+
+#define BOOT_DEP(id) (1u << (id)) // 依赖表中第 id 个阶段
+#define BOOT_CORE_CALLER (-1)     // 在 boot_seq_run 的调用者任务中运行
+
+#define BOOT_SEQ_STAGE_STACK 4096 // stack_size 为 0 时的任务栈
+#define BOOT_SEQ_STAGE_PRIO 3     // 阶段任务优先级
+
+typedef struct {
+    const char *name;
+    void (*fn)(void);
+    uint32_t deps;       // BOOT_DEP() 的组合
+    int8_t core;         // 0 / 1 或 BOOT_CORE_CALLER
+    uint16_t stack_size; // 阶段任务栈，0 使用 BOOT_SEQ_STAGE_STACK
+} boot_stage_t;
+
+/**
+ * 执行启动阶段表
+ *
+ * 先为非调用者阶段创建任务，再在当前任务中按顺序执行调用者阶段，调用者阶段都完成后返回，
+ * 其余阶段可能仍在后台进行（用 boot_seq_wait 等待）。
+ * @param stages 阶段表，须在启动期间保持有效（通常为 static const）
+ * @param count 阶段数，不超过 BOOT_SEQ_MAX_STAGES
+ */
+void boot_seq_run(const boot_stage_t *stages, int count);
+
+/**
+ * 等待一组阶段完成
+ * @param deps BOOT_DEP() 的组合，0 表示全部阶段
+ * @return 超时前全部完成返回 true
+ */
+bool boot_seq_wait(uint32_t deps, uint32_t timeout_ms);
+
+/** 全部阶段是否已完成（不阻塞） */
+bool boot_seq_done(void);
+
+/** 记录一个时间点（当前时间），名称须为常量字符串 */
+void boot_seq_mark(const char *name);
+
+/** 记录一个指定时间的时间点（启动后微秒） */
+void boot_seq_mark_at(const char *name, int64_t time_us);
+
+/** 打印启动时间线，只在第一次调用时打印 */
+void boot_seq_print(void);
+
+#ifdef __cplusplus
+}
+#endif
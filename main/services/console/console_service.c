@@ -0,0 +1,47 @@
+/**
+ * @file console_service.c
+ * @brief 串口控制台实现
+ */
+
+#include "console_service.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "Console";
+
+#define CONSOLE_PROMPT "hmi>"
+#define CONSOLE_MAX_CMDLINE 256
+
+esp_err_t console_service_start(void) {
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = CONSOLE_PROMPT;
+    repl_config.max_cmdline_length = CONSOLE_MAX_CMDLINE;
+
+    esp_err_t ret;
+#if CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG
+    esp_console_dev_usb_serial_jtag_config_t dev_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    ret = esp_console_new_repl_usb_serial_jtag(&dev_config, &repl_config, &repl);
+#elif CONFIG_ESP_CONSOLE_USB_CDC
+    esp_console_dev_usb_cdc_config_t dev_config = ESP_CONSOLE_DEV_CDC_CONFIG_DEFAULT();
+    ret = esp_console_new_repl_usb_cdc(&dev_config, &repl_config, &repl);
+#else
+    esp_console_dev_uart_config_t dev_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    ret = esp_console_new_repl_uart(&dev_config, &repl_config, &repl);
+#endif
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "创建控制台失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    esp_console_register_help_command();
+
+    ret = esp_console_start_repl(repl);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "启动控制台失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "控制台已启动，输入 help 查看命令");
+    return ESP_OK;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file console_service.h
+ * @brief 串口控制台（esp_console REPL）
+ *
+ * 在 sdkconfig 选择的控制台设备（USB Serial/JTAG、USB CDC 或 UART）上运行 REPL，提示符 "hmi>"。
+ * 各模块在启动后用 esp_console_cmd_register 注册自己的命令（如 trace_register_console），
+ * 输入 help 列出全部命令。
+ */
+
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 启动控制台 REPL 任务，之后才能注册命令
+ * @return ESP_OK 成功
+ */
+esp_err_t console_service_start(void);
+
+#ifdef __cplusplus
+}
+#endif
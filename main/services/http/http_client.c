@@ -1,6 +1,7 @@
 #include "http_client.h"
 #include "esp_log.h"
 #include "esp_heap_caps.h"
+#include "utils.h"
 #include <string.h>
 #include <stdio.h>
 #include <sys/stat.h>
@@ -22,6 +23,13 @@
 
 static const char *TAG = "HttpClient";
 
+// HTTPS 握手前确保内部 RAM 充足（必要时让其他模块释放可重建的常驻状态）
+static void reserve_tls_memory(const char *url) {
+    if (url != NULL && strncmp(url, "https", 5) == 0) {
+        utils_mem_reclaim_internal(CONFIG_APP_TLS_INTERNAL_RESERVE);
+    }
+}
+
 // HTTP事件处理器
 static esp_err_t http_event_handler(esp_http_client_event_t *evt) {
     http_request_config_t *config = (http_request_config_t *)evt->user_data;
@@ -405,6 +413,7 @@ esp_err_t http_client_post_multipart_streaming(const http_request_config_t *conf
     }
 
     // 初始化HTTP客户端
+    reserve_tls_memory(client_config.url);
     esp_http_client_handle_t client = esp_http_client_init(&client_config);
     if (client == NULL) {
         ESP_LOGE(TAG, "无法初始化HTTP客户端");
@@ -702,6 +711,7 @@ esp_err_t http_client_request(const http_request_config_t *config,
         client_config.crt_bundle_attach = NULL;
     }
 
+    reserve_tls_memory(client_config.url);
     esp_http_client_handle_t client = esp_http_client_init(&client_config);
     if (client == NULL) {
         ESP_LOGE(TAG, "无法初始化HTTP客户端");
@@ -0,0 +1,380 @@
+/**
+ * @file metrics.c
+ * @brief 运行指标注册表与系统指标采集实现
+ */
+
+#include "metrics.h"
+#include "esp_console.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "utils.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "Metrics";
+
+#define METRICS_COLLECT_INTERVAL_MS 5000       // 采集周期
+#define METRICS_LOW_INTERNAL_BYTES (100 * 1024) // 内部 RAM 低于此值时打印详细分解
+#define METRICS_BREAKDOWN_INTERVAL_MS 60000     // 详细分解最多每分钟打印一次
+#define METRICS_SNAPSHOT_SIZE 8192              // 控制台输出缓冲区
+
+typedef enum {
+    METRIC_COUNTER = 0,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM,
+} metric_type_t;
+
+struct metric {
+    const char *name;
+    uint8_t type;
+    uint8_t bucket_count;
+    const uint32_t *bounds;
+    uint32_t value; // 计数器 / 仪表（按 int32 解释）
+    uint32_t sum;   // 直方图总和
+    uint32_t buckets[METRICS_MAX_BUCKETS + 1];
+};
+
+// ============================================================================
+// 注册表
+// ============================================================================
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static struct metric s_metrics[METRICS_MAX_COUNT];
+static int s_count = 0;
+static struct metric s_overflow; // 注册表满时返回，更新照常进行但不输出
+
+static metric_t *register_metric(const char *name, metric_type_t type, const uint32_t *bounds, int count) {
+    metric_t *m = NULL;
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < s_count; i++) {
+        if (strcmp(s_metrics[i].name, name) == 0) {
+            m = &s_metrics[i];
+            break;
+        }
+    }
+    if (m == NULL && s_count < METRICS_MAX_COUNT) {
+        m = &s_metrics[s_count];
+        m->name = name;
+        m->type = (uint8_t)type;
+        m->bounds = bounds;
+        m->bucket_count = (uint8_t)count;
+        __atomic_store_n(&s_count, s_count + 1, __ATOMIC_RELEASE); // 快照不加锁读取，先填好再发布
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (m == NULL) {
+        ESP_LOGW(TAG, "注册表已满（%d），指标 %s 不输出", METRICS_MAX_COUNT, name);
+        return &s_overflow;
+    }
+    if (m->type != type) {
+        ESP_LOGW(TAG, "指标 %s 已按其他类型注册", name);
+    }
+    return m;
+}
+
+metric_t *metrics_counter(const char *name) {
+    return register_metric(name, METRIC_COUNTER, NULL, 0);
+}
+
+metric_t *metrics_gauge(const char *name) {
+    return register_metric(name, METRIC_GAUGE, NULL, 0);
+}
+
+metric_t *metrics_histogram(const char *name, const uint32_t *bounds, int count) {
+    if (count > METRICS_MAX_BUCKETS) {
+        ESP_LOGW(TAG, "直方图 %s 分桶过多（%d），只保留前 %d 个", name, count, METRICS_MAX_BUCKETS);
+        count = METRICS_MAX_BUCKETS;
+    }
+    return register_metric(name, METRIC_HISTOGRAM, bounds, count);
+}
+
+// ============================================================================
+// 更新（无锁）
+// ============================================================================
+
+void metrics_counter_add(metric_t *m, uint32_t n) {
+    __atomic_fetch_add(&m->value, n, __ATOMIC_RELAXED);
+}
+
+void metrics_gauge_set(metric_t *m, int32_t value) {
+    __atomic_store_n(&m->value, (uint32_t)value, __ATOMIC_RELAXED);
+}
+
+void metrics_histogram_observe(metric_t *m, uint32_t value) {
+    int i = 0;
+    while (i < m->bucket_count && value > m->bounds[i]) {
+        i++;
+    }
+    __atomic_fetch_add(&m->buckets[i], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&m->sum, value, __ATOMIC_RELAXED);
+}
+
+// ============================================================================
+// 系统指标采集
+// ============================================================================
+
+typedef struct {
+    metric_t *free;
+    metric_t *largest;
+    metric_t *min;
+} heap_metrics_t;
+
+static heap_metrics_t s_heap_internal;
+static heap_metrics_t s_heap_psram;
+static heap_metrics_t s_heap_dma;
+static metric_t *s_cpu_load[portNUM_PROCESSORS];
+
+static metrics_task_t s_tasks[METRICS_MAX_TASKS];
+static int s_task_count = 0;
+
+#if configGENERATE_RUN_TIME_STATS
+// 上一次采集时各任务的运行时间，按任务编号匹配
+typedef struct {
+    UBaseType_t number;
+    configRUN_TIME_COUNTER_TYPE runtime;
+} runtime_record_t;
+
+static runtime_record_t s_prev_runtime[METRICS_MAX_TASKS];
+static int s_prev_count = 0;
+static configRUN_TIME_COUNTER_TYPE s_prev_total = 0;
+#endif
+
+static void heap_metrics_init(heap_metrics_t *h, const char *free_name, const char *largest_name,
+                              const char *min_name) {
+    h->free = metrics_gauge(free_name);
+    h->largest = metrics_gauge(largest_name);
+    h->min = min_name ? metrics_gauge(min_name) : NULL;
+}
+
+static void collect_heap(heap_metrics_t *h, uint32_t caps) {
+    metrics_gauge_set(h->free, (int32_t)heap_caps_get_free_size(caps));
+    metrics_gauge_set(h->largest, (int32_t)heap_caps_get_largest_free_block(caps));
+    if (h->min) {
+        metrics_gauge_set(h->min, (int32_t)heap_caps_get_minimum_free_size(caps));
+    }
+}
+
+static void collect_tasks(void) {
+    UBaseType_t capacity = uxTaskGetNumberOfTasks() + 4;
+    TaskStatus_t *status = malloc(capacity * sizeof(TaskStatus_t));
+    if (status == NULL) {
+        return;
+    }
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t n = uxTaskGetSystemState(status, capacity, &total);
+
+    metrics_task_t tasks[METRICS_MAX_TASKS];
+    int count = 0;
+#if configGENERATE_RUN_TIME_STATS
+    // 运行时间计数为 32 位微秒，按无符号差值计算，采集周期远小于回绕周期
+    configRUN_TIME_COUNTER_TYPE elapsed = total - s_prev_total;
+    runtime_record_t runtime[METRICS_MAX_TASKS];
+    int runtime_count = 0;
+#endif
+
+    for (UBaseType_t i = 0; i < n && count < METRICS_MAX_TASKS; i++) {
+        metrics_task_t *t = &tasks[count++];
+        snprintf(t->name, sizeof(t->name), "%s", status[i].pcTaskName);
+        t->stack_free = (uint32_t)status[i].usStackHighWaterMark; // ESP-IDF 中单位为字节
+        t->priority = (uint8_t)status[i].uxCurrentPriority;
+        t->cpu_percent = 0xFF;
+#if configGENERATE_RUN_TIME_STATS
+        runtime[runtime_count].number = status[i].xTaskNumber;
+        runtime[runtime_count].runtime = status[i].ulRunTimeCounter;
+        runtime_count++;
+        if (s_prev_total == 0 || elapsed == 0) {
+            continue;
+        }
+        for (int k = 0; k < s_prev_count; k++) {
+            if (s_prev_runtime[k].number == status[i].xTaskNumber) {
+                uint64_t delta = (configRUN_TIME_COUNTER_TYPE)(status[i].ulRunTimeCounter - s_prev_runtime[k].runtime);
+                uint32_t pct = (uint32_t)(delta * 100 / elapsed);
+                t->cpu_percent = (uint8_t)(pct > 100 ? 100 : pct);
+                break;
+            }
+        }
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            if (status[i].xHandle == xTaskGetIdleTaskHandleForCore(core) && t->cpu_percent != 0xFF) {
+                metrics_gauge_set(s_cpu_load[core], 100 - t->cpu_percent);
+            }
+        }
+#endif
+    }
+    free(status);
+
+#if configGENERATE_RUN_TIME_STATS
+    memcpy(s_prev_runtime, runtime, runtime_count * sizeof(runtime_record_t));
+    s_prev_count = runtime_count;
+    s_prev_total = total;
+#endif
+
+    portENTER_CRITICAL(&s_lock);
+    memcpy(s_tasks, tasks, count * sizeof(metrics_task_t));
+    s_task_count = count;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+static void metrics_task(void *parameter) {
+    TickType_t last_breakdown = 0;
+    bool breakdown_printed = false;
+
+    while (1) {
+        collect_heap(&s_heap_internal, MALLOC_CAP_INTERNAL);
+        collect_heap(&s_heap_psram, MALLOC_CAP_SPIRAM);
+        collect_heap(&s_heap_dma, MALLOC_CAP_DMA);
+        collect_tasks();
+
+        // 内存紧张时仍打印详细分解（LVGL / EEZ 堆的分级统计不进注册表）
+        if (heap_caps_get_free_size(MALLOC_CAP_INTERNAL) < METRICS_LOW_INTERNAL_BYTES) {
+            TickType_t now = xTaskGetTickCount();
+            if (!breakdown_printed || now - last_breakdown >= pdMS_TO_TICKS(METRICS_BREAKDOWN_INTERVAL_MS)) {
+                utils_print_memory_breakdown();
+                last_breakdown = now;
+                breakdown_printed = true;
+            }
+        } else {
+            breakdown_printed = false;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(METRICS_COLLECT_INTERVAL_MS));
+    }
+
+    vTaskDelete(NULL);
+}
+
+void metrics_start(void) {
+    heap_metrics_init(&s_heap_internal, "heap.internal.free", "heap.internal.largest", "heap.internal.min");
+    heap_metrics_init(&s_heap_psram, "heap.psram.free", "heap.psram.largest", "heap.psram.min");
+    heap_metrics_init(&s_heap_dma, "heap.dma.free", "heap.dma.largest", NULL);
+#if configGENERATE_RUN_TIME_STATS
+    static const char *const cpu_names[] = {"cpu0.load", "cpu1.load"};
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        s_cpu_load[core] = metrics_gauge(cpu_names[core]);
+    }
+#endif
+
+    if (xTaskCreatePinnedToCore(metrics_task, "metrics", 4096, NULL, 1, NULL, 1) != pdPASS) {
+        ESP_LOGE(TAG, "创建指标采集任务失败");
+    }
+}
+
+int metrics_get_tasks(metrics_task_t *out, int max) {
+    portENTER_CRITICAL(&s_lock);
+    int count = s_task_count < max ? s_task_count : max;
+    memcpy(out, s_tasks, count * sizeof(metrics_task_t));
+    portEXIT_CRITICAL(&s_lock);
+    return count;
+}
+
+// ============================================================================
+// 快照
+// ============================================================================
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    bool overflow;
+} writer_t;
+
+static void put(writer_t *w, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void put(writer_t *w, const char *fmt, ...) {
+    if (w->overflow) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(w->buf + w->len, w->size - w->len, fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= w->size - w->len) {
+        w->overflow = true;
+        return;
+    }
+    w->len += n;
+}
+
+int metrics_snapshot(char *buffer, size_t buffer_size) {
+    if (buffer == NULL || buffer_size == 0) {
+        return -1;
+    }
+    writer_t w = {buffer, buffer_size, 0, false};
+    put(&w, "# metrics v1 uptime_ms=%lld\n", (long long)(esp_timer_get_time() / 1000));
+
+    // 注册只追加，读取计数后无需加锁
+    int count = __atomic_load_n(&s_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < count; i++) {
+        const struct metric *m = &s_metrics[i];
+        switch (m->type) {
+        case METRIC_COUNTER:
+            put(&w, "c %s %lu\n", m->name, (unsigned long)m->value);
+            break;
+        case METRIC_GAUGE:
+            put(&w, "g %s %ld\n", m->name, (long)(int32_t)m->value);
+            break;
+        case METRIC_HISTOGRAM: {
+            // 各桶分别读取，次数按桶求和，与分桶一致
+            uint32_t buckets[METRICS_MAX_BUCKETS + 1];
+            uint32_t total = 0;
+            for (int b = 0; b <= m->bucket_count; b++) {
+                buckets[b] = __atomic_load_n(&m->buckets[b], __ATOMIC_RELAXED);
+                total += buckets[b];
+            }
+            put(&w, "h %s %lu %lu", m->name, (unsigned long)total, (unsigned long)m->sum);
+            for (int b = 0; b < m->bucket_count; b++) {
+                put(&w, " %lu:%lu", (unsigned long)m->bounds[b], (unsigned long)buckets[b]);
+            }
+            put(&w, " +:%lu\n", (unsigned long)buckets[m->bucket_count]);
+            break;
+        }
+        }
+    }
+
+    metrics_task_t tasks[METRICS_MAX_TASKS];
+    int task_count = metrics_get_tasks(tasks, METRICS_MAX_TASKS);
+    for (int i = 0; i < task_count; i++) {
+        if (tasks[i].cpu_percent == 0xFF) {
+            put(&w, "t %s %lu - %u\n", tasks[i].name, (unsigned long)tasks[i].stack_free, tasks[i].priority);
+        } else {
+            put(&w, "t %s %lu %u %u\n", tasks[i].name, (unsigned long)tasks[i].stack_free, tasks[i].cpu_percent,
+                tasks[i].priority);
+        }
+    }
+    return w.overflow ? -1 : (int)w.len;
+}
+
+// ============================================================================
+// 控制台命令
+// ============================================================================
+
+static int cmd_metrics(int argc, char **argv) {
+    char *buf = heap_caps_malloc(METRICS_SNAPSHOT_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buf == NULL) {
+        printf("内存不足\n");
+        return 1;
+    }
+    int len = metrics_snapshot(buf, METRICS_SNAPSHOT_SIZE);
+    if (len < 0) {
+        printf("快照超过 %d 字节\n", METRICS_SNAPSHOT_SIZE);
+    } else {
+        fwrite(buf, 1, len, stdout);
+    }
+    heap_caps_free(buf);
+    return len < 0 ? 1 : 0;
+}
+
+void metrics_register_console(void) {
+    const esp_console_cmd_t cmd = {
+        .command = "metrics",
+        .help = "打印运行指标快照：计数器 c / 仪表 g / 直方图 h / 任务 t（栈剩余字节、CPU%、优先级）",
+        .hint = NULL,
+        .func = cmd_metrics,
+    };
+    esp_console_cmd_register(&cmd);
+}
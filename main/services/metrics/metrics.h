@@ -0,0 +1,85 @@
+/**
+ * @file metrics.h
+ * @brief 运行指标注册表
+ *
+ * 取代每 5 秒打印一次内存信息的 mem_monitor 任务：各模块注册计数器、仪表和固定分桶直方图，
+ * 后台任务定期采集堆（内部 RAM / PSRAM / DMA 的可用、最大连续块、历史最小）、
+ * 每个任务的栈高水位和 CPU 占用，统一由 metrics_snapshot() 输出一段紧凑文本，
+ * 供控制台命令 `metrics` 查看或随 HTTP 请求上传，不再依赖读串口日志。
+ *
+ * - 注册在启动时进行（内部加锁），按名称去重：同名再次注册返回同一个指标
+ * - 更新只做 32 位原子操作，不加锁，任意任务都可以调用，适合热路径（不能在中断中调用）
+ * - 注册表满时返回一个共享的空指标，调用方不需要判空
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define METRICS_MAX_COUNT 48  // 注册表容量
+#define METRICS_MAX_BUCKETS 8 // 直方图最多分桶上界数（另有一个溢出桶）
+#define METRICS_MAX_TASKS 32  // 任务表容量
+
+typedef struct metric metric_t;
+
+/** 任务统计（每次采集刷新） */
+typedef struct {
+    char name[16];
+    uint32_t stack_free;  // 栈历史最小剩余（字节）
+    uint8_t cpu_percent;  // 上一采集周期内占单核的百分比；未开启运行时间统计时为 0xFF
+    uint8_t priority;
+} metrics_task_t;
+
+/** 计数器：只增（32 位，回绕后由接收端按无符号差值处理） */
+metric_t *metrics_counter(const char *name);
+
+/** 仪表：记录当前值 */
+metric_t *metrics_gauge(const char *name);
+
+/**
+ * 直方图：按上界分桶计数并累计总和
+ * @param bounds 递增的桶上界（含），须为静态存储；超过最后一个上界的值计入溢出桶
+ * @param count  上界个数，最多 METRICS_MAX_BUCKETS
+ */
+metric_t *metrics_histogram(const char *name, const uint32_t *bounds, int count);
+
+void metrics_counter_add(metric_t *m, uint32_t n);
+void metrics_gauge_set(metric_t *m, int32_t value);
+void metrics_histogram_observe(metric_t *m, uint32_t value);
+
+/**
+ * 启动采集任务（替代原 mem_monitor 任务）
+ *
+ * 每 METRICS_COLLECT_INTERVAL_MS 采集一次系统指标；内部 RAM 低于阈值时打印详细内存分解
+ */
+void metrics_start(void);
+
+/**
+ * 复制最近一次采集的任务表
+ * @return 任务数
+ */
+int metrics_get_tasks(metrics_task_t *out, int max);
+
+/**
+ * 输出全部指标的文本快照（每行一项，空格分隔，便于脚本解析）：
+ *   # metrics v1 uptime_ms=<启动后毫秒>
+ *   c <名称> <值>                              计数器
+ *   g <名称> <值>                              仪表
+ *   h <名称> <次数> <总和> <上界>:<个数>... +:<溢出个数>  直方图
+ *   t <任务名> <栈剩余字节> <CPU%|-> <优先级>  任务
+ *
+ * @return 写入的字节数（不含结尾 0）；缓冲区不足时返回 -1
+ */
+int metrics_snapshot(char *buffer, size_t buffer_size);
+
+/** 注册控制台命令 metrics（需在 console_service_start 之后） */
+void metrics_register_console(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,13 +4,27 @@
  */
 
 #include "network_monitor.h"
+#include "metrics.h"
 #include "wifi_service.h"
 #include "pcm5101.h"
+#include "prompt.h"
+#include "app_config.h"
+#include "esp_event.h"
 #include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
 #include "freertos/task.h"
+#include "lwip/netdb.h"
+#include "lwip/sockets.h"
+#include <errno.h>
+#include <fcntl.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 static const char *TAG = "NetMonitor";
 
@@ -18,48 +32,293 @@ static const char *TAG = "NetMonitor";
 // 配置参数
 // ============================================================================
 
-// 网络断开提示音文件路径（SD卡）
+// 网络断开提示音文件路径（SD卡，提示音缓存未加载时直接播放）
 #define NETWORK_ALERT_DIR "/sdcard"
 #define NETWORK_ALERT_FILE "no_network.mp3"
 
-// 网络检测间隔（毫秒）
-#define NETWORK_CHECK_INTERVAL_MS 5000
-
 // 网络断开后播放提示音的间隔（毫秒）- 避免频繁播放
 #define NETWORK_ALERT_INTERVAL_MS 60000
 
 // 启动后首次检测延迟（等待音频系统就绪）
 #define STARTUP_DELAY_MS 3000
 
+// 后端可达时的探测间隔
+#define NETWORK_PROBE_INTERVAL_MS 15000
+// 不可达时的探测间隔：从最小值起每次加倍
+#define NETWORK_PROBE_RETRY_MIN_MS 2000
+#define NETWORK_PROBE_RETRY_MAX_MS 30000
+// 两次探测的最小间隔（服务频繁报告失败时）
+#define NETWORK_PROBE_MIN_GAP_MS 1000
+// 单次 TCP 建连超时
+#define NETWORK_PROBE_TIMEOUT_MS 3000
+// 连续失败多少次判定为不可达
+#define NETWORK_PROBE_FAIL_THRESHOLD 2
+// 往返时间超过该值视为降级
+#define NETWORK_DEGRADED_RTT_MS 1000
+// 失败率超过该值（‰）视为降级
+#define NETWORK_DEGRADED_LOSS_PERMILLE 200
+// EWMA 系数 1/2^N（与 TCP SRTT 相同取 1/8）
+#define NETWORK_EWMA_SHIFT 3
+
+// 事件位
+#define EV_LINK_CHANGED BIT0 // WiFi 断开 / 获取或丢失 IP
+#define EV_PROBE_NOW    BIT1 // 服务报告请求失败
+#define EV_STOP         BIT2
+#define EV_REACHABLE    BIT3 // 电平：后端可达（ONLINE / DEGRADED）
+
 // ============================================================================
 // 内部变量
 // ============================================================================
 
 static TaskHandle_t g_monitor_task_handle = NULL;
 static volatile bool g_monitor_running = false;
+static EventGroupHandle_t g_events = NULL;
+static esp_event_handler_instance_t g_wifi_handler = NULL;
+static esp_event_handler_instance_t g_ip_handler = NULL;
+
+static portMUX_TYPE g_status_lock = portMUX_INITIALIZER_UNLOCKED;
+static net_status_t g_status;
+
+// 探测目标（由 CG_API_URL 解析）
+static char g_probe_host[128];
+static uint16_t g_probe_port = 443;
+static struct sockaddr_in g_probe_addr; // DNS 结果缓存，链路变化或探测失败后重新解析
+static bool g_probe_addr_valid = false;
+
+// 探测往返时间分布（ms）与失败次数，随指标快照上传
+static const uint32_t g_rtt_bounds[] = {20, 50, 100, 200, 500, 1000, 2000};
+static metric_t *g_rtt_metric;
+static metric_t *g_fail_metric;
+
+static const char *state_name(net_state_t state) {
+    switch (state) {
+        case NET_STATE_DOWN: return "断开";
+        case NET_STATE_UNKNOWN: return "未探测";
+        case NET_STATE_ONLINE: return "可达";
+        case NET_STATE_DEGRADED: return "降级";
+        case NET_STATE_UNREACHABLE: return "不可达";
+        default: return "?";
+    }
+}
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// ============================================================================
+// 事件
+// ============================================================================
+
+static void link_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
+    xEventGroupSetBits(g_events, EV_LINK_CHANGED);
+}
+
+static void register_link_events(void) {
+    esp_event_handler_instance_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, link_event_handler, NULL,
+                                        &g_wifi_handler);
+    esp_event_handler_instance_register(IP_EVENT, ESP_EVENT_ANY_ID, link_event_handler, NULL, &g_ip_handler);
+}
+
+static void unregister_link_events(void) {
+    if (g_wifi_handler) {
+        esp_event_handler_instance_unregister(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, g_wifi_handler);
+        g_wifi_handler = NULL;
+    }
+    if (g_ip_handler) {
+        esp_event_handler_instance_unregister(IP_EVENT, ESP_EVENT_ANY_ID, g_ip_handler);
+        g_ip_handler = NULL;
+    }
+}
+
+// ============================================================================
+// 状态
+// ============================================================================
+
+static void set_state(net_state_t state) {
+    portENTER_CRITICAL(&g_status_lock);
+    net_state_t old = g_status.state;
+    g_status.state = state;
+    portEXIT_CRITICAL(&g_status_lock);
+
+    if (state == NET_STATE_ONLINE || state == NET_STATE_DEGRADED) {
+        xEventGroupSetBits(g_events, EV_REACHABLE);
+    } else {
+        xEventGroupClearBits(g_events, EV_REACHABLE);
+    }
+    if (old != state) {
+        ESP_LOGI(TAG, "网络状态: %s -> %s", state_name(old), state_name(state));
+    }
+}
+
+static net_state_t get_state(void) {
+    portENTER_CRITICAL(&g_status_lock);
+    net_state_t state = g_status.state;
+    portEXIT_CRITICAL(&g_status_lock);
+    return state;
+}
+
+// ============================================================================
+// 探测
+// ============================================================================
+
+/** 从 URL 取主机和端口（scheme://host[:port]/...） */
+static void parse_probe_target(const char *url) {
+    const char *host = strstr(url, "://");
+    bool tls = strncmp(url, "https", 5) == 0 || strncmp(url, "wss", 3) == 0;
+    host = host ? host + 3 : url;
+    size_t len = strcspn(host, ":/");
+    if (len >= sizeof(g_probe_host)) {
+        len = sizeof(g_probe_host) - 1;
+    }
+    memcpy(g_probe_host, host, len);
+    g_probe_host[len] = '\0';
+    g_probe_port = tls ? 443 : 80;
+    if (host[len] == ':') {
+        g_probe_port = (uint16_t)atoi(host + len + 1);
+    }
+}
+
+static bool resolve_probe_target(void) {
+    struct addrinfo hints = {
+        .ai_family = AF_INET,
+        .ai_socktype = SOCK_STREAM,
+    };
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(g_probe_host, NULL, &hints, &res) != 0 || res == NULL) {
+        ESP_LOGW(TAG, "解析 %s 失败", g_probe_host);
+        return false;
+    }
+    memcpy(&g_probe_addr, res->ai_addr, sizeof(g_probe_addr));
+    g_probe_addr.sin_port = htons(g_probe_port);
+    freeaddrinfo(res);
+    g_probe_addr_valid = true;
+    return true;
+}
+
+/**
+ * TCP 建连探测（非阻塞 connect + select），成功后立即关闭
+ * @param rtt_ms 成功时返回建连耗时
+ */
+static bool probe_once(uint32_t *rtt_ms) {
+    if (!g_probe_addr_valid && !resolve_probe_target()) {
+        return false;
+    }
+    int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) {
+        return false;
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+    int64_t t0 = esp_timer_get_time();
+    bool ok = false;
+    int ret = connect(sock, (struct sockaddr *)&g_probe_addr, sizeof(g_probe_addr));
+    if (ret == 0) {
+        ok = true;
+    } else if (errno == EINPROGRESS) {
+        fd_set wfds;
+        FD_ZERO(&wfds);
+        FD_SET(sock, &wfds);
+        struct timeval tv = {
+            .tv_sec = NETWORK_PROBE_TIMEOUT_MS / 1000,
+            .tv_usec = (NETWORK_PROBE_TIMEOUT_MS % 1000) * 1000,
+        };
+        if (select(sock + 1, NULL, &wfds, NULL, &tv) > 0) {
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &len);
+            ok = err == 0;
+        }
+    }
+    *rtt_ms = (uint32_t)((esp_timer_get_time() - t0) / 1000);
+    close(sock);
+
+    if (!ok) {
+        // 地址可能已变化，下次重新解析
+        g_probe_addr_valid = false;
+    }
+    return ok;
+}
+
+/** 探测一次并更新 EWMA 和状态，返回下次探测前的等待时间 */
+static uint32_t probe_and_update(uint32_t retry_ms) {
+    uint32_t rtt = 0;
+    bool ok = probe_once(&rtt);
+
+    portENTER_CRITICAL(&g_status_lock);
+    net_status_t *st = &g_status;
+    st->probes++;
+    int32_t loss_sample = ok ? 0 : 1000;
+    st->loss_permille = (uint16_t)((int32_t)st->loss_permille +
+                                   ((loss_sample - (int32_t)st->loss_permille) >> NETWORK_EWMA_SHIFT));
+    if (ok) {
+        st->rtt_last_ms = rtt;
+        if (st->rtt_ms == 0) {
+            st->rtt_ms = rtt;
+        } else {
+            st->rtt_ms = (uint32_t)((int32_t)st->rtt_ms + (((int32_t)rtt - (int32_t)st->rtt_ms) >> NETWORK_EWMA_SHIFT));
+        }
+        st->fail_streak = 0;
+    } else {
+        st->failures++;
+        st->fail_streak++;
+    }
+    net_status_t snapshot = *st;
+    portEXIT_CRITICAL(&g_status_lock);
+
+    net_state_t state;
+    if (snapshot.fail_streak >= NETWORK_PROBE_FAIL_THRESHOLD) {
+        state = NET_STATE_UNREACHABLE;
+    } else if (snapshot.fail_streak > 0 || snapshot.rtt_ms >= NETWORK_DEGRADED_RTT_MS ||
+               snapshot.loss_permille >= NETWORK_DEGRADED_LOSS_PERMILLE) {
+        state = NET_STATE_DEGRADED;
+    } else {
+        state = NET_STATE_ONLINE;
+    }
+    set_state(state);
+
+    if (ok) {
+        metrics_histogram_observe(g_rtt_metric, rtt);
+        ESP_LOGD(TAG, "探测 %s:%u 成功 %lu ms（平均 %lu ms，失败率 %u‰）", g_probe_host, g_probe_port,
+                 (unsigned long)rtt, (unsigned long)snapshot.rtt_ms, snapshot.loss_permille);
+        return NETWORK_PROBE_INTERVAL_MS;
+    }
+    metrics_counter_add(g_fail_metric, 1);
+    ESP_LOGW(TAG, "探测 %s:%u 失败（连续 %u 次，失败率 %u‰）", g_probe_host, g_probe_port, snapshot.fail_streak,
+             snapshot.loss_permille);
+    return state == NET_STATE_UNREACHABLE ? retry_ms : NETWORK_PROBE_RETRY_MIN_MS;
+}
 
 // ============================================================================
 // 任务实现
 // ============================================================================
 
+static void play_alert(void) {
+    if (prompt_play(PROMPT_NO_NETWORK) == ESP_OK) {
+        ESP_LOGI(TAG, "播放网络断开提示音");
+        return;
+    }
+    ESP_LOGI(TAG, "播放网络断开提示音: %s/%s", NETWORK_ALERT_DIR, NETWORK_ALERT_FILE);
+    Play_Music(NETWORK_ALERT_DIR, NETWORK_ALERT_FILE);
+}
+
 /**
  * @brief 网络监控任务
  *
- * 检测网络连接状态，断开时播放语音提示
+ * 等待链路事件或下一次探测 / 提示音的时间点，其余时间阻塞
  */
 static void network_monitor_task(void *parameter) {
     ESP_LOGI(TAG, "网络监控任务启动，等待系统初始化...");
-    
+
     // 等待系统完全初始化（WiFi + 音频）
     vTaskDelay(pdMS_TO_TICKS(STARTUP_DELAY_MS));
-    
+
     // 等待 WiFi 初始化完成
     int wait_count = 0;
     while (!WiFi_IsInitComplete() && wait_count < 60) {
         vTaskDelay(pdMS_TO_TICKS(1000));
         wait_count++;
     }
-    
+
     if (!WiFi_IsInitComplete()) {
         ESP_LOGE(TAG, "WiFi 初始化超时，网络监控任务退出");
         g_monitor_task_handle = NULL;
@@ -67,51 +326,91 @@ static void network_monitor_task(void *parameter) {
         vTaskDelete(NULL);
         return;
     }
-    
-    ESP_LOGI(TAG, "开始监控网络连接状态");
-    
+
+    // WIFI_Init 已创建默认事件循环
+    register_link_events();
+    ESP_LOGI(TAG, "开始监控网络连接状态，探测目标 %s:%u", g_probe_host, g_probe_port);
+
     bool last_connected = WiFi_IsConnected();
     uint32_t last_alert_time = 0;
-    
+    uint32_t next_probe_time = now_ms();
+    uint32_t last_probe_time = 0;
+    uint32_t retry_ms = NETWORK_PROBE_RETRY_MIN_MS;
+
     // 如果启动时就没有网络，立即播放提示音
     if (!last_connected) {
         ESP_LOGW(TAG, "启动时网络未连接，播放提示音");
-        Play_Music(NETWORK_ALERT_DIR, NETWORK_ALERT_FILE);
-        last_alert_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        set_state(NET_STATE_DOWN);
+        play_alert();
+        last_alert_time = now_ms();
+    } else {
+        set_state(NET_STATE_UNKNOWN);
     }
-    
+
     while (g_monitor_running) {
+        // 计算下一个时间点：连通时为下次探测，断开时为下次提示音
+        uint32_t now = now_ms();
+        uint32_t wait_ms;
+        if (last_connected) {
+            wait_ms = (int32_t)(next_probe_time - now) > 0 ? next_probe_time - now : 0;
+        } else {
+            uint32_t since = now - last_alert_time;
+            wait_ms = since < NETWORK_ALERT_INTERVAL_MS ? NETWORK_ALERT_INTERVAL_MS - since : 0;
+        }
+        EventBits_t bits = xEventGroupWaitBits(g_events, EV_LINK_CHANGED | EV_PROBE_NOW | EV_STOP, pdTRUE,
+                                               pdFALSE, pdMS_TO_TICKS(wait_ms));
+        if (bits & EV_STOP) {
+            break;
+        }
+        now = now_ms();
+
         bool connected = WiFi_IsConnected();
-        uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
-        
-        // 检测网络状态变化
         if (connected != last_connected) {
+            portENTER_CRITICAL(&g_status_lock);
+            g_status.link_changes++;
+            portEXIT_CRITICAL(&g_status_lock);
             if (!connected) {
-                // 网络刚断开
                 ESP_LOGW(TAG, "检测到网络断开！");
-                
-                // 播放提示音
-                ESP_LOGI(TAG, "播放网络断开提示音: %s/%s", 
-                         NETWORK_ALERT_DIR, NETWORK_ALERT_FILE);
-                Play_Music(NETWORK_ALERT_DIR, NETWORK_ALERT_FILE);
+                set_state(NET_STATE_DOWN);
+                play_alert();
                 last_alert_time = now;
             } else {
-                // 网络恢复连接
+                // 网络恢复：立即探测，DNS 重新解析
                 ESP_LOGI(TAG, "网络已恢复连接");
+                set_state(NET_STATE_UNKNOWN);
+                g_probe_addr_valid = false;
+                retry_ms = NETWORK_PROBE_RETRY_MIN_MS;
+                next_probe_time = now;
             }
             last_connected = connected;
         }
-        
-        // 如果网络持续断开，定期播放提示音
-        if (!connected && (now - last_alert_time >= NETWORK_ALERT_INTERVAL_MS)) {
-            ESP_LOGW(TAG, "网络仍未连接，再次播放提示音");
-            Play_Music(NETWORK_ALERT_DIR, NETWORK_ALERT_FILE);
-            last_alert_time = now;
+
+        if (!connected) {
+            // 网络持续断开，定期播放提示音
+            if (now - last_alert_time >= NETWORK_ALERT_INTERVAL_MS) {
+                ESP_LOGW(TAG, "网络仍未连接，再次播放提示音");
+                play_alert();
+                last_alert_time = now;
+            }
+            continue;
+        }
+
+        if ((bits & EV_PROBE_NOW) && now - last_probe_time >= NETWORK_PROBE_MIN_GAP_MS) {
+            next_probe_time = now;
+        }
+        if ((int32_t)(now - next_probe_time) >= 0) {
+            last_probe_time = now;
+            uint32_t delay = probe_and_update(retry_ms);
+            if (get_state() == NET_STATE_UNREACHABLE) {
+                retry_ms = retry_ms * 2 > NETWORK_PROBE_RETRY_MAX_MS ? NETWORK_PROBE_RETRY_MAX_MS : retry_ms * 2;
+            } else {
+                retry_ms = NETWORK_PROBE_RETRY_MIN_MS;
+            }
+            next_probe_time = now_ms() + delay;
         }
-        
-        vTaskDelay(pdMS_TO_TICKS(NETWORK_CHECK_INTERVAL_MS));
     }
-    
+
+    unregister_link_events();
     ESP_LOGI(TAG, "网络监控任务结束");
     g_monitor_task_handle = NULL;
     vTaskDelete(NULL);
@@ -126,9 +425,25 @@ void network_monitor_start(void) {
         ESP_LOGW(TAG, "网络监控已在运行");
         return;
     }
-    
+
+    if (g_events == NULL) {
+        g_events = xEventGroupCreate();
+        if (g_events == NULL) {
+            ESP_LOGE(TAG, "创建事件组失败");
+            return;
+        }
+    }
+    xEventGroupClearBits(g_events, EV_LINK_CHANGED | EV_PROBE_NOW | EV_STOP | EV_REACHABLE);
+    parse_probe_target(CG_API_URL);
+    g_probe_addr_valid = false;
+    memset(&g_status, 0, sizeof(g_status));
+    // 任务首次判定链路前（启动延时、等待 WiFi 初始化）按"尚未探测"处理，
+    // network_monitor_backend_reachable() 此时等同于 WiFi_IsConnected()
+    g_status.state = NET_STATE_UNKNOWN;
+    g_rtt_metric = metrics_histogram("net.probe_rtt_ms", g_rtt_bounds, sizeof(g_rtt_bounds) / sizeof(g_rtt_bounds[0]));
+    g_fail_metric = metrics_counter("net.probe_fail");
     g_monitor_running = true;
-    
+
     BaseType_t ret = xTaskCreatePinnedToCore(
         network_monitor_task,
         "net_monitor",
@@ -138,13 +453,13 @@ void network_monitor_start(void) {
         &g_monitor_task_handle,
         1   // 运行在 Core 1
     );
-    
+
     if (ret != pdPASS) {
         ESP_LOGE(TAG, "创建网络监控任务失败");
         g_monitor_running = false;
         return;
     }
-    
+
     ESP_LOGI(TAG, "网络监控服务已启动");
 }
 
@@ -152,16 +467,17 @@ void network_monitor_stop(void) {
     if (!g_monitor_running) {
         return;
     }
-    
+
     g_monitor_running = false;
-    
-    // 等待任务结束
+    xEventGroupSetBits(g_events, EV_STOP);
+
+    // 等待任务结束（探测中最多阻塞 NETWORK_PROBE_TIMEOUT_MS）
     int wait = 0;
-    while (g_monitor_task_handle != NULL && wait < 30) {
+    while (g_monitor_task_handle != NULL && wait < (NETWORK_PROBE_TIMEOUT_MS / 100) + 10) {
         vTaskDelay(pdMS_TO_TICKS(100));
         wait++;
     }
-    
+
     ESP_LOGI(TAG, "网络监控服务已停止");
 }
 
@@ -169,3 +485,36 @@ bool network_monitor_is_running(void) {
     return g_monitor_running;
 }
 
+void network_monitor_get_status(net_status_t *status) {
+    portENTER_CRITICAL(&g_status_lock);
+    *status = g_status;
+    portEXIT_CRITICAL(&g_status_lock);
+}
+
+bool network_monitor_backend_reachable(void) {
+    if (!g_monitor_running) {
+        return WiFi_IsConnected();
+    }
+    net_state_t state = get_state();
+    return state != NET_STATE_DOWN && state != NET_STATE_UNREACHABLE && WiFi_IsConnected();
+}
+
+bool network_monitor_wait_reachable(uint32_t timeout_ms) {
+    if (!g_monitor_running) {
+        // 没有探测结果，只能按 WiFi 状态等待
+        uint32_t waited = 0;
+        while (!WiFi_IsConnected() && waited < timeout_ms) {
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            waited += 1000;
+        }
+        return WiFi_IsConnected();
+    }
+    EventBits_t bits = xEventGroupWaitBits(g_events, EV_REACHABLE, pdFALSE, pdFALSE, pdMS_TO_TICKS(timeout_ms));
+    return (bits & EV_REACHABLE) != 0;
+}
+
+void network_monitor_report_failure(void) {
+    if (g_monitor_running && g_events) {
+        xEventGroupSetBits(g_events, EV_PROBE_NOW);
+    }
+}
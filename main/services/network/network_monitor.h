@@ -3,19 +3,46 @@
  * @brief 网络连接监控服务
  *
  * 功能：
- * - 持续监控 WiFi 连接状态
+ * - 由 WiFi / IP 事件驱动，链路变化时立即处理，不再定时轮询 WiFi_IsConnected()
+ * - 链路连通时定期向 API 服务器（CG_API_URL 的主机和端口）发起 TCP 连接探测，
+ *   区分“已连上 WiFi 但后端不可达”
+ * - 探测往返时间和失败率按 EWMA 平滑后发布，AI / 笔记服务据此决定等待还是重试
  * - 网络断开时播放语音提示
- * - 支持配置检测间隔和提示音间隔
+ *
+ * 探测间隔：可达时 NETWORK_PROBE_INTERVAL_MS；不可达时从 NETWORK_PROBE_RETRY_MIN_MS 起加倍，
+ * 最长 NETWORK_PROBE_RETRY_MAX_MS。服务请求失败时调用 network_monitor_report_failure() 提前探测。
  */
 
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** 网络状态 */
+typedef enum {
+    NET_STATE_DOWN = 0,    // WiFi 未连接
+    NET_STATE_UNKNOWN,     // WiFi 已连接，尚未探测
+    NET_STATE_ONLINE,      // 后端可达
+    NET_STATE_DEGRADED,    // 后端可达，但最近有探测失败或往返时间过长
+    NET_STATE_UNREACHABLE, // WiFi 已连接，后端连续探测失败
+} net_state_t;
+
+/** 网络状态与探测统计 */
+typedef struct {
+    net_state_t state;
+    uint32_t rtt_ms;          // 探测往返时间（TCP 建连）的 EWMA
+    uint32_t rtt_last_ms;     // 最近一次成功探测的往返时间
+    uint16_t loss_permille;   // 探测失败率的 EWMA（‰）
+    uint16_t fail_streak;     // 连续失败次数
+    uint32_t probes;          // 累计探测次数
+    uint32_t failures;        // 累计失败次数
+    uint32_t link_changes;    // 链路变化次数
+} net_status_t;
+
 /**
  * 启动网络监控任务
  *
@@ -34,6 +61,29 @@ void network_monitor_stop(void);
  */
 bool network_monitor_is_running(void);
 
+/**
+ * 获取网络状态（任意任务）
+ */
+void network_monitor_get_status(net_status_t *status);
+
+/**
+ * 后端是否可用（任意任务，不阻塞）
+ * WiFi 已连接且未判定为不可达时返回 true；监控未运行时等同于 WiFi_IsConnected()
+ */
+bool network_monitor_backend_reachable(void);
+
+/**
+ * 等待后端可达（阻塞，由探测结果唤醒）
+ * @param timeout_ms 最长等待时间
+ * @return 超时前后端可达返回 true
+ */
+bool network_monitor_wait_reachable(uint32_t timeout_ms);
+
+/**
+ * 服务请求失败时调用，监控任务尽快重新探测（与上次探测间隔至少 NETWORK_PROBE_MIN_GAP_MS）
+ */
+void network_monitor_report_failure(void);
+
 #ifdef __cplusplus
 }
 #endif
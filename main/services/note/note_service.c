@@ -6,8 +6,12 @@
 #include "http_client.h"
 #include "utils.h"
 #include "wifi_service.h"  // 添加 WiFi 状态检测
+#include "network_monitor.h"
+#include "alloc_prof.h"
+#include "trace.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/event_groups.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -18,14 +22,21 @@ static const char *TAG = "NoteService";
 #define UPLOAD_TIMEOUT_MS 30000       // 上传超时时间：30秒（原来是120秒）
 #define UPLOAD_MAX_RETRIES 3          // 上传最大重试次数
 #define UPLOAD_RETRY_DELAY_MS 2000    // 重试间隔：2秒
-#define WIFI_WAIT_TIMEOUT_MS 10000    // WiFi 等待超时：10秒
+#define WIFI_WAIT_TIMEOUT_MS 10000    // 等待网络恢复超时：10秒
 #define QUEUE_WAIT_TIMEOUT_SEC 120    // 队列等待超时：2分钟
+#define RECORDER_WAIT_TIMEOUT_MS 10000 // 等待上一会话释放录音器：10秒
 
 // 录音配置（从 app_config.h 读取）
 #define RECORD_SAMPLE_RATE 16000
 #define RECORD_CHANNELS 1
 #define RECORD_BITS_PER_SAMPLE 16
 
+// 最小有效录音时长（秒）
+#define MIN_RECORDING_DURATION_SEC 60
+
+// 同时存在的会话数：1 个录音中 + 最多 NOTE_MAX_SESSIONS-1 个收尾中
+#define NOTE_MAX_SESSIONS 3
+
 // 上传队列项
 typedef struct {
     uint8_t *wav_buffer;     // WAV数据缓冲区
@@ -33,57 +44,101 @@ typedef struct {
     char filename[128];      // 文件名
 } upload_item_t;
 
+#define UPLOAD_QUEUE_SIZE 2  // 最多缓存2个待上传文件
+
+/**
+ * 录音会话
+ *
+ * 每次 start_note_recording() 占用一个会话，由两个任务推进：
+ * - record_task：分段录音放入本会话的上传队列；停止后把最后一段也放入队列，
+ *   释放录音器（下一个会话可以开始录音）后退出
+ * - upload_task：上传分段；停止后继续排空队列，然后生成笔记（或丢弃），
+ *   回收会话。收尾全部在这里完成，stop_note_recording() 不等待
+ */
+typedef struct {
+    volatile bool in_use;
+    volatile bool stop_requested; // stop_note_recording() 已调用
+    volatile bool record_done;    // record_task 已退出（不会再有新分段）
+    bool submit;                  // 停止时决定：上传并生成笔记 / 丢弃
+    bool aborted;                 // 录音器不可用，会话已按失败结束（已发布 RECORD_FAILED）
+    uint32_t id;                  // 会话序号
+    char prof_name[16];           // 分配分析会话名 note#<id>（alloc_prof 只保存指针）
+    char uuid[64];
+    int file_counter;
+    int uploaded;                 // 已上传成功的分段数
+    int failed;                   // 上传失败的分段数
+    QueueHandle_t upload_queue;
+} note_session_t;
+
 // 录音数据缓冲区结构
 typedef struct {
     uint8_t *buffer;        // 音频数据缓冲区
     size_t buffer_size;      // 缓冲区大小
     size_t data_size;        // 实际数据大小
     bool recording;          // 是否正在录音
+    note_session_t *session; // 所属会话（检查停止标志）
 } audio_buffer_t;
 
-// 录音任务句柄和运行标志
-static TaskHandle_t g_record_task_handle = NULL;
-static TaskHandle_t g_upload_task_handle = NULL;
-static bool g_record_task_running = false;
+static note_session_t g_sessions[NOTE_MAX_SESSIONS];
+static note_session_t *volatile g_active_session = NULL; // 正在录音的会话
+static uint32_t g_session_seq = 0;
 
-// 上传队列
-static QueueHandle_t g_upload_queue = NULL;
-#define UPLOAD_QUEUE_SIZE 2  // 最多缓存2个待上传文件
+// 录音器同一时间只能属于一个会话
+static EventGroupHandle_t g_note_events = NULL;
+#define NOTE_RECORDER_FREE_BIT (1 << 0)
+
+// 事件回调
+static note_event_callback_t g_event_callback = NULL;
+static void *g_event_user_data = NULL;
+
+// ============== 事件 ==============
 
-// 录音会话信息（在开始录音时初始化）
-static char g_current_uuid[64] = {0};
-static int g_file_counter = 0;
+static void emit_event(const note_session_t *session, note_event_t event) {
+    note_event_callback_t cb = g_event_callback;
+    if (cb == NULL) {
+        return;
+    }
+    note_event_info_t info = {
+        .event = event,
+        .session_id = session->id,
+        .uploaded = session->uploaded,
+        .failed = session->failed,
+        .pending = session->upload_queue ? (int)uxQueueMessagesWaiting(session->upload_queue) : 0,
+    };
+    cb(&info, g_event_user_data);
+}
 
 // 录音数据回调函数：将音频数据收集到内存缓冲区
 static bool audio_data_callback(const void *data, size_t size, void *user_data) {
     audio_buffer_t *audio_buf = (audio_buffer_t *)user_data;
-    
+
     if (audio_buf == NULL) {
         ESP_LOGE(TAG, "回调函数：audio_buf 为 NULL");
         return false;
     }
-    
-    // 检查全局停止标志
-    if (!g_record_task_running) {
+
+    // 检查会话停止标志
+    if (audio_buf->session->stop_requested) {
         ESP_LOGI(TAG, "回调函数：检测到停止标志，停止录音");
         audio_buf->recording = false;
         return false;
     }
-    
+
     if (!audio_buf->recording) {
         return false;
     }
-    
+
     // 检查缓冲区是否有足够空间
     if (audio_buf->data_size + size > audio_buf->buffer_size) {
         ESP_LOGW(TAG, "音频缓冲区已满，停止录音");
         return false;
     }
-    
+
     // 复制数据到缓冲区
     memcpy(audio_buf->buffer + audio_buf->data_size, data, size);
     audio_buf->data_size += size;
-    
+    TRACE_INSTANT(TRACE_EV_NOTE_CHUNK, size, audio_buf->data_size);
+
     return true;
 }
 
@@ -109,7 +164,7 @@ static void create_wav_header_in_memory(uint8_t *buffer, uint32_t data_size,
 
     wav_header_t *header = (wav_header_t *)buffer;
     memset(header, 0, sizeof(wav_header_t));
-    
+
     memcpy(header->chunk_id, "RIFF", 4);
     header->chunk_size = data_size + sizeof(wav_header_t) - 8;
     memcpy(header->format, "WAVE", 4);
@@ -125,116 +180,231 @@ static void create_wav_header_in_memory(uint8_t *buffer, uint32_t data_size,
     header->subchunk2_size = data_size;
 }
 
-// 上传任务运行标志（独立于录音任务）
-static bool g_upload_task_running = false;
+// 等待后端可达的辅助函数（由网络监控的探测结果唤醒，不再每秒轮询）
+static bool wait_for_backend(int timeout_ms) {
+    ESP_LOGW(TAG, "等待网络恢复... (最长 %d ms)", timeout_ms);
+    return network_monitor_wait_reachable((uint32_t)timeout_ms);
+}
 
-// 等待 WiFi 连接的辅助函数
-static bool wait_for_wifi(int timeout_ms) {
-    int waited = 0;
-    while (!WiFi_IsConnected() && waited < timeout_ms) {
-        ESP_LOGW(TAG, "等待 WiFi 连接... (%d/%d ms)", waited, timeout_ms);
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        waited += 1000;
+// ============== 上传 ==============
+
+/**
+ * @brief 上传一个分段（带 WiFi 等待和重试）
+ * @return true 上传成功
+ */
+static bool upload_segment(const upload_item_t *item) {
+    ESP_LOGI(TAG, "========== 开始上传 ==========");
+    ESP_LOGI(TAG, "文件名: %s", item->filename);
+    ESP_LOGI(TAG, "文件大小: %zu KB", item->wav_size / 1024);
+    ESP_LOGI(TAG, "==============================");
+
+    // 检查网络状态（WiFi 断开或后端不可达），不可用则等待恢复
+    if (!network_monitor_backend_reachable()) {
+        ESP_LOGW(TAG, "网络不可用，等待恢复...");
+        if (!wait_for_backend(WIFI_WAIT_TIMEOUT_MS)) {
+            ESP_LOGE(TAG, "网络恢复超时，丢弃文件: %s", item->filename);
+            return false;
+        }
+        ESP_LOGI(TAG, "网络已恢复，继续上传");
     }
-    return WiFi_IsConnected();
+
+    // 构建上传URL
+    char url[512];
+    snprintf(url, sizeof(url), "%s%s", CG_API_URL, API_UPLOAD);
+
+    http_request_config_t upload_config = {
+        .url = url,
+        .method = "POST",
+        .token = CG_TOKEN,
+        .timeout_ms = UPLOAD_TIMEOUT_MS,  // 使用新的超时时间
+        .ssl_verify_mode = HTTP_SSL_VERIFY_NONE,
+    };
+
+    // 添加重试机制
+    int retry_count = 0;
+    bool upload_success = false;
+
+    while (retry_count < UPLOAD_MAX_RETRIES && !upload_success) {
+        if (retry_count > 0) {
+            ESP_LOGW(TAG, "第 %d 次重试上传: %s", retry_count, item->filename);
+            vTaskDelay(pdMS_TO_TICKS(UPLOAD_RETRY_DELAY_MS));
+
+            // 重试前再次检查网络状态
+            if (!network_monitor_backend_reachable()) {
+                ESP_LOGW(TAG, "网络不可用，等待恢复...");
+                if (!wait_for_backend(WIFI_WAIT_TIMEOUT_MS)) {
+                    ESP_LOGE(TAG, "网络恢复超时，停止重试");
+                    break;
+                }
+            }
+        }
+
+        int status_code = 0;
+        char response_buffer[512] = {0};
+        TRACE_BEGIN(TRACE_EV_NOTE_UPLOAD, item->wav_size / 1024, 0);
+        esp_err_t ret = http_client_post_multipart_from_memory(
+            &upload_config, item->wav_buffer, item->wav_size,
+            item->filename, "file", "fileName",
+            &status_code, response_buffer, sizeof(response_buffer));
+        TRACE_END(TRACE_EV_NOTE_UPLOAD, item->wav_size / 1024, status_code);
+
+        if (ret == ESP_OK && status_code == 200) {
+            ESP_LOGI(TAG, "上传成功: %s", item->filename);
+            upload_success = true;
+        } else {
+            ESP_LOGW(TAG, "上传失败: %s, 状态码: %d, 错误: %s",
+                     item->filename, status_code, esp_err_to_name(ret));
+            if (ret != ESP_OK) {
+                // 请求没有到达服务器，让网络监控尽快重新探测
+                network_monitor_report_failure();
+            }
+            retry_count++;
+        }
+    }
+
+    if (!upload_success) {
+        ESP_LOGE(TAG, "上传最终失败（重试 %d 次）: %s", retry_count, item->filename);
+    }
+    return upload_success;
 }
 
-// 上传任务（异步上传，不阻塞录音）
+// 生成笔记请求参数
+typedef struct {
+    char note_id[64];
+    char device[32];
+    bool is_voice;
+    int type;
+    char version[16];
+} generate_note_params_t;
+
+static bool generate_note_request(const generate_note_params_t *params);
+
+/**
+ * @brief 会话收尾：生成笔记或丢弃，然后回收会话
+ * 在 upload_task 中执行，此时 record_task 已退出、上传队列已空
+ */
+static void session_finalize(note_session_t *session) {
+    if (session->aborted) {
+        ESP_LOGW(TAG, "会话 #%lu 录音失败，回收会话", (unsigned long)session->id);
+    } else if (session->submit) {
+        ESP_LOGI(TAG, "会话 #%lu 所有分段已处理（成功 %d，失败 %d），生成笔记",
+                 (unsigned long)session->id, session->uploaded, session->failed);
+        emit_event(session, NOTE_EVENT_GENERATING);
+
+        generate_note_params_t params = {
+            .is_voice = true,
+            .type = 2,
+        };
+        strncpy(params.note_id, session->uuid, sizeof(params.note_id) - 1);
+        strncpy(params.device, "box", sizeof(params.device) - 1);
+        strncpy(params.version, "box1.0", sizeof(params.version) - 1);
+
+        bool ok = strlen(params.note_id) > 0 && generate_note_request(&params);
+        if (!ok) {
+            ESP_LOGE(TAG, "生成笔记失败");
+        }
+        emit_event(session, ok ? NOTE_EVENT_DONE : NOTE_EVENT_FAILED);
+    } else {
+        ESP_LOGI(TAG, "会话 #%lu 已停止（时长不足，未提交数据）", (unsigned long)session->id);
+        emit_event(session, NOTE_EVENT_DISCARDED);
+    }
+
+    vQueueDelete(session->upload_queue);
+    session->upload_queue = NULL;
+    // 先结束分析会话再释放槽位，否则新会话的 begin 可能排在这次 end 之前
+    alloc_prof_session_end(session->prof_name);
+    session->in_use = false;
+}
+
+// 上传任务（异步上传，不阻塞录音；停止后负责收尾）
 static void upload_task(void *pvParameters) {
-    ESP_LOGI(TAG, "上传任务启动");
-    g_upload_task_running = true;
-    
+    note_session_t *session = (note_session_t *)pvParameters;
+    ESP_LOGI(TAG, "上传任务启动（会话 #%lu）", (unsigned long)session->id);
+
     upload_item_t item;
-    
-    // 持续运行直到被明确停止，并且队列为空
-    while (g_upload_task_running || uxQueueMessagesWaiting(g_upload_queue) > 0) {
+
+    // 持续运行直到会话停止、录音任务退出并且队列为空
+    while (!(session->stop_requested && session->record_done) ||
+           uxQueueMessagesWaiting(session->upload_queue) > 0) {
         // 等待上传队列中的数据（最多等待1秒）
-        if (xQueueReceive(g_upload_queue, &item, pdMS_TO_TICKS(1000)) == pdTRUE) {
-            ESP_LOGI(TAG, "========== 开始上传 ==========");
-            ESP_LOGI(TAG, "文件名: %s", item.filename);
-            ESP_LOGI(TAG, "文件大小: %zu KB", item.wav_size / 1024);
-            ESP_LOGI(TAG, "队列剩余: %d 个文件", uxQueueMessagesWaiting(g_upload_queue));
-            ESP_LOGI(TAG, "==============================");
-            
-            // 检查 WiFi 连接状态，如果断开则等待重连
-            if (!WiFi_IsConnected()) {
-                ESP_LOGW(TAG, "WiFi 未连接，等待重连...");
-                if (!wait_for_wifi(WIFI_WAIT_TIMEOUT_MS)) {
-                    ESP_LOGE(TAG, "WiFi 连接超时，丢弃文件: %s", item.filename);
-                    free(item.wav_buffer);
-                    ESP_LOGI(TAG, "已释放上传缓冲区，队列剩余: %d", uxQueueMessagesWaiting(g_upload_queue));
-                    continue;
-                }
-                ESP_LOGI(TAG, "WiFi 已重新连接，继续上传");
-            }
-            
-            // 构建上传URL
-            char url[512];
-            snprintf(url, sizeof(url), "%s%s", CG_API_URL, API_UPLOAD);
-            
-            http_request_config_t upload_config = {
-                .url = url,
-                .method = "POST",
-                .token = CG_TOKEN,
-                .timeout_ms = UPLOAD_TIMEOUT_MS,  // 使用新的超时时间
-                .ssl_verify_mode = HTTP_SSL_VERIFY_NONE,
-            };
-
-            // 添加重试机制
-            int retry_count = 0;
-            bool upload_success = false;
-            
-            while (retry_count < UPLOAD_MAX_RETRIES && !upload_success) {
-                if (retry_count > 0) {
-                    ESP_LOGW(TAG, "第 %d 次重试上传: %s", retry_count, item.filename);
-                    vTaskDelay(pdMS_TO_TICKS(UPLOAD_RETRY_DELAY_MS));
-                    
-                    // 重试前再次检查 WiFi 状态
-                    if (!WiFi_IsConnected()) {
-                        ESP_LOGW(TAG, "WiFi 断开，等待重连...");
-                        if (!wait_for_wifi(WIFI_WAIT_TIMEOUT_MS)) {
-                            ESP_LOGE(TAG, "WiFi 连接超时，停止重试");
-                            break;
-                        }
-                    }
-                }
-                
-                int status_code = 0;
-                char response_buffer[512] = {0};
-                esp_err_t ret = http_client_post_multipart_from_memory(
-                    &upload_config, item.wav_buffer, item.wav_size,
-                    item.filename, "file", "fileName",
-                    &status_code, response_buffer, sizeof(response_buffer));
-                
-                if (ret == ESP_OK && status_code == 200) {
-                    ESP_LOGI(TAG, "上传成功: %s", item.filename);
-                    upload_success = true;
-                } else {
-                    ESP_LOGW(TAG, "上传失败: %s, 状态码: %d, 错误: %s", 
-                             item.filename, status_code, esp_err_to_name(ret));
-                    retry_count++;
-                }
-            }
-            
-            if (!upload_success) {
-                ESP_LOGE(TAG, "上传最终失败（重试 %d 次）: %s", retry_count, item.filename);
-            }
-            
-            // 释放缓冲区
-            free(item.wav_buffer);
-            ESP_LOGI(TAG, "已释放上传缓冲区，队列剩余: %d", uxQueueMessagesWaiting(g_upload_queue));
+        if (xQueueReceive(session->upload_queue, &item, pdMS_TO_TICKS(1000)) != pdTRUE) {
+            continue;
+        }
+
+        if (session->stop_requested && !session->submit) {
+            // 不提交数据时，丢弃剩余分段
+            ESP_LOGI(TAG, "丢弃未上传的录音文件: %s", item.filename);
+        } else if (upload_segment(&item)) {
+            session->uploaded++;
+        } else {
+            session->failed++;
+        }
+
+        // 释放缓冲区
+        free(item.wav_buffer);
+        ESP_LOGI(TAG, "已释放上传缓冲区，队列剩余: %d", uxQueueMessagesWaiting(session->upload_queue));
+
+        if (session->stop_requested && session->submit) {
+            emit_event(session, NOTE_EVENT_UPLOADING);
         }
     }
-    
+
     ESP_LOGI(TAG, "上传任务结束（所有文件已处理）");
-    g_upload_task_handle = NULL;
+    session_finalize(session);
     vTaskDelete(NULL);
 }
 
+// ============== 录音 ==============
+
+/**
+ * @brief 录音器不可用：会话按失败结束
+ * 会话不再占用 g_active_session，界面收到 RECORD_FAILED 后退出录音状态；
+ * upload_task 看到停止标志后直接回收会话，不生成笔记
+ */
+static void session_abort(note_session_t *session) {
+    session->aborted = true;
+    session->submit = false;
+    session->stop_requested = true;
+    if (g_active_session == session) {
+        g_active_session = NULL;
+    }
+    emit_event(session, NOTE_EVENT_RECORD_FAILED);
+}
+
+/**
+ * @brief 释放录音器，下一个会话可以开始录音
+ */
+static void release_recorder(bool *released) {
+    if (!*released) {
+        audio_recorder_deinit();
+        xEventGroupSetBits(g_note_events, NOTE_RECORDER_FREE_BIT);
+        *released = true;
+    }
+}
+
 // 录音任务（连续录音，录音完成后放入上传队列）
 static void record_task(void *pvParameters) {
-    ESP_LOGI(TAG, "录音任务启动（UUID: %s）", g_current_uuid);
-    
+    note_session_t *session = (note_session_t *)pvParameters;
+    ESP_LOGI(TAG, "录音任务启动（UUID: %s）", session->uuid);
+    bool recorder_released = false;
+
+    // 上一个会话可能还在释放录音器
+    EventBits_t bits = xEventGroupWaitBits(g_note_events, NOTE_RECORDER_FREE_BIT, pdTRUE, pdFALSE,
+                                           pdMS_TO_TICKS(RECORDER_WAIT_TIMEOUT_MS));
+    if (!(bits & NOTE_RECORDER_FREE_BIT)) {
+        ESP_LOGE(TAG, "等待录音器超时");
+        session_abort(session);
+        goto done;
+    }
+
+    // 初始化录音器
+    if (audio_recorder_init(NULL) != ESP_OK) {
+        ESP_LOGE(TAG, "初始化录音器失败");
+        xEventGroupSetBits(g_note_events, NOTE_RECORDER_FREE_BIT);
+        session_abort(session);
+        goto done;
+    }
+
     const size_t wav_header_size = 44;
     const int bytes_per_sample = RECORD_CHANNELS * RECORD_BITS_PER_SAMPLE / 8;
     const int samples_to_record = RECORD_SAMPLE_RATE * RECORD_DURATION_SEC;
@@ -243,50 +413,49 @@ static void record_task(void *pvParameters) {
 
     // 队列等待计时器
     uint32_t queue_wait_start = 0;
-    
-    while (g_record_task_running) {
-        
+
+    while (!session->stop_requested) {
+
         // 检查可用内存
         size_t free_spiram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
         ESP_LOGI(TAG, "内存状态 - PSRAM空闲: %d KB, 需要: %d KB, 上传队列: %d/%d",
                  free_spiram / 1024, total_buffer_size / 1024,
-                 uxQueueMessagesWaiting(g_upload_queue), UPLOAD_QUEUE_SIZE);
-        
+                 uxQueueMessagesWaiting(session->upload_queue), UPLOAD_QUEUE_SIZE);
+
         // 如果上传队列已满，等待队列有空位（添加超时机制）
-        if (uxQueueMessagesWaiting(g_upload_queue) >= UPLOAD_QUEUE_SIZE) {
+        if (uxQueueMessagesWaiting(session->upload_queue) >= UPLOAD_QUEUE_SIZE) {
             // 初始化等待计时
             if (queue_wait_start == 0) {
                 queue_wait_start = xTaskGetTickCount() * portTICK_PERIOD_MS / 1000;
             }
-            
+
             uint32_t now_sec = xTaskGetTickCount() * portTICK_PERIOD_MS / 1000;
             uint32_t waited_sec = now_sec - queue_wait_start;
-            
+
             // 检查是否超时
             if (waited_sec >= QUEUE_WAIT_TIMEOUT_SEC) {
                 ESP_LOGE(TAG, "等待上传队列超时 (%lu 秒)，检查网络状态...", (unsigned long)waited_sec);
-                
+
                 // 检查 WiFi 状态
                 if (!WiFi_IsConnected()) {
                     ESP_LOGE(TAG, "WiFi 已断开！停止录音任务。");
                     // 不再继续等待，让上传任务处理失败情况
-                    g_record_task_running = false;
                     break;
                 }
-                
+
                 // WiFi 正常但上传仍然卡住，重置等待计时器继续等待
                 ESP_LOGW(TAG, "WiFi 正常，继续等待上传完成...");
                 queue_wait_start = now_sec;
             }
-            
+
             ESP_LOGW(TAG, "上传队列已满，等待上传完成... (已等待 %lu 秒)", (unsigned long)waited_sec);
             vTaskDelay(pdMS_TO_TICKS(1000));
             continue;
         }
-        
+
         // 队列有空位，重置等待计时器
         queue_wait_start = 0;
-        
+
         // 分配内存（优先PSRAM）
         uint8_t *wav_buffer = NULL;
         if (free_spiram >= total_buffer_size) {
@@ -295,32 +464,33 @@ static void record_task(void *pvParameters) {
         if (wav_buffer == NULL) {
             wav_buffer = (uint8_t *)malloc(total_buffer_size);
         }
-        
+
         if (wav_buffer == NULL) {
             ESP_LOGE(TAG, "无法分配录音缓冲区，等待 5 秒后重试");
             vTaskDelay(pdMS_TO_TICKS(5000));
             continue;
         }
-        
+
         ESP_LOGI(TAG, "分配录音缓冲区成功: %d KB", total_buffer_size / 1024);
-        
+
         // 初始化音频缓冲区
         audio_buffer_t audio_buf = {
             .buffer = wav_buffer + wav_header_size,
             .buffer_size = audio_data_size,
             .data_size = 0,
-            .recording = true
+            .recording = true,
+            .session = session,
         };
-        
+
         // 构建文件名
         char filename[128];
-        snprintf(filename, sizeof(filename), "note_box_%s_%s_%d.wav", 
-                 USER_ID, g_current_uuid, g_file_counter);
-        
-        ESP_LOGI(TAG, "===== 开始录音 #%d =====", g_file_counter);
+        snprintf(filename, sizeof(filename), "note_box_%s_%s_%d.wav",
+                 USER_ID, session->uuid, session->file_counter);
+
+        ESP_LOGI(TAG, "===== 开始录音 #%d =====", session->file_counter);
         ESP_LOGI(TAG, "文件名: %s", filename);
         ESP_LOGI(TAG, "时长: %d 秒", RECORD_DURATION_SEC);
-        
+
         // 启动录音
         esp_err_t ret = audio_recorder_start_with_callback(audio_data_callback, &audio_buf);
         if (ret != ESP_OK) {
@@ -333,34 +503,34 @@ static void record_task(void *pvParameters) {
         // 等待录音完成
         int wait_count = 0;
         int max_wait_count = (RECORD_DURATION_SEC * 1000 + 2000) / 100;
-        
-        while (wait_count < max_wait_count && g_record_task_running && audio_recorder_is_recording()) {
+
+        while (wait_count < max_wait_count && !session->stop_requested && audio_recorder_is_recording()) {
             vTaskDelay(pdMS_TO_TICKS(100));
             wait_count++;
-            
-            if (!g_record_task_running) {
+
+            if (session->stop_requested) {
                 ESP_LOGI(TAG, "检测到停止标志");
                 break;
             }
-            
+
             // 每10秒打印进度
             if (wait_count % 100 == 0) {
-                ESP_LOGI(TAG, "录音进度: %d KB / %d KB (%d秒)", 
+                ESP_LOGI(TAG, "录音进度: %d KB / %d KB (%d秒)",
                          audio_buf.data_size / 1024, audio_data_size / 1024, wait_count / 10);
             }
         }
-        
+
         // 停止录音
         audio_buf.recording = false;
         audio_recorder_stop();
-        
+
         // 等待录音完全停止
         int stop_wait = 0;
         while (audio_recorder_is_recording() && stop_wait < 50) {
             vTaskDelay(pdMS_TO_TICKS(100));
             stop_wait++;
         }
-        
+
         if (audio_buf.data_size == 0) {
             ESP_LOGE(TAG, "录音数据为空！");
             free(wav_buffer);
@@ -369,237 +539,204 @@ static void record_task(void *pvParameters) {
 
         float duration_sec = (float)audio_buf.data_size / (RECORD_SAMPLE_RATE * bytes_per_sample);
         ESP_LOGI(TAG, "录音完成: %d KB (约 %.1f 秒)", audio_buf.data_size / 1024, duration_sec);
-        
+
         // 创建WAV文件头
         create_wav_header_in_memory(wav_buffer, audio_buf.data_size,
                                    RECORD_SAMPLE_RATE, RECORD_CHANNELS,
                                    RECORD_BITS_PER_SAMPLE);
-        
+
         size_t wav_file_size = wav_header_size + audio_buf.data_size;
-        
+
+        // 最后一段：先释放录音器，下面等待队列时下一个会话已经可以开始录音
+        if (session->stop_requested) {
+            release_recorder(&recorder_released);
+        }
+
         // 将录音数据放入上传队列（不阻塞，立即开始下一轮录音）
         upload_item_t item = {
             .wav_buffer = wav_buffer,
             .wav_size = wav_file_size,
         };
         strncpy(item.filename, filename, sizeof(item.filename) - 1);
-        
-        if (xQueueSend(g_upload_queue, &item, pdMS_TO_TICKS(100)) == pdTRUE) {
-            ESP_LOGI(TAG, "录音 #%d 已加入上传队列", g_file_counter);
-            g_file_counter++;
+
+        // 停止后的最后一段不能丢，等上传任务腾出队列
+        TickType_t send_wait = session->stop_requested ? pdMS_TO_TICKS(QUEUE_WAIT_TIMEOUT_SEC * 1000)
+                                                       : pdMS_TO_TICKS(100);
+        if (xQueueSend(session->upload_queue, &item, send_wait) == pdTRUE) {
+            ESP_LOGI(TAG, "录音 #%d 已加入上传队列", session->file_counter);
+            session->file_counter++;
         } else {
-            ESP_LOGW(TAG, "上传队列已满，丢弃录音 #%d", g_file_counter);
+            ESP_LOGW(TAG, "上传队列已满，丢弃录音 #%d", session->file_counter);
             free(wav_buffer);
         }
-        
+
         // 立即开始下一轮录音（无需等待上传完成）
         ESP_LOGI(TAG, "===== 准备下一轮录音 =====");
     }
 
-    g_record_task_running = false;
-    g_record_task_handle = NULL;
-    ESP_LOGI(TAG, "录音任务结束");
+    release_recorder(&recorder_released);
+
+done:
+    ESP_LOGI(TAG, "录音任务结束（会话 #%lu）", (unsigned long)session->id);
+    session->record_done = true;
     vTaskDelete(NULL);
 }
 
+// ============== 对外接口 ==============
+
 int start_note_recording(void) {
-    if (g_record_task_running) {
+    if (g_active_session != NULL) {
         ESP_LOGW(TAG, "录音已在进行中");
         return 0;
     }
 
+    if (g_note_events == NULL) {
+        g_note_events = xEventGroupCreate();
+        if (g_note_events == NULL) {
+            ESP_LOGE(TAG, "创建事件组失败");
+            return -1;
+        }
+        xEventGroupSetBits(g_note_events, NOTE_RECORDER_FREE_BIT);
+    }
+
+    note_session_t *session = NULL;
+    for (int i = 0; i < NOTE_MAX_SESSIONS; i++) {
+        if (!g_sessions[i].in_use) {
+            session = &g_sessions[i];
+            break;
+        }
+    }
+    if (session == NULL) {
+        ESP_LOGW(TAG, "之前的笔记仍在上传，暂不能开始新的录音");
+        return -1;
+    }
+
+    memset(session, 0, sizeof(*session));
+    session->id = ++g_session_seq;
+    session->file_counter = 1;
+
     // 生成UUID
-    if (utils_generate_uuid(g_current_uuid, sizeof(g_current_uuid)) != 0) {
+    if (utils_generate_uuid(session->uuid, sizeof(session->uuid)) != 0) {
         ESP_LOGE(TAG, "生成UUID失败");
         return -1;
     }
-    g_file_counter = 1;
-    
+
     ESP_LOGI(TAG, "========================================");
-    ESP_LOGI(TAG, "开始新的录音会话");
-    ESP_LOGI(TAG, "UUID: %s", g_current_uuid);
+    ESP_LOGI(TAG, "开始新的录音会话 #%lu", (unsigned long)session->id);
+    ESP_LOGI(TAG, "UUID: %s", session->uuid);
     ESP_LOGI(TAG, "录音时长: %d 秒/次", RECORD_DURATION_SEC);
     ESP_LOGI(TAG, "上传队列大小: %d", UPLOAD_QUEUE_SIZE);
     ESP_LOGI(TAG, "========================================");
 
     // 创建上传队列
-    if (g_upload_queue == NULL) {
-        g_upload_queue = xQueueCreate(UPLOAD_QUEUE_SIZE, sizeof(upload_item_t));
-        if (g_upload_queue == NULL) {
-            ESP_LOGE(TAG, "创建上传队列失败");
-            return -1;
-        }
+    session->upload_queue = xQueueCreate(UPLOAD_QUEUE_SIZE, sizeof(upload_item_t));
+    if (session->upload_queue == NULL) {
+        ESP_LOGE(TAG, "创建上传队列失败");
+        return -1;
     }
 
-    // 初始化录音器
-    esp_err_t ret = audio_recorder_init(NULL);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "初始化录音器失败");
+    session->in_use = true;
+    // 录音开始到生成笔记结束为一个分析会话，由 session_finalize 结束。
+    // 按会话序号命名：上一条笔记收尾时新会话的 begin 被忽略，上一条的 end 也不会结束新会话的记录
+    snprintf(session->prof_name, sizeof(session->prof_name), "note#%lu", (unsigned long)session->id);
+    alloc_prof_session_begin(session->prof_name);
+
+    // 启动上传任务
+    if (xTaskCreate(upload_task, "upload_task", 8192, session, 4, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "创建上传任务失败");
+        vQueueDelete(session->upload_queue);
+        session->upload_queue = NULL;
+        alloc_prof_session_end(session->prof_name);
+        session->in_use = false;
         return -1;
     }
 
-    g_record_task_running = true;
-    
-    // 启动上传任务
-    xTaskCreate(upload_task, "upload_task", 8192, NULL, 4, &g_upload_task_handle);
-    
+    // 录音任务可能立即以失败结束（session_abort），先登记会话并发布 RECORDING
+    g_active_session = session;
+    emit_event(session, NOTE_EVENT_RECORDING);
+
     // 启动录音任务（优先级高于上传任务）
-    xTaskCreate(record_task, "record_task", 8192, NULL, 5, &g_record_task_handle);
-    
+    if (xTaskCreate(record_task, "record_task", 8192, session, 5, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "创建录音任务失败");
+        g_active_session = NULL;
+        // 上传任务直接回收会话（调用方已按失败处理，不再发布事件）
+        session->aborted = true;
+        session->record_done = true;
+        session->stop_requested = true;
+        return -1;
+    }
     return 0;
 }
 
-// 最小有效录音时长（秒）
-#define MIN_RECORDING_DURATION_SEC 60
-
 int stop_note_recording(uint32_t duration_sec) {
-    if (!g_record_task_running && !g_upload_task_running) {
+    note_session_t *session = g_active_session;
+    if (session == NULL) {
         ESP_LOGW(TAG, "录音未在进行");
         return 0;
     }
 
     ESP_LOGI(TAG, "停止录音... (持续时间: %lu 秒)", (unsigned long)duration_sec);
-    
+
     // 判断是否需要提交数据
-    bool should_submit = (duration_sec >= MIN_RECORDING_DURATION_SEC);
-    if (!should_submit) {
+    session->submit = (duration_sec >= MIN_RECORDING_DURATION_SEC);
+    if (!session->submit) {
         ESP_LOGI(TAG, "录音时长不足 %d 秒，不提交数据", MIN_RECORDING_DURATION_SEC);
     }
-    
-    // 1. 先停止录音任务
-    g_record_task_running = false;
-    
-    if (audio_recorder_is_recording()) {
-        audio_recorder_stop();
-        int wait = 0;
-        while (audio_recorder_is_recording() && wait < 50) {
-            vTaskDelay(pdMS_TO_TICKS(100));
-            wait++;
-        }
-    }
-    
-    // 等待录音任务结束
-    int wait = 0;
-    while (g_record_task_handle != NULL && wait < 50) {
-        vTaskDelay(pdMS_TO_TICKS(100));
-        wait++;
-    }
-    ESP_LOGI(TAG, "录音任务已停止");
-    
-    // 保存UUID副本（在清空前）
-    char uuid_copy[64];
-    strncpy(uuid_copy, g_current_uuid, sizeof(uuid_copy) - 1);
-    uuid_copy[sizeof(uuid_copy) - 1] = '\0';
-    
-    if (should_submit) {
-        // 2. 等待上传任务处理完队列中的所有数据
-        int queue_count = uxQueueMessagesWaiting(g_upload_queue);
-        if (queue_count > 0) {
-            ESP_LOGI(TAG, "等待上传队列中的 %d 个文件上传完成...", queue_count);
-        }
-        
-        wait = 0;
-        while (uxQueueMessagesWaiting(g_upload_queue) > 0 && wait < 600) {  // 最多等待60秒
-            vTaskDelay(pdMS_TO_TICKS(100));
-            wait++;
-            if (wait % 50 == 0) {
-                ESP_LOGI(TAG, "等待上传完成，队列剩余: %d", uxQueueMessagesWaiting(g_upload_queue));
-            }
-        }
-    } else {
-        // 不提交数据时，清空上传队列中的数据
-        upload_item_t item;
-        while (xQueueReceive(g_upload_queue, &item, 0) == pdTRUE) {
-            if (item.wav_buffer != NULL) {
-                free(item.wav_buffer);
-            }
-            ESP_LOGI(TAG, "丢弃未上传的录音文件: %s", item.filename);
-        }
-    }
-    
-    // 3. 停止上传任务
-    g_upload_task_running = false;
-    
-    wait = 0;
-    while (g_upload_task_handle != NULL && wait < 50) {
-        vTaskDelay(pdMS_TO_TICKS(100));
-        wait++;
-    }
-    ESP_LOGI(TAG, "上传任务已停止");
-    
-    // 4. 清理
-    audio_recorder_deinit();
-    
-    if (g_upload_queue != NULL) {
-        vQueueDelete(g_upload_queue);
-        g_upload_queue = NULL;
-    }
-    
-    memset(g_current_uuid, 0, sizeof(g_current_uuid));
-    g_file_counter = 0;
-
-    if (should_submit) {
-        ESP_LOGI(TAG, "录音已完全停止，所有文件已上传");
-        
-        // 5. 使用保存的UUID副本调用生成笔记接口
-        if (strlen(uuid_copy) > 0) {
-            int ret = generate_note(uuid_copy, "box", true, 2, "box1.0");
-            if (ret != 0) {
-                ESP_LOGE(TAG, "生成笔记失败");
-                return -1;
-            }
-        } else {
-            ESP_LOGW(TAG, "UUID为空，跳过生成笔记");
-        }
-    } else {
-        ESP_LOGI(TAG, "录音已停止（时长不足，未提交数据）");
-    }
-    
+
+    // 只置停止标志：最后一段、上传和生成笔记由会话的两个任务完成
+    session->stop_requested = true;
+    g_active_session = NULL;
+    emit_event(session, NOTE_EVENT_STOPPING);
     return 0;
 }
 
-// 生成笔记任务参数
-typedef struct {
-    char note_id[64];
-    char device[32];
-    bool is_voice;
-    int type;
-    char version[16];
-} generate_note_params_t;
+void note_service_set_event_callback(note_event_callback_t callback, void *user_data) {
+    g_event_user_data = user_data;
+    g_event_callback = callback;
+}
 
-// 生成笔记任务（在独立任务中执行，避免占用 main 任务栈）
-static void generate_note_task(void *pvParameters) {
-    generate_note_params_t *params = (generate_note_params_t *)pvParameters;
-    
-    ESP_LOGI(TAG, "生成笔记任务启动，UUID: %s", params->note_id);
-    
-    // 检查 WiFi 连接状态
-    if (!WiFi_IsConnected()) {
-        ESP_LOGW(TAG, "WiFi 未连接，等待重连...");
-        if (!wait_for_wifi(WIFI_WAIT_TIMEOUT_MS)) {
-            ESP_LOGE(TAG, "WiFi 连接超时，生成笔记失败");
-            free(params);
-            ESP_LOGI(TAG, "生成笔记任务结束（网络错误）");
-            vTaskDelete(NULL);
-            return;
+int note_service_pending_count(void) {
+    int count = 0;
+    for (int i = 0; i < NOTE_MAX_SESSIONS; i++) {
+        if (g_sessions[i].in_use && &g_sessions[i] != g_active_session) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// ============== 生成笔记 ==============
+
+/**
+ * @brief 调用 API_NOTE 生成笔记（阻塞，带 WiFi 等待和重试）
+ * @return true 成功
+ */
+static bool generate_note_request(const generate_note_params_t *params) {
+    // 检查网络状态
+    if (!network_monitor_backend_reachable()) {
+        ESP_LOGW(TAG, "网络不可用，等待恢复...");
+        if (!wait_for_backend(WIFI_WAIT_TIMEOUT_MS)) {
+            ESP_LOGE(TAG, "网络恢复超时，生成笔记失败");
+            return false;
         }
-        ESP_LOGI(TAG, "WiFi 已重新连接，继续生成笔记");
+        ESP_LOGI(TAG, "网络已恢复，继续生成笔记");
     }
-    
+
     // 使用动态分配减少栈压力
+    bool success = false;
     char *url = (char *)malloc(256);
     char *json_body = (char *)malloc(256);
     char *response_buffer = (char *)malloc(256);
-    
+
     if (url == NULL || json_body == NULL || response_buffer == NULL) {
         ESP_LOGE(TAG, "生成笔记：内存分配失败");
         goto cleanup;
     }
-    
+
     snprintf(url, 256, "%s%s", CG_API_URL, API_NOTE);
     snprintf(json_body, 256,
         "{\"id\":\"%s\",\"device\":\"%s\",\"isVoice\":%s,\"type\":%d,\"v\":\"%s\"}",
-        params->note_id, params->device, params->is_voice ? "true" : "false", 
+        params->note_id, params->device, params->is_voice ? "true" : "false",
         params->type, params->version);
 
     http_request_config_t config = {
@@ -615,36 +752,40 @@ static void generate_note_task(void *pvParameters) {
 
     // 添加重试机制
     int retry_count = 0;
-    bool success = false;
-    
+
     while (retry_count < UPLOAD_MAX_RETRIES && !success) {
         if (retry_count > 0) {
             ESP_LOGW(TAG, "第 %d 次重试生成笔记", retry_count);
             vTaskDelay(pdMS_TO_TICKS(UPLOAD_RETRY_DELAY_MS));
-            
-            // 重试前检查 WiFi
-            if (!WiFi_IsConnected()) {
-                ESP_LOGW(TAG, "WiFi 断开，等待重连...");
-                if (!wait_for_wifi(WIFI_WAIT_TIMEOUT_MS)) {
-                    ESP_LOGE(TAG, "WiFi 连接超时，停止重试");
+
+            // 重试前检查网络状态
+            if (!network_monitor_backend_reachable()) {
+                ESP_LOGW(TAG, "网络不可用，等待恢复...");
+                if (!wait_for_backend(WIFI_WAIT_TIMEOUT_MS)) {
+                    ESP_LOGE(TAG, "网络恢复超时，停止重试");
                     break;
                 }
             }
         }
-        
+
         int status_code = 0;
         response_buffer[0] = '\0';
+        TRACE_BEGIN(TRACE_EV_NOTE_GENERATE, 0, 0);
         esp_err_t err = http_client_post_json(&config, &status_code, response_buffer, 256);
-        
+        TRACE_END(TRACE_EV_NOTE_GENERATE, 0, status_code);
+
         if (err == ESP_OK && status_code == 200) {
             ESP_LOGI(TAG, "生成笔记成功");
             success = true;
         } else {
             ESP_LOGW(TAG, "生成笔记失败，状态码: %d, 错误: %s", status_code, esp_err_to_name(err));
+            if (err != ESP_OK) {
+                network_monitor_report_failure();
+            }
             retry_count++;
         }
     }
-    
+
     if (!success) {
         ESP_LOGE(TAG, "生成笔记最终失败（重试 %d 次）", retry_count);
     }
@@ -653,8 +794,17 @@ cleanup:
     if (url) free(url);
     if (json_body) free(json_body);
     if (response_buffer) free(response_buffer);
+    return success;
+}
+
+// 生成笔记任务（在独立任务中执行，避免占用 main 任务栈）
+static void generate_note_task(void *pvParameters) {
+    generate_note_params_t *params = (generate_note_params_t *)pvParameters;
+
+    ESP_LOGI(TAG, "生成笔记任务启动，UUID: %s", params->note_id);
+    generate_note_request(params);
     free(params);
-    
+
     ESP_LOGI(TAG, "生成笔记任务结束");
     vTaskDelete(NULL);
 }
@@ -664,7 +814,7 @@ int generate_note(const char *note_id, const char *device, bool is_voice, int ty
         ESP_LOGE(TAG, "参数不能为空");
         return -1;
     }
-    
+
     if (strlen(note_id) == 0) {
         ESP_LOGE(TAG, "note_id 不能为空字符串");
         return -1;
@@ -676,7 +826,7 @@ int generate_note(const char *note_id, const char *device, bool is_voice, int ty
         ESP_LOGE(TAG, "生成笔记：参数内存分配失败");
         return -1;
     }
-    
+
     // 复制参数
     strncpy(params->note_id, note_id, sizeof(params->note_id) - 1);
     params->note_id[sizeof(params->note_id) - 1] = '\0';
@@ -686,7 +836,7 @@ int generate_note(const char *note_id, const char *device, bool is_voice, int ty
     params->type = type;
     strncpy(params->version, version, sizeof(params->version) - 1);
     params->version[sizeof(params->version) - 1] = '\0';
-    
+
     // 创建独立任务执行（8KB 栈空间）
     BaseType_t ret = xTaskCreate(generate_note_task, "generate_note", 8192, params, 3, NULL);
     if (ret != pdPASS) {
@@ -694,11 +844,12 @@ int generate_note(const char *note_id, const char *device, bool is_voice, int ty
         free(params);
         return -1;
     }
-    
+
     ESP_LOGI(TAG, "已启动生成笔记任务");
     return 0;
 }
 
 bool is_recording(void) {
-    return g_record_task_running;
+    note_session_t *session = g_active_session;
+    return session != NULL && !session->record_done;
 }
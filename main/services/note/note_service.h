@@ -7,16 +7,59 @@ extern "C" {
 #include <stdbool.h>
 #include <stdint.h>
 
+/**
+ * 笔记会话事件
+ *
+ * 一次录音（会话）的流转：
+ * RECORDING → STOPPING → UPLOADING(×N) → GENERATING → DONE / FAILED
+ *           │          └→ DISCARDED（时长不足，不提交）
+ *           └→ RECORD_FAILED（录音器不可用，会话直接结束，无需 stop_note_recording）
+ *
+ * stop_note_recording() 立即返回，STOPPING 之后的收尾在服务任务中完成，
+ * 期间可以开始新的录音，新旧会话用 session_id 区分。
+ */
+typedef enum {
+  NOTE_EVENT_RECORDING = 0, // 录音已开始
+  NOTE_EVENT_STOPPING,      // 已请求停止，正在收尾最后一段
+  NOTE_EVENT_UPLOADING,     // 停止后上传了一个分段（pending 为剩余段数）
+  NOTE_EVENT_GENERATING,    // 分段已全部处理，正在生成笔记
+  NOTE_EVENT_DONE,          // 笔记生成请求成功
+  NOTE_EVENT_FAILED,        // 笔记生成失败
+  NOTE_EVENT_DISCARDED,     // 时长不足，录音已丢弃
+  NOTE_EVENT_RECORD_FAILED, // 等待或初始化录音器失败，会话已结束
+} note_event_t;
+
+/**
+ * 事件信息
+ */
+typedef struct {
+  note_event_t event;
+  uint32_t session_id; // 会话序号
+  int uploaded;        // 已上传成功的分段数
+  int failed;          // 上传失败的分段数
+  int pending;         // 队列中待上传的分段数
+} note_event_info_t;
+
+/**
+ * 事件回调
+ * 在服务任务（或调用 start/stop 的任务）中调用，不能直接操作 LVGL 对象
+ */
+typedef void (*note_event_callback_t)(const note_event_info_t *info,
+                                      void *user_data);
+
 /**
  * 开始录音业务逻辑
  * 每隔30秒录音文件压缩为mp3文件，然后调用API_UPLOAD接口上传录音文件
+ * 上一条笔记仍在收尾时也可以开始，录音器释放后新会话才真正开始采集
  *
- * @return 0 成功，非0 失败
+ * @return 0 成功，非0 失败（收尾中的会话过多等）
  */
 int start_note_recording(void);
 
 /**
- * 停止录音业务逻辑
+ * 停止录音业务逻辑（不阻塞）
+ * 只发出停止请求并立即返回；最后一段录音、剩余上传和生成笔记在服务任务中完成，
+ * 进度和结果通过事件回调通知。返回后即可再次调用 start_note_recording()。
  *
  * @param duration_sec 录音持续时间（秒），用于判断是否提交数据
  *                     如果 >= 60 秒则上传数据并生成笔记
@@ -25,6 +68,21 @@ int start_note_recording(void);
  */
 int stop_note_recording(uint32_t duration_sec);
 
+/**
+ * 设置会话事件回调
+ * @param callback 回调函数，NULL 取消
+ * @param user_data 用户数据，传递给回调函数
+ */
+void note_service_set_event_callback(note_event_callback_t callback,
+                                     void *user_data);
+
+/**
+ * 正在收尾（上传 / 生成笔记）的会话数
+ *
+ * @return 会话数，不含正在录音的会话
+ */
+int note_service_pending_count(void);
+
 /**
  * 生成笔记
  * 调用API_NOTE接口生成笔记
@@ -0,0 +1,461 @@
+/**
+ * @file prompt.c
+ * @brief 提示音缓存实现
+ */
+
+#include "prompt.h"
+#include "esp_console.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "metrics.h"
+#include "mp3dec.h"
+#include "audio_mixer.h"
+#include "pcm5101.h"
+#include "trace.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "Prompt";
+
+// ============================================================================
+// 配置参数
+// ============================================================================
+
+#define PROMPT_DIR "/sdcard"
+#define PROMPT_RATE CONFIG_APP_PROMPT_SAMPLE_RATE
+
+// 单个提示音文件的最大字节数（整个读入 PSRAM 后解码）
+#define PROMPT_MAX_FILE_BYTES (256 * 1024)
+
+// 播放任务每次写入混音器的采样数
+#define PROMPT_CHUNK_SAMPLES 512
+#define PROMPT_WRITE_TIMEOUT_MS 200
+
+#define PROMPT_QUEUE_LEN 4
+#define PROMPT_TASK_STACK 4096
+#define PROMPT_TASK_PRIO 4
+
+/** 清单：编号 → 控制台名称和文件 */
+typedef struct {
+    const char *name;
+    const char *file;
+} prompt_entry_t;
+
+static const prompt_entry_t s_manifest[PROMPT_COUNT] = {
+    [PROMPT_NO_NETWORK] = {"no_network", "no_network.mp3"},
+};
+
+// ============================================================================
+// 内部变量
+// ============================================================================
+
+/** 解码后的提示音：PROMPT_RATE 单声道 PCM（PSRAM） */
+typedef struct {
+    int16_t *pcm;
+    size_t samples;
+} prompt_pcm_t;
+
+/** 播放请求 */
+typedef struct {
+    prompt_id_t id;
+    int64_t trigger_us; // prompt_play 调用时间
+} prompt_req_t;
+
+/** 按 Q16 步长从单声道 PCM 线性插值读出（加载时重采样） */
+typedef struct {
+    const int16_t *pcm;
+    size_t samples;
+    uint64_t pos;  // 源位置（Q16）
+    uint32_t step; // 每输出一帧前进的源采样数（Q16）
+} prompt_cursor_t;
+
+static prompt_pcm_t s_cache[PROMPT_COUNT];
+static QueueHandle_t s_queue = NULL;
+static metric_t *s_latency_metric = NULL;
+
+// 最近一次播放的触发到出声延迟，供 prompt bench 读取
+static volatile uint32_t s_last_latency_us = 0;
+static volatile uint32_t s_play_count = 0;
+
+static const uint32_t LATENCY_BOUNDS_US[] = {500, 1000, 2000, 5000, 10000, 50000, 100000, 200000};
+
+// ============================================================================
+// 解码
+// ============================================================================
+
+static void cursor_init(prompt_cursor_t *cur, const int16_t *pcm, size_t samples, uint32_t src_rate,
+                        uint32_t dst_rate) {
+    cur->pcm = pcm;
+    cur->samples = samples;
+    cur->pos = 0;
+    cur->step = (uint32_t)(((uint64_t)src_rate << 16) / dst_rate);
+}
+
+/**
+ * 读出至多 max_frames 个采样
+ * @return 实际采样数，0 表示已读完
+ */
+static size_t cursor_read(prompt_cursor_t *cur, int16_t *out, size_t max_frames) {
+    size_t frames = 0;
+    while (frames < max_frames) {
+        size_t i = (size_t)(cur->pos >> 16);
+        if (i >= cur->samples) {
+            break;
+        }
+        int32_t a = cur->pcm[i];
+        int32_t b = (i + 1 < cur->samples) ? cur->pcm[i + 1] : a;
+        int32_t frac = (int32_t)(cur->pos & 0xffff);
+        out[frames++] = (int16_t)(a + (int32_t)(((int64_t)(b - a) * frac) >> 16));
+        cur->pos += cur->step;
+    }
+    return frames;
+}
+
+// ID3v2 标签长度（标签内容里可能出现伪同步字，直接跳过）
+static size_t id3v2_size(const uint8_t *buf, size_t len) {
+    if (len < 10 || memcmp(buf, "ID3", 3) != 0) {
+        return 0;
+    }
+    size_t size = ((size_t)(buf[6] & 0x7f) << 21) | ((size_t)(buf[7] & 0x7f) << 14) |
+                  ((size_t)(buf[8] & 0x7f) << 7) | (size_t)(buf[9] & 0x7f);
+    size += 10;
+    if (buf[5] & 0x10) {
+        size += 10; // 标签尾
+    }
+    return size < len ? size : len;
+}
+
+static uint8_t *read_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        ESP_LOGW(TAG, "无法打开 %s", path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size <= 0 || size > PROMPT_MAX_FILE_BYTES) {
+        ESP_LOGW(TAG, "%s 大小 %ld 字节，超出范围", path, size);
+        fclose(f);
+        return NULL;
+    }
+
+    uint8_t *data = heap_caps_malloc((size_t)size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (data == NULL) {
+        fclose(f);
+        return NULL;
+    }
+    size_t n = fread(data, 1, (size_t)size, f);
+    fclose(f);
+    if (n != (size_t)size) {
+        ESP_LOGW(TAG, "读取 %s 失败", path);
+        heap_caps_free(data);
+        return NULL;
+    }
+    *len = n;
+    return data;
+}
+
+/**
+ * MP3 解码为单声道 PCM（源采样率，PSRAM）
+ * @return 失败或没有可解码的帧时返回 NULL
+ */
+static int16_t *decode_mp3(const uint8_t *data, size_t len, size_t *out_samples, uint32_t *out_rate) {
+    HMP3Decoder dec = MP3InitDecoder();
+    int16_t *frame = heap_caps_malloc(MAX_NCHAN * MAX_NGRAN * MAX_NSAMP * sizeof(int16_t),
+                                      MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (dec == NULL || frame == NULL) {
+        if (dec) {
+            MP3FreeDecoder(dec);
+        }
+        heap_caps_free(frame);
+        return NULL;
+    }
+
+    size_t skip = id3v2_size(data, len);
+    unsigned char *in = (unsigned char *)data + skip;
+    int left = (int)(len - skip);
+    int16_t *pcm = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    uint32_t rate = 0;
+
+    while (left > 0) {
+        int offset = MP3FindSyncWord(in, left);
+        if (offset < 0) {
+            break;
+        }
+        in += offset;
+        left -= offset;
+
+        int err = MP3Decode(dec, &in, &left, frame, 0);
+        if (err == ERR_MP3_INDATA_UNDERFLOW) {
+            break;
+        }
+        if (err == ERR_MP3_MAINDATA_UNDERFLOW) {
+            continue; // 位储备尚未填满，该帧没有输出
+        }
+        if (err != ERR_MP3_NONE) {
+            // 坏帧：跳过同步字重新查找
+            in++;
+            left--;
+            continue;
+        }
+
+        MP3FrameInfo info;
+        MP3GetLastFrameInfo(dec, &info);
+        if (rate == 0) {
+            rate = (uint32_t)info.samprate;
+        } else if ((uint32_t)info.samprate != rate) {
+            continue;
+        }
+        size_t frames = (size_t)(info.outputSamps / info.nChans);
+        if (count + frames > capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : rate;
+            while (new_capacity < count + frames) {
+                new_capacity *= 2;
+            }
+            int16_t *grown = heap_caps_realloc(pcm, new_capacity * sizeof(int16_t),
+                                               MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+            if (grown == NULL) {
+                heap_caps_free(pcm);
+                pcm = NULL;
+                count = 0;
+                break;
+            }
+            pcm = grown;
+            capacity = new_capacity;
+        }
+        // 立体声混为单声道
+        for (size_t i = 0; i < frames; i++) {
+            pcm[count + i] =
+                info.nChans == 2 ? (int16_t)(((int32_t)frame[2 * i] + frame[2 * i + 1]) / 2) : frame[i];
+        }
+        count += frames;
+    }
+
+    MP3FreeDecoder(dec);
+    heap_caps_free(frame);
+    if (count == 0) {
+        heap_caps_free(pcm);
+        return NULL;
+    }
+    *out_samples = count;
+    *out_rate = rate;
+    return pcm;
+}
+
+static bool load_prompt(prompt_id_t id) {
+    const prompt_entry_t *entry = &s_manifest[id];
+    char path[64];
+    snprintf(path, sizeof(path), "%s/%s", PROMPT_DIR, entry->file);
+
+    size_t len = 0;
+    uint8_t *data = read_file(path, &len);
+    if (data == NULL) {
+        return false;
+    }
+    size_t samples = 0;
+    uint32_t rate = 0;
+    int16_t *src = decode_mp3(data, len, &samples, &rate);
+    heap_caps_free(data);
+    if (src == NULL) {
+        ESP_LOGW(TAG, "%s 解码失败", path);
+        return false;
+    }
+
+    // 重采样到 PROMPT_RATE（源采样率相同时只是复制）
+    size_t out_samples = (size_t)((uint64_t)samples * PROMPT_RATE / rate);
+    int16_t *pcm = heap_caps_malloc(out_samples * sizeof(int16_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (pcm == NULL) {
+        heap_caps_free(src);
+        return false;
+    }
+    prompt_cursor_t cur;
+    cursor_init(&cur, src, samples, rate, PROMPT_RATE);
+    out_samples = cursor_read(&cur, pcm, out_samples);
+    heap_caps_free(src);
+
+    s_cache[id].samples = out_samples;
+    s_cache[id].pcm = pcm;
+    ESP_LOGI(TAG, "%s: %lu Hz -> %d Hz，%u ms", entry->name, (unsigned long)rate, PROMPT_RATE,
+             (unsigned)(out_samples * 1000 / PROMPT_RATE));
+    return true;
+}
+
+// ============================================================================
+// 播放
+// ============================================================================
+
+static void play_one(const prompt_req_t *req) {
+    const prompt_pcm_t *p = &s_cache[req->id];
+    bool first = true;
+
+    // 写入混音器的提示音通道：不打断音乐和 TTS，由混音器转换采样率并闪避音乐
+    TRACE_BEGIN(TRACE_EV_PROMPT, req->id, p->samples);
+    for (size_t offset = 0; offset < p->samples; offset += PROMPT_CHUNK_SAMPLES) {
+        size_t n = p->samples - offset < PROMPT_CHUNK_SAMPLES ? p->samples - offset : PROMPT_CHUNK_SAMPLES;
+        if (audio_mixer_write(MIXER_CH_PROMPT, p->pcm + offset, n * sizeof(int16_t), NULL,
+                              PROMPT_WRITE_TIMEOUT_MS) != ESP_OK) {
+            ESP_LOGW(TAG, "写入混音器失败，提示音中断");
+            break;
+        }
+        if (first) {
+            // 第一块已进入混音器：混音任务被唤醒，下一个混音周期即写入 I2S
+            first = false;
+            uint32_t latency_us = (uint32_t)(esp_timer_get_time() - req->trigger_us);
+            metrics_histogram_observe(s_latency_metric, latency_us);
+            s_last_latency_us = latency_us;
+            s_play_count++;
+            ESP_LOGI(TAG, "播放 %s：触发到出声 %lu us", s_manifest[req->id].name, (unsigned long)latency_us);
+        }
+    }
+    TRACE_END(TRACE_EV_PROMPT, req->id, p->samples);
+}
+
+static void prompt_task(void *arg) {
+    prompt_req_t req;
+    while (true) {
+        if (xQueueReceive(s_queue, &req, portMAX_DELAY) == pdTRUE) {
+            play_one(&req);
+        }
+    }
+}
+
+// ============================================================================
+// 公共接口
+// ============================================================================
+
+void prompt_init(void) {
+    if (s_queue != NULL) {
+        return;
+    }
+    s_latency_metric = metrics_histogram("prompt.latency_us", LATENCY_BOUNDS_US,
+                                         sizeof(LATENCY_BOUNDS_US) / sizeof(LATENCY_BOUNDS_US[0]));
+
+    int64_t t0 = esp_timer_get_time();
+    int loaded = 0;
+    size_t bytes = 0;
+    for (int i = 0; i < PROMPT_COUNT; i++) {
+        if (load_prompt((prompt_id_t)i)) {
+            loaded++;
+            bytes += s_cache[i].samples * sizeof(int16_t);
+        }
+    }
+    ESP_LOGI(TAG, "提示音缓存：%d/%d 个，%u KB PSRAM，用时 %lld ms", loaded, PROMPT_COUNT,
+             (unsigned)(bytes / 1024), (esp_timer_get_time() - t0) / 1000);
+
+    QueueHandle_t queue = xQueueCreate(PROMPT_QUEUE_LEN, sizeof(prompt_req_t));
+    if (queue == NULL) {
+        ESP_LOGE(TAG, "创建队列失败");
+        return;
+    }
+    if (audio_mixer_set_format(MIXER_CH_PROMPT, PROMPT_RATE, 1) != ESP_OK) {
+        ESP_LOGE(TAG, "混音器提示音通道配置失败");
+        vQueueDelete(queue);
+        return;
+    }
+    if (xTaskCreatePinnedToCore(prompt_task, "prompt", PROMPT_TASK_STACK, NULL, PROMPT_TASK_PRIO, NULL, 1) !=
+        pdPASS) {
+        ESP_LOGE(TAG, "创建播放任务失败");
+        vQueueDelete(queue);
+        return;
+    }
+    s_queue = queue;
+}
+
+esp_err_t prompt_play(prompt_id_t id) {
+    if (s_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!prompt_is_ready(id)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    prompt_req_t req = {.id = id, .trigger_us = esp_timer_get_time()};
+    return xQueueSend(s_queue, &req, 0) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+bool prompt_is_ready(prompt_id_t id) {
+    return (unsigned)id < PROMPT_COUNT && s_cache[id].pcm != NULL;
+}
+
+// ============================================================================
+// 控制台
+// ============================================================================
+
+static int find_prompt(const char *name) {
+    for (int i = 0; i < PROMPT_COUNT; i++) {
+        if (strcmp(s_manifest[i].name, name) == 0) {
+            return i;
+        }
+    }
+    printf("未知提示音: %s\n", name);
+    return -1;
+}
+
+// 依次用原 Play_Music 路径和缓存路径播放同一提示音，打印两者的触发到出声延迟
+static void bench(int id) {
+    // Play_Music 返回时播放器刚进入 PLAYING，之后才解码第一帧、写混音器，测得的是下限
+    int64_t t0 = esp_timer_get_time();
+    Play_Music(PROMPT_DIR, s_manifest[id].file);
+    int64_t legacy_us = esp_timer_get_time() - t0;
+    for (int i = 0; i < 100 && audio_player_get_state() == AUDIO_PLAYER_STATE_PLAYING; i++) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+
+    uint32_t count = s_play_count;
+    esp_err_t ret = prompt_play((prompt_id_t)id);
+    if (ret != ESP_OK) {
+        printf("prompt_play 失败: %s\n", esp_err_to_name(ret));
+        return;
+    }
+    for (int i = 0; i < 100 && s_play_count == count; i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    printf("%s: Play_Music >= %lld us, prompt_play %lu us\n", s_manifest[id].name, legacy_us,
+           (unsigned long)s_last_latency_us);
+}
+
+static int cmd_prompt(int argc, char **argv) {
+    const char *sub = argc > 1 ? argv[1] : "list";
+    if (strcmp(sub, "list") == 0) {
+        for (int i = 0; i < PROMPT_COUNT; i++) {
+            printf("%-12s %s %u ms\n", s_manifest[i].name, s_cache[i].pcm ? "ready" : "missing",
+                   (unsigned)(s_cache[i].samples * 1000 / PROMPT_RATE));
+        }
+        printf("last latency %lu us\n", (unsigned long)s_last_latency_us);
+        return 0;
+    }
+    if ((strcmp(sub, "play") == 0 || strcmp(sub, "bench") == 0) && argc > 2) {
+        int id = find_prompt(argv[2]);
+        if (id < 0) {
+            return 1;
+        }
+        if (sub[0] == 'b') {
+            bench(id);
+        } else {
+            esp_err_t ret = prompt_play((prompt_id_t)id);
+            if (ret != ESP_OK) {
+                printf("prompt_play 失败: %s\n", esp_err_to_name(ret));
+                return 1;
+            }
+        }
+        return 0;
+    }
+    printf("用法: prompt [list|play <名称>|bench <名称>]\n");
+    return 1;
+}
+
+void prompt_register_console(void) {
+    const esp_console_cmd_t cmd = {
+        .command = "prompt",
+        .help = "提示音缓存：list 列出，play <名称> 播放，bench <名称> 对比 Play_Music 与缓存的触发到出声延迟",
+        .hint = NULL,
+        .func = cmd_prompt,
+    };
+    esp_console_cmd_register(&cmd);
+}
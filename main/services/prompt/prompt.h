@@ -0,0 +1,54 @@
+/**
+ * @file prompt.h
+ * @brief 提示音缓存
+ *
+ * 原来每次提示都走 Play_Music：从 SD 卡打开 MP3、启动 Helix 解码、等待播放器事件（最多 100 ms），
+ * 并把 I2S 时钟改成文件的采样率。这里改为启动时把清单中的短提示音一次性解码成
+ * CONFIG_APP_PROMPT_SAMPLE_RATE 的单声道 PCM 放在 PSRAM，之后播放：
+ * - prompt_play 只把请求放进队列，立即返回，可以在任意任务中调用（不能在中断中调用）
+ * - 播放任务把 PCM 写入混音器的提示音通道，不打开文件，也不改 I2S 时钟
+ * - 提示音之间依次播放；与音乐、TTS 叠加，音乐由混音器自动压低
+ *
+ * 触发到出声的延迟（请求入队到第一块数据写入混音器）记入直方图 prompt.latency_us，
+ * 控制台命令 `prompt bench` 对比原 Play_Music 路径和缓存路径。
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 提示音编号（与 prompt.c 中的清单一一对应） */
+typedef enum {
+    PROMPT_NO_NETWORK = 0, // 网络断开
+    PROMPT_COUNT,
+} prompt_id_t;
+
+/**
+ * 创建播放任务并解码清单中的全部提示音（启动阶段调用，需在 Audio_Init 之后）
+ *
+ * 文件不存在或解码失败的提示音跳过，prompt_is_ready 返回 false。
+ */
+void prompt_init(void);
+
+/**
+ * 播放提示音（不阻塞）
+ * @return ESP_OK 已入队；ESP_ERR_NOT_FOUND 该提示音未加载；
+ *         ESP_ERR_INVALID_STATE 未初始化；ESP_ERR_TIMEOUT 队列已满
+ */
+esp_err_t prompt_play(prompt_id_t id);
+
+/** 提示音是否已解码到缓存 */
+bool prompt_is_ready(prompt_id_t id);
+
+/** 注册控制台命令 prompt（需在 console_service_start 之后） */
+void prompt_register_console(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,238 @@
+/**
+ * @file trace.c
+ * @brief 热路径二进制事件跟踪实现
+ */
+
+#include "trace.h"
+#include "esp_console.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CONFIG_APP_TRACE
+
+static const char *TAG = "Trace";
+
+#define TRACE_RING_RECORDS CONFIG_APP_TRACE_RING_RECORDS
+#define TRACE_RING_MASK (TRACE_RING_RECORDS - 1)
+#define TRACE_DUMP_PER_LINE 4 // dump 每行的记录数
+
+_Static_assert((TRACE_RING_RECORDS & TRACE_RING_MASK) == 0, "CONFIG_APP_TRACE_RING_RECORDS 必须是 2 的幂");
+
+typedef struct {
+    trace_record_t *buf;     // PSRAM
+    uint32_t head;           // 已预留的记录数（只增，取模得到槽位）
+    TickType_t last_sync;    // 上一次 SYNC 记录的 tick
+    bool synced;
+} trace_ring_t;
+
+// 写位置在内部 RAM（原子操作），记录在 PSRAM
+static trace_ring_t s_rings[portNUM_PROCESSORS];
+static volatile bool s_enabled = false;
+
+#define TRACE_EVENT_NAME(id, name) name,
+static const char *const s_event_names[TRACE_EV_COUNT] = {TRACE_EVENT_LIST(TRACE_EVENT_NAME)};
+#undef TRACE_EVENT_NAME
+
+// ============================================================================
+// 写入
+// ============================================================================
+
+static inline uint8_t current_task_number(void) {
+#if configUSE_TRACE_FACILITY
+    return (uint8_t)uxTaskGetTaskNumber(xTaskGetCurrentTaskHandle());
+#else
+    return 0;
+#endif
+}
+
+static inline void put(trace_ring_t *ring, uint16_t event, uint8_t kind, uint32_t arg0, uint32_t arg1) {
+    uint32_t index = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED);
+    trace_record_t *r = &ring->buf[index & TRACE_RING_MASK];
+    r->cycles = esp_cpu_get_cycle_count();
+    r->event = event;
+    r->kind = kind;
+    r->task = current_task_number();
+    r->arg0 = arg0;
+    r->arg1 = arg1;
+}
+
+void trace_write(uint16_t event, uint8_t kind, uint32_t arg0, uint32_t arg1) {
+    if (!s_enabled) {
+        return;
+    }
+    TickType_t now = xTaskGetTickCount();
+    // 关本核中断：选缓冲区到读取周期计数之间任务不会被切走、迁移到另一个核，
+    // 否则会把另一个核的周期计数写进这个核的缓冲区
+    UBaseType_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+    trace_ring_t *ring = &s_rings[xPortGetCoreID()];
+    if (!ring->synced || now - ring->last_sync >= pdMS_TO_TICKS(TRACE_SYNC_INTERVAL_MS)) {
+        ring->synced = true;
+        ring->last_sync = now;
+        int64_t us = esp_timer_get_time();
+        put(ring, TRACE_EV_SYNC, TRACE_KIND_SYNC, (uint32_t)us, (uint32_t)((uint64_t)us >> 32));
+    }
+    put(ring, event, kind, arg0, arg1);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+}
+
+// ============================================================================
+// 控制
+// ============================================================================
+
+void trace_init(void) {
+    size_t bytes = TRACE_RING_RECORDS * sizeof(trace_record_t);
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        s_rings[core].buf = heap_caps_calloc(TRACE_RING_RECORDS, sizeof(trace_record_t),
+                                             MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (s_rings[core].buf == NULL) {
+            ESP_LOGE(TAG, "跟踪缓冲区分配失败（%u 字节），跟踪未启用", (unsigned)bytes);
+            for (int i = 0; i < core; i++) {
+                heap_caps_free(s_rings[i].buf);
+                s_rings[i].buf = NULL;
+            }
+            return;
+        }
+    }
+    s_enabled = true;
+    ESP_LOGI(TAG, "事件跟踪已启用：每核 %d 条记录（%u KB PSRAM）", TRACE_RING_RECORDS, (unsigned)(bytes / 1024));
+}
+
+void trace_set_enabled(bool enabled) {
+    s_enabled = enabled && s_rings[0].buf != NULL;
+}
+
+void trace_clear(void) {
+    bool was_enabled = s_enabled;
+    s_enabled = false;
+    vTaskDelay(pdMS_TO_TICKS(10)); // 等正在写的记录完成
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        s_rings[core].head = 0;
+        s_rings[core].synced = false;
+    }
+    s_enabled = was_enabled;
+}
+
+// ============================================================================
+// 输出
+// ============================================================================
+
+static void dump_tasks(void) {
+#if configUSE_TRACE_FACILITY
+    UBaseType_t count = uxTaskGetNumberOfTasks() + 4;
+    TaskStatus_t *tasks = malloc(count * sizeof(TaskStatus_t));
+    if (tasks == NULL) {
+        return;
+    }
+    count = uxTaskGetSystemState(tasks, count, NULL);
+    for (UBaseType_t i = 0; i < count; i++) {
+        printf("T %u %s\n", (unsigned)(tasks[i].xTaskNumber & 0xFF), tasks[i].pcTaskName);
+    }
+    free(tasks);
+#endif
+}
+
+/**
+ * 输出格式（tools/trace_convert 解析）：
+ *   # trace v<版本> cpu_mhz=<频率> cores=<核数>
+ *   E <编号> <事件名>
+ *   T <任务编号> <任务名>        （当前存活的任务）
+ *   R <核> <记录的十六进制>...   （每条 32 个十六进制字符，按写入顺序）
+ *   # end
+ */
+void trace_dump(void) {
+    if (s_rings[0].buf == NULL) {
+        printf("跟踪未启用\n");
+        return;
+    }
+    bool was_enabled = s_enabled;
+    s_enabled = false;
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    printf("# trace v%d cpu_mhz=%d cores=%d\n", TRACE_FORMAT_VERSION, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+           portNUM_PROCESSORS);
+    for (int i = 0; i < TRACE_EV_COUNT; i++) {
+        printf("E %d %s\n", i, s_event_names[i]);
+    }
+    dump_tasks();
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        trace_ring_t *ring = &s_rings[core];
+        uint32_t head = ring->head;
+        uint32_t count = head < TRACE_RING_RECORDS ? head : TRACE_RING_RECORDS;
+        for (uint32_t i = 0; i < count; i += TRACE_DUMP_PER_LINE) {
+            printf("R %d", core);
+            for (uint32_t k = i; k < count && k < i + TRACE_DUMP_PER_LINE; k++) {
+                const uint8_t *p = (const uint8_t *)&ring->buf[(head - count + k) & TRACE_RING_MASK];
+                printf(" ");
+                for (int b = 0; b < (int)sizeof(trace_record_t); b++) {
+                    printf("%02x", p[b]);
+                }
+            }
+            printf("\n");
+        }
+    }
+    printf("# end\n");
+    fflush(stdout);
+
+    s_enabled = was_enabled;
+}
+
+static void print_stats(void) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        uint32_t head = s_rings[core].head;
+        printf("核 %d: 已写 %lu 条，缓冲区保留 %lu 条\n", core, (unsigned long)head,
+               (unsigned long)(head < TRACE_RING_RECORDS ? head : TRACE_RING_RECORDS));
+    }
+    printf("记录%s\n", s_enabled ? "中" : "已暂停");
+}
+
+#else // CONFIG_APP_TRACE
+
+void trace_init(void) {}
+void trace_write(uint16_t event, uint8_t kind, uint32_t arg0, uint32_t arg1) {}
+void trace_set_enabled(bool enabled) {}
+void trace_clear(void) {}
+void trace_dump(void) { printf("跟踪未编译（CONFIG_APP_TRACE）\n"); }
+static void print_stats(void) { trace_dump(); }
+
+#endif // CONFIG_APP_TRACE
+
+// ============================================================================
+// 控制台命令
+// ============================================================================
+
+static int cmd_trace(int argc, char **argv) {
+    const char *sub = argc > 1 ? argv[1] : "stat";
+    if (strcmp(sub, "dump") == 0) {
+        trace_dump();
+    } else if (strcmp(sub, "clear") == 0) {
+        trace_clear();
+    } else if (strcmp(sub, "on") == 0) {
+        trace_set_enabled(true);
+    } else if (strcmp(sub, "off") == 0) {
+        trace_set_enabled(false);
+    } else if (strcmp(sub, "stat") == 0) {
+        print_stats();
+    } else {
+        printf("用法: trace [stat|dump|clear|on|off]\n");
+        return 1;
+    }
+    return 0;
+}
+
+void trace_register_console(void) {
+    const esp_console_cmd_t cmd = {
+        .command = "trace",
+        .help = "事件跟踪: stat 统计 / dump 输出记录（tools/trace_convert 转换）/ clear 清空 / on / off",
+        .hint = "[stat|dump|clear|on|off]",
+        .func = cmd_trace,
+    };
+    esp_console_cmd_register(&cmd);
+}
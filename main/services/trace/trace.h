@@ -0,0 +1,63 @@
+/**
+ * @file trace.h
+ * @brief 热路径二进制事件跟踪
+ *
+ * ESP_LOGI 格式化和串口输出太慢，音频 / 网络 / 渲染热路径上的日志大多被注释掉了。
+ * 这里改为写 16 字节的二进制记录（格式见 trace_format.h）：
+ * - 每个核一个 PSRAM 环形缓冲区（CONFIG_APP_TRACE_RING_RECORDS 条），写满后覆盖最旧的记录
+ * - 写入不加锁：在关本核中断的几十个周期内按当前核选缓冲区、预留槽位并读取周期计数，
+ *   任务不会在中间迁移到另一个核；不同核互不阻塞
+ * - 关闭 CONFIG_APP_TRACE 时所有 TRACE_* 宏为空，参数不求值
+ *
+ * 控制台命令 `trace dump` 以文本形式打印事件名、任务名和全部记录，
+ * 用 tools/trace_convert 转换为 Chrome / Perfetto 的 trace JSON。
+ *
+ * TRACE_BEGIN / TRACE_END 须在同一任务中配对，不能在中断中调用。
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+#include "trace_events.h"
+#include "trace_format.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 分配环形缓冲区并开始记录（启动时最先调用） */
+void trace_init(void);
+
+/** 写一条记录（通过 TRACE_* 宏调用） */
+void trace_write(uint16_t event, uint8_t kind, uint32_t arg0, uint32_t arg1);
+
+/** 暂停 / 恢复记录 */
+void trace_set_enabled(bool enabled);
+
+/** 清空已记录的数据 */
+void trace_clear(void);
+
+/** 打印全部记录（dump 期间暂停记录） */
+void trace_dump(void);
+
+/** 注册控制台命令 trace（需在 console_service_start 之后） */
+void trace_register_console(void);
+
+#if CONFIG_APP_TRACE
+#define TRACE_BEGIN(ev, a0, a1) trace_write((ev), TRACE_KIND_BEGIN, (uint32_t)(a0), (uint32_t)(a1))
+#define TRACE_END(ev, a0, a1) trace_write((ev), TRACE_KIND_END, (uint32_t)(a0), (uint32_t)(a1))
+#define TRACE_INSTANT(ev, a0, a1) trace_write((ev), TRACE_KIND_INSTANT, (uint32_t)(a0), (uint32_t)(a1))
+#define TRACE_COUNTER(ev, value) trace_write((ev), TRACE_KIND_COUNTER, (uint32_t)(value), 0)
+#else
+#define TRACE_BEGIN(ev, a0, a1) ((void)0)
+#define TRACE_END(ev, a0, a1) ((void)0)
+#define TRACE_INSTANT(ev, a0, a1) ((void)0)
+#define TRACE_COUNTER(ev, value) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
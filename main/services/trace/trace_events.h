@@ -0,0 +1,34 @@
+/**
+ * @file trace_events.h
+ * @brief 跟踪事件列表
+ *
+ * 新增事件只在列表末尾追加一行（编号即顺序），名称会随 dump 输出，主机侧不需要同步修改。
+ * 参数含义写在每行注释里，转换后出现在 Perfetto 的 args 中（a0 / a1）。
+ */
+
+#pragma once
+
+// X(编号, 名称)
+#define TRACE_EVENT_LIST(X)                                                                  \
+    X(TRACE_EV_SYNC, "sync")                 /* 时间同步（内部） */                         \
+    X(TRACE_EV_MIC_READ, "mic_read")         /* a0 读到的字节数 */                          \
+    X(TRACE_EV_AFE_FEED, "afe_feed")         /* a0 每次 feed 的采样数 */                    \
+    X(TRACE_EV_AFE_FETCH, "afe_fetch")       /* 瞬时，a0 输出字节数，a1 vad_state */        \
+    X(TRACE_EV_VAD, "vad")                   /* 瞬时，a0 1 说话开始 / 0 结束 */             \
+    X(TRACE_EV_OPUS_ENCODE, "opus_encode")   /* a0 输入采样数 */                            \
+    X(TRACE_EV_WS_SEND, "ws_send")           /* a0 字节数，a1 返回值 */                     \
+    X(TRACE_EV_WS_RECV, "ws_recv")           /* 瞬时，a0 完整消息字节数，a1 opcode */       \
+    X(TRACE_EV_AUDIO_QUEUE, "audio_out_queue") /* 计数，播放队列长度 */                     \
+    X(TRACE_EV_OPUS_DECODE, "opus_decode")   /* a0 输入字节数，a1 输出采样数 */             \
+    X(TRACE_EV_I2S_WRITE, "i2s_write")       /* a0 采样数 */                                \
+    X(TRACE_EV_LV_TIMER, "lv_timer_handler") /* 主循环中的 LVGL 处理（含渲染） */           \
+    X(TRACE_EV_LV_REFR, "lv_refr")           /* 瞬时，a0 渲染耗时 ms，a1 像素数 */          \
+    X(TRACE_EV_LCD_FLUSH, "lcd_flush")       /* a0 像素数，a1 起始行 */                     \
+    X(TRACE_EV_NOTE_CHUNK, "note_chunk")     /* 瞬时，a0 本次字节数，a1 已缓冲字节数 */     \
+    X(TRACE_EV_NOTE_UPLOAD, "note_upload")   /* a0 文件 KB，a1 结束时为 HTTP 状态码 */      \
+    X(TRACE_EV_NOTE_GENERATE, "note_generate") /* a1 结束时为 HTTP 状态码 */                \
+    X(TRACE_EV_PROMPT, "prompt")             /* a0 提示音编号，a1 采样数 */
+
+#define TRACE_EVENT_ENUM(id, name) id,
+enum { TRACE_EVENT_LIST(TRACE_EVENT_ENUM) TRACE_EV_COUNT };
+#undef TRACE_EVENT_ENUM
@@ -0,0 +1,44 @@
+/**
+ * @file trace_format.h
+ * @brief 事件跟踪记录格式（固件与 tools/trace_convert 共用，不依赖 ESP-IDF）
+ *
+ * 每条记录 16 字节，按核分别写入各自的环形缓冲区：
+ * - cycles：写入时所在核的 CPU 周期计数（32 位，240 MHz 下约 17.9 秒回绕一次）
+ * - event / kind：事件编号（trace_events.h）和类型
+ * - task：写入任务的编号（uxTaskGetTaskNumber）低 8 位，主机侧据此按任务分线程显示
+ * - arg0 / arg1：事件参数
+ *
+ * 时间基准：每核第一条记录前、以及距上一次同步超过 TRACE_SYNC_INTERVAL_MS 时，先写一条 SYNC 记录，
+ * 参数为 esp_timer 微秒时间（arg0 低 32 位，arg1 高 32 位）。两次同步之间周期计数不会回绕，
+ * 主机侧用 sync_us + (cycles - sync_cycles) / cpu_mhz 换算为绝对时间，不同核的记录可直接合并。
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define TRACE_FORMAT_VERSION 1
+#define TRACE_SYNC_INTERVAL_MS 1000
+
+enum {
+    TRACE_KIND_BEGIN = 1, // 区间开始（同一任务内与 END 配对）
+    TRACE_KIND_END,       // 区间结束
+    TRACE_KIND_INSTANT,   // 瞬时事件
+    TRACE_KIND_COUNTER,   // 计数值（arg0）
+    TRACE_KIND_SYNC,      // 时间同步
+};
+
+typedef struct {
+    uint32_t cycles;
+    uint16_t event;
+    uint8_t kind;
+    uint8_t task;
+    uint32_t arg0;
+    uint32_t arg1;
+} trace_record_t;
+
+#ifdef __cplusplus
+static_assert(sizeof(trace_record_t) == 16, "trace_record_t 必须为 16 字节");
+#else
+_Static_assert(sizeof(trace_record_t) == 16, "trace_record_t 必须为 16 字节");
+#endif
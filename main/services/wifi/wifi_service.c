@@ -2,6 +2,9 @@
 #include "app_config.h"
 #include "esp_event.h"
 #include "esp_netif.h"
+#include "esp_timer.h"
+#include "freertos/event_groups.h"
+#include <stdlib.h>
 #include <string.h>
 
 uint16_t WIFI_NUM = 0;
@@ -14,7 +17,75 @@ static bool wifi_connected = false;
 static int current_wifi_index = 0;  // 当前尝试连接的 WiFi 索引
 static char wifi_error_msg[128] = {0};  // WiFi错误信息
 static bool wifi_init_complete = false;  // WiFi初始化是否完成
+static wifi_state_callback_t wifi_state_callback = NULL;
+static void *wifi_state_user_data = NULL;
+
+// ============== 快速连接 ==============
+//
+// 上次连接成功的网络（配置序号、BSSID、信道）保存在 NVS。启动时先按缓存直接连接该 AP：
+// 指定 BSSID 和信道，驱动只在这一个信道上探测，IP 由 lwIP 按上次的租约直接请求
+// （CONFIG_LWIP_DHCP_RESTORE_LAST_IP，DHCP 只走 REQUEST / ACK）。
+// 失败后做一次全信道扫描，同时匹配所有配置的 SSID，按配置顺序连接扫描到的 AP；
+// 扫描不到任何配置的网络时（例如隐藏 SSID）再逐个尝试。
+// 等待连接结果使用事件组，不再轮询。
+
+#define WIFI_STARTED_BIT      BIT0
+#define WIFI_GOT_IP_BIT       BIT1
+#define WIFI_DISCONNECTED_BIT BIT2
+#define WIFI_SCAN_DONE_BIT    BIT3
+#define WIFI_ABORTED_BIT      BIT4 // 超时后主动断开的尝试已由驱动确认
+
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 4000 // 缓存的 AP：关联 + DHCP
+#define WIFI_SCAN_TIMEOUT_MS         5000 // 全信道主动扫描
+#define WIFI_DISCONNECT_WAIT_MS      500  // 超时后等待驱动断开完成
+#define WIFI_SCAN_MAX_AP             20
+
+#define WIFI_NVS_NAMESPACE "wifi_fast"
+#define WIFI_NVS_KEY       "last"
+#define WIFI_CACHE_VERSION 1
+
+typedef struct {
+    uint8_t version;
+    uint8_t index;        // wifi_configs 中的序号
+    uint8_t channel;
+    uint8_t bssid[6];
+    uint32_t config_hash; // SSID + 密码的散列，配置修改后缓存失效
+    uint32_t ip;          // 上次获得的 IP，用于判断租约是否续用
+} wifi_fast_cache_t;
+
+typedef struct {
+    int index;
+    uint8_t bssid[6];
+    uint8_t channel;
+    int8_t rssi;
+} wifi_candidate_t;
+
+static EventGroupHandle_t s_wifi_events = NULL;
+static wifi_fast_cache_t s_cache;          // 从 NVS 读出的缓存
+static bool s_cache_valid = false;
+static wifi_connect_info_t s_connect_info;
+static int64_t s_got_ip_us = 0;            // 获取 IP 的时间（启动后微秒）
+static uint32_t s_got_ip = 0;
+// 超时后调用了 esp_wifi_disconnect，尚未收到对应的断开事件（原因 ASSOC_LEAVE）。
+// 这个事件可能在下一次尝试开始后才到，不能算作下一次尝试的失败
+static volatile bool s_abort_pending = false;
+
+// 状态可能变化时通知回调（事件处理函数和初始化结束时调用）
+static void wifi_notify_state(void)
+{
+    wifi_state_callback_t callback = wifi_state_callback;
+    if (callback) {
+        callback(WiFi_GetLinkState(), wifi_state_user_data);
+    }
+}
+
 void Wireless_Init(void)
+{
+    WiFi_NVS_Init();
+    WiFi_Start();
+}
+
+void WiFi_NVS_Init(void)
 {
     // Initialize NVS.
     esp_err_t ret = nvs_flash_init();
@@ -23,6 +94,10 @@ void Wireless_Init(void)
         ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK( ret );
+}
+
+void WiFi_Start(void)
+{
     // WiFi
     xTaskCreatePinnedToCore(
         WIFI_Init, 
@@ -39,24 +114,246 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                                 int32_t event_id, void* event_data)
 {
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-        esp_wifi_connect();
-        ESP_LOGI(TAG, "WiFi 开始连接...");
+        // 连接由 WIFI_Init 按缓存 / 扫描结果发起
+        xEventGroupSetBits(s_wifi_events, WIFI_STARTED_BIT);
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_SCAN_DONE) {
+        xEventGroupSetBits(s_wifi_events, WIFI_SCAN_DONE_BIT);
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        wifi_event_sta_disconnected_t *event = (wifi_event_sta_disconnected_t *)event_data;
         wifi_connected = false;
-        // 断开连接时不自动重连，由主循环控制尝试下一个网络
-        ESP_LOGI(TAG, "WiFi 断开连接");
+        xEventGroupClearBits(s_wifi_events, WIFI_GOT_IP_BIT);
+        // 断开连接时不自动重连，由 WIFI_Init 决定下一次尝试
+        if (s_abort_pending && event->reason == WIFI_REASON_ASSOC_LEAVE) {
+            s_abort_pending = false;
+            ESP_LOGI(TAG, "WiFi 断开连接（中止的连接尝试）");
+            xEventGroupSetBits(s_wifi_events, WIFI_ABORTED_BIT);
+        } else {
+            ESP_LOGI(TAG, "WiFi 断开连接（原因 %d）", event->reason);
+            xEventGroupSetBits(s_wifi_events, WIFI_DISCONNECTED_BIT);
+        }
+        wifi_notify_state();
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
         ESP_LOGI(TAG, "WiFi 连接成功!");
         ESP_LOGI(TAG, "IP 地址: " IPSTR, IP2STR(&event->ip_info.ip));
         ESP_LOGI(TAG, "子网掩码: " IPSTR, IP2STR(&event->ip_info.netmask));
         ESP_LOGI(TAG, "网关: " IPSTR, IP2STR(&event->ip_info.gw));
+        s_got_ip_us = esp_timer_get_time();
+        s_got_ip = event->ip_info.ip.addr;
+        s_abort_pending = false;
         wifi_connected = true;
+        xEventGroupSetBits(s_wifi_events, WIFI_GOT_IP_BIT);
+        wifi_notify_state();
+    }
+}
+
+// ============== 缓存 ==============
+
+// FNV-1a，覆盖 SSID 和密码
+static uint32_t wifi_config_hash(const wifi_config_item_t *config)
+{
+    uint32_t h = 2166136261u;
+    const char *parts[2] = { config->ssid, config->password ? config->password : "" };
+    for (int p = 0; p < 2; p++) {
+        for (const char *c = parts[p]; ; c++) {
+            h ^= (uint8_t)*c;
+            h *= 16777619u;
+            if (*c == '\0') {
+                break;
+            }
+        }
+    }
+    return h;
+}
+
+static bool wifi_config_valid(int index)
+{
+    const wifi_config_item_t *config = &wifi_configs[index];
+    return config->ssid != NULL && config->ssid[0] != '\0';
+}
+
+static void wifi_cache_load(void)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(WIFI_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return;
+    }
+    size_t len = sizeof(s_cache);
+    esp_err_t ret = nvs_get_blob(nvs, WIFI_NVS_KEY, &s_cache, &len);
+    nvs_close(nvs);
+    if (ret != ESP_OK || len != sizeof(s_cache) || s_cache.version != WIFI_CACHE_VERSION ||
+        s_cache.index >= WIFI_CONFIG_COUNT || !wifi_config_valid(s_cache.index) ||
+        s_cache.config_hash != wifi_config_hash(&wifi_configs[s_cache.index])) {
+        return;
+    }
+    s_cache_valid = true;
+}
+
+// 连接成功后记录当前 AP，内容未变时不写 flash
+static void wifi_cache_save(int index)
+{
+    wifi_ap_record_t ap;
+    if (esp_wifi_sta_get_ap_info(&ap) != ESP_OK) {
+        return;
+    }
+    wifi_fast_cache_t cache;
+    memset(&cache, 0, sizeof(cache));
+    cache.version = WIFI_CACHE_VERSION;
+    cache.index = (uint8_t)index;
+    cache.channel = ap.primary;
+    memcpy(cache.bssid, ap.bssid, sizeof(cache.bssid));
+    cache.config_hash = wifi_config_hash(&wifi_configs[index]);
+    cache.ip = s_got_ip;
+    if (s_cache_valid && memcmp(&cache, &s_cache, sizeof(cache)) == 0) {
+        return;
+    }
+
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(WIFI_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(nvs, WIFI_NVS_KEY, &cache, sizeof(cache));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "保存快速连接缓存失败: %s", esp_err_to_name(ret));
+        return;
+    }
+    s_cache = cache;
+    s_cache_valid = true;
+    ESP_LOGI(TAG, "快速连接缓存已更新: [%d] 信道 %d", index + 1, cache.channel);
+}
+
+// ============== 连接 ==============
+
+/**
+ * 连接一个网络并等待获取 IP
+ * @param bssid 指定 AP，NULL 时由驱动扫描
+ * @param channel 指定信道（bssid 非 NULL 时有效）
+ */
+static bool wifi_try_connect(int index, const uint8_t *bssid, uint8_t channel, uint32_t timeout_ms)
+{
+    const wifi_config_item_t *config = &wifi_configs[index];
+    wifi_config_t wifi_config = {0};
+    strncpy((char *)wifi_config.sta.ssid, config->ssid, sizeof(wifi_config.sta.ssid) - 1);
+    if (config->password != NULL) {
+        strncpy((char *)wifi_config.sta.password, config->password, sizeof(wifi_config.sta.password) - 1);
+    }
+    wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
+    if (bssid) {
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, bssid, sizeof(wifi_config.sta.bssid));
+        wifi_config.sta.channel = channel;
+        wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+    }
+
+    esp_err_t ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "设置 WiFi 配置失败: %s", esp_err_to_name(ret));
+        return false;
+    }
+
+    s_connect_info.attempts++;
+    xEventGroupClearBits(s_wifi_events, WIFI_GOT_IP_BIT | WIFI_DISCONNECTED_BIT);
+    ret = esp_wifi_connect();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "启动 WiFi 连接失败: %s", esp_err_to_name(ret));
+        return false;
     }
+
+    EventBits_t bits = xEventGroupWaitBits(s_wifi_events, WIFI_GOT_IP_BIT | WIFI_DISCONNECTED_BIT,
+                                           pdFALSE, pdFALSE, pdMS_TO_TICKS(timeout_ms));
+    if (bits & WIFI_GOT_IP_BIT) {
+        return true;
+    }
+    if (bits & WIFI_DISCONNECTED_BIT) {
+        ESP_LOGW(TAG, "WiFi 连接失败: %s", config->ssid);
+    } else {
+        ESP_LOGW(TAG, "WiFi 连接超时: %s", config->ssid);
+        // 关联中的连接要等驱动上报断开后才能发起下一次；
+        // 等待超时后才到的断开事件由 s_abort_pending 识别，不会让下一次尝试立即失败
+        xEventGroupClearBits(s_wifi_events, WIFI_ABORTED_BIT);
+        s_abort_pending = true;
+        esp_wifi_disconnect();
+        xEventGroupWaitBits(s_wifi_events, WIFI_ABORTED_BIT, pdFALSE, pdFALSE,
+                            pdMS_TO_TICKS(WIFI_DISCONNECT_WAIT_MS));
+    }
+    return false;
+}
+
+/**
+ * 全信道扫描一次，按配置顺序找出可见的网络（同名取信号最强的 AP）
+ * @return 候选个数
+ */
+static int wifi_scan_candidates(wifi_candidate_t *candidates)
+{
+    xEventGroupClearBits(s_wifi_events, WIFI_SCAN_DONE_BIT);
+    wifi_scan_config_t scan_config = {0};
+    esp_err_t ret = esp_wifi_scan_start(&scan_config, false);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "启动扫描失败: %s", esp_err_to_name(ret));
+        return 0;
+    }
+    EventBits_t bits = xEventGroupWaitBits(s_wifi_events, WIFI_SCAN_DONE_BIT, pdTRUE, pdFALSE,
+                                           pdMS_TO_TICKS(WIFI_SCAN_TIMEOUT_MS));
+    if (!(bits & WIFI_SCAN_DONE_BIT)) {
+        ESP_LOGW(TAG, "扫描超时");
+        esp_wifi_scan_stop();
+        return 0;
+    }
+
+    uint16_t ap_count = WIFI_SCAN_MAX_AP;
+    wifi_ap_record_t *records = calloc(ap_count, sizeof(wifi_ap_record_t));
+    if (!records) {
+        esp_wifi_clear_ap_list();
+        return 0;
+    }
+    ret = esp_wifi_scan_get_ap_records(&ap_count, records);
+    if (ret != ESP_OK) {
+        free(records);
+        return 0;
+    }
+    ESP_LOGI(TAG, "扫描到 %d 个 AP", ap_count);
+
+    int count = 0;
+    for (int i = 0; i < WIFI_CONFIG_COUNT; i++) {
+        if (!wifi_config_valid(i)) {
+            continue;
+        }
+        const wifi_ap_record_t *best = NULL;
+        for (int k = 0; k < ap_count; k++) {
+            if (strcmp((const char *)records[k].ssid, wifi_configs[i].ssid) == 0 &&
+                (best == NULL || records[k].rssi > best->rssi)) {
+                best = &records[k];
+            }
+        }
+        if (best) {
+            wifi_candidate_t *c = &candidates[count++];
+            c->index = i;
+            memcpy(c->bssid, best->bssid, sizeof(c->bssid));
+            c->channel = best->primary;
+            c->rssi = best->rssi;
+        }
+    }
+    free(records);
+    return count;
+}
+
+static void wifi_connected_at(int index, wifi_connect_path_t path, int64_t start_us)
+{
+    s_connect_info.path = path;
+    s_connect_info.index = index;
+    s_connect_info.boot_to_ip_ms = (uint32_t)(s_got_ip_us / 1000);
+    s_connect_info.connect_ms = (uint32_t)((s_got_ip_us - start_us) / 1000);
+    s_connect_info.lease_reused = s_cache_valid && s_cache.ip != 0 && s_cache.ip == s_got_ip;
 }
 
 void WIFI_Init(void *arg)
 {
+    s_wifi_events = xEventGroupCreate();
+
     // 初始化网络接口
     esp_netif_init();                                                     
     
@@ -69,6 +366,8 @@ void WIFI_Init(void *arg)
     // 初始化 WiFi
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();                 
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+    // 每次尝试都会 set_config，配置只放在 RAM，网络记录由快速连接缓存保存
+    esp_wifi_set_storage(WIFI_STORAGE_RAM);
     
     // 注册 WiFi 和 IP 事件处理函数
     ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
@@ -87,71 +386,54 @@ void WIFI_Init(void *arg)
     
     // 启动 WiFi
     ESP_ERROR_CHECK(esp_wifi_start());
+    xEventGroupWaitBits(s_wifi_events, WIFI_STARTED_BIT, pdFALSE, pdFALSE, portMAX_DELAY);
     
-    ESP_LOGI(TAG, "WiFi 初始化完成，开始尝试连接 WiFi 网络...");
-    
-    // 循环尝试连接所有配置的 WiFi 网络
+    ESP_LOGI(TAG, "WiFi 初始化完成，开始连接 WiFi 网络...");
+    int64_t start_us = esp_timer_get_time();
     bool connected = false;
-    for (int i = 0; i < WIFI_CONFIG_COUNT; i++) {
-        current_wifi_index = i;
-        const wifi_config_item_t *config = &wifi_configs[i];
-        
-        // 检查配置是否有效（SSID 不为空）
-        if (config->ssid == NULL || strlen(config->ssid) == 0) {
-            ESP_LOGW(TAG, "跳过无效的 WiFi 配置 [%d]", i);
-            continue;
-        }
-        
-        ESP_LOGI(TAG, "尝试连接 WiFi [%d/%d]: %s", i + 1, WIFI_CONFIG_COUNT, config->ssid);
-        
-        // 配置 WiFi SSID 和密码
-        wifi_config_t wifi_config = {0};
-        strncpy((char *)wifi_config.sta.ssid, config->ssid, sizeof(wifi_config.sta.ssid) - 1);
-        if (config->password != NULL) {
-            strncpy((char *)wifi_config.sta.password, config->password, sizeof(wifi_config.sta.password) - 1);
+
+    // 1. 缓存的 AP：指定 BSSID 和信道
+    wifi_cache_load();
+    if (s_cache_valid) {
+        current_wifi_index = s_cache.index;
+        ESP_LOGI(TAG, "快速连接 [%d/%d]: %s（信道 %d）", s_cache.index + 1, WIFI_CONFIG_COUNT,
+                 wifi_configs[s_cache.index].ssid, s_cache.channel);
+        if (wifi_try_connect(s_cache.index, s_cache.bssid, s_cache.channel, WIFI_FAST_CONNECT_TIMEOUT_MS)) {
+            connected = true;
+            wifi_connected_at(s_cache.index, WIFI_CONNECT_PATH_CACHED, start_us);
         }
-        wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
-        
-        esp_err_t ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "设置 WiFi 配置失败: %s", esp_err_to_name(ret));
-            continue;
+    }
+
+    // 2. 全信道扫描一次，匹配所有配置
+    int scanned = 0;
+    if (!connected) {
+        wifi_candidate_t candidates[WIFI_CONFIG_COUNT];
+        scanned = wifi_scan_candidates(candidates);
+        for (int i = 0; i < scanned && !connected; i++) {
+            wifi_candidate_t *c = &candidates[i];
+            current_wifi_index = c->index;
+            ESP_LOGI(TAG, "尝试连接 WiFi [%d/%d]: %s（信道 %d，%d dBm）", c->index + 1, WIFI_CONFIG_COUNT,
+                     wifi_configs[c->index].ssid, c->channel, c->rssi);
+            if (wifi_try_connect(c->index, c->bssid, c->channel, WIFI_CONNECT_TIMEOUT_SEC * 1000)) {
+                connected = true;
+                wifi_connected_at(c->index, WIFI_CONNECT_PATH_SCAN, start_us);
+            }
         }
-        
-        // 先断开之前的连接（如果有）
-        esp_wifi_disconnect();
-        vTaskDelay(pdMS_TO_TICKS(500));  // 等待断开完成
-        
-        // 开始连接（检查返回值，避免在已连接时重复连接导致错误）
-        wifi_connected = false;
-        ret = esp_wifi_connect();
-        if (ret != ESP_OK) {
-            if (ret == ESP_ERR_WIFI_CONN) {
-                ESP_LOGW(TAG, "WiFi 正在连接中，等待连接结果...");
-                // 如果正在连接，等待一段时间看是否成功
-            } else {
-                ESP_LOGE(TAG, "启动 WiFi 连接失败: %s", esp_err_to_name(ret));
-                vTaskDelay(pdMS_TO_TICKS(1000));  // 等待1秒后尝试下一个
+    }
+
+    // 3. 扫描不到任何配置的网络（隐藏 SSID 等）：逐个尝试
+    if (!connected && scanned == 0) {
+        for (int i = 0; i < WIFI_CONFIG_COUNT && !connected; i++) {
+            if (!wifi_config_valid(i)) {
+                ESP_LOGW(TAG, "跳过无效的 WiFi 配置 [%d]", i);
                 continue;
             }
-        }
-        
-        // 等待连接完成（带超时）
-        int timeout_count = 0;
-        while (!wifi_connected && timeout_count < WIFI_CONNECT_TIMEOUT_SEC * 10) {
-            vTaskDelay(pdMS_TO_TICKS(100));
-            timeout_count++;
-        }
-        
-        if (wifi_connected) {
-            ESP_LOGI(TAG, "WiFi 连接成功! 网络: %s", config->ssid);
-            connected = true;
-            break;  // 连接成功，退出循环
-        } else {
-            ESP_LOGW(TAG, "WiFi 连接超时: %s", config->ssid);
-            // 断开当前连接，准备尝试下一个
-            esp_wifi_disconnect();
-            vTaskDelay(pdMS_TO_TICKS(1000));  // 等待1秒后尝试下一个
+            current_wifi_index = i;
+            ESP_LOGI(TAG, "尝试连接 WiFi [%d/%d]: %s", i + 1, WIFI_CONFIG_COUNT, wifi_configs[i].ssid);
+            if (wifi_try_connect(i, NULL, 0, WIFI_CONNECT_TIMEOUT_SEC * 1000)) {
+                connected = true;
+                wifi_connected_at(i, WIFI_CONNECT_PATH_FULL, start_us);
+            }
         }
     }
     
@@ -160,10 +442,17 @@ void WIFI_Init(void *arg)
         ESP_LOGE(TAG, "请检查：1. WiFi 网络是否可用 2. SSID 和密码是否正确 3. 信号强度是否足够");
         snprintf(wifi_error_msg, sizeof(wifi_error_msg), "WiFi连接失败\n已尝试%d个网络\n请检查网络配置", WIFI_CONFIG_COUNT);
     } else {
+        static const char *path_names[] = { "", "缓存", "扫描", "逐个尝试" };
+        ESP_LOGI(TAG, "WiFi 连接成功! 网络: %s，方式: %s，尝试 %d 次，连接耗时 %lu ms，启动到获取 IP %lu ms%s",
+                 wifi_configs[s_connect_info.index].ssid, path_names[s_connect_info.path],
+                 s_connect_info.attempts, (unsigned long)s_connect_info.connect_ms,
+                 (unsigned long)s_connect_info.boot_to_ip_ms, s_connect_info.lease_reused ? "（续用上次租约）" : "");
+        wifi_cache_save(s_connect_info.index);
         wifi_error_msg[0] = '\0';  // 清除错误信息
     }
     
     wifi_init_complete = true;  // 标记初始化完成
+    wifi_notify_state();
     vTaskDelete(NULL);
 }
 uint16_t WIFI_Scan(void)
@@ -208,3 +497,26 @@ const char* WiFi_GetError(void) {
     }
     return NULL;  // 无错误
 }
+
+// 获取WiFi连接状态
+wifi_link_state_t WiFi_GetLinkState(void) {
+    if (!wifi_init_complete) {
+        return WIFI_LINK_CONNECTING;
+    }
+    if (wifi_connected) {
+        return WIFI_LINK_CONNECTED;
+    }
+    return wifi_error_msg[0] != '\0' ? WIFI_LINK_FAILED : WIFI_LINK_DISCONNECTED;
+}
+
+// 获取启动时的连接结果
+void WiFi_GetConnectInfo(wifi_connect_info_t *info) {
+    *info = s_connect_info;
+}
+
+// 设置WiFi状态回调
+void WiFi_SetStateCallback(wifi_state_callback_t callback, void *user_data) {
+    wifi_state_user_data = user_data;
+    wifi_state_callback = callback;
+    wifi_notify_state();
+}
@@ -14,9 +14,45 @@ extern "C" {
 #include <string.h> // For memcpy
 
 extern uint16_t WIFI_NUM;
+
+/**
+ * WiFi 连接状态（与 WiFi_IsConnected / WiFi_GetError 的判断一致）
+ */
+typedef enum {
+    WIFI_LINK_CONNECTING = 0, // 初始化中，正在逐个尝试配置的网络
+    WIFI_LINK_CONNECTED,      // 已获取 IP
+    WIFI_LINK_DISCONNECTED,   // 连接后断开
+    WIFI_LINK_FAILED,         // 所有配置的网络都连接失败，原因见 WiFi_GetError()
+} wifi_link_state_t;
+
+/** 启动时连接成功的方式 */
+typedef enum {
+    WIFI_CONNECT_PATH_NONE = 0, // 未连接
+    WIFI_CONNECT_PATH_CACHED,   // NVS 缓存的 AP（指定 BSSID 和信道）
+    WIFI_CONNECT_PATH_SCAN,     // 全信道扫描后匹配到的 AP
+    WIFI_CONNECT_PATH_FULL,     // 扫描不到任何配置的网络，逐个尝试
+} wifi_connect_path_t;
+
+/** 启动时的连接结果（WIFI_Init 结束后有效） */
+typedef struct {
+    wifi_connect_path_t path;
+    int index;              // wifi_configs 中的序号
+    uint8_t attempts;       // 发起连接的次数
+    bool lease_reused;      // 获得的 IP 与上次相同（DHCP 续用租约）
+    uint32_t connect_ms;    // WiFi 启动完成到获取 IP
+    uint32_t boot_to_ip_ms; // 系统启动到获取 IP
+} wifi_connect_info_t;
+
+/**
+ * 状态变化回调
+ * 在 WiFi 任务或系统事件任务中调用，不能直接操作 LVGL 对象
+ */
+typedef void (*wifi_state_callback_t)(wifi_link_state_t state, void *user_data);
 extern bool Scan_finish;
 
-void Wireless_Init(void);
+void Wireless_Init(void);   // WiFi_NVS_Init + WiFi_Start
+void WiFi_NVS_Init(void);   // 初始化 NVS（WiFi 驱动和快速连接缓存都依赖）
+void WiFi_Start(void);      // 创建 WiFi 任务（WIFI_Init），连接在后台进行
 void WIFI_Init(void *arg);
 uint16_t WIFI_Scan(void);
 
@@ -24,6 +60,15 @@ uint16_t WIFI_Scan(void);
 bool WiFi_IsConnected(void);
 bool WiFi_IsInitComplete(void); // 检查WiFi初始化是否完成
 const char *WiFi_GetError(void);
+wifi_link_state_t WiFi_GetLinkState(void);
+void WiFi_GetConnectInfo(wifi_connect_info_t *info);
+
+/**
+ * 设置状态变化回调，设置后立即以当前状态调用一次
+ * @param callback 回调函数，NULL 取消
+ * @param user_data 用户数据，传递给回调函数
+ */
+void WiFi_SetStateCallback(wifi_state_callback_t callback, void *user_data);
 
 #ifdef __cplusplus
 }
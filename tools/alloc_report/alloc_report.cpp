@@ -0,0 +1,339 @@
+/**
+ * @file alloc_report.cpp
+ * @brief 把固件 `allocprof` 的输出符号化，按会话列出分配最多的调用点
+ *
+ * 用法：alloc_report <串口日志> <固件 ELF> [--top N] [--sort count|bytes|live]
+ *                    [--addr2line 路径] [--skip 函数名前缀]...
+ *
+ * 设备端每个调用点记录从堆钩子向外的若干层返回地址（main/services/alloc_prof/alloc_prof.h）。
+ * 这里用 addr2line 一次性解析全部地址，跳过 malloc / new / heap_caps / STL 容器内部等栈帧，
+ * 把分配归到第一个业务代码的位置，再按会话（ai / note / manual）合并、排序输出。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// ============== 数据 ==============
+
+struct Site {
+    char mem = 'i'; // i 内部 RAM / p PSRAM
+    unsigned long long count = 0;
+    unsigned long long bytes = 0;
+    unsigned long long freed = 0;
+    unsigned long long live_bytes = 0;
+    unsigned long long peak_live = 0;
+    unsigned long long life_avg_us = 0;
+    unsigned long long life_max_us = 0;
+    std::vector<unsigned long> frames;
+};
+
+struct Session {
+    std::string name;
+    long long duration_ms = 0;
+    unsigned long dropped = 0;
+    bool complete = false;
+    std::vector<Site> sites;
+};
+
+struct Symbol {
+    std::string function;
+    std::string location; // 文件:行
+};
+
+// 调用点归属后的合并结果
+struct Row {
+    std::string function;
+    std::string location;
+    std::string via; // 实际调用的分配函数（第一个栈帧）
+    char mem = 'i';
+    unsigned long long count = 0;
+    unsigned long long bytes = 0;
+    unsigned long long freed = 0;
+    unsigned long long live_bytes = 0;
+    unsigned long long peak_live = 0;
+    unsigned long long life_sum_us = 0; // 平均存活 × 已释放次数，合并后再求平均
+    unsigned long long life_max_us = 0;
+};
+
+// 分配器、C 库和 STL 内部的栈帧，归属时跳过
+static std::vector<std::string> s_skip_prefixes = {
+    "malloc", "calloc", "realloc", "free", "_malloc_r", "_calloc_r", "_realloc_r", "_free_r",
+    "heap_caps_", "multi_heap_", "tlsf_", "esp_heap_trace_", "record_alloc", "record_free",
+    "operator new", "operator delete", "__cxa_", "strdup", "strndup", "asprintf", "vasprintf",
+    "__gnu_cxx::", "std::", "_svfprintf_r", "_vfprintf_r", "__smakebuf_r", "__ssputs_r", "__ssprint_r",
+    "lv_mem_", "cJSON_malloc", "cJSON_New_Item",
+};
+
+// ============== 解析日志 ==============
+
+static std::vector<Session> parse_log(FILE *f) {
+    std::vector<Session> sessions;
+    char line[4096];
+    Session *cur = nullptr;
+    while (fgets(line, sizeof(line), f)) {
+        const char *hdr = strstr(line, "# allocprof v1 ");
+        if (hdr) {
+            sessions.emplace_back();
+            cur = &sessions.back();
+            char name[64] = "-";
+            int depth = 0;
+            unsigned long sites = 0;
+            if (sscanf(hdr, "# allocprof v1 session=%63s duration_ms=%lld depth=%d sites=%lu dropped=%lu", name,
+                       &cur->duration_ms, &depth, &sites, &cur->dropped) < 1) {
+                fprintf(stderr, "无法解析: %s", hdr);
+            }
+            cur->name = name;
+            continue;
+        }
+        if (!cur) {
+            continue;
+        }
+        if (strncmp(line, "# end", 5) == 0) {
+            cur->complete = true;
+            cur = nullptr;
+            continue;
+        }
+        if (line[0] != 'S' || line[1] != ' ') {
+            continue;
+        }
+        Site s;
+        int n = 0;
+        if (sscanf(line, "S %c %llu %llu %llu %llu %llu %llu %llu%n", &s.mem, &s.count, &s.bytes, &s.freed,
+                   &s.live_bytes, &s.peak_live, &s.life_avg_us, &s.life_max_us, &n) != 8) {
+            continue;
+        }
+        const char *p = line + n;
+        char *end;
+        for (;;) {
+            unsigned long pc = strtoul(p, &end, 16);
+            if (end == p) {
+                break;
+            }
+            s.frames.push_back(pc);
+            p = end;
+        }
+        cur->sites.push_back(std::move(s));
+    }
+    return sessions;
+}
+
+// ============== 符号化 ==============
+
+static std::string trim(const std::string &s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return b == std::string::npos ? "" : s.substr(b, e - b + 1);
+}
+
+/** 把全部地址写入临时文件，addr2line 每个地址输出两行：函数名、文件:行 */
+static std::map<unsigned long, Symbol> symbolize(const std::set<unsigned long> &pcs, const char *elf,
+                                                 const char *addr2line) {
+    std::map<unsigned long, Symbol> result;
+    char tmp[] = "/tmp/alloc_report_XXXXXX";
+    int fd = mkstemp(tmp);
+    if (fd < 0) {
+        perror("mkstemp");
+        return result;
+    }
+    FILE *f = fdopen(fd, "w");
+    for (unsigned long pc : pcs) {
+        fprintf(f, "0x%08lx\n", pc);
+    }
+    fclose(f);
+
+    std::string cmd = std::string(addr2line) + " -f -C -e '" + elf + "' < " + tmp;
+    FILE *p = popen(cmd.c_str(), "r");
+    if (!p) {
+        perror("popen");
+        unlink(tmp);
+        return result;
+    }
+    char func[2048], loc[2048];
+    auto it = pcs.begin();
+    while (it != pcs.end() && fgets(func, sizeof(func), p) && fgets(loc, sizeof(loc), p)) {
+        Symbol sym;
+        sym.function = trim(func);
+        sym.location = trim(loc);
+        size_t slash = sym.location.rfind('/');
+        if (slash != std::string::npos) {
+            sym.location = sym.location.substr(slash + 1);
+        }
+        size_t disc = sym.location.find(" (discriminator");
+        if (disc != std::string::npos) {
+            sym.location.resize(disc);
+        }
+        result[*it++] = sym;
+    }
+    int status = pclose(p);
+    unlink(tmp);
+    if (status != 0 || it != pcs.end()) {
+        fprintf(stderr, "addr2line 执行失败（%s），请确认 ESP-IDF 工具链在 PATH 中或用 --addr2line 指定\n", addr2line);
+    }
+    return result;
+}
+
+static bool skipped(const std::string &function) {
+    if (function.empty() || function == "??") {
+        return true;
+    }
+    // 返回类型在前的模板函数，如 "void std::vector<...>::_M_realloc_insert<...>(...)"
+    std::string name = function.substr(0, function.find('('));
+    size_t space = name.rfind(' ');
+    if (space != std::string::npos && name.compare(0, 9, "operator ") != 0) {
+        name = name.substr(space + 1);
+    }
+    for (const std::string &prefix : s_skip_prefixes) {
+        if (name.compare(0, prefix.size(), prefix) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::string short_name(const std::string &function) {
+    std::string name = function.substr(0, function.find('('));
+    return name.empty() ? function : name;
+}
+
+// ============== 输出 ==============
+
+static void report(const Session &session, const std::map<unsigned long, Symbol> &symbols, size_t top,
+                   const std::string &sort) {
+    std::map<std::string, Row> rows;
+    unsigned long long total_count = 0, total_bytes = 0, internal_count = 0;
+    for (const Site &s : session.sites) {
+        Row key;
+        for (unsigned long pc : s.frames) {
+            auto it = symbols.find(pc);
+            const Symbol *sym = it == symbols.end() ? nullptr : &it->second;
+            if (key.via.empty() && sym) {
+                key.via = short_name(sym->function);
+            }
+            if (sym && !skipped(sym->function)) {
+                key.function = short_name(sym->function);
+                key.location = sym->location;
+                break;
+            }
+        }
+        if (key.function.empty()) {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "0x%08lx", s.frames.empty() ? 0ul : s.frames.back());
+            key.function = "(未识别) ";
+            key.function += buf;
+        }
+        std::string id = key.function + '\n' + key.location + '\n' + s.mem;
+        Row &r = rows[id];
+        if (r.count == 0) {
+            r.function = key.function;
+            r.location = key.location;
+            r.via = key.via;
+            r.mem = s.mem;
+        }
+        r.count += s.count;
+        r.bytes += s.bytes;
+        r.freed += s.freed;
+        r.live_bytes += s.live_bytes;
+        r.peak_live += s.peak_live; // 同一位置不同调用栈的峰值相加，为上界
+        r.life_sum_us += s.life_avg_us * s.freed;
+        r.life_max_us = std::max(r.life_max_us, s.life_max_us);
+        total_count += s.count;
+        total_bytes += s.bytes;
+        if (s.mem == 'i') {
+            internal_count += s.count;
+        }
+    }
+
+    std::vector<Row> sorted;
+    for (auto &kv : rows) {
+        sorted.push_back(kv.second);
+    }
+    std::sort(sorted.begin(), sorted.end(), [&](const Row &a, const Row &b) {
+        if (sort == "bytes") {
+            return a.bytes > b.bytes;
+        }
+        if (sort == "live") {
+            return a.live_bytes > b.live_bytes;
+        }
+        return a.count > b.count;
+    });
+
+    double seconds = session.duration_ms > 0 ? session.duration_ms / 1000.0 : 0;
+    printf("== 会话 %s：%.1f 秒，分配 %llu 次（%.0f 次/秒），%llu 字节，内部 RAM %llu 次 / PSRAM %llu 次%s\n",
+           session.name.c_str(), seconds, total_count, seconds > 0 ? total_count / seconds : 0.0, total_bytes,
+           internal_count, total_count - internal_count, session.complete ? "" : "（输出不完整）");
+    if (session.dropped) {
+        printf("   表满未记录 %lu 次，调大 APP_ALLOC_PROF_SITES / APP_ALLOC_PROF_LIVE\n", session.dropped);
+    }
+    printf("%8s %10s %8s %8s %9s %10s %10s %3s  %s\n", "次数", "字节", "平均", "未释放", "存活峰值", "平均存活us",
+           "最长存活us", "区", "调用点（经由）");
+    for (size_t i = 0; i < sorted.size() && i < top; i++) {
+        const Row &r = sorted[i];
+        unsigned long long unfreed = r.count - r.freed;
+        printf("%8llu %10llu %8llu %8llu %9llu %10llu %10llu %3c  %s %s（%s）\n", r.count, r.bytes,
+               r.count ? r.bytes / r.count : 0, unfreed, r.peak_live, r.freed ? r.life_sum_us / r.freed : 0,
+               r.life_max_us, r.mem, r.function.c_str(), r.location.c_str(), r.via.c_str());
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    const char *log_path = nullptr, *elf = nullptr;
+    const char *addr2line = "xtensa-esp32s3-elf-addr2line";
+    size_t top = 20;
+    std::string sort = "count";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            top = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sort") == 0 && i + 1 < argc) {
+            sort = argv[++i];
+        } else if (strcmp(argv[i], "--addr2line") == 0 && i + 1 < argc) {
+            addr2line = argv[++i];
+        } else if (strcmp(argv[i], "--skip") == 0 && i + 1 < argc) {
+            s_skip_prefixes.push_back(argv[++i]);
+        } else if (!log_path) {
+            log_path = argv[i];
+        } else if (!elf) {
+            elf = argv[i];
+        }
+    }
+    if (!log_path || !elf) {
+        fprintf(stderr,
+                "用法: %s <串口日志> <固件 ELF> [--top N] [--sort count|bytes|live] [--addr2line 路径] "
+                "[--skip 函数名前缀]\n",
+                argv[0]);
+        return 2;
+    }
+
+    FILE *f = fopen(log_path, "r");
+    if (!f) {
+        perror(log_path);
+        return 1;
+    }
+    std::vector<Session> sessions = parse_log(f);
+    fclose(f);
+    if (sessions.empty()) {
+        fprintf(stderr, "日志中没有找到 allocprof 输出\n");
+        return 1;
+    }
+
+    std::set<unsigned long> pcs;
+    for (const Session &s : sessions) {
+        for (const Site &site : s.sites) {
+            pcs.insert(site.frames.begin(), site.frames.end());
+        }
+    }
+    std::map<unsigned long, Symbol> symbols = symbolize(pcs, elf, addr2line);
+
+    for (const Session &s : sessions) {
+        report(s, symbols, top, sort);
+    }
+    return 0;
+}
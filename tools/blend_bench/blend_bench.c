@@ -0,0 +1,289 @@
+/**
+ * @file blend_bench.c
+ * @brief lvgl_blend 加速内核的主机端逐像素对比与吞吐基准
+ *
+ * 1. 校验：随机生成目标缓冲、源图像、遮罩、混合区域和裁剪区域，
+ *    分别交给 LVGL 原实现 lv_draw_sw_blend_basic 和 lvgl_blend_fast，
+ *    要求整块缓冲逐字节一致（含区域外像素未被改写）。
+ * 2. 基准：对每种操作统计两种实现的 Mpixel/s。
+ *
+ * 任一操作出现不一致时返回非 0。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lvgl.h"
+#include "lvgl_blend.h"
+
+// ============== 配置 ==============
+
+// 与固件显存一致：360 宽，一次刷新 18 行（LVGL_BUF_LEN = 360 * 360 / 20）
+#define BUF_W 360
+#define BUF_H 18
+
+// 校验用的源图像/遮罩容量（混合区域最多比缓冲大 1 行 1 列）
+#define SRC_CAP ((BUF_W + 2) * (BUF_H + 2))
+
+#define VERIFY_ROUNDS 4000     // 每种操作的随机校验次数
+#define BENCH_MIN_NS 200000000 // 每项基准至少运行 200ms
+
+typedef enum {
+    OP_FILL = 0,   // 不透明填充
+    OP_FILL_OPA,   // 带透明度填充
+    OP_FILL_MASK,  // 带遮罩填充（文字、抗锯齿边缘）
+    OP_MAP,        // RGB565 图像拷贝
+    OP_MAP_OPA,    // 带透明度图像拷贝
+    OP_COUNT,
+} blend_op_t;
+
+static const char *const s_op_names[OP_COUNT] = {
+    "fill", "fill_opa", "fill_mask", "map", "map_opa",
+};
+
+typedef void (*blend_fn_t)(lv_draw_ctx_t *, const lv_draw_sw_blend_dsc_t *);
+
+// ============== 工具 ==============
+
+static uint32_t s_rng = 0x12345678;
+
+static uint32_t rnd(void) {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static int32_t rnd_range(int32_t lo, int32_t hi) {
+    return lo + (int32_t)(rnd() % (uint32_t)(hi - lo + 1));
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief 填充测试图案：少量调色板颜色组成的色块（含黑色），模拟真实界面
+ */
+static void fill_pattern(lv_color_t *buf, size_t n, bool all_black) {
+    uint16_t palette[6] = { 0x0000, 0xFFFF, (uint16_t)rnd(), (uint16_t)rnd(), (uint16_t)rnd(), (uint16_t)rnd() };
+    size_t i = 0;
+    while (i < n) {
+        uint16_t c = all_black ? 0 : ((rnd() & 3) ? palette[rnd() % 6] : (uint16_t)rnd());
+        size_t run = 1 + rnd() % 24;
+        for (; run && i < n; run--, i++) {
+            buf[i].full = c;
+        }
+    }
+}
+
+/**
+ * @brief 生成遮罩：大段全透明/全覆盖夹杂抗锯齿过渡，与文字遮罩分布相近
+ */
+static void fill_mask(lv_opa_t *mask, size_t n) {
+    size_t i = 0;
+    while (i < n) {
+        uint32_t kind = rnd() % 4;
+        size_t run = 1 + rnd() % 12;
+        for (; run && i < n; run--, i++) {
+            mask[i] = kind == 0 ? LV_OPA_TRANSP : kind == 1 ? LV_OPA_COVER : (lv_opa_t)rnd();
+        }
+    }
+}
+
+static lv_opa_t pick_opa(blend_op_t op) {
+    if (op == OP_FILL || op == OP_MAP) {
+        return LV_OPA_COVER;
+    }
+    if (op == OP_FILL_MASK && (rnd() & 1)) {
+        return LV_OPA_COVER;
+    }
+    // 覆盖量化边界（249..252 在原实现中会被截断）
+    return (rnd() & 7) == 0 ? (lv_opa_t)rnd_range(245, 252) : (lv_opa_t)rnd_range(LV_OPA_MIN + 1, LV_OPA_MAX - 1);
+}
+
+// ============== 绘制上下文 ==============
+
+static lv_disp_drv_t s_disp_drv;
+static lv_disp_draw_buf_t s_disp_buf;
+static lv_color_t s_disp_px[BUF_W * BUF_H];
+
+static void dummy_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
+    (void)area;
+    (void)color_p;
+    lv_disp_flush_ready(drv);
+}
+
+static void setup_display(void) {
+    lv_disp_draw_buf_init(&s_disp_buf, s_disp_px, NULL, BUF_W * BUF_H);
+    lv_disp_drv_init(&s_disp_drv);
+    s_disp_drv.hor_res = BUF_W;
+    s_disp_drv.ver_res = BUF_H;
+    s_disp_drv.flush_cb = dummy_flush;
+    s_disp_drv.draw_buf = &s_disp_buf;
+    lv_disp_t *disp = lv_disp_drv_register(&s_disp_drv);
+    // 混合函数通过 _lv_refr_get_disp_refreshing() 读取驱动配置
+    _lv_refr_set_disp_refreshing(disp);
+}
+
+static void ctx_init(lv_draw_sw_ctx_t *ctx, lv_color_t *buf, const lv_area_t *buf_area, const lv_area_t *clip) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->base_draw.buf = buf;
+    ctx->base_draw.buf_area = (lv_area_t *)buf_area;
+    ctx->base_draw.clip_area = clip;
+}
+
+// ============== 逐像素校验 ==============
+
+static uint32_t verify_op(blend_op_t op) {
+    static lv_color_t ref_buf[BUF_W * BUF_H];
+    static lv_color_t fast_buf[BUF_W * BUF_H];
+    static lv_color_t src[SRC_CAP];
+    static lv_opa_t mask[SRC_CAP];
+
+    const lv_area_t buf_area = { 0, 0, BUF_W - 1, BUF_H - 1 };
+    uint32_t mismatches = 0;
+
+    for (uint32_t round = 0; round < VERIFY_ROUNDS; round++) {
+        // 混合区域可以超出缓冲，裁剪区域在缓冲内
+        lv_area_t blend_area;
+        blend_area.x1 = rnd_range(-8, BUF_W - 1);
+        blend_area.y1 = rnd_range(-4, BUF_H - 1);
+        blend_area.x2 = blend_area.x1 + ((rnd() & 3) ? rnd_range(0, 40) : rnd_range(0, BUF_W));
+        blend_area.y2 = blend_area.y1 + rnd_range(0, BUF_H);
+
+        lv_area_t clip = buf_area;
+        if (rnd() & 1) {
+            clip.x1 = rnd_range(0, BUF_W / 2);
+            clip.y1 = rnd_range(0, BUF_H / 2);
+            clip.x2 = rnd_range(clip.x1, BUF_W - 1);
+            clip.y2 = rnd_range(clip.y1, BUF_H - 1);
+        }
+
+        fill_pattern(ref_buf, BUF_W * BUF_H, (rnd() % 8) == 0);
+        memcpy(fast_buf, ref_buf, sizeof(ref_buf));
+        fill_pattern(src, (size_t)lv_area_get_size(&blend_area), false);
+        fill_mask(mask, (size_t)lv_area_get_size(&blend_area));
+
+        lv_draw_sw_blend_dsc_t dsc;
+        memset(&dsc, 0, sizeof(dsc));
+        dsc.blend_area = &blend_area;
+        dsc.color.full = (uint16_t)rnd();
+        dsc.opa = pick_opa(op);
+        dsc.blend_mode = LV_BLEND_MODE_NORMAL;
+        if (op == OP_MAP || op == OP_MAP_OPA) {
+            dsc.src_buf = src;
+        }
+        if (op == OP_FILL_MASK) {
+            dsc.mask_buf = mask;
+            dsc.mask_area = &blend_area;
+            dsc.mask_res = LV_DRAW_MASK_RES_CHANGED;
+        }
+
+        lv_draw_sw_ctx_t ctx;
+        ctx_init(&ctx, ref_buf, &buf_area, &clip);
+        lv_draw_sw_blend_basic(&ctx.base_draw, &dsc);
+        ctx_init(&ctx, fast_buf, &buf_area, &clip);
+        lvgl_blend_fast(&ctx.base_draw, &dsc);
+
+        if (memcmp(ref_buf, fast_buf, sizeof(ref_buf)) != 0) {
+            if (mismatches == 0) {
+                for (int i = 0; i < BUF_W * BUF_H; i++) {
+                    if (ref_buf[i].full != fast_buf[i].full) {
+                        printf("  %s 第 %u 轮不一致: (%d,%d) opa=%u ref=%04x fast=%04x\n", s_op_names[op], round,
+                               i % BUF_W, i / BUF_W, dsc.opa, ref_buf[i].full, fast_buf[i].full);
+                        break;
+                    }
+                }
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// ============== 吞吐基准 ==============
+
+static double bench_op(blend_op_t op, blend_fn_t fn, int32_t w, int32_t h) {
+    static lv_color_t dest[BUF_W * BUF_H];
+    static lv_color_t src[BUF_W * BUF_H];
+    static lv_opa_t mask[BUF_W * BUF_H];
+
+    const lv_area_t buf_area = { 0, 0, BUF_W - 1, BUF_H - 1 };
+    lv_area_t blend_area = { 0, 0, w - 1, h - 1 };
+
+    fill_pattern(dest, BUF_W * BUF_H, false);
+    fill_pattern(src, BUF_W * BUF_H, false);
+    fill_mask(mask, BUF_W * BUF_H);
+
+    lv_draw_sw_blend_dsc_t dsc;
+    memset(&dsc, 0, sizeof(dsc));
+    dsc.blend_area = &blend_area;
+    dsc.color = lv_color_make(0x20, 0x80, 0xE0);
+    dsc.opa = (op == OP_FILL || op == OP_MAP || op == OP_FILL_MASK) ? LV_OPA_COVER : LV_OPA_60;
+    dsc.blend_mode = LV_BLEND_MODE_NORMAL;
+    if (op == OP_MAP || op == OP_MAP_OPA) {
+        dsc.src_buf = src;
+    }
+    if (op == OP_FILL_MASK) {
+        dsc.mask_buf = mask;
+        dsc.mask_area = &blend_area;
+        dsc.mask_res = LV_DRAW_MASK_RES_CHANGED;
+    }
+
+    lv_draw_sw_ctx_t ctx;
+    ctx_init(&ctx, dest, &buf_area, &buf_area);
+
+    uint64_t iters = 0;
+    uint64_t t0 = now_ns();
+    uint64_t elapsed;
+    do {
+        for (int i = 0; i < 64; i++) {
+            // 交替两种底色，避免透明度填充一直命中原实现的单色缓存
+            dsc.color.full ^= 0x0841;
+            fn(&ctx.base_draw, &dsc);
+        }
+        iters += 64;
+        elapsed = now_ns() - t0;
+    } while (elapsed < BENCH_MIN_NS);
+
+    return (double)iters * w * h / (elapsed / 1e9) / 1e6;
+}
+
+int main(void) {
+    static const struct {
+        const char *name;
+        int32_t w;
+        int32_t h;
+    } sizes[] = {
+        { "360x18", BUF_W, BUF_H }, // 整条刷新缓冲
+        { "16x16", 16, 16 },        // 单个字形 / 图标
+    };
+
+    lv_init();
+    setup_display();
+
+    printf("== 逐像素校验（每项 %d 轮） ==\n", VERIFY_ROUNDS);
+    uint32_t total_bad = 0;
+    for (int op = 0; op < OP_COUNT; op++) {
+        uint32_t bad = verify_op((blend_op_t)op);
+        printf("%-10s %s (%u/%d 不一致)\n", s_op_names[op], bad ? "FAIL" : "OK", bad, VERIFY_ROUNDS);
+        total_bad += bad;
+    }
+
+    printf("\n== 吞吐（Mpixel/s） ==\n");
+    printf("%-10s %-7s %10s %10s %8s\n", "op", "area", "scalar", "fast", "speedup");
+    for (int op = 0; op < OP_COUNT; op++) {
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            double ref = bench_op((blend_op_t)op, lv_draw_sw_blend_basic, sizes[s].w, sizes[s].h);
+            double fast = bench_op((blend_op_t)op, lvgl_blend_fast, sizes[s].w, sizes[s].h);
+            printf("%-10s %-7s %10.1f %10.1f %7.2fx\n", s_op_names[op], sizes[s].name, ref, fast, fast / ref);
+        }
+    }
+
+    return total_bad ? 1 : 0;
+}
@@ -0,0 +1,33 @@
+# ============================================================================
+# 主机端工具共用的 LVGL 构建（Linux，独立于 ESP-IDF 工程）
+#
+#   include("${CMAKE_CURRENT_SOURCE_DIR}/../cmake/host_lvgl.cmake")
+#
+# 定义：
+#   REPO_DIR / LVGL_DIR / PORT_DIR   仓库根目录、LVGL 源码、ESP-IDF 替身（tools/ui_bench/port）
+#   lvgl                             静态库，使用仓库内的 lv_conf.h，与固件配置一致
+#   LVGL_PORT_DIR                    main/drivers/lvgl_port（字形/图片缓存、混合内核、分区字体）
+#   LVGL_PORT_SRCS                   上述三个模块的源文件，按需取用
+# ============================================================================
+
+get_filename_component(REPO_DIR "${CMAKE_CURRENT_LIST_DIR}/../.." ABSOLUTE)
+set(LVGL_DIR "${REPO_DIR}/components/lvgl")
+set(PORT_DIR "${REPO_DIR}/tools/ui_bench/port")
+set(LVGL_PORT_DIR "${REPO_DIR}/main/drivers/lvgl_port")
+
+file(GLOB_RECURSE LVGL_SRCS "${LVGL_DIR}/src/*.c")
+# LVGL 两级堆（LV_MEM_CUSTOM_ALLOC）随 LVGL 一起编译
+add_library(lvgl STATIC ${LVGL_SRCS} "${REPO_DIR}/components/lvgl_mem/lvgl_mem.c")
+target_include_directories(lvgl PUBLIC
+    "${PORT_DIR}"
+    "${LVGL_DIR}"
+    "${LVGL_DIR}/src"
+    "${REPO_DIR}/components/lvgl_mem/include"
+)
+target_compile_options(lvgl PRIVATE -w)
+
+set(LVGL_PORT_SRCS
+    "${LVGL_PORT_DIR}/lvgl_cache.c"
+    "${LVGL_PORT_DIR}/lvgl_blend.c"
+    "${LVGL_PORT_DIR}/lvgl_font.c"
+)
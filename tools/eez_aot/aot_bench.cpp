@@ -0,0 +1,251 @@
+/**
+ * @file aot_bench.cpp
+ * @brief EEZ flow 预编译连线与解释器的等价性校验和耗时对比
+ *
+ * 对 eez_flow_aot_gen.c 中的每条连线，从同一个初始状态（连线所在页面为当前屏幕、屏幕栈为空、
+ * 对象标志 / 状态还原）分别用解释器和预编译结果处理一次控件事件，再跑一个 eez_flow_tick：
+ * - 比较处理后的可见状态：当前屏幕、屏幕栈、活动屏幕对象、所有对象的标志和状态
+ * - 各重复 ROUNDS 次，统计“事件 + 一个 tick”的平均耗时（还原状态不计时）
+ * - 目标对象取不到的连线（生成函数返回 false，运行时交给解释器报错）只列出、不运行，
+ *   避免解释器报错后停止 flow 影响后面的连线
+ *
+ * 定义 AOT_FIXTURE 时（aot_bench_fixture）改用 make_fixture 生成的 assets 和对应的生成文件，
+ * 覆盖不带动画的屏幕切换、标志、状态、组件展开和非常量属性。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lvgl.h"
+#include "ui.h"
+#include "screens.h"
+#include "images.h"
+#include "eez_flow_aot.h"
+#include "esp_heap_caps.h"
+#include "lvgl_cache.h"
+
+// eez-flow.cpp 中的屏幕栈
+extern int16_t g_screenStack[];
+extern unsigned g_screenStackPosition;
+
+#ifdef AOT_FIXTURE
+// make_fixture 生成的 aot_fixture_assets.c，ui.c 中的动作表
+extern "C" const uint8_t aot_fixture_assets[];
+extern "C" const size_t aot_fixture_assets_size;
+extern "C" ActionExecFunc actions[];
+#endif
+
+// ============== 配置 ==============
+
+#define BENCH_HOR_RES 360
+#define BENCH_VER_RES 360
+#define BENCH_BUF_LEN (BENCH_HOR_RES * BENCH_VER_RES / 20)
+
+#define ROUNDS 5000 // 每条连线、每种方式的重复次数
+#define NUM_OBJECTS (sizeof(objects_t) / sizeof(lv_obj_t *))
+#define MAX_STACK 16
+#define ANIM_FINISH_MS 2000 // 还原状态时让屏幕切换动画走完的时长（大于 assets 中的 speed + delay）
+
+// ============== 显示（只为创建屏幕，不统计渲染） ==============
+
+static lv_disp_draw_buf_t s_draw_buf;
+static lv_disp_drv_t s_disp_drv;
+
+static void bench_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
+    (void)area;
+    (void)color_p;
+    lv_disp_flush_ready(drv);
+}
+
+static void bench_display_init(void) {
+    size_t buf_size = BENCH_BUF_LEN * sizeof(lv_color_t);
+    void *buf = heap_caps_malloc(buf_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buf) {
+        fprintf(stderr, "显存分配失败\n");
+        exit(1);
+    }
+    lv_disp_draw_buf_init(&s_draw_buf, buf, NULL, BENCH_BUF_LEN);
+    lv_disp_drv_init(&s_disp_drv);
+    s_disp_drv.hor_res = BENCH_HOR_RES;
+    s_disp_drv.ver_res = BENCH_VER_RES;
+    s_disp_drv.flush_cb = bench_flush_cb;
+    s_disp_drv.draw_buf = &s_draw_buf;
+    lv_disp_drv_register(&s_disp_drv);
+}
+
+// ============== 状态快照 ==============
+
+typedef struct {
+    int16_t screen;
+    unsigned stack_len;
+    int16_t stack[MAX_STACK];
+    lv_obj_t *active;
+    lv_obj_t *to_load; // 动画中的目标屏幕
+    uint32_t flags[NUM_OBJECTS];
+    uint16_t states[NUM_OBJECTS];
+} snapshot_t;
+
+static lv_obj_t *object_at(size_t i) {
+    return ((lv_obj_t **)&objects)[i];
+}
+
+static void take_snapshot(snapshot_t *s) {
+    memset(s, 0, sizeof(*s));
+    s->screen = eez_flow_get_current_screen();
+    s->stack_len = g_screenStackPosition;
+    for (unsigned i = 0; i < g_screenStackPosition && i < MAX_STACK; i++) {
+        s->stack[i] = g_screenStack[i];
+    }
+    s->active = lv_scr_act();
+    s->to_load = lv_disp_get_default()->scr_to_load;
+    for (size_t i = 0; i < NUM_OBJECTS; i++) {
+        lv_obj_t *obj = object_at(i);
+        if (obj) {
+            s->flags[i] = obj->flags;
+            s->states[i] = obj->state;
+        }
+    }
+}
+
+static bool same_snapshot(const snapshot_t *a, const snapshot_t *b) {
+    return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+static snapshot_t s_baseline; // ui_init 之后的对象标志 / 状态
+
+/**
+ * 让进行中的屏幕切换动画立即结束
+ *
+ * LVGL 8.3 的 lv_scr_load_anim 在上一次切换动画未结束时会先清空 scr_to_load 再使用它，
+ * 基准里不跑 lv_timer_handler，所以每次还原前把动画时间推过去。
+ */
+static void finish_animations(void) {
+    lv_tick_inc(ANIM_FINISH_MS);
+    lv_anim_refr_now();
+}
+
+/** 还原到连线所在页面，清空屏幕栈，还原对象标志和状态 */
+static void reset_state(int flow_index) {
+    finish_animations();
+    eez_flow_set_screen((int16_t)(flow_index + 1), LV_SCR_LOAD_ANIM_NONE, 0, 0);
+    for (size_t i = 0; i < NUM_OBJECTS; i++) {
+        lv_obj_t *obj = object_at(i);
+        if (obj) {
+            obj->flags = s_baseline.flags[i];
+            obj->state = s_baseline.states[i];
+        }
+    }
+}
+
+// ============== 运行 ==============
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/** 处理一次控件事件并跑一个 flow tick（解释器在这个 tick 里执行排队的组件） */
+static void fire(const eez_flow_aot_entry_t *entry) {
+    void *flowState = getFlowState(0, (unsigned)entry->flow_index);
+    lv_event_t e;
+    memset(&e, 0, sizeof(e));
+    e.code = LV_EVENT_CLICKED;
+    e.target = lv_scr_act();
+    e.current_target = e.target;
+    flowPropagateValueLVGLEvent(flowState, entry->component_index, entry->output_index, &e);
+    eez_flow_tick();
+}
+
+typedef struct {
+    snapshot_t after;
+    double ns;
+} run_result_t;
+
+static void run(const eez_flow_aot_entry_t *entry, bool aot, run_result_t *r) {
+    eez_flow_aot_set_enabled(aot);
+
+    reset_state(entry->flow_index);
+    fire(entry);
+    take_snapshot(&r->after);
+
+    uint64_t total = 0;
+    for (int i = 0; i < ROUNDS; i++) {
+        reset_state(entry->flow_index);
+        uint64_t t0 = now_ns();
+        fire(entry);
+        total += now_ns() - t0;
+    }
+    r->ns = (double)total / ROUNDS;
+}
+
+int main(void) {
+    lv_init();
+    lvgl_cache_init(LVGL_CACHE_BUDGET_BYTES);
+    bench_display_init();
+    // 快照按对象指针和标志比较，所有屏幕在启动时创建且不驱逐
+    screens_set_resident_max(UI_SCREEN_COUNT);
+#ifdef AOT_FIXTURE
+    // 与 ui_init 相同，只是换成 fixture 的 assets
+    eez_flow_init(aot_fixture_assets, aot_fixture_assets_size, (lv_obj_t **)&objects, NUM_OBJECTS, images,
+                  sizeof(images), actions);
+    eez_flow_aot_init(aot_fixture_assets, aot_fixture_assets_size);
+#else
+    ui_init();
+#endif
+    lv_timer_handler();
+
+    eez_flow_aot_stats_t st;
+    eez_flow_aot_get_stats(&st);
+    if (!st.matched) {
+        fprintf(stderr, "eez_flow_aot_gen.c 与 ui.c 的 assets 不一致，请先运行 eez_aot_gen\n");
+        return 1;
+    }
+    if (eez_flow_aot_num_entries == 0) {
+        printf("没有预编译的连线\n");
+        return 0;
+    }
+    take_snapshot(&s_baseline);
+
+    printf("预编译连线 %u 条，每条每种方式 %d 次（事件 + 一个 eez_flow_tick）\n\n", (unsigned)eez_flow_aot_num_entries,
+           ROUNDS);
+    printf("%-16s %12s %12s %8s %6s\n", "connection", "interp ns", "aot ns", "speedup", "equal");
+
+    bool all_equal = true;
+    double sum_interp = 0, sum_aot = 0;
+    unsigned measured = 0;
+    for (size_t i = 0; i < eez_flow_aot_num_entries; i++) {
+        const eez_flow_aot_entry_t *entry = &eez_flow_aot_entries[i];
+        char name[32];
+        snprintf(name, sizeof(name), "f%d c%u o%u", entry->flow_index, entry->component_index, entry->output_index);
+
+        reset_state(entry->flow_index);
+        if (!entry->func()) {
+            printf("%-16s 目标对象不存在，运行时交给解释器\n", name);
+            continue;
+        }
+
+        run_result_t interp, aot;
+        run(entry, false, &interp);
+        run(entry, true, &aot);
+
+        bool equal = same_snapshot(&interp.after, &aot.after);
+        all_equal = all_equal && equal;
+        sum_interp += interp.ns;
+        sum_aot += aot.ns;
+        measured++;
+
+        printf("%-16s %12.1f %12.1f %7.2fx %6s\n", name, interp.ns, aot.ns, interp.ns / aot.ns, equal ? "yes" : "NO");
+    }
+
+    eez_flow_aot_get_stats(&st);
+    if (measured > 0) {
+        printf("\n平均 %.1f -> %.1f ns（%.2fx），", sum_interp / measured, sum_aot / measured, sum_interp / sum_aot);
+    } else {
+        printf("\n");
+    }
+    printf("预编译处理 %u 次 / 交给解释器 %u 次，结果 %s\n", st.hits, st.fallbacks, all_equal ? "一致" : "不一致");
+    return all_equal ? 0 : 1;
+}
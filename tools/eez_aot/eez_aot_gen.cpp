@@ -0,0 +1,553 @@
+/**
+ * @file eez_aot_gen.cpp
+ * @brief 把 EEZ flow 的“控件事件 → LVGL 动作”连线翻译成 C 函数
+ *
+ * 用法：eez_aot_gen <ui.c | assets.bin> <eez_flow_aot_gen.c>
+ *
+ * 读取 ui.c 中的 assets（或 tools/eez_assets 输出的 .bin），遍历每个 flow 中 LVGL 控件组件（类型 >= FIRST_LVGL_WIDGET_COMPONENT_TYPE）
+ * 的输出连线。连线只到 LVGL API 动作组件（COMPONENT_TYPE_LVGL_ACTION）、每个动作的属性都是整数常量、
+ * 且动作能照搬 eez-flow.cpp 中对应 ACTION_START 函数的行为时，生成一个直接调用 LVGL / eez_flow API
+ * 的函数，属性在生成时求值；否则这条连线留给解释器，原因写进生成文件开头的注释。
+ *
+ * 翻译规则与解释器一致：
+ * - 目标组件按连线顺序执行，序列输出（第一个 isSeqOut 输出）连出的组件排在后面（与队列顺序相同）
+ * - 目标组件只能有一个输入且就是连线的输入，此时收到值必然就绪
+ * - 需要目标对象的动作在函数开头取对象，有对象取不到时整条连线交给解释器（此时还没有任何副作用），
+ *   由解释器照常报错
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "eez-flow.h"
+
+using namespace eez;
+using namespace eez::flow;
+using namespace eez::flow::defs_v3;
+
+#define MAX_CHAIN 32 // 一条连线最多展开的组件数
+
+// ============== 解析 ui.c ==============
+
+static bool read_file(const char *path, std::string &out) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        out.append(buf, n);
+    }
+    fclose(f);
+    return true;
+}
+
+/** 解析 `assets[N] = { 0x.., ... };` 中的字节 */
+static bool parse_assets(const std::string &src, std::vector<uint8_t> &bytes) {
+    size_t pos = src.find(" assets[");
+    if (pos == std::string::npos) {
+        return false;
+    }
+    size_t begin = src.find('{', pos);
+    size_t end = src.find('}', begin);
+    if (begin == std::string::npos || end == std::string::npos) {
+        return false;
+    }
+    const char *p = src.c_str() + begin + 1;
+    const char *e = src.c_str() + end;
+    while (p < e) {
+        char *next;
+        unsigned long v = strtoul(p, &next, 0);
+        if (next == p) {
+            p++;
+            continue;
+        }
+        if (v > 0xFF) {
+            return false;
+        }
+        bytes.push_back((uint8_t)v);
+        p = next;
+    }
+    return !bytes.empty();
+}
+
+// 与 main/eez_ui/eez_flow_aot.cpp 的 eez_flow_aot_hash 相同
+static uint32_t fnv1a(const uint8_t *data, size_t size) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+static std::string format(const char *fmt, ...) {
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    return buf;
+}
+
+// ============== 翻译 ==============
+
+// 与 eez-flow.cpp 中 LVGL API 动作表 actions[] 的顺序相同
+static const char *ACTION_NAMES[] = {
+    "changeScreen",        "changeToPreviousScreen", "objSetX",
+    "objGetX",             "objSetY",                "objGetY",
+    "objSetWidth",         "objGetWidth",            "objSetHeight",
+    "objGetHeight",        "objSetStyleOpa",         "objGetStyleOpa",
+    "objAddStyle",         "objRemoveStyle",         "objSetFlagHidden",
+    "objAddFlag",          "objClearFlag",           "objHasFlag",
+    "objSetStateChecked",  "objSetStateDisabled",    "objAddState",
+    "objClearState",       "objHasState",            "arcSetValue",
+    "barSetValue",         "dropdownSetSelected",    "imageSetSrc",
+    "imageSetAngle",       "imageSetZoom",           "labelSetText",
+    "rollerSetSelected",   "sliderSetValue",         "keyboardSetTextarea",
+    "groupFocusObj",       "groupFocusNext",         "groupFocusPrev",
+    "groupGetFocused",     "groupFocusFreeze",       "groupSetWrap",
+    "groupSetEditing",     "animX",                  "animY",
+    "animWidth",           "animHeight",             "animOpacity",
+    "animImageZoom",       "animImageAngle",         "createScreen",
+    "deleteScreen",        "isScreenCreated",        "calendarSetTodayDate",
+    "calendarSetShowedDate", "calendarSetHighlightedDate", "calendarGetPressedDate",
+    "buttonMatrixSetButtonCtrl", "buttonMatrixClearButtonCtrl", "sliderSetValueLeft",
+    "sliderSetRange",      "qrCodeUpdate",
+};
+#define NUM_ACTIONS (sizeof(ACTION_NAMES) / sizeof(ACTION_NAMES[0]))
+
+enum {
+    ACTION_CHANGE_SCREEN = 0,
+    ACTION_CHANGE_TO_PREVIOUS_SCREEN = 1,
+    ACTION_OBJ_SET_X = 2,
+    ACTION_OBJ_SET_Y = 4,
+    ACTION_OBJ_SET_WIDTH = 6,
+    ACTION_OBJ_SET_HEIGHT = 8,
+    ACTION_OBJ_SET_STYLE_OPA = 10,
+    ACTION_OBJ_SET_FLAG_HIDDEN = 14,
+    ACTION_OBJ_ADD_FLAG = 15,
+    ACTION_OBJ_CLEAR_FLAG = 16,
+    ACTION_OBJ_SET_STATE_CHECKED = 18,
+    ACTION_OBJ_SET_STATE_DISABLED = 19,
+    ACTION_OBJ_ADD_STATE = 20,
+    ACTION_OBJ_CLEAR_STATE = 21,
+};
+
+typedef struct {
+    std::vector<std::string> body;    // 函数体（不含取对象）
+    std::map<int32_t, bool> targets;  // 需要的对象下标
+    std::string reason;               // 无法翻译的原因
+} plan_t;
+
+static FlowDefinition *s_flowDefinition;
+static Flow *s_flow;
+static uint32_t s_num_screens;
+static const char *s_source_name;
+
+static uint16_t read_instruction(const Property *property, int i) {
+    return property->evalInstructions[2 * i] | (property->evalInstructions[2 * i + 1] << 8);
+}
+
+/**
+ * 属性是否为单个整数 / 布尔常量（PUSH_CONSTANT n, END）
+ *
+ * 解释器的 INT32_PROP、BOOL_PROP 等宏直接读 Value 的 int32Value，这里取同一个字段；
+ * 字符串（按名字找对象 / 屏幕）、枚举和其他表达式都交给解释器。
+ */
+static bool const_prop(const LVGLApiComponent_ActionType *action, uint32_t p, int32_t &value) {
+    if (p >= action->properties.count) {
+        return false;
+    }
+    auto property = action->properties[p];
+    uint16_t first = read_instruction(property, 0);
+    uint16_t second = read_instruction(property, 1);
+    if ((first & EXPR_EVAL_INSTRUCTION_TYPE_MASK) != EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT ||
+        (second & EXPR_EVAL_INSTRUCTION_TYPE_MASK) != EXPR_EVAL_INSTRUCTION_TYPE_END) {
+        return false;
+    }
+    uint32_t index = first & EXPR_EVAL_INSTRUCTION_PARAM_MASK;
+    if (index >= s_flowDefinition->constants.count) {
+        return false;
+    }
+    auto constant = s_flowDefinition->constants[index];
+    if (!constant->isInt32OrLess()) {
+        return false;
+    }
+    value = constant->getInt32();
+    return true;
+}
+
+/** 动作的属性全部是常量时取出，否则记录原因 */
+static bool const_props(const LVGLApiComponent_ActionType *action, uint32_t count, int32_t *values,
+                        const std::string &where, plan_t &plan) {
+    if (action->properties.count < count) {
+        plan.reason = format("%s：%s 只有 %u 个属性", where.c_str(), ACTION_NAMES[action->action],
+                             action->properties.count);
+        return false;
+    }
+    for (uint32_t p = 0; p < count; p++) {
+        if (!const_prop(action, p, values[p])) {
+            plan.reason = format("%s：%s 的第 %u 个属性不是整数常量", where.c_str(), ACTION_NAMES[action->action], p);
+            return false;
+        }
+    }
+    return true;
+}
+
+/** 记录动作的目标对象（objects 中的下标），负数下标交给解释器报错 */
+static bool add_object(int32_t index, const std::string &where, const char *name, plan_t &plan) {
+    if (index < 0) {
+        plan.reason = format("%s：%s 的对象下标 %d 无效", where.c_str(), name, index);
+        return false;
+    }
+    plan.targets[index] = true;
+    return true;
+}
+
+/** 翻译一个 LVGL API 动作组件的动作列表，与 executeLVGLApiComponent 和各 ACTION_START 函数一致 */
+static bool compile_actions(unsigned componentIndex, plan_t &plan) {
+    auto component = (LVGLApiComponent *)s_flow->components[componentIndex];
+    plan.body.push_back(format("    // 组件 %u", componentIndex));
+    for (uint32_t a = 0; a < component->actions.count; a++) {
+        auto action = component->actions[a];
+        std::string where = format("组件 %u 动作 %u", componentIndex, a);
+        if (action->action >= NUM_ACTIONS) {
+            plan.reason = format("%s：未知动作编号 %u", where.c_str(), action->action);
+            return false;
+        }
+        const char *name = ACTION_NAMES[action->action];
+        int32_t v[5];
+
+        switch (action->action) {
+        case ACTION_CHANGE_SCREEN: {
+            // screen, fadeMode, speed, delay[, useStack]
+            uint32_t count = action->properties.count > 4 ? 5 : 4;
+            if (!const_props(action, count, v, where, plan)) {
+                return false;
+            }
+            // 屏幕越界时解释器会访问不存在的页面 flow，不照搬
+            if (v[0] < 1 || (uint32_t)v[0] > s_num_screens) {
+                plan.reason = format("%s：%s 的屏幕 %d 不在 1..%u 内", where.c_str(), name, v[0], s_num_screens);
+                return false;
+            }
+            if (count == 5 && !v[4]) {
+                // useStack 为 false 时解释器调用 eez-flow.cpp 内部的 replacePageHook
+                plan.reason = format("%s：%s 不使用屏幕栈", where.c_str(), name);
+                return false;
+            }
+            plan.body.push_back(format("    eez_flow_push_screen(%d, (lv_scr_load_anim_t)%d, %u, %u);", v[0], v[1],
+                                       (uint32_t)v[2], (uint32_t)v[3]));
+            break;
+        }
+        case ACTION_CHANGE_TO_PREVIOUS_SCREEN:
+            if (!const_props(action, 3, v, where, plan)) {
+                return false;
+            }
+            plan.body.push_back(format("    eez_flow_pop_screen((lv_scr_load_anim_t)%d, %u, %u);", v[0], (uint32_t)v[1],
+                                       (uint32_t)v[2]));
+            break;
+        case ACTION_OBJ_SET_X:
+        case ACTION_OBJ_SET_Y:
+        case ACTION_OBJ_SET_WIDTH:
+        case ACTION_OBJ_SET_HEIGHT: {
+            static const char *setters[] = {"x", "y", "width", "height"};
+            if (!const_props(action, 2, v, where, plan)) {
+                return false;
+            }
+            if (!add_object(v[0], where, name, plan)) {
+                return false;
+            }
+            plan.body.push_back(format("    lv_obj_set_%s(t%d, (lv_coord_t)%d);",
+                                       setters[(action->action - ACTION_OBJ_SET_X) / 2], v[0], v[1]));
+            break;
+        }
+        case ACTION_OBJ_SET_STYLE_OPA:
+            if (!const_props(action, 2, v, where, plan)) {
+                return false;
+            }
+            if (!add_object(v[0], where, name, plan)) {
+                return false;
+            }
+            plan.body.push_back(format("    lv_obj_set_style_opa(t%d, (lv_opa_t)%d, 0);", v[0], v[1]));
+            break;
+        case ACTION_OBJ_SET_FLAG_HIDDEN:
+            if (!const_props(action, 2, v, where, plan)) {
+                return false;
+            }
+            if (!add_object(v[0], where, name, plan)) {
+                return false;
+            }
+            plan.body.push_back(format("    lv_obj_%s_flag(t%d, LV_OBJ_FLAG_HIDDEN);", v[1] ? "add" : "clear", v[0]));
+            break;
+        case ACTION_OBJ_ADD_FLAG:
+        case ACTION_OBJ_CLEAR_FLAG:
+            if (!const_props(action, 2, v, where, plan)) {
+                return false;
+            }
+            if (!add_object(v[0], where, name, plan)) {
+                return false;
+            }
+            plan.body.push_back(format("    lv_obj_%s_flag(t%d, (lv_obj_flag_t)%u);",
+                                       action->action == ACTION_OBJ_ADD_FLAG ? "add" : "clear", v[0], (uint32_t)v[1]));
+            break;
+        case ACTION_OBJ_SET_STATE_CHECKED:
+        case ACTION_OBJ_SET_STATE_DISABLED:
+            if (!const_props(action, 2, v, where, plan)) {
+                return false;
+            }
+            if (!add_object(v[0], where, name, plan)) {
+                return false;
+            }
+            plan.body.push_back(format("    lv_obj_%s_state(t%d, %s);", v[1] ? "add" : "clear", v[0],
+                                       action->action == ACTION_OBJ_SET_STATE_CHECKED ? "LV_STATE_CHECKED"
+                                                                                      : "LV_STATE_DISABLED"));
+            break;
+        case ACTION_OBJ_ADD_STATE:
+        case ACTION_OBJ_CLEAR_STATE:
+            if (!const_props(action, 2, v, where, plan)) {
+                return false;
+            }
+            if (!add_object(v[0], where, name, plan)) {
+                return false;
+            }
+            plan.body.push_back(format("    lv_obj_%s_state(t%d, (lv_state_t)%u);",
+                                       action->action == ACTION_OBJ_ADD_STATE ? "add" : "clear", v[0], (uint32_t)v[1]));
+            break;
+        default:
+            // 取值（RESULT 写回变量）、样式、分组、动画等依赖 eez-flow.cpp 内部状态
+            plan.reason = format("%s：%s 未支持", where.c_str(), name);
+            return false;
+        }
+    }
+    return true;
+}
+
+/** 连线目标是否能直接执行，能则加入待执行列表 */
+static bool add_targets(unsigned componentIndex, const ComponentOutput *output, std::vector<unsigned> &order,
+                        plan_t &plan) {
+    for (uint32_t k = 0; k < output->connections.count; k++) {
+        auto connection = output->connections[k];
+        unsigned target = connection->targetComponentIndex;
+        auto component = s_flow->components[target];
+        if (component->type != COMPONENT_TYPE_LVGL_ACTION) {
+            plan.reason = format("组件 %u 连到类型 %u 的组件 %u", componentIndex, component->type, target);
+            return false;
+        }
+        if (component->inputs.count != 1 || component->inputs[0] != connection->targetInputIndex) {
+            plan.reason = format("组件 %u 的输入不止一个", target);
+            return false;
+        }
+        if (order.size() >= MAX_CHAIN) {
+            plan.reason = format("展开到组件 %u 时超过 %d 个组件（可能有环）", target, MAX_CHAIN);
+            return false;
+        }
+        order.push_back(target);
+    }
+    return true;
+}
+
+static bool compile_output(unsigned componentIndex, unsigned outputIndex, plan_t &plan) {
+    auto source = s_flow->components[componentIndex];
+    std::vector<unsigned> order;
+    if (!add_targets(componentIndex, source->outputs[outputIndex], order, plan)) {
+        return false;
+    }
+    // 按队列顺序（广度优先）展开
+    for (size_t i = 0; i < order.size(); i++) {
+        unsigned target = order[i];
+        if (!compile_actions(target, plan)) {
+            return false;
+        }
+        auto component = s_flow->components[target];
+        for (uint32_t o = 0; o < component->outputs.count; o++) {
+            if (component->outputs[o]->isSeqOut) {
+                if (!add_targets(target, component->outputs[o], order, plan)) {
+                    return false;
+                }
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+// ============== 输出 ==============
+
+typedef struct {
+    int flow;
+    unsigned component;
+    unsigned output;
+    std::string name;
+    plan_t plan;
+    bool ok;
+} entry_t;
+
+static void emit(FILE *f, const std::vector<entry_t> &entries, size_t assetsSize, uint32_t hash) {
+    size_t compiled = 0;
+    for (auto &e : entries) {
+        compiled += e.ok;
+    }
+
+    fprintf(f, "/**\n");
+    fprintf(f, " * @file eez_flow_aot_gen.c\n");
+    fprintf(f, " * @brief EEZ flow 预先编译结果，说明见 eez_flow_aot.h\n");
+    fprintf(f, " *\n");
+    fprintf(f, " * 由 tools/eez_aot 根据 %s 的 assets 生成，不要手工修改。界面资源更新后重新生成：\n", s_source_name);
+    fprintf(f, " *\n");
+    fprintf(f, " *   ./build_eez_aot/eez_aot_gen main/eez_ui/ui.c main/eez_ui/eez_flow_aot_gen.c\n");
+    fprintf(f, " *\n");
+    fprintf(f, " * 控件事件连线 %zu 条，预编译 %zu 条", entries.size(), compiled);
+    if (compiled < entries.size()) {
+        fprintf(f, "，以下交给解释器：\n");
+        for (auto &e : entries) {
+            if (!e.ok) {
+                fprintf(f, " * - flow %d 组件 %u 输出 %u：%s\n", e.flow, e.component, e.output, e.plan.reason.c_str());
+            }
+        }
+    } else {
+        fprintf(f, "\n");
+    }
+    fprintf(f, " */\n\n");
+
+    fprintf(f, "#include \"eez_flow_aot.h\"\n");
+    fprintf(f, "#include \"eez-flow.h\"\n\n");
+    fprintf(f, "const uint32_t eez_flow_aot_assets_size = %zu;\n", assetsSize);
+    fprintf(f, "const uint32_t eez_flow_aot_assets_hash = 0x%08xu;\n", hash);
+
+    for (auto &e : entries) {
+        if (!e.ok) {
+            continue;
+        }
+        fprintf(f, "\n// flow %d 组件 %u 输出 %u\n", e.flow, e.component, e.output);
+        fprintf(f, "static bool %s(void) {\n", e.name.c_str());
+        for (auto &t : e.plan.targets) {
+            fprintf(f, "    lv_obj_t *t%d = eez_flow_aot_object(%d);\n", t.first, t.first);
+        }
+        if (!e.plan.targets.empty()) {
+            fprintf(f, "    if (");
+            bool first = true;
+            for (auto &t : e.plan.targets) {
+                fprintf(f, "%s!t%d", first ? "" : " || ", t.first);
+                first = false;
+            }
+            fprintf(f, ") {\n        return false;\n    }\n");
+        }
+        for (auto &line : e.plan.body) {
+            fprintf(f, "%s\n", line.c_str());
+        }
+        fprintf(f, "    return true;\n}\n");
+    }
+
+    fprintf(f, "\nconst eez_flow_aot_entry_t eez_flow_aot_entries[] = {\n");
+    for (auto &e : entries) {
+        if (e.ok) {
+            fprintf(f, "    {%d, %u, %u, %s},\n", e.flow, e.component, e.output, e.name.c_str());
+        }
+    }
+    if (compiled == 0) {
+        fprintf(f, "    {-1, 0, 0, NULL},\n");
+    }
+    fprintf(f, "};\n");
+    fprintf(f, "const size_t eez_flow_aot_num_entries = %zu;\n\n", compiled);
+
+    fprintf(f, "bool eez_flow_aot_run(int flow_index, unsigned component_index, unsigned output_index) {\n");
+    if (compiled == 0) {
+        fprintf(f, "    (void)flow_index;\n    (void)component_index;\n    (void)output_index;\n    return false;\n}\n");
+        return;
+    }
+    fprintf(f, "    switch (EEZ_FLOW_AOT_KEY(flow_index, component_index, output_index)) {\n");
+    for (auto &e : entries) {
+        if (e.ok) {
+            fprintf(f, "    case EEZ_FLOW_AOT_KEY(%d, %u, %u):\n        return %s();\n", e.flow, e.component, e.output,
+                    e.name.c_str());
+        }
+    }
+    fprintf(f, "    default:\n        return false;\n    }\n}\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "用法: %s <ui.c | assets.bin> <eez_flow_aot_gen.c>\n", argv[0]);
+        return 2;
+    }
+
+    std::string src;
+    std::vector<uint8_t> bytes;
+    if (!read_file(argv[1], src)) {
+        fprintf(stderr, "无法读取 %s\n", argv[1]);
+        return 1;
+    }
+    size_t len = strlen(argv[1]);
+    if (len > 4 && strcmp(argv[1] + len - 4, ".bin") == 0) {
+        bytes.assign(src.begin(), src.end());
+    } else if (!parse_assets(src, bytes)) {
+        fprintf(stderr, "%s 中没有找到 assets[] 数组\n", argv[1]);
+        return 1;
+    }
+    uint32_t tag = 0;
+    if (bytes.size() >= sizeof(tag)) {
+        memcpy(&tag, bytes.data(), sizeof(tag));
+    }
+    if (tag != HEADER_TAG || bytes.size() < sizeof(uint32_t) + sizeof(Assets)) {
+        fprintf(stderr, "只支持非压缩格式的 assets（tag 0x%08x）\n", (unsigned)tag);
+        return 1;
+    }
+
+    const char *slash = strrchr(argv[1], '/');
+    s_source_name = slash ? slash + 1 : argv[1];
+
+    // 与 loadMainAssets 相同：tag 之后就是 Assets，偏移都是相对的，原地使用
+    auto assets = (Assets *)(bytes.data() + sizeof(uint32_t));
+    auto flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+    s_flowDefinition = flowDefinition;
+    // 每个屏幕对应一个页面 flow，screenId = flowIndex + 1
+    s_num_screens = flowDefinition->flows.count;
+
+    std::vector<entry_t> entries;
+    for (uint32_t fi = 0; fi < flowDefinition->flows.count; fi++) {
+        s_flow = flowDefinition->flows[fi];
+        for (uint32_t ci = 0; ci < s_flow->components.count; ci++) {
+            auto component = s_flow->components[ci];
+            if (component->type < FIRST_LVGL_WIDGET_COMPONENT_TYPE) {
+                continue;
+            }
+            for (uint32_t oi = 0; oi < component->outputs.count; oi++) {
+                if (component->outputs[oi]->connections.count == 0) {
+                    continue;
+                }
+                entry_t e;
+                e.flow = (int)fi;
+                e.component = ci;
+                e.output = oi;
+                e.name = format("flow%u_c%u_o%u", fi, ci, oi);
+                e.ok = compile_output(ci, oi, e.plan);
+                entries.push_back(e);
+            }
+        }
+    }
+
+    FILE *f = fopen(argv[2], "w");
+    if (!f) {
+        fprintf(stderr, "无法写入 %s\n", argv[2]);
+        return 1;
+    }
+    emit(f, entries, bytes.size(), fnv1a(bytes.data(), bytes.size()));
+    fclose(f);
+
+    size_t compiled = 0;
+    for (auto &e : entries) {
+        compiled += e.ok;
+        if (!e.ok) {
+            printf("解释器: flow %d 组件 %u 输出 %u：%s\n", e.flow, e.component, e.output, e.plan.reason.c_str());
+        }
+    }
+    printf("控件事件连线 %zu 条，预编译 %zu 条 -> %s\n", entries.size(), compiled, argv[2]);
+    return 0;
+}
@@ -0,0 +1,251 @@
+/**
+ * @file make_fixture.cpp
+ * @brief 为等价性校验生成一份覆盖各类可翻译动作的 assets
+ *
+ * 用法：make_fixture <ui.c> <aot_fixture.bin> <aot_fixture_assets.c>
+ *
+ * 当前 assets 里的动作只有带动画的屏幕切换和隐藏 objects 之外的对象，
+ * 这里复制一份 assets，把部分 LVGL API 动作组件的动作列表改指向追加在末尾的新动作：
+ *
+ * - flow 1 组件 5：changeScreen 到屏幕 3（4 个属性的旧格式），序列输出再连到组件 6（展开成两个组件）
+ * - flow 1 组件 6：objAddState btn_notes CHECKED、objAddFlag obj0 HIDDEN、objSetStateDisabled btn_notes_end
+ * - flow 2 组件 5：changeToPreviousScreen（屏幕栈为空时不动）、objClearFlag btn_notes_start CLICKABLE、
+ *   objSetFlagHidden btn_notes_end
+ * - flow 2 组件 6：objSetX 的坐标取自组件输入，不是常量，生成器应交给解释器
+ *
+ * 属性都是 PUSH_CONSTANT + END，值不在常量表里时追加到常量表末尾。
+ * 其余内容不变；偏移都是相对的，追加和改指向不影响原有结构。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "eez-flow.h"
+
+using namespace eez;
+using namespace eez::flow;
+
+#define EXTRA_BYTES 2048 // 追加区的容量（不重新分配，已有指针保持有效）
+
+// objects_t 中的下标（screens.h）
+#define OBJ_BTN_NOTES 4
+#define OBJ_OBJ0 5
+#define OBJ_BTN_NOTES_START 6
+#define OBJ_BTN_NOTES_END 7
+
+// eez-flow.cpp 中 LVGL API 动作表 actions[] 的下标
+#define ACTION_CHANGE_SCREEN 0
+#define ACTION_CHANGE_TO_PREVIOUS_SCREEN 1
+#define ACTION_OBJ_SET_X 2
+#define ACTION_OBJ_SET_FLAG_HIDDEN 14
+#define ACTION_OBJ_ADD_FLAG 15
+#define ACTION_OBJ_CLEAR_FLAG 16
+#define ACTION_OBJ_SET_STATE_DISABLED 19
+#define ACTION_OBJ_ADD_STATE 20
+
+// ============== 解析 ui.c ==============
+
+static bool read_file(const char *path, std::string &out) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        out.append(buf, n);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool parse_assets(const std::string &src, std::vector<uint8_t> &bytes) {
+    size_t pos = src.find(" assets[");
+    if (pos == std::string::npos) {
+        return false;
+    }
+    size_t begin = src.find('{', pos);
+    size_t end = src.find('}', begin);
+    if (begin == std::string::npos || end == std::string::npos) {
+        return false;
+    }
+    const char *p = src.c_str() + begin + 1;
+    const char *e = src.c_str() + end;
+    while (p < e) {
+        char *next;
+        unsigned long v = strtoul(p, &next, 0);
+        if (next == p) {
+            p++;
+            continue;
+        }
+        bytes.push_back((uint8_t)v);
+        p = next;
+    }
+    return !bytes.empty();
+}
+
+// ============== 追加与改指向 ==============
+
+static std::vector<uint8_t> s_buf;
+
+/** 在末尾追加一块清零的内存，至少 4 字节对齐（Value 按 8 字节） */
+template <typename T> static T *append(size_t count = 1) {
+    size_t align = alignof(T) > 4 ? alignof(T) : 4;
+    size_t offset = (s_buf.size() + align - 1) & ~(align - 1);
+    size_t size = sizeof(T) * count;
+    if (offset + size > s_buf.capacity()) {
+        fprintf(stderr, "追加区不足\n");
+        exit(1);
+    }
+    s_buf.resize(offset + size, 0);
+    return (T *)&s_buf[offset];
+}
+
+/** 与 ListOfAssetsPtr 布局相同，但可以改 count 和 items */
+template <typename T> struct RawList {
+    uint32_t count;
+    AssetsPtr<AssetsPtr<T>> items;
+};
+
+template <typename T> static void set_list(ListOfAssetsPtr<T> &list, const std::vector<T *> &items) {
+    auto raw = (RawList<T> *)&list;
+    auto slots = append<AssetsPtr<T>>(items.size());
+    for (size_t i = 0; i < items.size(); i++) {
+        slots[i] = items[i];
+    }
+    raw->count = (uint32_t)items.size();
+    raw->items = slots;
+}
+
+// ============== 动作 ==============
+
+static FlowDefinition *s_flowDefinition;
+static std::vector<Value *> s_constants; // 原有常量 + 追加的常量，最后写回常量表
+
+/** 常量表中值为 value 的下标，没有就追加一个 */
+static uint16_t constant(int32_t value, ValueType type = VALUE_TYPE_INT32) {
+    for (size_t i = 0; i < s_constants.size(); i++) {
+        if (s_constants[i]->getType() == type && s_constants[i]->getInt32() == value) {
+            return (uint16_t)i;
+        }
+    }
+    auto v = new (append<Value>()) Value(value, type);
+    s_constants.push_back(v);
+    return (uint16_t)(s_constants.size() - 1);
+}
+
+/** 单条指令 + END 的属性 */
+static Property *property(uint16_t instruction) {
+    auto p = append<uint16_t>(2);
+    p[0] = instruction;
+    p[1] = EXPR_EVAL_INSTRUCTION_TYPE_END;
+    return (Property *)p;
+}
+
+static Property *int_prop(int32_t value) {
+    return property(EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT | constant(value));
+}
+
+static Property *bool_prop(bool value) {
+    return property(EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT | constant(value, VALUE_TYPE_BOOLEAN));
+}
+
+static LVGLApiComponent_ActionType *action(uint32_t type, const std::vector<Property *> &props) {
+    auto a = append<LVGLApiComponent_ActionType>();
+    a->action = type;
+    set_list<Property>(a->properties, props);
+    return a;
+}
+
+static LVGLApiComponent *lvgl_component(unsigned flowIndex, unsigned componentIndex) {
+    auto component = s_flowDefinition->flows[flowIndex]->components[componentIndex];
+    if (component->type != defs_v3::COMPONENT_TYPE_LVGL_ACTION) {
+        fprintf(stderr, "flow %u 组件 %u 不是 LVGL 动作组件，assets 已变化，请更新 make_fixture\n", flowIndex,
+                componentIndex);
+        exit(1);
+    }
+    return (LVGLApiComponent *)component;
+}
+
+// ============== 输出 ==============
+
+static bool write_outputs(const char *binPath, const char *cPath) {
+    FILE *f = fopen(binPath, "wb");
+    if (!f || fwrite(s_buf.data(), 1, s_buf.size(), f) != s_buf.size()) {
+        return false;
+    }
+    fclose(f);
+
+    f = fopen(cPath, "w");
+    if (!f) {
+        return false;
+    }
+    fprintf(f, "// 由 tools/eez_aot/make_fixture 生成\n\n");
+    fprintf(f, "#include <stddef.h>\n#include <stdint.h>\n\n");
+    fprintf(f, "__attribute__((aligned(8))) const uint8_t aot_fixture_assets[%zu] = {", s_buf.size());
+    for (size_t i = 0; i < s_buf.size(); i++) {
+        fprintf(f, "%s0x%02x,", i % 16 == 0 ? "\n    " : " ", s_buf[i]);
+    }
+    fprintf(f, "\n};\nconst size_t aot_fixture_assets_size = %zu;\n", s_buf.size());
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        fprintf(stderr, "用法: %s <ui.c> <aot_fixture.bin> <aot_fixture_assets.c>\n", argv[0]);
+        return 2;
+    }
+
+    std::string src;
+    std::vector<uint8_t> bytes;
+    if (!read_file(argv[1], src) || !parse_assets(src, bytes)) {
+        fprintf(stderr, "无法从 %s 读取 assets[]\n", argv[1]);
+        return 1;
+    }
+    s_buf.reserve(bytes.size() + EXTRA_BYTES);
+    s_buf.assign(bytes.begin(), bytes.end());
+
+    auto assets = (Assets *)(s_buf.data() + sizeof(uint32_t));
+    s_flowDefinition = static_cast<FlowDefinition *>(assets->flowDefinition);
+    for (uint32_t i = 0; i < s_flowDefinition->constants.count; i++) {
+        s_constants.push_back(s_flowDefinition->constants[i]);
+    }
+
+    auto f1c5 = lvgl_component(1, 5);
+    auto f1c6 = lvgl_component(1, 6);
+    auto f2c5 = lvgl_component(2, 5);
+    auto f2c6 = lvgl_component(2, 6);
+
+    set_list<LVGLApiComponent_ActionType>(
+        f1c5->actions, {action(ACTION_CHANGE_SCREEN, {int_prop(3), int_prop(LV_SCR_LOAD_ANIM_NONE), int_prop(0), int_prop(0)})});
+    set_list<LVGLApiComponent_ActionType>(
+        f1c6->actions, {action(ACTION_OBJ_ADD_STATE, {int_prop(OBJ_BTN_NOTES), int_prop(LV_STATE_CHECKED)}),
+                        action(ACTION_OBJ_ADD_FLAG, {int_prop(OBJ_OBJ0), int_prop(LV_OBJ_FLAG_HIDDEN)}),
+                        action(ACTION_OBJ_SET_STATE_DISABLED, {int_prop(OBJ_BTN_NOTES_END), bool_prop(true)})});
+    set_list<LVGLApiComponent_ActionType>(
+        f2c5->actions, {action(ACTION_CHANGE_TO_PREVIOUS_SCREEN, {int_prop(LV_SCR_LOAD_ANIM_NONE), int_prop(0), int_prop(0)}),
+                        action(ACTION_OBJ_CLEAR_FLAG, {int_prop(OBJ_BTN_NOTES_START), int_prop(LV_OBJ_FLAG_CLICKABLE)}),
+                        action(ACTION_OBJ_SET_FLAG_HIDDEN, {int_prop(OBJ_BTN_NOTES_END), bool_prop(true)})});
+    set_list<LVGLApiComponent_ActionType>(
+        f2c6->actions,
+        {action(ACTION_OBJ_SET_X, {int_prop(OBJ_OBJ0), property(EXPR_EVAL_INSTRUCTION_TYPE_PUSH_INPUT | f2c6->inputs[0])})});
+    set_list<Value>(s_flowDefinition->constants, s_constants);
+
+    // 组件 5 的序列输出连到组件 6 唯一的输入
+    auto connection = append<Connection>();
+    connection->targetComponentIndex = 6;
+    connection->targetInputIndex = f1c6->inputs[0];
+    set_list<Connection>(f1c5->outputs[0]->connections, {connection});
+
+    if (!write_outputs(argv[2], argv[3])) {
+        fprintf(stderr, "写入输出失败\n");
+        return 1;
+    }
+    printf("fixture: %zu 字节（追加 %zu 字节）\n", s_buf.size(), s_buf.size() - bytes.size());
+    return 0;
+}
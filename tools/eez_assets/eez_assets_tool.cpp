@@ -0,0 +1,143 @@
+/**
+ * @file eez_assets_tool.cpp
+ * @brief 从 ui.c 提取 EEZ 资源，校验后写成 eez_assets 分区镜像
+ *
+ * 用法：eez_assets_tool <ui.c> [eez_assets.bin] [固件的 ui.c]
+ *
+ * 校验使用固件同一份 eez_assets_check()（main/eez_ui/eez_assets.cpp），
+ * 分区只接受原地使用的非压缩格式，校验不过时不写文件并返回 1。
+ * 镜像以 eez_assets_part_header_t 开头，build_id 取编译固件所用 ui.c 中 assets[] 的哈希
+ * （不给时即输入的 ui.c），固件只接受 build_id 与自身内置资源一致的分区。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "eez_assets.h"
+
+// 与 partitions.csv 中 eez_assets 分区的大小一致
+#define PARTITION_SIZE (64 * 1024)
+
+// ============== 解析 ui.c ==============
+
+static bool read_file(const char *path, std::string &out) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        out.append(buf, n);
+    }
+    fclose(f);
+    return true;
+}
+
+/** 解析 `assets[N] = { 0x.., ... };` 中的字节 */
+static bool parse_assets(const std::string &src, std::vector<uint8_t> &bytes) {
+    size_t pos = src.find(" assets[");
+    if (pos == std::string::npos) {
+        return false;
+    }
+    size_t begin = src.find('{', pos);
+    size_t end = src.find('}', begin);
+    if (begin == std::string::npos || end == std::string::npos) {
+        return false;
+    }
+    const char *p = src.c_str() + begin + 1;
+    const char *e = src.c_str() + end;
+    while (p < e) {
+        char *next;
+        unsigned long v = strtoul(p, &next, 0);
+        if (next == p) {
+            p++; // 逗号、空白、换行
+            continue;
+        }
+        if (v > 0xFF) {
+            return false;
+        }
+        bytes.push_back((uint8_t)v);
+        p = next;
+    }
+    return !bytes.empty();
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "用法: %s <ui.c> [eez_assets.bin] [固件的 ui.c]\n", argv[0]);
+        return 2;
+    }
+
+    std::string src;
+    if (!read_file(argv[1], src)) {
+        fprintf(stderr, "无法读取 %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> bytes;
+    if (!parse_assets(src, bytes)) {
+        fprintf(stderr, "%s 中没有找到 assets[] 数组\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<uint8_t> firmware_bytes;
+    const char *firmware_path = argc >= 4 ? argv[3] : argv[1];
+    if (argc >= 4) {
+        std::string firmware_src;
+        if (!read_file(firmware_path, firmware_src) || !parse_assets(firmware_src, firmware_bytes)) {
+            fprintf(stderr, "无法从 %s 读取 assets[] 数组\n", firmware_path);
+            return 1;
+        }
+    } else {
+        firmware_bytes = bytes;
+    }
+
+    // vector 的缓冲区按 malloc 对齐，与分区映射地址（页对齐）一样满足 4 字节对齐
+    eez_assets_info_t info;
+    bool ok = eez_assets_check(bytes.data(), bytes.size(), &info);
+
+    printf("资源: %u 字节，工程版本 %u，%s\n", (unsigned)info.size, (unsigned)info.major_version,
+           info.compressed ? "LZ4 压缩" : "非压缩");
+    if (!ok) {
+        fprintf(stderr, "校验失败（格式或版本不支持，或当前配置未打开 LZ4）\n");
+        return 1;
+    }
+    if (info.compressed || !info.in_place) {
+        fprintf(stderr, "分区只支持原地使用的非压缩资源\n");
+        return 1;
+    }
+    eez_assets_part_header_t header = {};
+    header.magic = EEZ_ASSETS_PART_MAGIC;
+    header.build_id = eez_assets_build_id(firmware_bytes.data(), firmware_bytes.size());
+    header.size = (uint32_t)bytes.size();
+    size_t image_size = sizeof(header) + bytes.size();
+    if (image_size > PARTITION_SIZE) {
+        fprintf(stderr, "镜像 %u 字节超过分区大小 %u 字节\n", (unsigned)image_size, (unsigned)PARTITION_SIZE);
+        return 1;
+    }
+
+    // 压缩格式需要的解压缓冲区覆盖 Assets 整体，即 tag 之后的全部数据
+    printf("原地使用占用 RAM %u 字节（压缩格式需解压缓冲区 %u 字节）\n", (unsigned)info.ram_bytes,
+           (unsigned)(bytes.size() - sizeof(uint32_t)));
+    printf("build_id 0x%08x（%s 的内置资源）\n", (unsigned)header.build_id, firmware_path);
+    printf("分区占用 %u / %u 字节\n", (unsigned)image_size, (unsigned)PARTITION_SIZE);
+
+    if (argc >= 3) {
+        FILE *f = fopen(argv[2], "wb");
+        if (!f || fwrite(&header, 1, sizeof(header), f) != sizeof(header) ||
+            fwrite(bytes.data(), 1, bytes.size(), f) != bytes.size()) {
+            fprintf(stderr, "写入 %s 失败\n", argv[2]);
+            if (f) {
+                fclose(f);
+            }
+            return 1;
+        }
+        fclose(f);
+        printf("已写入 %s\n", argv[2]);
+    }
+    return 0;
+}
@@ -0,0 +1,451 @@
+/**
+ * @file eez_heap_bench.c
+ * @brief EEZ flow 堆主机端回放基准
+ *
+ * 对比三种 eez::alloc / eez::free 实现：
+ * - first_fit: eez-flow.cpp 非 LVGL 分支的原实现（单链表首次适配，64 字节对齐，释放时 0xCC 填充）
+ * - eez_heap:  main/eez_ui/eez_heap.c（分级空闲链表，区块经 lvgl_mem 申请，与固件相同）
+ * - malloc:    系统 malloc，作为参考
+ *
+ * 负载：
+ * - trace:     逐条回放 ui_bench --eez-trace 录下的分配序列（重复多轮）
+ * - trace_mix: 按跟踪文件中的大小/id 随机抽样，维持一定数量的存活块做随机分配/释放
+ * - flow_mix:  内置的 flow 对象大小分布（字符串、数组、组件状态、FlowState、大缓冲区）
+ *
+ * 每种负载输出：平均 ns/op、请求字节峰值、实际占用、回放结束前的碎片率和失败次数。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lvgl.h"
+#include "eez_heap.h"
+
+// ============== 配置 ==============
+
+#define FIRST_FIT_HEAP_KB 256 // 原实现的固定堆大小（STM32 固件上由 initAllocHeap 传入）
+#define TRACE_ROUNDS 2000     // trace 负载重复轮数
+#define MIX_OPS 200000        // 随机负载操作数
+#define MIX_LIVE 400          // 随机负载的目标存活块数
+#define MIX_ROUNDS 5          // 随机负载重复轮数
+
+// ============== 操作序列 ==============
+
+typedef struct {
+    uint8_t op; // 'a' / 'f'
+    uint32_t slot;
+    uint32_t size;
+    uint32_t id;
+} bench_op_t;
+
+typedef struct {
+    const char *name;
+    bench_op_t *ops;
+    uint32_t count;
+    uint32_t teardown; // 从这里开始是释放剩余存活块的收尾操作
+    uint32_t slots;
+    uint32_t rounds;
+} workload_t;
+
+static void wl_push(workload_t *wl, uint32_t *cap, char op, uint32_t slot, uint32_t size, uint32_t id) {
+    if (wl->count == *cap) {
+        *cap = *cap ? *cap * 2 : 1024;
+        wl->ops = realloc(wl->ops, *cap * sizeof(bench_op_t));
+    }
+    wl->ops[wl->count++] = (bench_op_t){(uint8_t)op, slot, size, id};
+    if (slot + 1 > wl->slots) {
+        wl->slots = slot + 1;
+    }
+}
+
+/** 补上释放剩余存活块的操作，使序列可以重复回放 */
+static void wl_close(workload_t *wl, uint32_t *cap, const uint8_t *live) {
+    wl->teardown = wl->count;
+    for (uint32_t s = 0; s < wl->slots; s++) {
+        if (live[s]) {
+            wl_push(wl, cap, 'f', s, 0, 0);
+        }
+    }
+}
+
+// ============== 跟踪文件 ==============
+
+typedef struct {
+    uint32_t size;
+    uint32_t id;
+} size_sample_t;
+
+static bool load_trace(const char *path, workload_t *wl, size_sample_t **samples, uint32_t *nsamples) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return false;
+    }
+    uint32_t cap = 0, scap = 0;
+    uint8_t *live = NULL;
+    uint32_t live_cap = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), fp)) {
+        unsigned h, size, id;
+        if (sscanf(line, "a %u %u %x", &h, &size, &id) == 3) {
+            wl_push(wl, &cap, 'a', h, size, id);
+            if (*nsamples == scap) {
+                scap = scap ? scap * 2 : 256;
+                *samples = realloc(*samples, scap * sizeof(size_sample_t));
+            }
+            (*samples)[(*nsamples)++] = (size_sample_t){size, id};
+        } else if (sscanf(line, "f %u", &h) == 1) {
+            wl_push(wl, &cap, 'f', h, 0, 0);
+        } else {
+            continue;
+        }
+        if (wl->slots > live_cap) {
+            uint32_t n = wl->slots * 2;
+            live = realloc(live, n);
+            memset(live + live_cap, 0, n - live_cap);
+            live_cap = n;
+        }
+        live[h] = line[0] == 'a';
+    }
+    fclose(fp);
+    wl_close(wl, &cap, live);
+    free(live);
+    return true;
+}
+
+// ============== 随机负载 ==============
+
+static uint32_t s_rng = 0x12345678;
+
+static uint32_t rng(void) {
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return s_rng >> 8;
+}
+
+/** 内置的 flow 对象大小分布（64 位主机上的近似值） */
+static size_sample_t flow_sample(void) {
+    uint32_t r = rng() % 100;
+    if (r < 30) {
+        return (size_sample_t){24 + rng() % 16, 0x5354524e}; // 短字符串 Value
+    }
+    if (r < 50) {
+        return (size_sample_t){40 + rng() % 120, 0x5354524c}; // 长字符串
+    }
+    if (r < 65) {
+        return (size_sample_t){16 + 16 * (1 + rng() % 32), 0x41525259}; // ArrayValue
+    }
+    if (r < 88) {
+        return (size_sample_t){32 + 8 * (rng() % 9), 0x434f4d50}; // 组件执行状态
+    }
+    if (r < 98) {
+        return (size_sample_t){200 + rng() % 400, 0x464c4f57}; // FlowState
+    }
+    return (size_sample_t){1024 + rng() % 5120, 0x42554646}; // 大缓冲区（JSON / blob）
+}
+
+static void build_mix(workload_t *wl, const size_sample_t *samples, uint32_t nsamples) {
+    uint32_t cap = 0;
+    uint32_t max_slots = MIX_LIVE * 2;
+    uint8_t *live = calloc(max_slots, 1);
+    uint32_t *live_list = malloc(max_slots * sizeof(uint32_t));
+    uint32_t *free_slots = malloc(max_slots * sizeof(uint32_t));
+    uint32_t nlive = 0, nfree = 0;
+    for (uint32_t s = max_slots; s-- > 0;) {
+        free_slots[nfree++] = s;
+    }
+
+    for (uint32_t i = 0; i < MIX_OPS; i++) {
+        bool do_alloc;
+        if (nlive < MIX_LIVE / 2) {
+            do_alloc = true;
+        } else if (nlive >= MIX_LIVE * 3 / 2 || nfree == 0) {
+            do_alloc = false;
+        } else {
+            do_alloc = rng() & 1;
+        }
+        if (do_alloc) {
+            size_sample_t s = samples ? samples[rng() % nsamples] : flow_sample();
+            uint32_t slot = free_slots[--nfree];
+            live[slot] = 1;
+            live_list[nlive++] = slot;
+            wl_push(wl, &cap, 'a', slot, s.size, s.id);
+        } else {
+            uint32_t k = rng() % nlive;
+            uint32_t slot = live_list[k];
+            live_list[k] = live_list[--nlive];
+            live[slot] = 0;
+            free_slots[nfree++] = slot;
+            wl_push(wl, &cap, 'f', slot, 0, 0);
+        }
+    }
+    wl_close(wl, &cap, live);
+    free(live);
+    free(live_list);
+    free(free_slots);
+}
+
+// ============== first_fit：eez-flow.cpp 原实现 ==============
+
+static const size_t ALIGNMENT = 64;
+static const size_t MIN_BLOCK_SIZE = 8;
+
+typedef struct AllocBlock {
+    struct AllocBlock *next;
+    int free;
+    size_t size;
+    uint32_t id;
+} AllocBlock;
+
+static uint8_t *g_heap;
+static size_t g_heap_size;
+static size_t g_ff_top; // 触及过的最高地址（相对堆起点）
+
+static void ff_init(void) {
+    g_heap_size = FIRST_FIT_HEAP_KB * 1024;
+    free(g_heap);
+    g_heap = malloc(g_heap_size);
+    AllocBlock *first = (AllocBlock *)g_heap;
+    first->next = 0;
+    first->free = 1;
+    first->size = g_heap_size - sizeof(AllocBlock);
+    g_ff_top = 0;
+}
+
+static void *ff_alloc(size_t size, uint32_t id) {
+    if (size == 0) {
+        return NULL;
+    }
+    AllocBlock *block = (AllocBlock *)g_heap;
+    size = ((size + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+    while (block) {
+        if (block->free && block->size >= size) {
+            break;
+        }
+        block = block->next;
+    }
+    if (!block) {
+        return NULL;
+    }
+    int remainingSize = block->size - size - sizeof(AllocBlock);
+    if (remainingSize >= (int)MIN_BLOCK_SIZE) {
+        AllocBlock *newBlock = (AllocBlock *)((uint8_t *)block + sizeof(AllocBlock) + size);
+        newBlock->next = block->next;
+        newBlock->free = 1;
+        newBlock->size = remainingSize;
+        block->next = newBlock;
+        block->size = size;
+    }
+    block->free = 0;
+    block->id = id;
+    size_t top = (uint8_t *)(block + 1) + block->size - g_heap;
+    if (top > g_ff_top) {
+        g_ff_top = top;
+    }
+    return block + 1;
+}
+
+static void ff_free(void *ptr) {
+    if (ptr == 0) {
+        return;
+    }
+    AllocBlock *prevBlock = NULL;
+    AllocBlock *block = (AllocBlock *)g_heap;
+    while (block && (void *)(block + 1) < ptr) {
+        prevBlock = block;
+        block = block->next;
+    }
+    if (!block || (void *)(block + 1) != ptr || block->free) {
+        return;
+    }
+    memset(ptr, 0xCC, block->size);
+    AllocBlock *nextBlock = block->next;
+    if (nextBlock && nextBlock->free) {
+        if (prevBlock && prevBlock->free) {
+            prevBlock->next = nextBlock->next;
+            prevBlock->size += sizeof(AllocBlock) + block->size + sizeof(AllocBlock) + nextBlock->size;
+        } else {
+            block->next = nextBlock->next;
+            block->size += sizeof(AllocBlock) + nextBlock->size;
+            block->free = 1;
+        }
+    } else if (prevBlock && prevBlock->free) {
+        prevBlock->next = nextBlock;
+        prevBlock->size += sizeof(AllocBlock) + block->size;
+    } else {
+        block->free = 1;
+    }
+}
+
+/** 占用 = 触及过的最高地址；碎片 = 1 - 最大空闲块 / 空闲总量 */
+static void ff_report(size_t *footprint, double *frag) {
+    size_t total = 0, largest = 0;
+    for (AllocBlock *b = (AllocBlock *)g_heap; b; b = b->next) {
+        if (b->free) {
+            total += b->size;
+            if (b->size > largest) {
+                largest = b->size;
+            }
+        }
+    }
+    *footprint = g_ff_top;
+    *frag = total ? (1.0 - (double)largest / total) * 100.0 : 0.0;
+}
+
+// ============== eez_heap ==============
+
+static void eh_init(void) {
+}
+
+static void eh_report(size_t *footprint, double *frag) {
+    eez_heap_stats_t st;
+    eez_heap_get_stats(&st);
+    // 区块一旦申请不再归还，占用 = 区块 + 大块
+    *footprint = st.reserved_bytes + st.large_bytes;
+    *frag = st.reserved_bytes ? (1.0 - (double)st.block_bytes / st.reserved_bytes) * 100.0 : 0.0;
+}
+
+// ============== malloc ==============
+
+static void sys_init(void) {
+}
+
+static void *sys_alloc(size_t size, uint32_t id) {
+    (void)id;
+    return malloc(size);
+}
+
+static void sys_report(size_t *footprint, double *frag) {
+    *footprint = 0;
+    *frag = 0.0;
+}
+
+// ============== 回放 ==============
+
+typedef struct {
+    const char *name;
+    void (*init)(void);
+    void *(*alloc)(size_t size, uint32_t id);
+    void (*free)(void *p);
+    void (*report)(size_t *footprint, double *frag);
+} allocator_t;
+
+static const allocator_t s_allocators[] = {
+    {"first_fit", ff_init, ff_alloc, ff_free, ff_report},
+    {"eez_heap", eh_init, eez_heap_alloc, eez_heap_free, eh_report},
+    {"malloc", sys_init, sys_alloc, free, sys_report},
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void run(const workload_t *wl, const allocator_t *a) {
+    void **ptrs = calloc(wl->slots, sizeof(void *));
+    uint32_t *sizes = calloc(wl->slots, sizeof(uint32_t));
+    size_t live_bytes = 0, peak_bytes = 0, footprint = 0;
+    double frag = 0.0;
+    uint32_t failed = 0;
+
+    a->init();
+    uint64_t t0 = now_ns();
+    for (uint32_t r = 0; r < wl->rounds; r++) {
+        for (uint32_t i = 0; i < wl->count; i++) {
+            const bench_op_t *op = &wl->ops[i];
+            if (i == wl->teardown && r == wl->rounds - 1) {
+                a->report(&footprint, &frag);
+            }
+            if (op->op == 'a') {
+                void *p = a->alloc(op->size, op->id);
+                ptrs[op->slot] = p;
+                if (!p) {
+                    failed++;
+                    continue;
+                }
+                sizes[op->slot] = op->size;
+                live_bytes += op->size;
+                if (live_bytes > peak_bytes) {
+                    peak_bytes = live_bytes;
+                }
+            } else if (ptrs[op->slot]) {
+                a->free(ptrs[op->slot]);
+                ptrs[op->slot] = NULL;
+                live_bytes -= sizes[op->slot];
+            }
+        }
+    }
+    uint64_t ns = now_ns() - t0;
+    if (wl->teardown == wl->count) {
+        a->report(&footprint, &frag);
+    }
+
+    printf("%-10s %-10s %9.1f %10zu %10zu %7.1f%% %7u\n", wl->name, a->name,
+           (double)ns / ((uint64_t)wl->count * wl->rounds), peak_bytes, footprint, frag, failed);
+    free(ptrs);
+    free(sizes);
+}
+
+static void print_ids(void) {
+    eez_heap_id_stats_t ids[8];
+    size_t n = eez_heap_get_id_stats(ids, sizeof(ids) / sizeof(ids[0]));
+    printf("\n%-10s %8s %10s %10s\n", "id", "allocs", "live_B", "peak_B");
+    for (size_t i = 0; i < n; i++) {
+        printf("0x%08x %8u %10zu %10zu\n", ids[i].id, ids[i].allocs, ids[i].live_bytes, ids[i].peak_bytes);
+    }
+}
+
+int main(int argc, char **argv) {
+    workload_t wls[3];
+    int nwl = 0;
+    size_sample_t *samples = NULL;
+    uint32_t nsamples = 0;
+
+    lv_init();
+
+    if (argc > 1) {
+        workload_t *wl = &wls[nwl];
+        memset(wl, 0, sizeof(*wl));
+        wl->name = "trace";
+        wl->rounds = TRACE_ROUNDS;
+        if (!load_trace(argv[1], wl, &samples, &nsamples)) {
+            fprintf(stderr, "无法读取 %s，用法: %s [跟踪文件]\n", argv[1], argv[0]);
+            return 1;
+        }
+        nwl++;
+        if (nsamples > 0) {
+            wl = &wls[nwl++];
+            memset(wl, 0, sizeof(*wl));
+            wl->name = "trace_mix";
+            wl->rounds = MIX_ROUNDS;
+            build_mix(wl, samples, nsamples);
+        }
+    }
+    workload_t *wl = &wls[nwl++];
+    memset(wl, 0, sizeof(*wl));
+    wl->name = "flow_mix";
+    wl->rounds = MIX_ROUNDS;
+    build_mix(wl, NULL, 0);
+
+    printf("%-10s %-10s %9s %10s %10s %8s %7s\n", "workload", "alloc", "ns/op", "req_peak", "footprint", "frag",
+           "failed");
+    for (int w = 0; w < nwl; w++) {
+        printf("%-10s %u ops x %u\n", wls[w].name, wls[w].count, wls[w].rounds);
+        for (size_t i = 0; i < sizeof(s_allocators) / sizeof(s_allocators[0]); i++) {
+            run(&wls[w], &s_allocators[i]);
+        }
+    }
+
+    // eez_heap 累计的分级和按 id 统计（所有负载合计）
+    print_ids();
+    eez_heap_stats_t st;
+    eez_heap_get_stats(&st);
+    printf("\n%-6s %8s %8s %8s\n", "class", "allocs", "peak", "cached");
+    for (int i = 0; i < EEZ_HEAP_CLASS_NUM; i++) {
+        const eez_heap_class_stats_t *c = &st.cls[i];
+        printf("%-6u %8u %8u %8u\n", c->block_size, c->allocs, c->peak, c->cached);
+    }
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,346 @@
+/**
+ * @file expr_bench.cpp
+ * @brief EEZ flow 表达式求值主机端基准
+ *
+ * 链接仓库内的 LVGL 与 eez_ui，ui_init() 后测两组表达式：
+ * - assets：assets 中所有 flow 的组件属性表达式（目前几乎都是未设置的空表达式）
+ * - synthetic：用 assets 的常量和 flow 输入拼出的典型表达式（算术、比较、条件、数学函数），
+ *   模拟项目里以后写在属性上的绑定表达式
+ * - strings：同样的常量拼出的字符串表达式（数字转文本、拼接），测每次求值的 eez 堆分配
+ *
+ * 每组先校验：每个表达式分别用解释器和预编译结果（eez_expr）求值，结果必须一致；
+ * 再两种方式各重复求值 ROUNDS 轮，输出每个表达式的平均 ns。
+ * 求值错误不抛给 flow（enableThrowError(false)），两种方式出错的表达式也必须一致。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lvgl.h"
+#include "ui.h"
+#include "eez_expr.h"
+#include "eez_heap.h"
+#include "esp_heap_caps.h"
+#include "lvgl_cache.h"
+
+using namespace eez;
+using namespace eez::flow;
+using namespace eez::flow::defs_v3;
+
+// ============== 配置 ==============
+
+#define BENCH_HOR_RES 360
+#define BENCH_VER_RES 360
+#define BENCH_BUF_LEN (BENCH_HOR_RES * BENCH_VER_RES / 20)
+
+#define ROUNDS 20000 // 每个表达式的求值轮数
+#define MAX_EXPRS 1024
+#define SYN_INPUT_VALUE 7 // synthetic 组表达式读取的 flow 输入值
+
+// ============== 显示（只为创建屏幕，不统计渲染） ==============
+
+static lv_disp_draw_buf_t s_draw_buf;
+static lv_disp_drv_t s_disp_drv;
+
+static void bench_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
+    (void)area;
+    (void)color_p;
+    lv_disp_flush_ready(drv);
+}
+
+static void bench_display_init(void) {
+    size_t buf_size = BENCH_BUF_LEN * sizeof(lv_color_t);
+    void *buf = heap_caps_malloc(buf_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buf) {
+        fprintf(stderr, "显存分配失败\n");
+        exit(1);
+    }
+    lv_disp_draw_buf_init(&s_draw_buf, buf, NULL, BENCH_BUF_LEN);
+    lv_disp_drv_init(&s_disp_drv);
+    s_disp_drv.hor_res = BENCH_HOR_RES;
+    s_disp_drv.ver_res = BENCH_VER_RES;
+    s_disp_drv.flush_cb = bench_flush_cb;
+    s_disp_drv.draw_buf = &s_draw_buf;
+    lv_disp_drv_register(&s_disp_drv);
+}
+
+// ============== 表达式收集 ==============
+
+typedef struct {
+    FlowState *flowState;
+    int componentIndex;
+    const uint8_t *instructions;
+    bool ok;      // 解释器求值成功
+    Value result; // 解释器的结果
+} bench_expr_t;
+
+typedef struct {
+    const char *name;
+    bench_expr_t exprs[MAX_EXPRS];
+    int num;
+} bench_set_t;
+
+static bench_set_t s_assets = {"assets", {}, 0};
+static bench_set_t s_synthetic = {"synthetic", {}, 0};
+static bench_set_t s_strings = {"strings", {}, 0};
+
+static FlowState *find_flow_state(int flowIndex) {
+    for (FlowState *flowState = g_firstFlowState; flowState; flowState = flowState->nextSibling) {
+        if (flowState->flowIndex == flowIndex) {
+            return flowState;
+        }
+    }
+    return initPageFlowState(g_mainAssets, flowIndex, nullptr, 0);
+}
+
+static void add_expr(bench_set_t *set, FlowState *flowState, int componentIndex, const uint8_t *instructions) {
+    if (set->num >= MAX_EXPRS) {
+        return;
+    }
+    bench_expr_t *e = &set->exprs[set->num++];
+    e->flowState = flowState;
+    e->componentIndex = componentIndex;
+    e->instructions = instructions;
+}
+
+static void collect_assets(void) {
+    auto flowDefinition = static_cast<FlowDefinition *>(g_mainAssets->flowDefinition);
+    for (uint32_t f = 0; f < flowDefinition->flows.count; f++) {
+        FlowState *flowState = find_flow_state(f);
+        if (!flowState) {
+            continue;
+        }
+        auto flow = flowDefinition->flows[f];
+        for (uint32_t c = 0; c < flow->components.count; c++) {
+            auto component = flow->components[c];
+            for (uint32_t p = 0; p < component->properties.count; p++) {
+                if (component->properties[p]) {
+                    add_expr(&s_assets, flowState, (int)c, component->properties[p]->evalInstructions);
+                }
+            }
+        }
+    }
+}
+
+// ============== synthetic 表达式 ==============
+
+#define SYN_BUF_LEN 512
+
+static uint8_t s_syn_buf[SYN_BUF_LEN];
+static int s_syn_len;
+
+// 指令助记（与 eez-flow.h 的 EXPR_EVAL_INSTRUCTION_* 编码一致）
+#define C(i) (uint16_t)(EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT | (i))
+#define IN(i) (uint16_t)(EXPR_EVAL_INSTRUCTION_TYPE_PUSH_INPUT | (i))
+#define OP(o) (uint16_t)(EXPR_EVAL_INSTRUCTION_TYPE_OPERATION | (o))
+#define END EXPR_EVAL_INSTRUCTION_TYPE_END
+
+/** 把逆波兰指令写入缓冲区，返回指令流地址（缓冲区不足时返回 NULL） */
+static const uint8_t *emit(const uint16_t *code, int n) {
+    if (s_syn_len + n * 2 > SYN_BUF_LEN) {
+        return NULL;
+    }
+    uint8_t *p = &s_syn_buf[s_syn_len];
+    for (int i = 0; i < n; i++) {
+        p[2 * i] = code[i] & 0xFF;
+        p[2 * i + 1] = code[i] >> 8;
+    }
+    s_syn_len += n * 2;
+    return p;
+}
+
+#define EMIT_TO(SET, ...)                                                                                              \
+    do {                                                                                                               \
+        static const uint16_t code[] = {__VA_ARGS__};                                                                  \
+        const uint8_t *ins = emit(code, sizeof(code) / sizeof(code[0]));                                               \
+        if (ins) {                                                                                                     \
+            add_expr(SET, flowState, 0, ins);                                                                          \
+        }                                                                                                              \
+    } while (0)
+
+#define EMIT(...) EMIT_TO(&s_synthetic, __VA_ARGS__)
+#define EMIT_STR(...) EMIT_TO(&s_strings, __VA_ARGS__)
+
+/**
+ * 在第一个有输入的 flow 上拼表达式：in0 为输入 0，a/b/c 为前三个非零 int32 常量，s 为字符串常量
+ * @return 选中的 flowState，条件不满足时返回 NULL
+ */
+static FlowState *build_synthetic(void) {
+    auto flowDefinition = static_cast<FlowDefinition *>(g_mainAssets->flowDefinition);
+
+    int ints[3];
+    int numInts = 0;
+    int str = -1;
+    for (uint32_t k = 0; k < flowDefinition->constants.count && k <= EXPR_EVAL_INSTRUCTION_PARAM_MASK; k++) {
+        const Value *v = flowDefinition->constants[k];
+        if (v->isInt32() && v->int32Value != 0 && numInts < 3) {
+            ints[numInts++] = (int)k;
+        } else if (v->isString() && str < 0) {
+            str = (int)k;
+        }
+    }
+    if (numInts < 3 || str < 0) {
+        return NULL;
+    }
+
+    FlowState *flowState = NULL;
+    for (uint32_t f = 0; f < flowDefinition->flows.count && !flowState; f++) {
+        if (flowDefinition->flows[f]->componentInputs.count > 0 && flowDefinition->flows[f]->components.count > 0) {
+            flowState = find_flow_state(f);
+        }
+    }
+    if (!flowState) {
+        return NULL;
+    }
+
+    int a = ints[0], b = ints[1], c = ints[2];
+    // in0 + a
+    EMIT(IN(0), C(a), OP(OPERATION_TYPE_ADD), END);
+    // in0 * (a + b)，a + b 折叠
+    EMIT(IN(0), C(a), C(b), OP(OPERATION_TYPE_ADD), OP(OPERATION_TYPE_MUL), END);
+    // in0 > a ? s : c
+    EMIT(IN(0), C(a), OP(OPERATION_TYPE_GREATER), C(str), C(c), OP(OPERATION_TYPE_CONDITIONAL), END);
+    // (in0 - a) * b / c + abs(in0)
+    EMIT(IN(0), C(a), OP(OPERATION_TYPE_SUB), C(b), OP(OPERATION_TYPE_MUL), C(c), OP(OPERATION_TYPE_DIV), IN(0),
+         OP(OPERATION_TYPE_MATH_ABS), OP(OPERATION_TYPE_ADD), END);
+    // !(in0 == a) && in0 < b * c，b * c 折叠
+    EMIT(IN(0), C(a), OP(OPERATION_TYPE_EQUAL), OP(OPERATION_TYPE_NOT), IN(0), C(b), C(c), OP(OPERATION_TYPE_MUL),
+         OP(OPERATION_TYPE_LESS), OP(OPERATION_TYPE_LOGICAL_AND), END);
+    // a * c + b，整体折叠成一个常量
+    EMIT(C(a), C(c), OP(OPERATION_TYPE_MUL), C(b), OP(OPERATION_TYPE_ADD), END);
+
+    // strings 组（s 为字符串常量，assets 中目前是空串，拼接即数字转文本）
+    // in0 + s：短数字文本
+    EMIT_STR(IN(0), C(str), OP(OPERATION_TYPE_ADD), END);
+    // s + in0 * (a + b)
+    EMIT_STR(C(str), IN(0), C(a), C(b), OP(OPERATION_TYPE_ADD), OP(OPERATION_TYPE_MUL), OP(OPERATION_TYPE_ADD), END);
+    // in0 / c + s：小数文本
+    EMIT_STR(IN(0), C(c), OP(OPERATION_TYPE_DIV), C(str), OP(OPERATION_TYPE_ADD), END);
+    // (in0 / c + s) + (in0 + s)：较长的拼接结果
+    EMIT_STR(IN(0), C(c), OP(OPERATION_TYPE_DIV), C(str), OP(OPERATION_TYPE_ADD), IN(0), C(str),
+             OP(OPERATION_TYPE_ADD), OP(OPERATION_TYPE_ADD), END);
+
+    for (int i = 0; i < s_synthetic.num; i++) {
+        exprCompile(g_mainAssets, flowState->flowIndex, s_synthetic.exprs[i].instructions);
+    }
+    for (int i = 0; i < s_strings.num; i++) {
+        exprCompile(g_mainAssets, flowState->flowIndex, s_strings.exprs[i].instructions);
+    }
+    return flowState;
+}
+
+// ============== 求值 ==============
+
+static bool eval(const bench_expr_t *e, Value &result) {
+    return evalExpression(e->flowState, e->componentIndex, e->instructions, result, FlowError::Plain("expr_bench"));
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t eez_allocs(void) {
+    eez_heap_stats_t hs;
+    eez_heap_get_stats(&hs);
+    return hs.allocs;
+}
+
+/** 返回每个表达式的平均 ns，*allocs 为每次求值的 eez 堆分配次数 */
+static double bench(const bench_set_t *set, bool compiled, double *allocs) {
+    exprSetEnabled(compiled);
+    Value result;
+    uint32_t a0 = eez_allocs();
+    uint64_t t0 = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < set->num; i++) {
+            eval(&set->exprs[i], result);
+        }
+    }
+    uint64_t t1 = now_ns();
+    *allocs = (double)(eez_allocs() - a0) / ((uint64_t)ROUNDS * set->num);
+    return (double)(t1 - t0) / ((uint64_t)ROUNDS * set->num);
+}
+
+/** 两种方式逐个比较，返回不一致的个数 */
+static int verify(bench_set_t *set) {
+    int mismatches = 0;
+    for (int i = 0; i < set->num; i++) {
+        bench_expr_t *e = &set->exprs[i];
+        exprSetEnabled(false);
+        e->ok = eval(e, e->result);
+
+        exprSetEnabled(true);
+        Value result;
+        bool ok = eval(e, result);
+        // 字符串按内容比较：同一内容可能是 StringRef、内联或驻留串（eez_string.h）
+        bool sameType = result.getType() == e->result.getType() || (result.isString() && e->result.isString());
+        if (ok != e->ok || (ok && (!sameType || result != e->result))) {
+            fprintf(stderr, "不一致: %s 组 flow %d 组件 %d 表达式 %d（解释器 %s / 预编译 %s）\n", set->name,
+                    e->flowState->flowIndex, e->componentIndex, i, e->ok ? "成功" : "失败", ok ? "成功" : "失败");
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+/** 校验并测一组表达式，返回不一致的个数 */
+static int run_set(bench_set_t *set) {
+    int mismatches = verify(set);
+    int failed = 0;
+    int compiled = 0;
+    for (int i = 0; i < set->num; i++) {
+        failed += !set->exprs[i].ok;
+        compiled += exprFind(set->exprs[i].instructions) != nullptr;
+    }
+    double interp_allocs, compiled_allocs;
+    double interp_ns = bench(set, false, &interp_allocs);
+    double compiled_ns = bench(set, true, &compiled_allocs);
+    printf("%-10s %6d %8d %8d %10.1f %11.1f %7.2fx %7.2f %6s\n", set->name, set->num, compiled, failed, interp_ns,
+           compiled_ns, interp_ns / compiled_ns, compiled_allocs, mismatches ? "FAIL" : "ok");
+    return mismatches;
+}
+
+int main(void) {
+    lv_init();
+    lvgl_cache_init(LVGL_CACHE_BUDGET_BYTES);
+    bench_display_init();
+    ui_init();
+    lv_timer_handler();
+
+    enableThrowError(false);
+    collect_assets();
+    FlowState *synFlowState = build_synthetic();
+    if (s_assets.num == 0 && !synFlowState) {
+        fprintf(stderr, "assets 中没有表达式，也缺少拼 synthetic 表达式所需的常量 / flow 输入\n");
+        return 1;
+    }
+
+    Value savedInput;
+    if (synFlowState) {
+        savedInput = synFlowState->values[0];
+        synFlowState->values[0] = Value(SYN_INPUT_VALUE, VALUE_TYPE_INT32);
+    }
+
+    printf("%-10s %6s %8s %8s %10s %11s %8s %7s %6s\n", "set", "exprs", "compiled", "failed", "interp ns", "compiled ns",
+           "speedup", "allocs", "verify");
+    int mismatches = 0;
+    if (s_assets.num > 0) {
+        mismatches += run_set(&s_assets);
+    }
+    if (synFlowState) {
+        mismatches += run_set(&s_synthetic);
+        mismatches += run_set(&s_strings);
+        synFlowState->values[0] = savedInput;
+    }
+
+    ExprStats st;
+    exprGetStats(&st);
+    printf("\n预编译 %u 个（空或单操作数 %u，跳过 %u），指令 %u -> 操作 %u，常量折叠 %u 个运算，编译结果 %u 字节\n",
+           st.programs, st.trivial, st.skipped, st.instructions, st.ops, st.folded, st.bytes);
+    printf("校验 %s\n", mismatches ? "失败" : "通过");
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,222 @@
+/**
+ * @file font_bench.c
+ * @brief 分区字体（tiny_ttf + lvgl_cache）主机端字形耗时基准
+ *
+ * 字体文件用 mmap 映射（对应固件上的 esp_partition_mmap，零拷贝），
+ * 经 lvgl_font_init_data / lvgl_font_create 创建与固件相同的缓存字体，
+ * 对界面文本中的每个字形统计：
+ * - ttf_first:  首次渲染（查 cmap + 光栅化 + 写入缓存）
+ * - ttf_cached: 缓存命中后的渲染
+ * - ttf_raw:    不经 lvgl_cache，仅靠 tiny_ttf 自带的小缓存
+ * - builtin / builtin_cached: 内置位图字库（主机上由 simsun 16 CJK 顶替）作为参照
+ *
+ *   ./font_bench [字体文件] [字号]
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lvgl.h"
+#include "lvgl_cache.h"
+#include "lvgl_font.h"
+
+#define WARM_PASSES 200 // 缓存命中统计的重复遍数
+
+// 界面上出现的文字（页面标签、状态提示）加常用字，覆盖一次界面切换的字形
+static const char *const s_sample_text =
+    "WiFi已连接！正在切换到主界面...连接中聆听中发送中播放中开始结束会议AI助手录音笔记"
+    "设置网络电量时间日期保存删除取消确定返回上一页下一页请稍候正在加载失败成功重试"
+    "0123456789:%-/ ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+// 未指定字体文件时依次尝试的常见中文字体路径
+static const char *const s_default_fonts[] = {
+    "fonts/ui_font.ttf",
+    "/usr/share/fonts/truetype/wqy/wqy-microhei.ttc",
+    "/usr/share/fonts/opentype/noto/NotoSansCJK-Regular.ttc",
+    "/usr/share/fonts/noto-cjk/NotoSansCJK-Regular.ttc",
+    "/usr/share/fonts/truetype/droid/DroidSansFallbackFull.ttf",
+};
+
+extern const lv_font_t ui_font_chinese_18;
+
+// ============== 工具 ==============
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief 取出文本中不重复的码点
+ */
+static uint32_t collect_letters(const char *text, uint32_t *out, uint32_t max) {
+    uint32_t n = 0;
+    uint32_t i = 0;
+    while (text[i] && n < max) {
+        uint32_t letter = _lv_txt_encoded_next(text, &i);
+        bool dup = false;
+        for (uint32_t k = 0; k < n; k++) {
+            if (out[k] == letter) {
+                dup = true;
+                break;
+            }
+        }
+        if (!dup) {
+            out[n++] = letter;
+        }
+    }
+    return n;
+}
+
+static const void *map_file(const char *path, size_t *size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        return NULL;
+    }
+    *size = (size_t)st.st_size;
+    return p;
+}
+
+// ============== 测量 ==============
+
+typedef struct {
+    const char *name;
+    uint32_t glyphs;  // 测量的字形数
+    uint32_t found;   // 字体中存在的字形数
+    double avg_us;    // 单字形平均耗时
+    double max_us;    // 单字形最大耗时
+    uint32_t bmp_px;  // 已找到字形的位图像素合计
+} glyph_stats_t;
+
+/**
+ * @brief 渲染一个字形需要的两步：取描述 + 取位图
+ */
+static bool render_glyph(const lv_font_t *font, uint32_t letter, uint32_t *px) {
+    lv_font_glyph_dsc_t g;
+    if (!lv_font_get_glyph_dsc(font, &g, letter, 0)) {
+        return false;
+    }
+    if (g.box_w && g.box_h) {
+        const uint8_t *bmp = lv_font_get_glyph_bitmap(g.resolved_font, letter);
+        if (!bmp) {
+            return false;
+        }
+        *px += (uint32_t)g.box_w * g.box_h;
+    }
+    return true;
+}
+
+static void measure(glyph_stats_t *st, const char *name, const lv_font_t *font, const uint32_t *letters,
+                    uint32_t n, uint32_t passes) {
+    memset(st, 0, sizeof(*st));
+    st->name = name;
+
+    uint64_t total = 0;
+    uint64_t max = 0;
+    for (uint32_t p = 0; p < passes; p++) {
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t px = 0;
+            uint64_t t0 = now_ns();
+            bool ok = render_glyph(font, letters[i], &px);
+            uint64_t dt = now_ns() - t0;
+            total += dt;
+            if (dt > max) {
+                max = dt;
+            }
+            if (p == 0 && ok) {
+                st->found++;
+                st->bmp_px += px;
+            }
+        }
+    }
+    st->glyphs = n;
+    st->avg_us = (double)total / ((double)n * passes) / 1000.0;
+    st->max_us = (double)max / 1000.0;
+}
+
+static void print_row(const glyph_stats_t *st) {
+    printf("%-15s %7u %7u %9.2f %9.2f %9u\n", st->name, st->glyphs, st->found, st->avg_us, st->max_us, st->bmp_px);
+}
+
+int main(int argc, char **argv) {
+    const char *path = argc > 1 ? argv[1] : NULL;
+    lv_coord_t px = argc > 2 ? (lv_coord_t)atoi(argv[2]) : 18;
+
+    size_t size = 0;
+    const void *data = NULL;
+    if (path) {
+        data = map_file(path, &size);
+    } else {
+        for (size_t i = 0; i < sizeof(s_default_fonts) / sizeof(s_default_fonts[0]) && !data; i++) {
+            path = s_default_fonts[i];
+            data = map_file(path, &size);
+        }
+    }
+    if (!data) {
+        fprintf(stderr, "找不到字体文件，用法: %s <字体.ttf|.otf|.ttc> [字号]\n", argv[0]);
+        return 1;
+    }
+
+    lv_init();
+    lvgl_cache_init(LVGL_CACHE_BUDGET_BYTES);
+    if (!lvgl_font_init_data(data, size)) {
+        fprintf(stderr, "%s 不是 TTF/OTF 字体\n", path);
+        return 1;
+    }
+
+    static lv_font_t ttf_cached;
+    static lv_font_t builtin_cached;
+    if (!lvgl_font_create(&ttf_cached, px)) {
+        fprintf(stderr, "tiny_ttf 创建 %d px 字体失败\n", (int)px);
+        return 1;
+    }
+    lv_font_t *ttf_raw = lv_tiny_ttf_create_data_ex(data, size, px, LVGL_FONT_TTF_CACHE_BYTES);
+    lvgl_cache_font_init(&builtin_cached, &ui_font_chinese_18);
+
+    static uint32_t letters[512];
+    uint32_t n = collect_letters(s_sample_text, letters, sizeof(letters) / sizeof(letters[0]));
+
+    printf("字体: %s (%zu KB, mmap)  字号: %d px  行高: %d  字形: %u\n\n", path, size / 1024, (int)px,
+           (int)ttf_cached.line_height, n);
+
+    glyph_stats_t rows[5];
+    lvgl_cache_stats_t cs;
+
+    measure(&rows[0], "ttf_first", &ttf_cached, letters, n, 1);
+    lvgl_cache_get_stats(&cs);
+    size_t ttf_bytes = cs.used_bytes;
+    measure(&rows[1], "ttf_cached", &ttf_cached, letters, n, WARM_PASSES);
+    measure(&rows[2], "ttf_raw", ttf_raw, letters, n, WARM_PASSES);
+    measure(&rows[3], "builtin", &ui_font_chinese_18, letters, n, WARM_PASSES);
+    measure(&rows[4], "builtin_cached", &builtin_cached, letters, n, 1); // 先装入缓存
+    measure(&rows[4], "builtin_cached", &builtin_cached, letters, n, WARM_PASSES);
+
+    printf("%-15s %7s %7s %9s %9s %9s\n", "case", "glyphs", "found", "avg_us", "max_us", "bmp_px");
+    for (size_t i = 0; i < sizeof(rows) / sizeof(rows[0]); i++) {
+        print_row(&rows[i]);
+    }
+
+    lvgl_cache_get_stats(&cs);
+    printf("\nttf 字形缓存占用: %zu 字节（%u 个字形，平均 %.0f 字节/字形），缓存总占用 %zu / %zu 字节\n", ttf_bytes,
+           rows[0].glyphs, rows[0].glyphs ? (double)ttf_bytes / rows[0].glyphs : 0.0, cs.used_bytes,
+           cs.budget_bytes);
+    printf("首次/命中耗时比: %.1fx\n", rows[1].avg_us > 0 ? rows[0].avg_us / rows[1].avg_us : 0.0);
+    return 0;
+}
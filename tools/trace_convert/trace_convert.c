@@ -0,0 +1,349 @@
+/**
+ * @file trace_convert.c
+ * @brief 把固件 `trace dump` 的输出转换为 Chrome / Perfetto trace JSON
+ *
+ * 用法：trace_convert <串口日志> [输出.json]
+ *
+ * 输入可以是包含其他日志的完整串口记录，只取最后一次 dump（`# trace v..` 到 `# end`）。
+ * 记录格式见 main/services/trace/trace_format.h：按核用 SYNC 记录把周期计数换算为微秒，
+ * 合并后按时间排序；每个任务一条线程轨道，线程名取自 dump 中的任务表。
+ * 不给输出文件时只打印统计。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace_format.h"
+
+#define MAX_EVENTS 256 // 事件编号上限（trace_events.h）
+#define MAX_TASKS 256  // 任务编号取低 8 位
+#define NAME_LEN 32
+
+typedef struct {
+    double ts;      // 微秒（esp_timer 时间）
+    uint32_t seq;   // 输入顺序，时间相同时保持先后
+    int core;
+    trace_record_t rec;
+} event_t;
+
+typedef struct {
+    int count;
+    double total_us;
+    double max_us;
+} span_stat_t;
+
+// ============== 解析 ==============
+
+static char s_event_names[MAX_EVENTS][NAME_LEN];
+static char s_task_names[MAX_TASKS][NAME_LEN];
+static int s_cpu_mhz = 0;
+
+static event_t *s_events = NULL;
+static size_t s_count = 0;
+static size_t s_cap = 0;
+
+// 每核当前的时间基准
+typedef struct {
+    int synced;
+    uint32_t sync_cycles;
+    double sync_us;
+} core_clock_t;
+
+#define MAX_CORES 8
+static core_clock_t s_clocks[MAX_CORES];
+static size_t s_dropped = 0; // 首个 SYNC 之前的记录（已被环形缓冲区覆盖掉同步点）
+
+static void reset(void) {
+    memset(s_event_names, 0, sizeof(s_event_names));
+    memset(s_task_names, 0, sizeof(s_task_names));
+    memset(s_clocks, 0, sizeof(s_clocks));
+    s_count = 0;
+    s_dropped = 0;
+}
+
+static uint32_t le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int hex_nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/** 解析 32 个十六进制字符（内存顺序，小端）为一条记录 */
+static int parse_record(const char *hex, trace_record_t *rec) {
+    uint8_t b[sizeof(trace_record_t)];
+    for (size_t i = 0; i < sizeof(b); i++) {
+        int hi = hex_nibble(hex[2 * i]);
+        int lo = hi < 0 ? -1 : hex_nibble(hex[2 * i + 1]);
+        if (lo < 0) {
+            return 0;
+        }
+        b[i] = (uint8_t)(hi << 4 | lo);
+    }
+    rec->cycles = le32(b);
+    rec->event = (uint16_t)(b[4] | b[5] << 8);
+    rec->kind = b[6];
+    rec->task = b[7];
+    rec->arg0 = le32(b + 8);
+    rec->arg1 = le32(b + 12);
+    return 1;
+}
+
+static void add_record(int core, const trace_record_t *rec) {
+    core_clock_t *clk = &s_clocks[core];
+    if (rec->kind == TRACE_KIND_SYNC) {
+        clk->synced = 1;
+        clk->sync_cycles = rec->cycles;
+        clk->sync_us = (double)((uint64_t)rec->arg1 << 32 | rec->arg0);
+        return;
+    }
+    if (!clk->synced) {
+        s_dropped++;
+        return;
+    }
+    if (s_count == s_cap) {
+        s_cap = s_cap ? s_cap * 2 : 4096;
+        s_events = realloc(s_events, s_cap * sizeof(event_t));
+        if (s_events == NULL) {
+            fprintf(stderr, "内存不足\n");
+            exit(1);
+        }
+    }
+    event_t *e = &s_events[s_count];
+    // 两次同步之间不超过 1 秒，32 位差值不会回绕
+    e->ts = clk->sync_us + (double)(uint32_t)(rec->cycles - clk->sync_cycles) / s_cpu_mhz;
+    e->seq = (uint32_t)s_count;
+    e->core = core;
+    e->rec = *rec;
+    s_count++;
+}
+
+static void copy_name(char *dst, const char *src) {
+    size_t n = strcspn(src, "\r\n");
+    if (n >= NAME_LEN) {
+        n = NAME_LEN - 1;
+    }
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+}
+
+/** 返回 1 表示找到完整的 dump */
+static int parse_log(FILE *f) {
+    char line[1024];
+    int in_dump = 0;
+    int complete = 0;
+    while (fgets(line, sizeof(line), f)) {
+        const char *hdr = strstr(line, "# trace v");
+        if (hdr) {
+            int version = 0, cores = 0;
+            if (sscanf(hdr, "# trace v%d cpu_mhz=%d cores=%d", &version, &s_cpu_mhz, &cores) != 3 ||
+                version != TRACE_FORMAT_VERSION || s_cpu_mhz <= 0 || cores > MAX_CORES) {
+                fprintf(stderr, "不支持的 dump 头: %s", hdr);
+                in_dump = 0;
+                continue;
+            }
+            reset(); // 日志中有多次 dump 时以最后一次为准
+            in_dump = 1;
+            complete = 0;
+            continue;
+        }
+        if (!in_dump) {
+            continue;
+        }
+        if (strncmp(line, "# end", 5) == 0) {
+            in_dump = 0;
+            complete = 1;
+            continue;
+        }
+        int id, n;
+        if (line[0] == 'E' && sscanf(line, "E %d %n", &id, &n) == 1 && id >= 0 && id < MAX_EVENTS) {
+            copy_name(s_event_names[id], line + n);
+        } else if (line[0] == 'T' && sscanf(line, "T %d %n", &id, &n) == 1 && id >= 0 && id < MAX_TASKS) {
+            copy_name(s_task_names[id], line + n);
+        } else if (line[0] == 'R' && sscanf(line, "R %d%n", &id, &n) == 1 && id >= 0 && id < MAX_CORES) {
+            const char *p = line + n;
+            while (*p == ' ') {
+                trace_record_t rec;
+                if (!parse_record(p + 1, &rec)) {
+                    break;
+                }
+                add_record(id, &rec);
+                p += 1 + 2 * sizeof(trace_record_t);
+            }
+        }
+    }
+    return complete;
+}
+
+// ============== 输出 ==============
+
+static int cmp_event(const void *a, const void *b) {
+    const event_t *x = a, *y = b;
+    if (x->ts != y->ts) {
+        return x->ts < y->ts ? -1 : 1;
+    }
+    return x->seq < y->seq ? -1 : 1;
+}
+
+static const char *event_name(uint16_t id, char *buf) {
+    if (id < MAX_EVENTS && s_event_names[id][0]) {
+        return s_event_names[id];
+    }
+    snprintf(buf, NAME_LEN, "event_%u", id);
+    return buf;
+}
+
+static void write_json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') {
+            fputc('\\', out);
+            fputc(*s, out);
+        } else if ((unsigned char)*s < 0x20) {
+            fprintf(out, "\\u%04x", *s);
+        } else {
+            fputc(*s, out);
+        }
+    }
+    fputc('"', out);
+}
+
+/**
+ * 写 JSON 并统计区间耗时。
+ * 环形缓冲区覆盖掉 BEGIN 后留下的孤立 END 不输出（Perfetto 会把它配到错误的区间上）。
+ */
+static void convert(FILE *out, span_stat_t *stats) {
+    static uint16_t depth[MAX_TASKS][MAX_EVENTS];
+    static double begin_ts[MAX_TASKS][MAX_EVENTS];
+    int first = 1;
+    char buf[NAME_LEN];
+
+    if (out) {
+        fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        for (int t = 0; t < MAX_TASKS; t++) {
+            if (s_task_names[t][0]) {
+                fprintf(out, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                        first ? "" : ",\n", t);
+                write_json_string(out, s_task_names[t]);
+                fprintf(out, "}}");
+                first = 0;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < s_count; i++) {
+        const event_t *e = &s_events[i];
+        const trace_record_t *r = &e->rec;
+        int ev = r->event < MAX_EVENTS ? r->event : MAX_EVENTS - 1;
+        const char *ph;
+        switch (r->kind) {
+        case TRACE_KIND_BEGIN:
+            ph = "B";
+            depth[r->task][ev]++;
+            begin_ts[r->task][ev] = e->ts; // 同一事件嵌套时只统计最内层
+            break;
+        case TRACE_KIND_END:
+            if (depth[r->task][ev] == 0) {
+                continue;
+            }
+            depth[r->task][ev]--;
+            ph = "E";
+            {
+                double d = e->ts - begin_ts[r->task][ev];
+                stats[ev].count++;
+                stats[ev].total_us += d;
+                if (d > stats[ev].max_us) {
+                    stats[ev].max_us = d;
+                }
+            }
+            break;
+        case TRACE_KIND_INSTANT:
+            ph = "i";
+            stats[ev].count++;
+            break;
+        case TRACE_KIND_COUNTER:
+            ph = "C";
+            stats[ev].count++;
+            break;
+        default:
+            continue;
+        }
+        if (!out) {
+            continue;
+        }
+        fprintf(out, "%s{\"name\":", first ? "" : ",\n");
+        write_json_string(out, event_name(r->event, buf));
+        fprintf(out, ",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u", ph, e->ts, r->task);
+        if (r->kind == TRACE_KIND_COUNTER) {
+            fprintf(out, ",\"args\":{\"value\":%u}", r->arg0);
+        } else {
+            if (r->kind == TRACE_KIND_INSTANT) {
+                fprintf(out, ",\"s\":\"t\"");
+            }
+            fprintf(out, ",\"args\":{\"a0\":%u,\"a1\":%d,\"core\":%d}", r->arg0, (int32_t)r->arg1, e->core);
+        }
+        fprintf(out, "}");
+        first = 0;
+    }
+    if (out) {
+        fprintf(out, "\n]}\n");
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "用法: %s <串口日志> [输出.json]\n", argv[0]);
+        return 2;
+    }
+    FILE *in = fopen(argv[1], "r");
+    if (!in) {
+        perror(argv[1]);
+        return 1;
+    }
+    int complete = parse_log(in);
+    fclose(in);
+    if (s_cpu_mhz == 0) {
+        fprintf(stderr, "日志中没有找到 trace dump\n");
+        return 1;
+    }
+    if (!complete) {
+        fprintf(stderr, "警告: dump 不完整（缺少 # end），只转换已读到的记录\n");
+    }
+    qsort(s_events, s_count, sizeof(event_t), cmp_event);
+
+    FILE *out = NULL;
+    if (argc > 2) {
+        out = fopen(argv[2], "w");
+        if (!out) {
+            perror(argv[2]);
+            return 1;
+        }
+    }
+    static span_stat_t stats[MAX_EVENTS];
+    convert(out, stats);
+    if (out) {
+        fclose(out);
+    }
+
+    double span_ms = s_count ? (s_events[s_count - 1].ts - s_events[0].ts) / 1000.0 : 0;
+    printf("记录 %zu 条（丢弃同步前 %zu 条），时间跨度 %.1f ms，CPU %d MHz\n", s_count, s_dropped, span_ms,
+           s_cpu_mhz);
+    printf("%-18s %8s %10s %10s\n", "事件", "次数", "平均 us", "最大 us");
+    char buf[NAME_LEN];
+    for (int i = 0; i < MAX_EVENTS; i++) {
+        if (stats[i].count == 0) {
+            continue;
+        }
+        if (stats[i].total_us > 0 || stats[i].max_us > 0) {
+            printf("%-18s %8d %10.1f %10.1f\n", event_name((uint16_t)i, buf), stats[i].count,
+                   stats[i].total_us / stats[i].count, stats[i].max_us);
+        } else {
+            printf("%-18s %8d %10s %10s\n", event_name((uint16_t)i, buf), stats[i].count, "-", "-");
+        }
+    }
+    return 0;
+}
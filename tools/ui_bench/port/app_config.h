@@ -0,0 +1,9 @@
+/**
+ * @file app_config.h
+ * @brief 主机端配置替身，仅提供 UI 代码引用到的常量
+ */
+
+#pragma once
+
+#define CLOSE_CONNECTION_NO_VOICE_TIME 30
+#define RECORD_DURATION_SEC 60
@@ -0,0 +1,45 @@
+/**
+ * @file esp_heap_caps.h
+ * @brief 主机端 heap_caps 替身
+ *
+ * 每块内存前放一个长度头，统计当前占用和峰值。
+ * LVGL 的分配经 lvgl_mem 两级堆，只有池本身和大块会落到这里。
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MALLOC_CAP_EXEC (1 << 0)
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+void *heap_caps_malloc(size_t size, uint32_t caps);
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps);
+void heap_caps_free(void *ptr);
+size_t heap_caps_get_allocated_size(void *ptr);
+
+/** 堆统计（主机端专用） */
+typedef struct {
+    size_t used;        // 当前占用字节
+    size_t peak;        // 峰值占用字节
+    uint32_t alloc_cnt; // 分配次数
+    uint32_t free_cnt;  // 释放次数
+} host_heap_stats_t;
+
+void host_heap_get_stats(host_heap_stats_t *stats);
+void host_heap_reset_peak(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,25 @@
+/**
+ * @file esp_log.h
+ * @brief 主机端 ESP_LOG 替身，默认只输出 W/E 级别，避免日志干扰测量
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+#ifndef HOST_LOG_LEVEL
+#define HOST_LOG_LEVEL 2 // 0=无 1=E 2=W 3=I 4=D
+#endif
+
+#define HOST_LOG(lvl, letter, tag, format, ...)                               \
+    do {                                                                      \
+        if (HOST_LOG_LEVEL >= (lvl)) {                                        \
+            printf(letter " (%s) " format "\n", tag, ##__VA_ARGS__);          \
+        }                                                                     \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) HOST_LOG(1, "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) HOST_LOG(2, "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) HOST_LOG(3, "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) HOST_LOG(4, "D", tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) HOST_LOG(5, "V", tag, format, ##__VA_ARGS__)
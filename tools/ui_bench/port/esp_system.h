@@ -0,0 +1,6 @@
+/**
+ * @file esp_system.h
+ * @brief 主机端空替身，仅为满足服务层头文件的包含关系
+ */
+
+#pragma once
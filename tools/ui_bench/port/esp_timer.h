@@ -0,0 +1,18 @@
+/**
+ * @file esp_timer.h
+ * @brief 主机端 esp_timer 替身，时间由基准程序的模拟时钟驱动
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,12 @@
+/**
+ * @file task.h
+ * @brief 主机端 FreeRTOS task 替身
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+
+#define vTaskDelay(ticks) ((void)(ticks))
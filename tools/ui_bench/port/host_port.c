@@ -0,0 +1,120 @@
+/**
+ * @file host_port.c
+ * @brief 主机端平台替身实现：带统计的 heap_caps、模拟时钟、空软件定时器
+ */
+
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/timers.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ============== heap_caps ==============
+
+// 每块前放 16 字节头（保持 16 字节对齐），记录用户请求的长度
+#define HEAP_HDR_SIZE 16
+
+static host_heap_stats_t s_heap;
+
+void *heap_caps_malloc(size_t size, uint32_t caps) {
+    (void)caps;
+    uint8_t *raw = malloc(size + HEAP_HDR_SIZE);
+    if (!raw) {
+        return NULL;
+    }
+    *(size_t *)raw = size;
+    s_heap.used += size;
+    s_heap.alloc_cnt++;
+    if (s_heap.used > s_heap.peak) {
+        s_heap.peak = s_heap.used;
+    }
+    return raw + HEAP_HDR_SIZE;
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+    void *p = heap_caps_malloc(n * size, caps);
+    if (p) {
+        memset(p, 0, n * size);
+    }
+    return p;
+}
+
+void heap_caps_free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    uint8_t *raw = (uint8_t *)ptr - HEAP_HDR_SIZE;
+    s_heap.used -= *(size_t *)raw;
+    s_heap.free_cnt++;
+    free(raw);
+}
+
+void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps) {
+    if (!ptr) {
+        return heap_caps_malloc(size, caps);
+    }
+    if (size == 0) {
+        heap_caps_free(ptr);
+        return NULL;
+    }
+    size_t old_size = *(size_t *)((uint8_t *)ptr - HEAP_HDR_SIZE);
+    void *p = heap_caps_malloc(size, caps);
+    if (p) {
+        memcpy(p, ptr, old_size < size ? old_size : size);
+        heap_caps_free(ptr);
+    }
+    return p;
+}
+
+size_t heap_caps_get_allocated_size(void *ptr) {
+    return *(size_t *)((uint8_t *)ptr - HEAP_HDR_SIZE);
+}
+
+void host_heap_get_stats(host_heap_stats_t *stats) {
+    *stats = s_heap;
+}
+
+void host_heap_reset_peak(void) {
+    s_heap.peak = s_heap.used;
+}
+
+// ============== 模拟时钟 ==============
+
+// 由 ui_bench.c 推进，保证各场景可重复
+int64_t g_host_time_us = 0;
+
+int64_t esp_timer_get_time(void) {
+    return g_host_time_us;
+}
+
+// ============== 软件定时器 ==============
+
+static int s_dummy_timer;
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload,
+                           void *id, TimerCallbackFunction_t callback) {
+    (void)name;
+    (void)period;
+    (void)auto_reload;
+    (void)id;
+    (void)callback;
+    return &s_dummy_timer;
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t wait) {
+    (void)timer;
+    (void)wait;
+    return pdPASS;
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t wait) {
+    (void)timer;
+    (void)wait;
+    return pdPASS;
+}
+
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t wait) {
+    (void)timer;
+    (void)wait;
+    return pdPASS;
+}
@@ -0,0 +1,6 @@
+/**
+ * @file nvs_flash.h
+ * @brief 主机端空替身，仅为满足服务层头文件的包含关系
+ */
+
+#pragma once
@@ -0,0 +1,161 @@
+/**
+ * @file service_stubs.c
+ * @brief 主机端服务层替身：WiFi / AI / 笔记
+ *
+ * 只保留 UI 会调用到的接口，状态由 ui_bench.c 的场景脚本驱动。
+ */
+
+#include "service_stubs.h"
+#include "wifi_service.h"
+#include "ai_service.h"
+#include "note_service.h"
+
+// ============== WiFi ==============
+
+uint16_t WIFI_NUM = 0;
+bool Scan_finish = false;
+
+static bool s_wifi_connected = false;
+static wifi_state_callback_t s_wifi_callback = NULL;
+static void *s_wifi_user_data = NULL;
+
+bool WiFi_IsConnected(void) {
+    return s_wifi_connected;
+}
+
+bool WiFi_IsInitComplete(void) {
+    return s_wifi_connected;
+}
+
+const char *WiFi_GetError(void) {
+    return NULL;
+}
+
+wifi_link_state_t WiFi_GetLinkState(void) {
+    return s_wifi_connected ? WIFI_LINK_CONNECTED : WIFI_LINK_CONNECTING;
+}
+
+void WiFi_SetStateCallback(wifi_state_callback_t callback, void *user_data) {
+    s_wifi_user_data = user_data;
+    s_wifi_callback = callback;
+    if (callback) {
+        callback(WiFi_GetLinkState(), user_data);
+    }
+}
+
+void stub_wifi_set_connected(bool connected) {
+    s_wifi_connected = connected;
+    if (s_wifi_callback) {
+        s_wifi_callback(WiFi_GetLinkState(), s_wifi_user_data);
+    }
+}
+
+// ============== AI ==============
+
+static cg_ai_state_t s_ai_state = CG_AI_STATE_IDLE;
+static bool s_ai_active = false;
+static cg_ai_state_callback_t s_ai_callback = NULL;
+static void *s_ai_user_data = NULL;
+
+esp_err_t cg_ai_service_init(void) {
+    return ESP_OK;
+}
+
+void cg_ai_service_deinit(void) {
+}
+
+esp_err_t cg_ai_service_start(void) {
+    s_ai_active = true;
+    return ESP_OK;
+}
+
+void cg_ai_service_stop(void) {
+    s_ai_active = false;
+    s_ai_state = CG_AI_STATE_IDLE;
+}
+
+cg_ai_state_t cg_ai_service_get_state(void) {
+    return s_ai_state;
+}
+
+bool cg_ai_service_is_active(void) {
+    return s_ai_active;
+}
+
+void cg_ai_service_set_state_callback(cg_ai_state_callback_t callback, void *user_data) {
+    s_ai_callback = callback;
+    s_ai_user_data = user_data;
+}
+
+uint32_t cg_ai_service_get_last_activity_time(void) {
+    return 0;
+}
+
+bool cg_ai_service_is_timeout(uint32_t timeout_sec) {
+    (void)timeout_sec;
+    return false;
+}
+
+void stub_ai_set_state(cg_ai_state_t state) {
+    s_ai_state = state;
+    if (s_ai_callback) {
+        s_ai_callback(state, s_ai_user_data);
+    }
+}
+
+// ============== 笔记 ==============
+
+static bool s_recording = false;
+static uint32_t s_note_session = 0;
+static note_event_callback_t s_note_callback = NULL;
+static void *s_note_user_data = NULL;
+
+static void stub_note_emit(note_event_t event) {
+    if (s_note_callback) {
+        note_event_info_t info = {.event = event, .session_id = s_note_session};
+        s_note_callback(&info, s_note_user_data);
+    }
+}
+
+int start_note_recording(void) {
+    s_recording = true;
+    s_note_session++;
+    stub_note_emit(NOTE_EVENT_RECORDING);
+    return 0;
+}
+
+// 收尾在替身中同步走完：STOPPING 后直接给出最终结果
+int stop_note_recording(uint32_t duration_sec) {
+    s_recording = false;
+    stub_note_emit(NOTE_EVENT_STOPPING);
+    if (duration_sec >= 60) {
+        stub_note_emit(NOTE_EVENT_GENERATING);
+        stub_note_emit(NOTE_EVENT_DONE);
+    } else {
+        stub_note_emit(NOTE_EVENT_DISCARDED);
+    }
+    return 0;
+}
+
+void note_service_set_event_callback(note_event_callback_t callback, void *user_data) {
+    s_note_user_data = user_data;
+    s_note_callback = callback;
+}
+
+int note_service_pending_count(void) {
+    return 0;
+}
+
+int generate_note(const char *note_id, const char *device, bool is_voice, int type,
+                  const char *version) {
+    (void)note_id;
+    (void)device;
+    (void)is_voice;
+    (void)type;
+    (void)version;
+    return 0;
+}
+
+bool is_recording(void) {
+    return s_recording;
+}
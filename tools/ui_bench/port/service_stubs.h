@@ -0,0 +1,27 @@
+/**
+ * @file service_stubs.h
+ * @brief 主机端服务替身的场景控制接口
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "ai_service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 设置模拟的 WiFi 连接状态，并触发 UI 注册的状态回调
+ */
+void stub_wifi_set_connected(bool connected);
+
+/**
+ * @brief 切换模拟的 AI 状态，并触发页面注册的状态回调
+ */
+void stub_ai_set_state(cg_ai_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
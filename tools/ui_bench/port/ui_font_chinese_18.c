@@ -0,0 +1,16 @@
+/**
+ * @file ui_font_chinese_18.c
+ * @brief 主机端中文字体替身
+ *
+ * 固件里的 ui_font_chinese_18 由字体工具生成，不在仓库中。
+ * 这里借用 LVGL 自带的 simsun 16 CJK 字库顶替，保证中文标签按真实路径
+ * （查字形 + A4 位图混合）渲染，而不是退化成占位框。
+ */
+
+#include "lvgl.h"
+
+#undef LV_FONT_SIMSUN_16_CJK
+#define LV_FONT_SIMSUN_16_CJK 1
+#define lv_font_simsun_16_cjk ui_font_chinese_18
+
+#include "src/font/lv_font_simsun_16_cjk.c"
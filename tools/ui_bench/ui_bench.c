@@ -0,0 +1,477 @@
+/**
+ * @file ui_bench.c
+ * @brief EEZ 界面主机端渲染基准
+ *
+ * 在 Linux 上链接仓库内的 LVGL 与 eez_ui（screens.c、pages、eez-flow.cpp），
+ * 用内存帧缓冲代替 ST77916 面板，按脚本回放导航和状态变化：
+ * - boot:  loading 屏幕等待 WiFi -> 连接成功切到 main
+ * - notes: main -> page_notes，开始录音（呼吸灯）-> 结束录音 -> 返回
+ * - ai:    main -> page_ai，依次经过 连接中/聆听中/发送中/播放中 -> 退出
+ *
+ * 每个场景输出：帧数、渲染像素、flush 字节数、ui_tick 与 lv_timer_handler
+ * 的单次耗时（平均/最大）、LVGL 堆峰值，以及图片/字形缓存命中情况。
+ *
+ * 时间基准使用模拟时钟（每次循环推进 5ms，与 main.cpp 主循环一致），
+ * 帧数等计数结果可重复；耗时为本机实测值，只用于前后对比。
+ *
+ * ui_bench --eez-trace <文件>：同时把 eez::alloc / eez::free 的调用序列写入文件，
+ * 供 tools/eez_heap_bench 回放。
+ *
+ * ui_bench --resident <N>：常驻屏幕上限（screens_set_resident_max），4 为启动时创建全部屏幕。
+ * 输出末尾给出各屏幕的创建 / 预建 / 驱逐次数，以及单独创建每个屏幕的耗时和 LVGL 堆占用。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lvgl.h"
+#include "ui.h"
+#include "screens.h"
+#include "esp_heap_caps.h"
+#include "lvgl_mem.h"
+#include "eez_heap.h"
+#include "eez_watch.h"
+#include "eez_flow_sched.h"
+#include "ui_bindings.h"
+#include "eez_assets.h"
+#include "eez_string.h"
+#include "lvgl_cache.h"
+#include "lvgl_blend.h"
+#include "service_stubs.h"
+
+// ============== 配置 ==============
+
+// 与 st77916.h / lvgl_driver.h 保持一致
+#define BENCH_HOR_RES 360
+#define BENCH_VER_RES 360
+#define BENCH_BUF_LEN (BENCH_HOR_RES * BENCH_VER_RES / 20)
+
+// main.cpp 主循环：ui_tick(); vTaskDelay(5ms); lv_timer_handler();
+#define BENCH_LOOP_MS 5
+
+extern int64_t g_host_time_us;
+
+// ============== 统计 ==============
+
+typedef struct {
+    const char *name;
+    uint32_t loops;            // 主循环次数
+    uint32_t frames;           // 完成刷新的帧数
+    uint64_t rendered_px;      // 渲染像素数（monitor_cb 上报）
+    uint32_t flush_calls;      // flush_cb 调用次数
+    uint64_t flushed_bytes;    // flush 到帧缓冲的字节数
+    uint64_t tick_ns_total;    // ui_tick 总耗时
+    uint64_t tick_ns_max;      // ui_tick 最大耗时
+    uint64_t handler_ns_total; // lv_timer_handler 总耗时
+    uint64_t handler_ns_max;   // lv_timer_handler 最大耗时
+    size_t pool_peak;          // 场景内 LVGL 内部池峰值（按块大小计）
+    size_t bulk_peak;          // 场景内 LVGL 大块（PSRAM）峰值
+    size_t heap_end;           // 场景结束时 LVGL 堆总占用
+    uint32_t alloc_cnt;        // 场景内分配次数
+    int16_t end_screen;        // 场景结束时的屏幕 ID
+    lvgl_cache_stats_t cache;  // 场景内图片/字形缓存统计
+} bench_stats_t;
+
+static bench_stats_t *s_cur;
+static uint64_t s_ui_init_ns; // ui_init 实测耗时（含 create_screens）
+
+// ============== 内存帧缓冲显示驱动 ==============
+
+static lv_disp_draw_buf_t s_draw_buf;
+static lv_disp_drv_t s_disp_drv;
+static lv_color_t *s_buf1;
+static lv_color_t *s_buf2;
+static lv_color_t *s_framebuffer;
+
+static void bench_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map) {
+    int32_t w = lv_area_get_width(area);
+    size_t row_bytes = (size_t)w * sizeof(lv_color_t);
+
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        memcpy(&s_framebuffer[y * BENCH_HOR_RES + area->x1], color_map, row_bytes);
+        color_map += w;
+    }
+
+    if (s_cur) {
+        s_cur->flush_calls++;
+        s_cur->flushed_bytes += (uint64_t)row_bytes * lv_area_get_height(area);
+    }
+    lv_disp_flush_ready(drv);
+}
+
+static void bench_monitor_cb(lv_disp_drv_t *drv, uint32_t time, uint32_t px) {
+    (void)drv;
+    (void)time;
+    if (s_cur) {
+        s_cur->frames++;
+        s_cur->rendered_px += px;
+    }
+}
+
+static void bench_display_init(void) {
+    size_t buf_size = BENCH_BUF_LEN * sizeof(lv_color_t);
+    s_buf1 = heap_caps_malloc(buf_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    s_buf2 = heap_caps_malloc(buf_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    s_framebuffer = calloc(BENCH_HOR_RES * BENCH_VER_RES, sizeof(lv_color_t));
+    if (!s_buf1 || !s_buf2 || !s_framebuffer) {
+        fprintf(stderr, "显存分配失败\n");
+        exit(1);
+    }
+    lv_disp_draw_buf_init(&s_draw_buf, s_buf1, s_buf2, BENCH_BUF_LEN);
+
+    lv_disp_drv_init(&s_disp_drv);
+    s_disp_drv.hor_res = BENCH_HOR_RES;
+    s_disp_drv.ver_res = BENCH_VER_RES;
+    s_disp_drv.flush_cb = bench_flush_cb;
+    s_disp_drv.monitor_cb = bench_monitor_cb;
+    s_disp_drv.draw_buf = &s_draw_buf;
+    s_disp_drv.draw_ctx_init = lvgl_blend_init_ctx; // 与 lvgl_driver.c 相同的混合后端
+    lv_disp_drv_register(&s_disp_drv);
+}
+
+// ============== 主循环模拟 ==============
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief 按 main.cpp 的节奏运行 ms 毫秒（模拟时间）
+ */
+static void bench_run(uint32_t ms) {
+    for (uint32_t t = 0; t < ms; t += BENCH_LOOP_MS) {
+        g_host_time_us += BENCH_LOOP_MS * 1000;
+        lv_tick_inc(BENCH_LOOP_MS);
+
+        uint64_t t0 = now_ns();
+        ui_tick();
+        uint64_t t1 = now_ns();
+        lv_timer_handler();
+        uint64_t t2 = now_ns();
+        // 与 main.cpp 相同：帧周期减去渲染和循环等待后的剩余作为 flow tick 预算
+        uint64_t busy_us = (t2 - t1) / 1000 + BENCH_LOOP_MS * 1000;
+        uint64_t frame_us = LV_DISP_DEF_REFR_PERIOD * 1000;
+        eez_flow_set_frame_remaining_us(busy_us < frame_us ? (uint32_t)(frame_us - busy_us) : 0);
+
+        s_cur->loops++;
+        s_cur->tick_ns_total += t1 - t0;
+        s_cur->handler_ns_total += t2 - t1;
+        if (t1 - t0 > s_cur->tick_ns_max) {
+            s_cur->tick_ns_max = t1 - t0;
+        }
+        if (t2 - t1 > s_cur->handler_ns_max) {
+            s_cur->handler_ns_max = t2 - t1;
+        }
+    }
+}
+
+static void bench_click(lv_obj_t *obj) {
+    if (obj) {
+        lv_event_send(obj, LV_EVENT_PRESSED, NULL);
+        lv_event_send(obj, LV_EVENT_RELEASED, NULL);
+        lv_event_send(obj, LV_EVENT_CLICKED, NULL);
+    }
+}
+
+/**
+ * @brief 通过控件点击导航；若 flow 未切换屏幕则直接切换，保证后续场景可继续
+ */
+static void bench_goto(lv_obj_t *trigger, enum ScreensEnum screen_id) {
+    bench_click(trigger);
+    bench_run(100);
+    if (eez_flow_get_current_screen() != (int16_t)screen_id) {
+        printf("W (BENCH) flow 未切换到屏幕 %d，直接切换\n", screen_id);
+        eez_flow_set_screen(screen_id, LV_SCR_LOAD_ANIM_NONE, 0, 0);
+        bench_run(50);
+    }
+}
+
+static uint32_t mem_alloc_count(const lvgl_mem_stats_t *mem) {
+    uint32_t n = mem->psram_allocs + mem->heap_allocs;
+    for (int i = 0; i < LVGL_MEM_CLASS_NUM; i++) {
+        n += mem->cls[i].allocs;
+    }
+    return n;
+}
+
+static void bench_begin(bench_stats_t *stats, const char *name) {
+    lvgl_mem_stats_t mem;
+    memset(stats, 0, sizeof(*stats));
+    stats->name = name;
+    lvgl_mem_reset_peak();
+    lvgl_mem_get_stats(&mem);
+    stats->alloc_cnt = mem_alloc_count(&mem);
+    lvgl_cache_reset_stats();
+    s_cur = stats;
+}
+
+static void bench_end(bench_stats_t *stats) {
+    lvgl_mem_stats_t mem;
+    lvgl_mem_get_stats(&mem);
+    stats->pool_peak = mem.pool_peak_bytes;
+    stats->bulk_peak = mem.psram_peak_bytes + mem.heap_peak_bytes;
+    stats->heap_end = mem.pool_used_bytes + mem.psram_used_bytes + mem.heap_used_bytes;
+    stats->alloc_cnt = mem_alloc_count(&mem) - stats->alloc_cnt;
+    stats->end_screen = eez_flow_get_current_screen();
+    lvgl_cache_get_stats(&stats->cache);
+    s_cur = NULL;
+}
+
+// ============== 场景 ==============
+
+static void scenario_boot(bench_stats_t *stats) {
+    bench_begin(stats, "boot");
+    stub_wifi_set_connected(false);
+    uint64_t t0 = now_ns();
+    ui_init();
+    s_ui_init_ns = now_ns() - t0;
+    bench_run(1000); // loading 屏幕 spinner 转动，等待 WiFi
+    stub_wifi_set_connected(true);
+    bench_run(500); // ui_tick 检测到连接，切换到 main
+    bench_end(stats);
+}
+
+static void scenario_notes(bench_stats_t *stats) {
+    bench_begin(stats, "notes");
+    bench_goto(objects.btn_notes, SCREEN_ID_PAGE_NOTES);
+    bench_run(300);
+    bench_click(objects.btn_notes_start); // 开始录音，结束按钮呼吸灯
+    bench_run(3000);
+    bench_click(objects.btn_notes_end); // 结束录音
+    bench_run(300);
+    eez_flow_set_screen(SCREEN_ID_MAIN, LV_SCR_LOAD_ANIM_NONE, 0, 0);
+    bench_run(200);
+    bench_end(stats);
+}
+
+static void scenario_ai(bench_stats_t *stats) {
+    static const struct {
+        cg_ai_state_t state;
+        uint32_t ms;
+    } steps[] = {
+        { CG_AI_STATE_CONNECTING, 300 },
+        { CG_AI_STATE_CONNECTED, 100 },
+        { CG_AI_STATE_LISTENING, 1000 },
+        { CG_AI_STATE_SENDING, 1000 },
+        { CG_AI_STATE_SPEAKING, 2000 },
+        { CG_AI_STATE_LISTENING, 500 },
+    };
+
+    bench_begin(stats, "ai");
+    bench_goto(objects.obj0, SCREEN_ID_PAGE_CONF);
+    bench_run(300);
+    bench_click(objects.btn_ai_start); // 启动 AI 服务
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        stub_ai_set_state(steps[i].state);
+        bench_run(steps[i].ms);
+    }
+    bench_click(objects.btn_ai_start); // 停止服务并返回主界面
+    bench_run(300);
+    bench_end(stats);
+}
+
+// ============== 报告 ==============
+
+static void bench_print(const bench_stats_t *s, size_t n) {
+    printf("\n%-6s %6s %6s %10s %7s %10s %9s %9s %9s %9s %9s %9s %9s %8s %6s\n",
+           "scene", "loops", "frames", "render_px", "flushes", "flush_B",
+           "tick_us", "tick_max", "lvgl_us", "lvgl_max", "pool_pk", "bulk_pk", "heap_end", "allocs", "screen");
+    for (size_t i = 0; i < n; i++) {
+        double loops = s[i].loops ? (double)s[i].loops : 1.0;
+        printf("%-6s %6u %6u %10llu %7u %10llu %9.1f %9.1f %9.1f %9.1f %9zu %9zu %9zu %8u %6d\n",
+               s[i].name, s[i].loops, s[i].frames,
+               (unsigned long long)s[i].rendered_px, s[i].flush_calls,
+               (unsigned long long)s[i].flushed_bytes,
+               s[i].tick_ns_total / loops / 1000.0, s[i].tick_ns_max / 1000.0,
+               s[i].handler_ns_total / loops / 1000.0, s[i].handler_ns_max / 1000.0,
+               s[i].pool_peak, s[i].bulk_peak, s[i].heap_end, s[i].alloc_cnt, s[i].end_screen);
+    }
+
+    printf("\n%-6s %10s %10s %8s %8s %9s %9s\n",
+           "scene", "glyph_hit", "glyph_miss", "img_hit", "img_miss", "cache_B", "cache_pk");
+    for (size_t i = 0; i < n; i++) {
+        const lvgl_cache_stats_t *c = &s[i].cache;
+        printf("%-6s %10u %10u %8u %8u %9zu %9zu\n", s[i].name, c->glyph_hits, c->glyph_misses,
+               c->img_hits, c->img_misses, c->used_bytes, c->peak_bytes);
+    }
+
+    // 运行结束时 LVGL 内部池各级别的占用（高水位为最后一个场景内的值）
+    lvgl_mem_stats_t mem;
+    lvgl_mem_get_stats(&mem);
+    size_t page_bytes = (size_t)mem.pool_pages_used * LVGL_MEM_PAGE_SIZE;
+    printf("\n%-6s %6s %8s %8s %9s %9s   内部池 %zu / %zu 字节，页 %u / %u，页内碎片 %.1f%%\n",
+           "class", "pages", "in_use", "peak", "allocs", "overflow", mem.pool_used_bytes, mem.pool_bytes,
+           mem.pool_pages_used, mem.pool_pages_total,
+           page_bytes ? (1.0 - (double)mem.pool_used_bytes / page_bytes) * 100.0 : 0.0);
+    for (int i = 0; i < LVGL_MEM_CLASS_NUM; i++) {
+        const lvgl_mem_class_stats_t *c = &mem.cls[i];
+        printf("%-6u %6u %8u %8u %9u %9u\n", c->slot_size, c->pages, c->in_use, c->peak, c->allocs,
+               c->overflow);
+    }
+}
+
+// ============== 屏幕 ==============
+
+static size_t lvgl_heap_used(void) {
+    lvgl_mem_stats_t mem;
+    lvgl_mem_get_stats(&mem);
+    return mem.pool_used_bytes + mem.psram_used_bytes + mem.heap_used_bytes;
+}
+
+/**
+ * @brief 打印各屏幕的按需创建统计，再单独测每个屏幕的创建耗时和堆占用
+ *
+ * 主机上 esp_timer 是模拟时钟，screens_get_stats 中的耗时为 0，这里用实测时间。
+ * 测量时切到一个空白屏幕，测完所有屏幕都被删除，只能在最后调用。
+ */
+static void screens_print(void) {
+    static const char *names[UI_SCREEN_COUNT] = {"loading", "main", "notes", "ai"};
+    screens_stats_t ss;
+    screens_get_stats(&ss);
+
+    printf("\n屏幕: 常驻 %d / 上限 %d，ui_init %.1f us\n", ss.resident, ss.resident_max, s_ui_init_ns / 1000.0);
+    printf("%-8s %7s %8s %9s %6s %10s %10s %10s\n", "screen", "creates", "prewarms", "evictions", "shows", "cold_shows",
+           "create_us", "heap_B");
+
+    lv_obj_t *blank = lv_obj_create(NULL);
+    lv_scr_load(blank);
+    for (int i = 0; i < UI_SCREEN_COUNT; i++) {
+        delete_screen(i);
+    }
+    for (int i = 0; i < UI_SCREEN_COUNT; i++) {
+        const screen_stats_t *st = &ss.screens[i];
+        size_t heap0 = lvgl_heap_used();
+        uint64_t t0 = now_ns();
+        create_screen(i);
+        uint64_t t1 = now_ns();
+        size_t heap1 = lvgl_heap_used();
+        delete_screen(i);
+        printf("%-8s %7u %8u %9u %6u %10u %10.1f %10zu\n", names[i], st->creates, st->prewarms, st->evictions,
+               st->shows, st->cold_shows, (t1 - t0) / 1000.0, heap1 - heap0);
+    }
+}
+
+// ============== eez 分配跟踪 ==============
+
+// 指针按首次出现的顺序编号，跟踪文件与地址无关，可以跨机器回放
+#define TRACE_MAX_LIVE 4096
+
+typedef struct {
+    FILE *fp;
+    const void *ptr[TRACE_MAX_LIVE];
+    uint32_t handle[TRACE_MAX_LIVE];
+    uint32_t live;
+    uint32_t next_handle;
+} eez_trace_t;
+
+static void eez_trace_cb(char op, const void *ptr, uint32_t size, uint32_t id, void *user_data) {
+    eez_trace_t *t = user_data;
+    if (op == 'a') {
+        if (t->live == TRACE_MAX_LIVE) {
+            return;
+        }
+        t->ptr[t->live] = ptr;
+        t->handle[t->live] = t->next_handle;
+        t->live++;
+        fprintf(t->fp, "a %u %u 0x%08x\n", t->next_handle++, size, id);
+        return;
+    }
+    for (uint32_t i = t->live; i-- > 0;) {
+        if (t->ptr[i] == ptr) {
+            fprintf(t->fp, "f %u\n", t->handle[i]);
+            t->live--;
+            t->ptr[i] = t->ptr[t->live];
+            t->handle[i] = t->handle[t->live];
+            return;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    bench_stats_t stats[3];
+    static eez_trace_t trace;
+
+    const char *trace_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--eez-trace") == 0) {
+            trace_path = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--resident") == 0) {
+            screens_set_resident_max(atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "用法: %s [--eez-trace <文件>] [--resident <N>]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (trace_path) {
+        trace.fp = fopen(trace_path, "w");
+        if (!trace.fp) {
+            fprintf(stderr, "无法写入 %s\n", trace_path);
+            return 1;
+        }
+        eez_heap_set_trace(eez_trace_cb, &trace);
+    }
+
+    lv_init();
+    lvgl_cache_init(LVGL_CACHE_BUDGET_BYTES);
+    bench_display_init();
+
+    scenario_boot(&stats[0]);
+    scenario_notes(&stats[1]);
+    scenario_ai(&stats[2]);
+
+    bench_print(stats, sizeof(stats) / sizeof(stats[0]));
+
+    eez_heap_stats_t eh;
+    eez_heap_get_stats(&eh);
+    printf("\neez 堆: 使用中 %zu 字节（高水位 %zu），区块 %zu 字节，分配 %u / 释放 %u\n",
+           eh.block_bytes + eh.large_bytes, eh.peak_bytes, eh.reserved_bytes, eh.allocs, eh.frees);
+
+    eez_string_stats_t es;
+    eez_string_get_stats(&es);
+    eez_watch_stats_t tick_ws;
+    eez_flow_get_watch_stats(&tick_ws);
+    printf("eez 字符串: 内联 %u，驻留命中 %u（驻留 %u 个 / %u 字节），StringRef 分配 %u；平均每个 flow tick eez 分配 %.3f 次\n",
+           es.inlined, es.intern_hits, es.interned, es.arena_bytes, es.ref_allocs,
+           tick_ws.ticks ? (double)eh.allocs / tick_ws.ticks : 0.0);
+
+    eez_assets_info_t ai;
+    eez_assets_get_info(&ai);
+    printf("eez 资源: %u 字节，%s，占用 RAM %u 字节，选择 + 校验 %u us\n", (unsigned)ai.size,
+           ai.compressed ? "LZ4 压缩" : (ai.in_place ? "原地使用" : "拷贝后使用"), (unsigned)ai.ram_bytes,
+           (unsigned)ai.load_us);
+
+    eez_watch_stats_t ws;
+    eez_flow_get_watch_stats(&ws);
+    printf("eez watch: %u 个（可跟踪 %u / 每 tick 求值 %u），flow tick %u 次，每 tick 遍历 %.2f / 求值 %.2f\n",
+           ws.tracked + ws.dynamic, ws.tracked, ws.dynamic, ws.ticks,
+           ws.ticks ? (double)ws.visited / ws.ticks : 0.0, ws.ticks ? (double)ws.evaluated / ws.ticks : 0.0);
+
+    eez_flow_sched_stats_t ss;
+    eez_flow_get_sched_stats(&ss);
+    printf("eez 队列: 执行任务的 tick %u 次，预算 %u us，超预算 %u / 留到下个 tick %u，最长 tick %u us\n", ss.ticks,
+           ss.budget_us, ss.overruns, ss.deferred, ss.max_tick_us);
+    static const char *lane_names[EEZ_FLOW_LANE_COUNT] = {"input", "normal", "continuous"};
+    for (int i = 0; i < EEZ_FLOW_LANE_COUNT; i++) {
+        const eez_flow_lane_stats_t *l = &ss.lanes[i];
+        printf("  %-10s 执行 %6u  队列峰值 %4u  等待 平均 %8.1f / 最长 %6u us\n", lane_names[i], l->executed, l->max_depth,
+               l->executed ? (double)l->wait_us_sum / l->executed : 0.0, l->wait_us_max);
+    }
+
+    ui_bind_stats_t bs;
+    ui_bindings_get_stats(&bs);
+    printf("界面绑定: 发布 %u 次（值未变忽略 %u，事件 %u / 丢失 %u），ui_tick 处理变化 %u 次 / 无变化直接返回 %u 次\n",
+           bs.published, bs.unchanged, bs.events, bs.events_lost, bs.dispatches, bs.idle);
+
+    screens_print();
+
+    if (trace.fp) {
+        eez_heap_set_trace(NULL, NULL);
+        fclose(trace.fp);
+        printf("eez 分配跟踪已写入 %s（%u 次分配）\n", trace_path, trace.next_handle);
+    }
+    return 0;
+}
@@ -0,0 +1,299 @@
+/**
+ * @file watch_bench.cpp
+ * @brief EEZ flow WatchVariable 按变化求值主机端基准
+ *
+ * 当前界面工程没有 WatchVariable 组件（ui_bench 末尾的 eez watch 行为 0），
+ * 这里在 assets 的 flow 上拼一组 watch 表达式，按 visitWatchList 的判断逻辑
+ * （watchVisitBegin / watchIsDirty / watchVisitEnd，见 main/eez_ui/eez_watch.h）逐 tick 求值：
+ * - full：关闭依赖跟踪，每个 tick 求值全部 watch（原实现）
+ * - tracked：只求值依赖槽位被写过的 watch
+ *
+ * 输入按固定节奏经 onValueChanged() 写入（与 propagateValue 相同的路径），
+ * 两种模式触发的变化序列（tick、watch、新值）必须一致。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lvgl.h"
+#include "ui.h"
+#include "eez_watch.h"
+#include "esp_heap_caps.h"
+#include "lvgl_cache.h"
+
+using namespace eez;
+using namespace eez::flow;
+using namespace eez::flow::defs_v3;
+
+// ============== 配置 ==============
+
+#define BENCH_HOR_RES 360
+#define BENCH_VER_RES 360
+#define BENCH_BUF_LEN (BENCH_HOR_RES * BENCH_VER_RES / 20)
+
+#define TICKS 20000 // 每种模式的 tick 数
+#define MAX_WATCHES 64
+
+// ============== 显示（只为创建屏幕，不统计渲染） ==============
+
+static lv_disp_draw_buf_t s_draw_buf;
+static lv_disp_drv_t s_disp_drv;
+
+static void bench_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
+    (void)area;
+    (void)color_p;
+    lv_disp_flush_ready(drv);
+}
+
+static void bench_display_init(void) {
+    size_t buf_size = BENCH_BUF_LEN * sizeof(lv_color_t);
+    void *buf = heap_caps_malloc(buf_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buf) {
+        fprintf(stderr, "显存分配失败\n");
+        exit(1);
+    }
+    lv_disp_draw_buf_init(&s_draw_buf, buf, NULL, BENCH_BUF_LEN);
+    lv_disp_drv_init(&s_disp_drv);
+    s_disp_drv.hor_res = BENCH_HOR_RES;
+    s_disp_drv.ver_res = BENCH_VER_RES;
+    s_disp_drv.flush_cb = bench_flush_cb;
+    s_disp_drv.draw_buf = &s_draw_buf;
+    lv_disp_drv_register(&s_disp_drv);
+}
+
+// ============== watch 表达式 ==============
+
+typedef struct {
+    FlowState *flowState;
+    const uint8_t *instructions;
+    uint64_t depMask;
+    bool dynamic;
+    bool has;   // 已有上次的值
+    Value last; // 上次的值
+} bench_watch_t;
+
+static bench_watch_t s_watches[MAX_WATCHES];
+static int s_num_watches;
+
+static FlowState *s_flow_states[8]; // 有输入的 flow
+static int s_num_flow_states;
+
+#define CODE_BUF_LEN 2048
+
+static uint8_t s_code[CODE_BUF_LEN];
+static int s_code_len;
+
+// 指令助记（与 eez-flow.h 的 EXPR_EVAL_INSTRUCTION_* 编码一致）
+#define C(i) (uint16_t)(EXPR_EVAL_INSTRUCTION_TYPE_PUSH_CONSTANT | (i))
+#define IN(i) (uint16_t)(EXPR_EVAL_INSTRUCTION_TYPE_PUSH_INPUT | (i))
+#define OP(o) (uint16_t)(EXPR_EVAL_INSTRUCTION_TYPE_OPERATION | (o))
+#define END EXPR_EVAL_INSTRUCTION_TYPE_END
+
+static void add_watch(FlowState *flowState, const uint16_t *code, int n) {
+    if (s_num_watches >= MAX_WATCHES || s_code_len + n * 2 > CODE_BUF_LEN) {
+        return;
+    }
+    uint8_t *p = &s_code[s_code_len];
+    for (int i = 0; i < n; i++) {
+        p[2 * i] = code[i] & 0xFF;
+        p[2 * i + 1] = code[i] >> 8;
+    }
+    s_code_len += n * 2;
+
+    bench_watch_t *w = &s_watches[s_num_watches++];
+    w->flowState = flowState;
+    w->instructions = p;
+    w->dynamic = !watchResolveDeps(flowState, p, &w->depMask);
+}
+
+#define ADD_WATCH(...)                                                                                                 \
+    do {                                                                                                               \
+        const uint16_t code[] = {__VA_ARGS__};                                                                         \
+        add_watch(flowState, code, sizeof(code) / sizeof(code[0]));                                                    \
+    } while (0)
+
+static FlowState *find_flow_state(int flowIndex) {
+    for (FlowState *flowState = g_firstFlowState; flowState; flowState = flowState->nextSibling) {
+        if (flowState->flowIndex == flowIndex) {
+            return flowState;
+        }
+    }
+    return initPageFlowState(g_mainAssets, flowIndex, nullptr, 0);
+}
+
+/**
+ * 每个有输入的 flow、每个输入拼 3 个可跟踪的 watch，每个 flow 再加 1 个依赖 getTick 的 watch
+ * （结果恒等于输入 0，但 getTick 使依赖无法静态确定）
+ * @return watch 数
+ */
+static int build_watches(void) {
+    auto flowDefinition = static_cast<FlowDefinition *>(g_mainAssets->flowDefinition);
+
+    int ints[3];
+    int numInts = 0;
+    for (uint32_t k = 0; k < flowDefinition->constants.count && numInts < 3; k++) {
+        const Value *v = flowDefinition->constants[k];
+        if (v->isInt32() && v->int32Value != 0) {
+            ints[numInts++] = (int)k;
+        }
+    }
+    if (numInts < 3) {
+        return 0;
+    }
+    int a = ints[0], b = ints[1], c = ints[2];
+
+    for (uint32_t f = 0; f < flowDefinition->flows.count && s_num_flow_states < 8; f++) {
+        auto flow = flowDefinition->flows[f];
+        if (flow->componentInputs.count == 0) {
+            continue;
+        }
+        FlowState *flowState = find_flow_state(f);
+        if (!flowState) {
+            continue;
+        }
+        s_flow_states[s_num_flow_states++] = flowState;
+        for (uint32_t k = 0; k < flow->componentInputs.count; k++) {
+            ADD_WATCH(IN(k), C(a), OP(OPERATION_TYPE_ADD), END);
+            ADD_WATCH(IN(k), C(b), OP(OPERATION_TYPE_MUL), C(c), OP(OPERATION_TYPE_GREATER), END);
+            ADD_WATCH(IN(k), C(a), OP(OPERATION_TYPE_SUB), OP(OPERATION_TYPE_MATH_ABS), END);
+        }
+        // getTick() <= getTick() ? in0 : a
+        ADD_WATCH(OP(OPERATION_TYPE_SYSTEM_GET_TICK), OP(OPERATION_TYPE_SYSTEM_GET_TICK),
+                  OP(OPERATION_TYPE_LESS_OR_EQUAL), IN(0), C(a), OP(OPERATION_TYPE_CONDITIONAL), END);
+    }
+    return s_num_watches;
+}
+
+// ============== 负载 ==============
+
+/** 每个 flow 的输入按不同周期改写：flow j 的输入 k 每 (10 << j) + 7k 个 tick 写一次 */
+static void write_inputs(int tick) {
+    for (int j = 0; j < s_num_flow_states; j++) {
+        FlowState *flowState = s_flow_states[j];
+        for (uint32_t k = 0; k < flowState->flow->componentInputs.count; k++) {
+            int period = (10 << j) + 7 * (int)k;
+            if (tick % period == 0) {
+                Value *slot = &flowState->values[k];
+                *slot = Value(tick / period, VALUE_TYPE_INT32);
+                onValueChanged(slot);
+            }
+        }
+    }
+}
+
+static void reset_inputs(void) {
+    for (int j = 0; j < s_num_flow_states; j++) {
+        FlowState *flowState = s_flow_states[j];
+        for (uint32_t k = 0; k < flowState->flow->componentInputs.count; k++) {
+            flowState->values[k] = Value(0, VALUE_TYPE_INT32);
+        }
+    }
+    for (int i = 0; i < s_num_watches; i++) {
+        s_watches[i].has = false;
+        s_watches[i].last = Value();
+    }
+}
+
+// ============== 运行 ==============
+
+typedef struct {
+    uint32_t fires;
+    uint32_t evaluated;
+    uint32_t visited;
+    double ns_per_tick;
+    uint32_t hash; // 变化序列的 FNV-1a
+} bench_result_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint32_t fnv(uint32_t h, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        h = (h ^ ((v >> (i * 8)) & 0xFF)) * 16777619u;
+    }
+    return h;
+}
+
+/** 与 visitWatchList 相同的判断：动态 watch 或依赖变脏时求值，值变化时记一次触发 */
+static void visit(bench_result_t *r, int tick) {
+    uint32_t evaluated = 0;
+    watchVisitBegin();
+    for (int i = 0; i < s_num_watches; i++) {
+        bench_watch_t *w = &s_watches[i];
+        if (!w->dynamic && !watchIsDirty(w->depMask)) {
+            continue;
+        }
+        evaluated++;
+        Value value;
+        if (!evalExpression(w->flowState, 0, w->instructions, value, FlowError::Plain("watch_bench"))) {
+            continue;
+        }
+        if (!w->has || value != w->last) {
+            w->has = true;
+            w->last = value;
+            r->fires++;
+            r->hash = fnv(fnv(fnv(r->hash, (uint32_t)tick), (uint32_t)i), (uint32_t)value.toInt32());
+        }
+    }
+    watchVisitEnd((uint32_t)s_num_watches, evaluated);
+}
+
+static void run(bool tracking, bench_result_t *r) {
+    memset(r, 0, sizeof(*r));
+    r->hash = 2166136261u;
+    reset_inputs();
+    watchSetTracking(tracking);
+    watchResetStats();
+    // 第一轮所有 watch 求值一次（对应 WatchVariable 首次执行）
+    watchMarkAllDirty();
+
+    uint64_t t0 = now_ns();
+    for (int tick = 1; tick <= TICKS; tick++) {
+        visit(r, tick);
+        write_inputs(tick);
+    }
+    r->ns_per_tick = (double)(now_ns() - t0) / TICKS;
+
+    eez_watch_stats_t st;
+    watchGetStats(&st);
+    r->evaluated = st.evaluated;
+    r->visited = st.visited;
+}
+
+int main(void) {
+    lv_init();
+    lvgl_cache_init(LVGL_CACHE_BUDGET_BYTES);
+    bench_display_init();
+    ui_init();
+    lv_timer_handler();
+
+    enableThrowError(false);
+    if (build_watches() == 0) {
+        fprintf(stderr, "assets 中缺少拼 watch 表达式所需的常量 / flow 输入\n");
+        return 1;
+    }
+
+    bench_result_t full, tracked;
+    run(false, &full);
+    run(true, &tracked);
+
+    eez_watch_stats_t st;
+    watchGetStats(&st);
+    printf("watch %d 个（可跟踪 %u / 动态 %u），%d 个 flow，%d tick\n", s_num_watches, st.tracked, st.dynamic,
+           s_num_flow_states, TICKS);
+    printf("\n%-8s %10s %10s %8s %10s\n", "mode", "visit/tick", "eval/tick", "fires", "ns/tick");
+    printf("%-8s %10.2f %10.2f %8u %10.1f\n", "full", (double)full.visited / TICKS, (double)full.evaluated / TICKS,
+           full.fires, full.ns_per_tick);
+    printf("%-8s %10.2f %10.2f %8u %10.1f\n", "tracked", (double)tracked.visited / TICKS,
+           (double)tracked.evaluated / TICKS, tracked.fires, tracked.ns_per_tick);
+
+    bool ok = full.fires == tracked.fires && full.hash == tracked.hash;
+    printf("\n求值减少 %.1f%%，变化序列 %s\n", 100.0 * (1.0 - (double)tracked.evaluated / full.evaluated),
+           ok ? "一致" : "不一致");
+    return ok ? 0 : 1;
+}